@@ -138,6 +138,14 @@ bool cmCTestMultiProcessHandler::SetTests(TestMap tests,
   this->PendingTests = std::move(tests);
   this->Properties = std::move(properties);
   this->Total = this->PendingTests.size();
+  for (auto const& p : this->Properties) {
+    this->TestIndexByName[p.second->Name] = p.first;
+  }
+  for (auto const& t : this->PendingTests) {
+    for (int d : t.second.Depends) {
+      this->Dependents[d].insert(t.first);
+    }
+  }
   if (!this->CTest->GetShowOnly()) {
     this->ReadCostData();
     this->HasCycles = !this->CheckCycles();
@@ -803,8 +811,11 @@ void cmCTestMultiProcessHandler::FinishTestProcess(
     this->Failed->push_back(properties->Name);
   }
 
-  for (auto& t : this->PendingTests) {
-    t.second.Depends.erase(test);
+  for (int d : this->Dependents[test]) {
+    auto t = this->PendingTests.find(d);
+    if (t != this->PendingTests.end()) {
+      t->second.Depends.erase(test);
+    }
   }
 
   this->WriteCheckpoint(test);
@@ -821,7 +832,10 @@ void cmCTestMultiProcessHandler::FinishTestProcess(
 
 void cmCTestMultiProcessHandler::UpdateCostData()
 {
-  std::string fname = this->CTest->GetCostDataFile();
+  // Each shard records its costs separately.  They are combined into the
+  // cost data file by --merge-shards.
+  std::string fname =
+    this->TestHandler->GetShardFileName(this->CTest->GetCostDataFile());
   std::string tmpout = fname + ".tmp";
   cmsys::ofstream fout;
   fout.open(tmpout.c_str());
@@ -918,16 +932,86 @@ void cmCTestMultiProcessHandler::ReadCostData()
   }
 }
 
-int cmCTestMultiProcessHandler::SearchByName(cm::string_view name)
+std::unordered_map<std::string, float> cmCTestMultiProcessHandler::ReadCosts(
+  std::string const& fname)
 {
-  int index = -1;
+  std::unordered_map<std::string, float> costs;
+  cmsys::ifstream fin(fname.c_str());
+  std::string line;
+  while (std::getline(fin, line)) {
+    if (line == "---") {
+      break;
+    }
+    // Format: <name> <previous_runs> <avg_cost>
+    cm::optional<CostEntry> entry = splitCostLine(line);
+    if (!entry) {
+      break;
+    }
+    costs[std::string(entry->name)] = entry->cost;
+  }
+  return costs;
+}
 
-  for (auto const& p : this->Properties) {
-    if (p.second->Name == name) {
-      index = p.first;
+void cmCTestMultiProcessHandler::MergeCostData(
+  std::string const& fname, std::vector<std::string> const& shardFiles)
+{
+  // Entries of the shards replace those of the cost data file, which
+  // keep their order.  The tests that failed in the shards replace the
+  // list of failed tests.
+  std::vector<std::string> names;
+  std::unordered_map<std::string, std::pair<int, float>> entries;
+  std::vector<std::string> failed;
+  auto readFile = [&](std::string const& file, bool readFailed) {
+    cmsys::ifstream fin(file.c_str());
+    std::string line;
+    while (std::getline(fin, line)) {
+      if (line == "---") {
+        break;
+      }
+      // Format: <name> <previous_runs> <avg_cost>
+      cm::optional<CostEntry> entry = splitCostLine(line);
+      if (!entry) {
+        return;
+      }
+      std::string name(entry->name);
+      if (entries.find(name) == entries.end()) {
+        names.push_back(name);
+      }
+      entries[name] = std::make_pair(entry->prevRuns, entry->cost);
     }
+    while (readFailed && std::getline(fin, line)) {
+      if (!line.empty()) {
+        failed.push_back(line);
+      }
+    }
+  };
+  readFile(fname, false);
+  for (std::string const& shardFile : shardFiles) {
+    readFile(shardFile, true);
   }
-  return index;
+
+  std::string tmpout = fname + ".tmp";
+  cmsys::ofstream fout;
+  fout.open(tmpout.c_str());
+  for (std::string const& name : names) {
+    auto const& entry = entries[name];
+    fout << name << " " << entry.first << " " << entry.second << "\n";
+  }
+  fout << "---\n";
+  for (std::string const& f : failed) {
+    fout << f << "\n";
+  }
+  fout.close();
+  cmSystemTools::RenameFile(tmpout, fname);
+}
+
+int cmCTestMultiProcessHandler::SearchByName(cm::string_view name)
+{
+  auto it = this->TestIndexByName.find(std::string(name));
+  if (it == this->TestIndexByName.end()) {
+    return -1;
+  }
+  return it->second;
 }
 
 void cmCTestMultiProcessHandler::CreateTestCostList()
@@ -947,10 +1031,13 @@ void cmCTestMultiProcessHandler::CreateParallelTestCostList()
   priorityStack.emplace_back();
   TestSet& topLevel = priorityStack.back();
 
+  std::set<cm::string_view> lastTestsFailed(this->LastTestsFailed.begin(),
+                                            this->LastTestsFailed.end());
+
   // In parallel test runs add previously failed tests to the front
   // of the cost list and queue other tests for further sorting
   for (auto const& t : this->PendingTests) {
-    if (cm::contains(this->LastTestsFailed, this->Properties[t.first]->Name)) {
+    if (cm::contains(lastTestsFailed, this->Properties[t.first]->Name)) {
       // If the test failed last time, it should be run first.
       this->OrderedTests.push_back(t.first);
       alreadyOrderedTests.insert(t.first);
@@ -959,6 +1046,11 @@ void cmCTestMultiProcessHandler::CreateParallelTestCostList()
     }
   }
 
+  if (this->CTest->GetScheduleType() == "CriticalPath") {
+    this->CreateCriticalPathTestCostList(alreadyOrderedTests);
+    return;
+  }
+
   // In parallel test runs repeatedly move dependencies of the tests on
   // the current dependency level to the next level until no
   // further dependencies exist.
@@ -997,6 +1089,76 @@ void cmCTestMultiProcessHandler::CreateParallelTestCostList()
   }
 }
 
+void cmCTestMultiProcessHandler::CreateCriticalPathTestCostList(
+  TestSet& alreadyOrderedTests)
+{
+  // Find the tests waiting on each test, and order the tests such that
+  // every test comes after the tests it depends on.
+  std::unordered_map<int, TestList> dependents;
+  std::unordered_map<int, size_t> unfinishedDepends;
+  TestList dependencyOrder;
+  dependencyOrder.reserve(this->PendingTests.size());
+  for (auto const& t : this->PendingTests) {
+    size_t& unfinished = unfinishedDepends[t.first];
+    for (int d : t.second.Depends) {
+      if (cm::contains(this->PendingTests, d)) {
+        dependents[d].push_back(t.first);
+        ++unfinished;
+      }
+    }
+    if (unfinished == 0) {
+      dependencyOrder.push_back(t.first);
+    }
+  }
+  for (std::size_t i = 0; i < dependencyOrder.size(); ++i) {
+    for (int d : dependents[dependencyOrder[i]]) {
+      if (--unfinishedDepends[d] == 0) {
+        dependencyOrder.push_back(d);
+      }
+    }
+  }
+
+  // The priority of a test is the largest total COST of a chain of tests
+  // that starts with it, and then the number of tests in that chain.  A
+  // test on a long chain must start early or the chain finishes last, so
+  // this orders independent tests by cost and starts long chains first.
+  struct CriticalPath
+  {
+    float Cost = 0;
+    std::size_t Length = 0;
+    bool operator<(CriticalPath const& other) const
+    {
+      return this->Cost < other.Cost ||
+        (this->Cost == other.Cost && this->Length < other.Length);
+    }
+  };
+  std::unordered_map<int, CriticalPath> criticalPaths;
+  for (int test : cmReverseRange(dependencyOrder)) {
+    CriticalPath longest;
+    for (int d : dependents[test]) {
+      longest = std::max(longest, criticalPaths[d]);
+    }
+    longest.Cost += this->Properties[test]->Cost;
+    ++longest.Length;
+    criticalPaths[test] = longest;
+  }
+
+  TestList sortedTests;
+  for (int test : dependencyOrder) {
+    if (!cm::contains(alreadyOrderedTests, test)) {
+      sortedTests.push_back(test);
+    }
+  }
+  std::stable_sort(sortedTests.begin(), sortedTests.end(),
+                   [&criticalPaths](int a, int b) -> bool {
+                     return criticalPaths[b] < criticalPaths[a];
+                   });
+  for (int test : sortedTests) {
+    this->OrderedTests.push_back(test);
+    alreadyOrderedTests.insert(test);
+  }
+}
+
 void cmCTestMultiProcessHandler::GetAllTestDependencies(int test,
                                                         TestList& dependencies)
 {
@@ -1042,8 +1204,8 @@ void cmCTestMultiProcessHandler::CreateSerialTestCostList()
 
 void cmCTestMultiProcessHandler::WriteCheckpoint(int index)
 {
-  std::string fname =
-    this->CTest->GetBinaryDir() + "/Testing/Temporary/CTestCheckpoint.txt";
+  std::string fname = this->TestHandler->GetShardFileName(
+    this->CTest->GetBinaryDir() + "/Testing/Temporary/CTestCheckpoint.txt");
   cmsys::ofstream fout;
   fout.open(fname.c_str(), std::ios::app);
   fout << index << "\n";
@@ -1052,8 +1214,8 @@ void cmCTestMultiProcessHandler::WriteCheckpoint(int index)
 
 void cmCTestMultiProcessHandler::MarkFinished()
 {
-  std::string fname =
-    this->CTest->GetBinaryDir() + "/Testing/Temporary/CTestCheckpoint.txt";
+  std::string fname = this->TestHandler->GetShardFileName(
+    this->CTest->GetBinaryDir() + "/Testing/Temporary/CTestCheckpoint.txt");
   cmSystemTools::RemoveFile(fname);
 }
 
@@ -1518,8 +1680,8 @@ void cmCTestMultiProcessHandler::PrintLabels()
 
 void cmCTestMultiProcessHandler::CheckResume()
 {
-  std::string fname =
-    this->CTest->GetBinaryDir() + "/Testing/Temporary/CTestCheckpoint.txt";
+  std::string fname = this->TestHandler->GetShardFileName(
+    this->CTest->GetBinaryDir() + "/Testing/Temporary/CTestCheckpoint.txt");
   if (this->CTest->GetFailover()) {
     if (cmSystemTools::FileExists(fname, true)) {
       *this->TestHandler->LogFile
@@ -1546,6 +1708,7 @@ void cmCTestMultiProcessHandler::RemoveTest(int index)
   this->OrderedTests.erase(
     std::find(this->OrderedTests.begin(), this->OrderedTests.end(), index));
   this->PendingTests.erase(index);
+  this->TestIndexByName.erase(this->Properties[index]->Name);
   this->Properties.erase(index);
   this->Completed++;
 }
@@ -10,6 +10,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <cm/optional>
@@ -99,6 +100,13 @@ public:
 
   void CheckResourceAvailability();
 
+  // Read the average cost of each test from a cost data file.
+  static std::unordered_map<std::string, float> ReadCosts(
+    std::string const& fname);
+  // Combine the cost data files written by shards into a cost data file.
+  static void MergeCostData(std::string const& fname,
+                            std::vector<std::string> const& shardFiles);
+
 protected:
   // Start the next test or tests as many as are allowed by
   // ParallelLevel
@@ -119,6 +127,7 @@ protected:
   void CreateSerialTestCostList();
 
   void CreateParallelTestCostList();
+  void CreateCriticalPathTestCostList(TestSet& alreadyOrderedTests);
 
   // Removes the checkpoint file
   void MarkFinished();
@@ -179,6 +188,8 @@ private:
 
   // Tests pending selection to start.  They may have dependencies.
   TestMap PendingTests;
+  // Tests depending on each test, to update when it finishes.
+  std::map<int, TestSet> Dependents;
   // List of pending test indexes, ordered by cost.
   std::list<int> OrderedTests;
   // Total number of tests we'll be running
@@ -191,6 +202,8 @@ private:
   bool StopTimePassed = false;
   // list of test properties (indices concurrent to the test map)
   PropertiesMap Properties;
+  // Index of each test by name, to look up cost data.
+  std::unordered_map<std::string, int> TestIndexByName;
   std::map<int, std::string> TestOutput;
   std::vector<std::string>* Passed;
   std::vector<std::string>* Failed;
@@ -7,14 +7,21 @@
 #include <cstddef> // IWYU pragma: keep
 #include <cstdint>
 #include <cstdio>
+#include <functional>
+#include <initializer_list>
 #include <iomanip>
+#include <ios>
 #include <ratio>
+#include <set>
 #include <sstream>
 #include <utility>
 
 #include <cm/memory>
 #include <cm/optional>
 
+#include <cm3p/uv.h>
+
+#include "cmsys/FStream.hxx"
 #include "cmsys/RegularExpression.hxx"
 
 #include "cmCTest.h"
@@ -28,6 +35,12 @@
 #include "cmUVHandlePtr.h"
 #include "cmWorkingDirectory.h"
 
+namespace {
+// Output of a test is kept in memory in full until it grows beyond this
+// size, or beyond four times the largest truncation threshold.
+size_t const BoundedOutputMinimum = 1024 * 1024;
+}
+
 cmCTestRunTest::cmCTestRunTest(cmCTestMultiProcessHandler& multiHandler,
                                int index)
   : MultiTestHandler(multiHandler)
@@ -38,6 +51,11 @@ cmCTestRunTest::cmCTestRunTest(cmCTestMultiProcessHandler& multiHandler,
 {
 }
 
+cmCTestRunTest::~cmCTestRunTest()
+{
+  this->RemoveOutputSpillFile();
+}
+
 void cmCTestRunTest::CheckOutput(std::string const& line)
 {
   cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
@@ -74,13 +92,23 @@ void cmCTestRunTest::CheckOutput(std::string const& line)
     }
   }
 
-  this->ProcessOutput += line;
-  this->ProcessOutput += "\n";
+  if (this->BoundedOutput) {
+    this->AppendBoundedOutput(line);
+  } else {
+    this->ProcessOutput += line;
+    this->ProcessOutput += "\n";
+    if (this->OutputWindow &&
+        this->ProcessOutput.size() >
+          std::max(4 * this->OutputWindow, BoundedOutputMinimum)) {
+      this->StartBoundedOutput();
+    }
+  }
 
-  // Check for TIMEOUT_AFTER_MATCH property.
+  // Check for TIMEOUT_AFTER_MATCH property.  Once the output is bounded,
+  // look only at the new line instead of scanning everything again.
   if (!this->TestProperties->TimeoutRegularExpressions.empty()) {
     for (auto& reg : this->TestProperties->TimeoutRegularExpressions) {
-      if (reg.first.find(this->ProcessOutput)) {
+      if (reg.first.find(this->BoundedOutput ? line : this->ProcessOutput)) {
         cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                    this->GetIndex()
                      << ": "
@@ -103,6 +131,7 @@ cmCTestRunTest::EndTestResult cmCTestRunTest::EndTest(size_t completed,
                                                       size_t total,
                                                       bool started)
 {
+  this->FinishBoundedOutput();
   this->WriteLogOutputTop(completed, total);
   std::string reason;
   bool passed = true;
@@ -117,7 +146,7 @@ cmCTestRunTest::EndTestResult cmCTestRunTest::EndTest(size_t completed,
       this->FailedDependencies.empty()) {
     bool found = false;
     for (auto& pass : this->TestProperties->RequiredRegularExpressions) {
-      if (pass.first.find(this->ProcessOutput)) {
+      if (this->FindInOutput(pass.first)) {
         found = true;
         reason = cmStrCat("Required regular expression found. Regex=[",
                           pass.second, ']');
@@ -137,7 +166,7 @@ cmCTestRunTest::EndTestResult cmCTestRunTest::EndTest(size_t completed,
   if (!this->TestProperties->ErrorRegularExpressions.empty() &&
       this->FailedDependencies.empty()) {
     for (auto& fail : this->TestProperties->ErrorRegularExpressions) {
-      if (fail.first.find(this->ProcessOutput)) {
+      if (this->FindInOutput(fail.first)) {
         reason = cmStrCat("Error regular expression found in output. Regex=[",
                           fail.second, ']');
         forceFail = true;
@@ -148,7 +177,7 @@ cmCTestRunTest::EndTestResult cmCTestRunTest::EndTest(size_t completed,
   if (!this->TestProperties->SkipRegularExpressions.empty() &&
       this->FailedDependencies.empty()) {
     for (auto& skip : this->TestProperties->SkipRegularExpressions) {
-      if (skip.first.find(this->ProcessOutput)) {
+      if (this->FindInOutput(skip.first)) {
         reason = cmStrCat("Skip regular expression found in output. Regex=[",
                           skip.second, ']');
         forceSkip = true;
@@ -273,7 +302,10 @@ cmCTestRunTest::EndTestResult cmCTestRunTest::EndTest(size_t completed,
   }
 
   if (outputTestErrorsToConsole) {
-    cmCTestLog(this->CTest, HANDLER_OUTPUT, this->ProcessOutput << std::endl);
+    this->WriteProcessOutput([this](std::string const& output) {
+      cmCTestLog(this->CTest, HANDLER_OUTPUT, output);
+    });
+    cmCTestLog(this->CTest, HANDLER_OUTPUT, std::endl);
   }
 
   if (!resourceSpecParseError.empty()) {
@@ -290,6 +322,14 @@ cmCTestRunTest::EndTestResult cmCTestRunTest::EndTest(size_t completed,
     *this->TestHandler->LogFile << "Test time = " << buf << std::endl;
   }
 
+  // The head and tail windows of bounded output are enough to truncate it.
+  if (this->BoundedOutput) {
+    this->ProcessOutput += this->OutputTail;
+    this->OutputTail.clear();
+    this->BoundedOutput = false;
+    this->RemoveOutputSpillFile();
+  }
+
   this->ParseOutputForMeasurements();
 
   // if this is doing MemCheck then all the output needs to be put into
@@ -558,6 +598,16 @@ bool cmCTestRunTest::StartTest(size_t completed, size_t total)
 
   this->ProcessOutput.clear();
 
+  // Large output may be bounded in memory only if it will be truncated.
+  // MemCheck parses all of the output.
+  this->OutputWindow = 0;
+  int const sizePassed = this->TestHandler->TestOptions.OutputSizePassed;
+  int const sizeFailed = this->TestHandler->TestOptions.OutputSizeFailed;
+  if (!this->TestHandler->MemCheck && sizePassed > 0 && sizeFailed > 0) {
+    this->OutputWindow =
+      static_cast<size_t>(std::max(sizePassed, sizeFailed));
+  }
+
   this->TestResult.Properties = this->TestProperties;
   this->TestResult.ExecutionTime = cmDuration::zero();
   this->TestResult.CompressOutput = false;
@@ -766,6 +816,149 @@ void cmCTestRunTest::ParseOutputForMeasurements()
   }
 }
 
+void cmCTestRunTest::StartBoundedOutput()
+{
+  this->BoundedOutput = true;
+  this->BoundedOutputNeedsAll =
+    this->ProcessOutput.find("CTEST_FULL_OUTPUT") != std::string::npos ||
+    this->ProcessOutput.find("<DartMeasurement") != std::string::npos ||
+    this->ProcessOutput.find("<CTestMeasurement") != std::string::npos;
+
+  // Search the output so far once.  Later lines are searched as they come.
+  this->OutputMatches.clear();
+  for (auto* regexes : { &this->TestProperties->RequiredRegularExpressions,
+                         &this->TestProperties->ErrorRegularExpressions,
+                         &this->TestProperties->SkipRegularExpressions }) {
+    for (auto& regex : *regexes) {
+      if (regex.first.find(this->ProcessOutput)) {
+        this->OutputMatches.insert(&regex.first);
+      }
+    }
+  }
+
+  // Other ctest processes, e.g. other shards, may run the same test in
+  // the same build tree.
+  this->OutputSpillName =
+    cmStrCat(this->CTest->GetBinaryDir(), "/Testing/Temporary/CTestOutput-",
+             uv_os_getpid(), '-', this->Index, ".tmp");
+  this->OutputSpill.open(this->OutputSpillName.c_str(),
+                         std::ios::out | std::ios::binary);
+  this->OutputSpillFailed = !this->OutputSpill;
+  this->OutputSpillSize = 0;
+
+  this->OutputTail = this->ProcessOutput.substr(this->OutputWindow);
+  this->ProcessOutput.resize(this->OutputWindow);
+  this->SpillOutputTail();
+}
+
+void cmCTestRunTest::AppendBoundedOutput(std::string const& line)
+{
+  if (!this->BoundedOutputNeedsAll &&
+      (line.find("CTEST_FULL_OUTPUT") != std::string::npos ||
+       line.find("<DartMeasurement") != std::string::npos ||
+       line.find("<CTestMeasurement") != std::string::npos)) {
+    this->BoundedOutputNeedsAll = true;
+  }
+
+  for (auto* regexes : { &this->TestProperties->RequiredRegularExpressions,
+                         &this->TestProperties->ErrorRegularExpressions,
+                         &this->TestProperties->SkipRegularExpressions }) {
+    for (auto& regex : *regexes) {
+      if (this->OutputMatches.count(&regex.first) == 0 &&
+          regex.first.find(line)) {
+        this->OutputMatches.insert(&regex.first);
+      }
+    }
+  }
+
+  this->OutputTail += line;
+  this->OutputTail += "\n";
+  this->SpillOutputTail();
+}
+
+void cmCTestRunTest::SpillOutputTail()
+{
+  // Let the tail grow to twice the window before moving its older part
+  // out so that each byte is moved once.
+  if (this->OutputTail.size() <= 2 * this->OutputWindow) {
+    return;
+  }
+  size_t const n = this->OutputTail.size() - this->OutputWindow;
+  if (!this->OutputSpillFailed) {
+    this->OutputSpill.write(this->OutputTail.data(),
+                            static_cast<std::streamsize>(n));
+    this->OutputSpillFailed = !this->OutputSpill;
+  }
+  this->OutputSpillSize += n;
+  this->OutputTail.erase(0, n);
+}
+
+void cmCTestRunTest::FinishBoundedOutput()
+{
+  if (!this->BoundedOutput) {
+    return;
+  }
+  this->OutputSpill.close();
+  if (!this->BoundedOutputNeedsAll || this->OutputSpillFailed) {
+    return;
+  }
+
+  // The output asks to be kept in full or has measurements to parse.
+  std::string output;
+  output.reserve(this->ProcessOutput.size() + this->OutputSpillSize +
+                 this->OutputTail.size());
+  this->WriteProcessOutput(
+    [&output](std::string const& part) { output += part; });
+  this->ProcessOutput = std::move(output);
+  this->OutputTail.clear();
+  this->BoundedOutput = false;
+  this->RemoveOutputSpillFile();
+}
+
+void cmCTestRunTest::WriteProcessOutput(
+  std::function<void(std::string const&)> const& write)
+{
+  write(this->ProcessOutput);
+  if (!this->BoundedOutput) {
+    return;
+  }
+  if (this->OutputSpillFailed) {
+    write(cmStrCat("\n[", this->OutputSpillSize,
+                   " bytes of the test output could not be written to ",
+                   this->OutputSpillName, "]\n"));
+  } else {
+    cmsys::ifstream fin(this->OutputSpillName.c_str(),
+                        std::ios::in | std::ios::binary);
+    std::string part(64 * 1024, '\0');
+    while (fin) {
+      fin.read(&part[0], static_cast<std::streamsize>(part.size()));
+      auto const n = static_cast<size_t>(fin.gcount());
+      if (n == 0) {
+        break;
+      }
+      write(n == part.size() ? part : part.substr(0, n));
+    }
+  }
+  write(this->OutputTail);
+}
+
+void cmCTestRunTest::RemoveOutputSpillFile()
+{
+  if (!this->OutputSpillName.empty()) {
+    this->OutputSpill.close();
+    cmSystemTools::RemoveFile(this->OutputSpillName);
+    this->OutputSpillName.clear();
+  }
+}
+
+bool cmCTestRunTest::FindInOutput(cmsys::RegularExpression& regex)
+{
+  if (this->BoundedOutput) {
+    return this->OutputMatches.count(&regex) != 0;
+  }
+  return regex.find(this->ProcessOutput);
+}
+
 bool cmCTestRunTest::ForkProcess()
 {
   this->TestProcess->SetId(this->Index);
@@ -1003,8 +1196,10 @@ void cmCTestRunTest::WriteLogOutputTop(size_t completed, size_t total)
     << "Output:" << std::endl
     << "----------------------------------------------------------"
     << std::endl;
-  *this->TestHandler->LogFile << this->ProcessOutput << "<end of output>"
-                              << std::endl;
+  this->WriteProcessOutput([this](std::string const& output) {
+    *this->TestHandler->LogFile << output;
+  });
+  *this->TestHandler->LogFile << "<end of output>" << std::endl;
 
   if (!this->CTest->GetTestProgressOutput()) {
     cmCTestLog(this->CTest, HANDLER_OUTPUT, outputStream.str());
@@ -5,12 +5,16 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "cmsys/FStream.hxx"
+#include "cmsys/RegularExpression.hxx"
+
 #include "cmCTest.h"
 #include "cmCTestMultiProcessHandler.h"
 #include "cmCTestTestHandler.h"
@@ -25,6 +29,7 @@ class cmCTestRunTest
 {
 public:
   explicit cmCTestRunTest(cmCTestMultiProcessHandler& multiHandler, int index);
+  ~cmCTestRunTest();
 
   void SetNumberOfRuns(int n)
   {
@@ -107,6 +112,16 @@ public:
 private:
   bool NeedsToRepeat();
   void ParseOutputForMeasurements();
+  // Keep only head and tail windows of large output in memory.
+  void StartBoundedOutput();
+  void AppendBoundedOutput(std::string const& line);
+  void SpillOutputTail();
+  void FinishBoundedOutput();
+  void WriteProcessOutput(
+    std::function<void(std::string const&)> const& write);
+  void RemoveOutputSpillFile();
+  // Search the output for a regular expression of the test properties.
+  bool FindInOutput(cmsys::RegularExpression& regex);
   void ExeNotFound(std::string exe);
   bool ForkProcess();
   void WriteLogOutputTop(size_t completed, size_t total);
@@ -126,6 +141,18 @@ private:
 
   std::unique_ptr<cmProcess> TestProcess;
   std::string ProcessOutput;
+  // Once the output grows large, ProcessOutput holds only its head and
+  // OutputTail its most recent part.  The output in between is spilled
+  // to a temporary file so that the test log still gets all of it.
+  bool BoundedOutput = false;
+  bool BoundedOutputNeedsAll = false;
+  size_t OutputWindow = 0;
+  std::string OutputTail;
+  std::string OutputSpillName;
+  cmsys::ofstream OutputSpill;
+  bool OutputSpillFailed = false;
+  size_t OutputSpillSize = 0;
+  std::set<cmsys::RegularExpression const*> OutputMatches;
   cmCTestTestHandler::cmCTestTestResult TestResult;
   std::set<std::string> FailedDependencies;
   std::string StartTime;
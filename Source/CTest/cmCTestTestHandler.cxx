@@ -12,9 +12,11 @@
 #include <functional>
 #include <iomanip>
 #include <iterator>
+#include <map>
 #include <ratio>
 #include <set>
 #include <sstream>
+#include <unordered_map>
 #include <utility>
 
 #ifndef _WIN32
@@ -23,9 +25,14 @@
 
 #include <cm/memory>
 #include <cm/string_view>
+#include <cm/vector>
 #include <cmext/algorithm>
 #include <cmext/string_view>
 
+#include <cm3p/json/reader.h>
+#include <cm3p/json/value.h>
+#include <cm3p/json/writer.h>
+
 #include "cmsys/FStream.hxx"
 #include <cmsys/Base64.h>
 #include <cmsys/Directory.hxx>
@@ -39,18 +46,21 @@
 #include "cmCTestTestMeasurementXMLParser.h"
 #include "cmDuration.h"
 #include "cmExecutionStatus.h"
+#include "cmFileTime.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGlobalGenerator.h"
 #include "cmInstrumentation.h"
 #include "cmInstrumentationQuery.h"
 #include "cmList.h"
 #include "cmMakefile.h"
+#include "cmMessageType.h"
 #include "cmState.h"
 #include "cmStateSnapshot.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmTimestamp.h"
 #include "cmValue.h"
+#include "cmVersion.h"
 #include "cmWorkingDirectory.h"
 #include "cmXMLWriter.h"
 #include "cmake.h"
@@ -88,8 +98,10 @@ public:
   cmCTestTestHandler* TestHandler;
 };
 
-bool ReadSubdirectory(std::string fname, cmExecutionStatus& status)
+bool ReadSubdirectory(std::string fname, cmExecutionStatus& status,
+                      cmCTestTestHandler* testHandler)
 {
+  testHandler->AddTestSubdirectory(fname);
   if (!cmSystemTools::FileExists(fname)) {
     // No subdirectory? So what...
     return true;
@@ -114,7 +126,12 @@ bool ReadSubdirectory(std::string fname, cmExecutionStatus& status)
     }
     fname += "/";
     fname += testFilename;
+    if (testHandler->ReplayTestFile(fname, status.GetMakefile())) {
+      return true;
+    }
+    testHandler->BeginTestFile(fname);
     readit = status.GetMakefile().ReadDependentFile(fname);
+    testHandler->EndTestFile(status.GetMakefile());
   }
   if (!readit) {
     status.SetError(cmStrCat("Could not find include file: ", fname));
@@ -123,8 +140,17 @@ bool ReadSubdirectory(std::string fname, cmExecutionStatus& status)
   return true;
 }
 
-bool cmCTestSubdirCommand(std::vector<std::string> const& args,
-                          cmExecutionStatus& status)
+class cmCTestSubdirCommand : public cmCTestCommand
+{
+public:
+  using cmCTestCommand::cmCTestCommand;
+
+  bool InitialPass(std::vector<std::string> const& args,
+                   cmExecutionStatus& status) override;
+};
+
+bool cmCTestSubdirCommand::InitialPass(std::vector<std::string> const& args,
+                                       cmExecutionStatus& status)
 {
   if (args.empty()) {
     status.SetError("called with incorrect number of arguments");
@@ -140,15 +166,24 @@ bool cmCTestSubdirCommand(std::vector<std::string> const& args,
       fname = cmStrCat(cwd, '/', arg);
     }
 
-    if (!ReadSubdirectory(std::move(fname), status)) {
+    if (!ReadSubdirectory(std::move(fname), status, this->TestHandler)) {
       return false;
     }
   }
   return true;
 }
 
-bool cmCTestAddSubdirectoryCommand(std::vector<std::string> const& args,
-                                   cmExecutionStatus& status)
+class cmCTestAddSubdirectoryCommand : public cmCTestCommand
+{
+public:
+  using cmCTestCommand::cmCTestCommand;
+
+  bool InitialPass(std::vector<std::string> const& args,
+                   cmExecutionStatus& status) override;
+};
+
+bool cmCTestAddSubdirectoryCommand::InitialPass(
+  std::vector<std::string> const& args, cmExecutionStatus& status)
 {
   if (args.empty()) {
     status.SetError("called with incorrect number of arguments");
@@ -158,7 +193,7 @@ bool cmCTestAddSubdirectoryCommand(std::vector<std::string> const& args,
   std::string fname =
     cmStrCat(cmSystemTools::GetLogicalWorkingDirectory(), '/', args[0]);
 
-  return ReadSubdirectory(std::move(fname), status);
+  return ReadSubdirectory(std::move(fname), status, this->TestHandler);
 }
 
 class cmCTestAddTestCommand : public cmCTestCommand
@@ -181,7 +216,8 @@ bool cmCTestAddTestCommand::InitialPass(std::vector<std::string> const& args,
     status.SetError("called with incorrect number of arguments");
     return false;
   }
-  return this->TestHandler->AddTest(args);
+  return this->TestHandler->AddTest(
+    args, cmSystemTools::GetLogicalWorkingDirectory());
 }
 
 class cmCTestSetTestsPropertiesCommand : public cmCTestCommand
@@ -219,7 +255,8 @@ public:
 bool cmCTestSetDirectoryPropertiesCommand::InitialPass(
   std::vector<std::string> const& args, cmExecutionStatus&)
 {
-  return this->TestHandler->SetDirectoryProperties(args);
+  return this->TestHandler->SetDirectoryProperties(
+    args, cmSystemTools::GetLogicalWorkingDirectory());
 }
 
 // get the next number in a string with numbers separated by ,
@@ -274,6 +311,105 @@ inline int GetNextRealNumber(std::string const& in, double& val,
   return 0;
 }
 
+// Identify the format of the test manifest.  Change this whenever
+// the format or the meaning of the recorded commands changes.
+char const* const TestManifestFormat = "CTestTestManifest 2";
+
+// Write a string with its length so any content round-trips.
+void WriteTestManifestString(std::ostream& os, cm::string_view s)
+{
+  os << s.size() << ' ' << s << '\n';
+}
+
+void WriteTestManifestNumber(std::ostream& os, long long n)
+{
+  WriteTestManifestString(os, std::to_string(n));
+}
+
+class TestManifestParser
+{
+public:
+  explicit TestManifestParser(std::string content)
+    : Content(std::move(content))
+  {
+  }
+
+  bool Read(std::string& s)
+  {
+    std::size_t const size = this->Content.size();
+    std::size_t pos = this->Pos;
+    std::size_t n = 0;
+    while (pos < size && pos - this->Pos < 18 && this->Content[pos] >= '0' &&
+           this->Content[pos] <= '9') {
+      n = n * 10 + static_cast<std::size_t>(this->Content[pos] - '0');
+      ++pos;
+    }
+    if (pos == this->Pos || pos >= size || this->Content[pos] != ' ' ||
+        size - pos - 1 < n + 1 || this->Content[pos + 1 + n] != '\n') {
+      return false;
+    }
+    s.assign(this->Content, pos + 1, n);
+    this->Pos = pos + n + 2;
+    return true;
+  }
+
+  bool Read(long long& n)
+  {
+    std::string s;
+    return this->Read(s) && cmStrToLongLong(s, &n);
+  }
+
+  bool Read(std::size_t& n)
+  {
+    long long value = 0;
+    if (!this->Read(value) || value < 0) {
+      return false;
+    }
+    n = static_cast<std::size_t>(value);
+    return true;
+  }
+
+  bool AtEnd() const { return this->Pos == this->Content.size(); }
+
+private:
+  std::string Content;
+  std::size_t Pos = 0;
+};
+
+// Whether an argument may reference a variable.  Test files generated by
+// CMake escape every '$' in the values they write.
+bool MayReferenceVariable(std::string const& value)
+{
+  for (std::size_t pos = value.find('$'); pos != std::string::npos;
+       pos = value.find('$', pos + 1)) {
+    std::size_t backslashes = 0;
+    while (backslashes < pos && value[pos - backslashes - 1] == '\\') {
+      ++backslashes;
+    }
+    if (backslashes % 2 == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Test files generated by CMake only call these commands.  Files calling
+// anything else, or reading variables that another test file may set,
+// may depend on state that the manifest does not record.
+bool IsTestManifestCommand(cmListFileFunction const& func)
+{
+  static std::set<cm::string_view> const commands = {
+    "add_subdirectory"_s, "add_test"_s, "set_directory_properties"_s,
+    "set_tests_properties"_s, "subdirs"_s
+  };
+  if (!cm::contains(commands, func.LowerCaseName())) {
+    return false;
+  }
+  return std::none_of(func.Arguments().begin(), func.Arguments().end(),
+                      [](cmListFileArgument const& arg) {
+                        return MayReferenceVariable(arg.Value);
+                      });
+}
 } // namespace
 
 cmCTestTestHandler::cmCTestTestHandler(cmCTest* ctest)
@@ -364,7 +500,10 @@ int cmCTestTestHandler::ProcessHandler()
   }
 
   cmGeneratedFileStream mLogFile;
-  this->StartLogFile((this->MemCheck ? "DynamicAnalysis" : "Test"), mLogFile);
+  this->StartLogFile(
+    this->GetShardFileName(this->MemCheck ? "DynamicAnalysis" : "Test")
+      .c_str(),
+    mLogFile);
   this->LogFile = &mLogFile;
 
   std::vector<std::string> passed;
@@ -373,11 +512,26 @@ int cmCTestTestHandler::ProcessHandler()
   // start the real time clock
   auto clock_start = std::chrono::steady_clock::now();
 
-  if (!this->ProcessDirectory(passed, failed)) {
+  if (this->TestOptions.MergeShards) {
+    if (!this->MergeShards(passed, failed)) {
+      return -1;
+    }
+  } else if (!this->ProcessDirectory(passed, failed)) {
     return -1;
   }
 
   auto clock_finish = std::chrono::steady_clock::now();
+  if (this->TestOptions.MergeShards) {
+    clock_finish = clock_start +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        this->ElapsedTestingTime);
+  }
+
+  if (this->TestOptions.ShardCount && !this->CTest->GetShowOnly() &&
+      !this->CTest->ShouldPrintLabels() &&
+      !this->WriteShardResults(passed, failed)) {
+    return -1;
+  }
 
   bool noTestsFoundError = false;
   if (passed.size() + failed.size() == 0) {
@@ -469,6 +623,8 @@ bool cmCTestTestHandler::ProcessOptions()
   this->SetTestsToRunInformation(this->TestOptions.TestsToRunInformation);
   if (this->TestOptions.ScheduleRandom) {
     this->CTest->SetScheduleType("Random");
+  } else if (this->TestOptions.ScheduleCriticalPath) {
+    this->CTest->SetScheduleType("CriticalPath");
   }
   if (auto repeat = this->Repeat) {
     cmsys::RegularExpression repeatRegex(
@@ -511,6 +667,22 @@ bool cmCTestTestHandler::ProcessOptions()
     }
   }
 
+  if (this->TestOptions.ShardCount && this->TestOptions.MergeShards) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               "The --shard and --merge-shards options may not be used "
+               "together."
+                 << std::endl);
+    return false;
+  }
+  if (this->MemCheck &&
+      (this->TestOptions.ShardCount || this->TestOptions.MergeShards)) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               "The --shard and --merge-shards options are not supported "
+               "for memory checks."
+                 << std::endl);
+    return false;
+  }
+
   if (this->TestOptions.StopOnFailure) {
     this->CTest->SetStopOnFailure(true);
   }
@@ -576,7 +748,7 @@ void cmCTestTestHandler::LogDisabledTests(
     cmCTestLog(this->CTest, HANDLER_OUTPUT,
                std::endl
                  << "The following tests did not run:" << std::endl);
-    this->StartLogFile("TestsDisabled", ofs);
+    this->StartLogFile(this->GetShardFileName("TestsDisabled").c_str(), ofs);
 
     char const* disabled_reason;
     cmCTestLog(this->CTest, HANDLER_OUTPUT,
@@ -605,7 +777,7 @@ void cmCTestTestHandler::LogFailedTests(std::vector<std::string> const& failed,
     cmCTestLog(this->CTest, HANDLER_OUTPUT,
                std::endl
                  << "The following tests FAILED:" << std::endl);
-    this->StartLogFile("TestsFailed", ofs);
+    this->StartLogFile(this->GetShardFileName("TestsFailed").c_str(), ofs);
 
     for (cmCTestTestResult const& ft : resultsSet) {
       if (ft.Status != cmCTestTestHandler::COMPLETED &&
@@ -640,6 +812,11 @@ void cmCTestTestHandler::LogFailedTests(std::vector<std::string> const& failed,
 
 bool cmCTestTestHandler::GenerateXML()
 {
+  // The results of all shards are written by --merge-shards.
+  if (this->TestOptions.ShardCount) {
+    return true;
+  }
+
   if (this->CTest->GetProduceXML()) {
     cmGeneratedFileStream xmlfile;
     if (!this->StartResultingXML(
@@ -899,6 +1076,7 @@ bool cmCTestTestHandler::ComputeTestList()
     finalList.push_back(tp);
   }
 
+  this->SelectShard(finalList);
   this->UpdateForFixtures(finalList);
 
   // Save the total number of tests before exclusions
@@ -928,6 +1106,7 @@ bool cmCTestTestHandler::ComputeTestListForRerunFailed()
     finalList.push_back(tp);
   }
 
+  this->SelectShard(finalList);
   this->UpdateForFixtures(finalList);
 
   // Save the total number of tests before exclusions
@@ -1175,6 +1354,342 @@ void cmCTestTestHandler::UpdateForFixtures(ListOfTests& tests) const
                      this->Quiet);
 }
 
+void cmCTestTestHandler::SelectShard(ListOfTests& tests) const
+{
+  unsigned int const count = this->TestOptions.ShardCount;
+  if (count == 0) {
+    return;
+  }
+
+  // Use the COST property or the cost recorded by previous runs, as
+  // the parallel scheduler does.  Tests without either count as the
+  // average test.
+  std::unordered_map<std::string, float> const recordedCosts =
+    cmCTestMultiProcessHandler::ReadCosts(this->CTest->GetCostDataFile());
+  std::vector<double> costs(tests.size(), -1);
+  double knownCost = 0;
+  std::size_t known = 0;
+  for (std::size_t i = 0; i < tests.size(); ++i) {
+    double cost = tests[i].Cost;
+    if (cost <= 0) {
+      auto it = recordedCosts.find(tests[i].Name);
+      if (it != recordedCosts.end()) {
+        cost = it->second;
+      }
+    }
+    if (cost > 0) {
+      costs[i] = cost;
+      knownCost += cost;
+      ++known;
+    }
+  }
+  double const averageCost = known ? knownCost / known : 1;
+  for (double& cost : costs) {
+    if (cost < 0) {
+      cost = averageCost;
+    }
+  }
+
+  // Every shard computes the same assignment from the same test list and
+  // cost data, so each test runs in exactly one shard.
+  std::vector<std::size_t> order(tests.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&costs](std::size_t l, std::size_t r) {
+                     return costs[l] > costs[r];
+                   });
+  std::vector<double> loads(count, 0);
+  std::vector<bool> selected(tests.size(), false);
+  for (std::size_t i : order) {
+    auto shard = std::min_element(loads.begin(), loads.end());
+    *shard += costs[i];
+    selected[i] = shard - loads.begin() == this->TestOptions.ShardIndex - 1;
+  }
+
+  ListOfTests shardList;
+  for (std::size_t i = 0; i < tests.size(); ++i) {
+    if (selected[i]) {
+      shardList.push_back(std::move(tests[i]));
+    }
+  }
+  tests = std::move(shardList);
+}
+
+std::string cmCTestTestHandler::GetShardFileName(std::string const& file) const
+{
+  if (this->TestOptions.ShardCount == 0) {
+    return file;
+  }
+  return GetShardFileName(file, this->TestOptions.ShardIndex,
+                          this->TestOptions.ShardCount);
+}
+
+std::string cmCTestTestHandler::GetShardFileName(std::string const& file,
+                                                 unsigned int index,
+                                                 unsigned int count)
+{
+  std::string::size_type const slash = file.rfind('/');
+  std::string::size_type dot = file.rfind('.');
+  if (dot == std::string::npos ||
+      (slash != std::string::npos && dot < slash)) {
+    dot = file.size();
+  }
+  std::string name = file;
+  name.insert(dot, cmStrCat("-shard-", index, "-of-", count));
+  return name;
+}
+
+std::string cmCTestTestHandler::GetShardResultsFile() const
+{
+  return cmStrCat(this->CTest->GetBinaryDir(),
+                  "/Testing/Temporary/CTestShardResults.json");
+}
+
+bool cmCTestTestHandler::WriteShardResults(
+  std::vector<std::string> const& passed,
+  std::vector<std::string> const& failed)
+{
+  Json::Value root = Json::objectValue;
+  root["startDateTime"] = this->StartTest;
+  root["endDateTime"] = this->EndTest;
+  root["startTestTime"] = static_cast<Json::Int64>(
+    std::chrono::system_clock::to_time_t(this->StartTestTime));
+  root["endTestTime"] = static_cast<Json::Int64>(
+    std::chrono::system_clock::to_time_t(this->EndTestTime));
+
+  Json::Value& jsonPassed = root["passed"] = Json::arrayValue;
+  for (std::string const& name : passed) {
+    jsonPassed.append(name);
+  }
+  Json::Value& jsonFailed = root["failed"] = Json::arrayValue;
+  for (std::string const& name : failed) {
+    jsonFailed.append(name);
+  }
+
+  Json::Value& tests = root["tests"] = Json::arrayValue;
+  for (cmCTestTestResult const& result : this->TestResults) {
+    Json::Value test = Json::objectValue;
+    test["name"] = result.Name;
+    test["path"] = result.Path;
+    test["reason"] = result.Reason;
+    test["fullCommandLine"] = result.FullCommandLine;
+    test["environment"] = result.Environment;
+    test["executionTime"] = result.ExecutionTime.count();
+    test["returnValue"] = static_cast<Json::Int64>(result.ReturnValue);
+    test["status"] = result.Status;
+    test["exceptionStatus"] = result.ExceptionStatus;
+    test["compressOutput"] = result.CompressOutput;
+    test["completionStatus"] = result.CompletionStatus;
+    test["customCompletionStatus"] = result.CustomCompletionStatus;
+    test["output"] = result.Output;
+    test["measurementsOutput"] = result.TestMeasurementsOutput;
+    test["instrumentationFile"] = result.InstrumentationFile;
+    test["index"] = result.TestCount;
+    tests.append(std::move(test));
+  }
+
+  std::string const file = this->GetShardFileName(this->GetShardResultsFile());
+  cmGeneratedFileStream fout(file);
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  std::unique_ptr<Json::StreamWriter> jout(builder.newStreamWriter());
+  jout->write(root, &fout);
+  fout << '\n';
+  if (!fout) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               "Cannot write shard results file: " << file << std::endl);
+    return false;
+  }
+  return true;
+}
+
+bool cmCTestTestHandler::MergeShards(std::vector<std::string>& passed,
+                                     std::vector<std::string>& failed)
+{
+  // The properties of the tests are not recorded by the shards.
+  if (!this->GetListOfTests()) {
+    return false;
+  }
+
+  unsigned int const count = this->TestOptions.MergeShards;
+  std::vector<std::string> resultsFiles;
+  std::vector<Json::Value> shards;
+  for (unsigned int i = 1; i <= count; ++i) {
+    resultsFiles.push_back(
+      GetShardFileName(this->GetShardResultsFile(), i, count));
+    cmsys::ifstream fin(resultsFiles.back().c_str(),
+                        std::ios::in | std::ios::binary);
+    Json::Value root;
+    Json::Reader reader;
+    if (!fin || !reader.parse(fin, root, false) || !root.isObject()) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Cannot read the results of shard "
+                   << i << " of " << count << " from "
+                   << resultsFiles.back() << std::endl);
+      return false;
+    }
+    shards.push_back(std::move(root));
+  }
+
+  // The merged run starts with the first shard and ends with the last.
+  std::time_t startTime = 0;
+  std::time_t endTime = 0;
+  std::set<std::string> failedNames;
+  std::map<int, std::size_t> resultsByIndex;
+  std::vector<bool> resultFailed;
+  ListOfTests mergedList;
+  this->TestResults.clear();
+  for (Json::Value const& root : shards) {
+    std::time_t const shardStart =
+      static_cast<std::time_t>(root["startTestTime"].asInt64());
+    std::time_t const shardEnd =
+      static_cast<std::time_t>(root["endTestTime"].asInt64());
+    if (&root == &shards.front() || shardStart < startTime) {
+      startTime = shardStart;
+      this->StartTest = root["startDateTime"].asString();
+    }
+    if (&root == &shards.front() || shardEnd > endTime) {
+      endTime = shardEnd;
+      this->EndTest = root["endDateTime"].asString();
+    }
+
+    std::set<std::string> shardFailedNames;
+    for (Json::Value const& name : root["failed"]) {
+      shardFailedNames.insert(name.asString());
+      if (failedNames.insert(name.asString()).second) {
+        failed.push_back(name.asString());
+      }
+    }
+
+    for (Json::Value const& test : root["tests"]) {
+      cmCTestTestResult result;
+      result.Name = test["name"].asString();
+      result.TestCount = test["index"].asInt();
+      auto listIndexes = this->TestListIndexesByName.find(result.Name);
+      if (listIndexes == this->TestListIndexesByName.end()) {
+        cmCTestLog(this->CTest, WARNING,
+                   "Test " << result.Name
+                           << " of the shard results no longer exists"
+                           << std::endl);
+        continue;
+      }
+      // Fixture setup and cleanup tests may have run in several shards.
+      // Report the result of a shard in which they failed, if any.
+      bool const testFailed = cm::contains(shardFailedNames, result.Name);
+      auto known = resultsByIndex.find(result.TestCount);
+      if (known != resultsByIndex.end() &&
+          (resultFailed[known->second] || !testFailed)) {
+        continue;
+      }
+      std::size_t listIndex = listIndexes->second.front();
+      for (std::size_t i : listIndexes->second) {
+        if (static_cast<int>(i) + 1 == result.TestCount) {
+          listIndex = i;
+        }
+      }
+      result.Path = test["path"].asString();
+      result.Reason = test["reason"].asString();
+      result.FullCommandLine = test["fullCommandLine"].asString();
+      result.Environment = test["environment"].asString();
+      result.ExecutionTime = cmDuration(test["executionTime"].asDouble());
+      result.ReturnValue = test["returnValue"].asInt64();
+      result.Status = test["status"].asInt();
+      result.ExceptionStatus = test["exceptionStatus"].asString();
+      result.CompressOutput = test["compressOutput"].asBool();
+      result.CompletionStatus = test["completionStatus"].asString();
+      result.CustomCompletionStatus =
+        test["customCompletionStatus"].asString();
+      result.Output = test["output"].asString();
+      result.TestMeasurementsOutput = test["measurementsOutput"].asString();
+      result.InstrumentationFile = test["instrumentationFile"].asString();
+      if (known != resultsByIndex.end()) {
+        this->TestResults[known->second] = std::move(result);
+        resultFailed[known->second] = true;
+        continue;
+      }
+      resultsByIndex[result.TestCount] = this->TestResults.size();
+      resultFailed.push_back(testFailed);
+      mergedList.push_back(this->TestList[listIndex]);
+      mergedList.back().Index = result.TestCount;
+      this->TestResults.push_back(std::move(result));
+    }
+  }
+  std::set<std::string> passedNames;
+  for (Json::Value const& root : shards) {
+    for (Json::Value const& name : root["passed"]) {
+      if (!cm::contains(failedNames, name.asString()) &&
+          passedNames.insert(name.asString()).second) {
+        passed.push_back(name.asString());
+      }
+    }
+  }
+
+  // The results refer to the properties of the tests that ran.
+  this->TotalNumberOfTests = this->TestList.size();
+  this->TestList = std::move(mergedList);
+  for (std::size_t i = 0; i < this->TestResults.size(); ++i) {
+    this->TestResults[i].Properties = &this->TestList[i];
+  }
+  this->UpdateMaxTestNameWidth();
+
+  this->StartTestTime = std::chrono::system_clock::from_time_t(startTime);
+  this->EndTestTime = std::chrono::system_clock::from_time_t(endTime);
+  this->ElapsedTestingTime = this->EndTestTime - this->StartTestTime;
+
+  std::string const costDataFile = this->CTest->GetCostDataFile();
+  std::vector<std::string> costDataFiles;
+  for (unsigned int i = 1; i <= count; ++i) {
+    costDataFiles.push_back(GetShardFileName(costDataFile, i, count));
+  }
+  cmCTestMultiProcessHandler::MergeCostData(costDataFile, costDataFiles);
+
+  // Results must not be merged twice.
+  for (std::string const& file : costDataFiles) {
+    cmSystemTools::RemoveFile(file);
+  }
+  for (std::string const& file : resultsFiles) {
+    cmSystemTools::RemoveFile(file);
+  }
+  this->RemoveShardLogs(count);
+
+  *this->LogFile << "Merged the results of " << count << " shards"
+                 << std::endl;
+  return true;
+}
+
+void cmCTestTestHandler::RemoveShardLogs(unsigned int count) const
+{
+  // The merged run writes the logs of the failed and disabled tests of all
+  // shards.  Remove those of the shards so that --rerun-failed reads it.
+  std::string const dirName =
+    cmStrCat(this->CTest->GetBinaryDir(), "/Testing/Temporary");
+  cmsys::Directory directory;
+  if (!directory.Load(dirName)) {
+    return;
+  }
+  std::vector<std::string> prefixes;
+  for (unsigned int i = 1; i <= count; ++i) {
+    for (char const* name : { "TestsFailed", "TestsDisabled" }) {
+      prefixes.push_back(cmStrCat("Last", GetShardFileName(name, i, count)));
+    }
+  }
+  for (unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i) {
+    std::string const fileName = directory.GetFile(i);
+    if (!cmHasLiteralSuffix(fileName, ".log")) {
+      continue;
+    }
+    for (std::string const& prefix : prefixes) {
+      if (cmHasPrefix(fileName, prefix) &&
+          (fileName[prefix.size()] == '.' || fileName[prefix.size()] == '_')) {
+        cmSystemTools::RemoveFile(cmStrCat(dirName, '/', fileName));
+        break;
+      }
+    }
+  }
+}
+
 void cmCTestTestHandler::UpdateMaxTestNameWidth()
 {
   std::string::size_type max = this->CTest->GetMaxTestNameWidth();
@@ -1334,6 +1849,12 @@ bool cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
                    << std::endl;
   }
 
+  // Map test names to indexes to look up dependencies.
+  std::unordered_map<std::string, int> testIndexes;
+  for (cmCTestTestProperties const& p : this->TestList) {
+    testIndexes.emplace(p.Name, p.Index);
+  }
+
   for (cmCTestTestProperties& p : this->TestList) {
     cmCTestMultiProcessHandler::TestSet depends;
 
@@ -1341,14 +1862,10 @@ bool cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
       p.Cost = static_cast<float>(rand());
     }
 
-    if (!p.Depends.empty()) {
-      for (std::string const& i : p.Depends) {
-        for (cmCTestTestProperties const& it2 : this->TestList) {
-          if (it2.Name == i) {
-            depends.insert(it2.Index);
-            break; // break out of test loop as name can only match 1
-          }
-        }
+    for (std::string const& i : p.Depends) {
+      auto it = testIndexes.find(i);
+      if (it != testIndexes.end()) {
+        depends.insert(it->second);
       }
     }
     tests[p.Index].Depends = depends;
@@ -1754,6 +2271,13 @@ bool cmCTestTestHandler::GetListOfTests()
   }
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                      "Constructing a list of tests" << std::endl, this->Quiet);
+  this->TestListIndexesByName.clear();
+  this->TestListIndexesByDirectory.clear();
+  this->TestFiles.clear();
+  this->ActiveTestFiles.clear();
+  this->TestFilesEvaluated = false;
+  this->ReadTestManifest();
+
   cmake cm(cmake::RoleScript, cmState::CTest);
   cm.SetHomeDirectory("");
   cm.SetHomeOutputDirectory("");
@@ -1766,11 +2290,11 @@ bool cmCTestTestHandler::GetListOfTests()
   cm.GetState()->AddBuiltinCommand("add_test", cmCTestAddTestCommand(this));
 
   // Add handler for SUBDIRS
-  cm.GetState()->AddBuiltinCommand("subdirs", cmCTestSubdirCommand);
+  cm.GetState()->AddBuiltinCommand("subdirs", cmCTestSubdirCommand(this));
 
   // Add handler for ADD_SUBDIRECTORY
   cm.GetState()->AddBuiltinCommand("add_subdirectory",
-                                   cmCTestAddSubdirectoryCommand);
+                                   cmCTestAddSubdirectoryCommand(this));
 
   // Add handler for SET_TESTS_PROPERTIES
   cm.GetState()->AddBuiltinCommand("set_tests_properties",
@@ -1792,8 +2316,14 @@ bool cmCTestTestHandler::GetListOfTests()
     return true;
   }
 
-  if (!mf.ReadListFile(testFilename)) {
-    return false;
+  std::string const testFile = cmSystemTools::CollapseFullPath(testFilename);
+  if (!this->ReplayTestFile(testFile, mf)) {
+    this->BeginTestFile(testFile);
+    bool const readit = mf.ReadListFile(testFilename);
+    this->EndTestFile(mf);
+    if (!readit) {
+      return false;
+    }
   }
   if (cmSystemTools::GetErrorOccurredFlag()) {
     // SEND_ERROR or FATAL_ERROR in CTestTestfile or TEST_INCLUDE_FILES
@@ -1803,7 +2333,260 @@ bool cmCTestTestHandler::GetListOfTests()
   if (this->TestOptions.ResourceSpecFile.empty() && specFile) {
     this->TestOptions.ResourceSpecFile = *specFile;
   }
+  if (this->TestFilesEvaluated) {
+    this->WriteTestManifest();
+  }
+
+  return this->FinishListOfTests();
+}
+
+std::string cmCTestTestHandler::GetTestManifestFile() const
+{
+  return cmStrCat(this->CTest->GetBinaryDir(),
+                  "/Testing/Temporary/CTestTestManifest.txt");
+}
+
+void cmCTestTestHandler::ReadTestManifest()
+{
+  this->TestManifest.clear();
+  std::string const manifestFile = this->GetTestManifestFile();
+  cmsys::ifstream fin(manifestFile.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return;
+  }
+  std::ostringstream content;
+  content << fin.rdbuf();
+  fin.close();
+  TestManifestParser parser(content.str());
+
+  // The manifest is valid only for the same working directory and
+  // configuration.
+  std::string format;
+  std::string version;
+  std::string directory;
+  std::string config;
+  if (!parser.Read(format) || format != TestManifestFormat ||
+      !parser.Read(version) || version != cmVersion::GetCMakeVersion() ||
+      !parser.Read(directory) ||
+      directory != cmSystemTools::GetLogicalWorkingDirectory() ||
+      !parser.Read(config) || config != this->CTest->GetConfigType()) {
+    return;
+  }
+  std::unordered_map<std::string, TestFile> manifest;
+  std::size_t fileCount = 0;
+  if (!parser.Read(fileCount)) {
+    return;
+  }
+  for (std::size_t i = 0; i < fileCount; ++i) {
+    TestFile file;
+    std::size_t commandCount = 0;
+    if (!parser.Read(file.Path) || !parser.Read(file.Time) ||
+        !parser.Read(commandCount)) {
+      return;
+    }
+    for (std::size_t j = 0; j < commandCount; ++j) {
+      TestFileCommand command;
+      std::size_t kind = 0;
+      std::size_t argc = 0;
+      if (!parser.Read(kind) ||
+          kind > static_cast<std::size_t>(TestFileCommandKind::Subdirectory) ||
+          !parser.Read(command.Directory) || !parser.Read(argc) ||
+          argc >= (std::size_t(1) << 24)) {
+        return;
+      }
+      command.Kind = static_cast<TestFileCommandKind>(kind);
+      command.Args.resize(argc);
+      for (std::string& arg : command.Args) {
+        if (!parser.Read(arg)) {
+          return;
+        }
+      }
+      if (command.Kind == TestFileCommandKind::AddTest &&
+          command.Args.size() < 2) {
+        return;
+      }
+      file.Commands.push_back(std::move(command));
+    }
+    file.Replayable = true;
+    std::string path = file.Path;
+    manifest[std::move(path)] = std::move(file);
+  }
+  if (!parser.AtEnd()) {
+    return;
+  }
+
+  cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                     "Reading test manifest " << manifestFile << std::endl,
+                     this->Quiet);
+  this->TestManifest = std::move(manifest);
+}
+
+void cmCTestTestHandler::WriteTestManifest() const
+{
+  std::string const manifestFile = this->GetTestManifestFile();
+  std::vector<TestFile const*> files;
+  for (TestFile const& file : this->TestFiles) {
+    if (file.Replayable) {
+      files.push_back(&file);
+    }
+  }
+
+  auto write = [this, &manifestFile](std::vector<TestFile const*> const& fs) {
+    cmGeneratedFileStream fout(manifestFile);
+    WriteTestManifestString(fout, TestManifestFormat);
+    WriteTestManifestString(fout, cmVersion::GetCMakeVersion());
+    WriteTestManifestString(fout,
+                            cmSystemTools::GetLogicalWorkingDirectory());
+    WriteTestManifestString(fout, this->CTest->GetConfigType());
+    WriteTestManifestNumber(fout, static_cast<long long>(fs.size()));
+    for (TestFile const* file : fs) {
+      WriteTestManifestString(fout, file->Path);
+      WriteTestManifestNumber(fout, file->Time);
+      WriteTestManifestNumber(
+        fout, static_cast<long long>(file->Commands.size()));
+      for (TestFileCommand const& command : file->Commands) {
+        WriteTestManifestNumber(fout, static_cast<long long>(command.Kind));
+        WriteTestManifestString(fout, command.Directory);
+        WriteTestManifestNumber(fout,
+                                static_cast<long long>(command.Args.size()));
+        for (std::string const& arg : command.Args) {
+          WriteTestManifestString(fout, arg);
+        }
+      }
+    }
+  };
+  write(files);
+
+  // A test file modified right after we read it may keep the same time
+  // on a filesystem with a coarse timestamp resolution, which is two
+  // seconds on FAT.  Leave out the test files that are not clearly older
+  // than the manifest, as measured by the filesystem that holds them, so
+  // that the next run evaluates them again.
+  cmFileTime manifestTime;
+  if (!manifestTime.Load(manifestFile)) {
+    cmSystemTools::RemoveFile(manifestFile);
+    return;
+  }
+  auto const recent =
+    std::remove_if(files.begin(), files.end(),
+                   [&manifestTime](TestFile const* file) {
+                     return manifestTime.GetTime() - file->Time <
+                       2 * cmFileTime::UtPerS;
+                   });
+  if (recent != files.end()) {
+    files.erase(recent, files.end());
+    write(files);
+  }
+}
+
+bool cmCTestTestHandler::ReplayTestFile(std::string const& file,
+                                        cmMakefile& mf)
+{
+  auto const entry = this->TestManifest.find(file);
+  cmFileTime fileTime;
+  if (entry == this->TestManifest.end() || !fileTime.Load(file) ||
+      fileTime.GetTime() != entry->second.Time) {
+    return false;
+  }
 
+  cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                     "Replaying test file " << file << std::endl,
+                     this->Quiet);
+  this->BeginTestFile(file, fileTime);
+  this->TestFiles[this->ActiveTestFiles.back()].Replayable = true;
+  for (TestFileCommand const& command : entry->second.Commands) {
+    bool replayed = false;
+    std::string error;
+    switch (command.Kind) {
+      case TestFileCommandKind::AddTest:
+        replayed = this->AddTest(command.Args, command.Directory);
+        break;
+      case TestFileCommandKind::SetTestsProperties:
+        replayed = this->SetTestsProperties(command.Args);
+        break;
+      case TestFileCommandKind::SetDirectoryProperties:
+        replayed =
+          this->SetDirectoryProperties(command.Args, command.Directory);
+        break;
+      case TestFileCommandKind::Subdirectory: {
+        // The test file of the subdirectory may need to be evaluated.
+        cmExecutionStatus status(mf);
+        replayed = ReadSubdirectory(command.Directory, status, this);
+        error = status.GetError();
+      } break;
+    }
+    if (!replayed) {
+      if (error.empty()) {
+        error = cmStrCat("Could not replay the commands of ", file,
+                         " from the test manifest.");
+      }
+      mf.IssueMessage(MessageType::FATAL_ERROR, error);
+      break;
+    }
+  }
+  this->EndTestFile(mf);
+  return true;
+}
+
+void cmCTestTestHandler::BeginTestFile(std::string const& file)
+{
+  // Load the time before the file is read so that any later change
+  // makes the recorded commands stale.
+  cmFileTime fileTime;
+  fileTime.Load(file);
+  this->BeginTestFile(file, fileTime);
+}
+
+void cmCTestTestHandler::BeginTestFile(std::string const& file,
+                                       cmFileTime const& time)
+{
+  TestFile testFile;
+  testFile.Path = file;
+  testFile.Time = time.GetTime();
+  this->ActiveTestFiles.push_back(this->TestFiles.size());
+  this->TestFiles.push_back(std::move(testFile));
+}
+
+void cmCTestTestHandler::EndTestFile(cmMakefile const& mf)
+{
+  TestFile& testFile = this->TestFiles[this->ActiveTestFiles.back()];
+  this->ActiveTestFiles.pop_back();
+  if (testFile.Replayable) {
+    return;
+  }
+  this->TestFilesEvaluated = true;
+  if (cmSystemTools::GetErrorOccurredFlag()) {
+    return;
+  }
+
+  // Replaying the recorded commands is equivalent to evaluating the file
+  // only if it calls nothing but those commands.
+  cmListFile listFile;
+  testFile.Replayable =
+    listFile.ParseFile(testFile.Path.c_str(), mf.GetMessenger(),
+                       mf.GetBacktrace()) &&
+    std::all_of(listFile.Functions.begin(), listFile.Functions.end(),
+                IsTestManifestCommand);
+}
+
+void cmCTestTestHandler::AddTestSubdirectory(std::string const& directory)
+{
+  this->AddTestFileCommand(TestFileCommandKind::Subdirectory, directory,
+                           std::vector<std::string>());
+}
+
+void cmCTestTestHandler::AddTestFileCommand(
+  TestFileCommandKind kind, std::string const& directory,
+  std::vector<std::string> const& args)
+{
+  if (!this->ActiveTestFiles.empty()) {
+    this->TestFiles[this->ActiveTestFiles.back()].Commands.push_back(
+      { kind, directory, args });
+  }
+}
+
+bool cmCTestTestHandler::FinishListOfTests()
+{
   if (!this->TestOptions.TestListFile.empty()) {
     this->TestsToRunByName =
       this->ReadTestListFile(this->TestOptions.TestListFile);
@@ -2172,6 +2955,9 @@ void cmCTestTestHandler::cmCTestTestProperties::AppendError(
 bool cmCTestTestHandler::SetTestsProperties(
   std::vector<std::string> const& args)
 {
+  this->AddTestFileCommand(TestFileCommandKind::SetTestsProperties,
+                           std::string(), args);
+
   std::vector<std::string>::const_iterator it;
   std::vector<std::string> tests;
   bool found = false;
@@ -2194,184 +2980,188 @@ bool cmCTestTestHandler::SetTestsProperties(
     }
     std::string const& val = *it;
     for (std::string const& t : tests) {
-      for (cmCTestTestProperties& rt : this->TestList) {
-        if (t == rt.Name) {
-          if (key == "_BACKTRACE_TRIPLES"_s) {
-            // allow empty args in the triples
-            cmList triples{ val, cmList::EmptyElements::Yes };
-
-            // Ensure we have complete triples otherwise the data is corrupt.
-            if (triples.size() % 3 == 0) {
-              cmState state(cmState::Unknown);
-              rt.Backtrace = cmListFileBacktrace();
-
-              // the first entry represents the top of the trace so we need to
-              // reconstruct the backtrace in reverse
-              for (auto i = triples.size(); i >= 3; i -= 3) {
-                cmListFileContext fc;
-                fc.FilePath = triples[i - 3];
-                long line = 0;
-                if (!cmStrToLong(triples[i - 2], &line)) {
-                  line = 0;
-                }
-                fc.Line = line;
-                fc.Name = triples[i - 1];
-                rt.Backtrace = rt.Backtrace.Push(fc);
+      auto indexes = this->TestListIndexesByName.find(t);
+      if (indexes == this->TestListIndexesByName.end()) {
+        continue;
+      }
+      for (std::size_t index : indexes->second) {
+        cmCTestTestProperties& rt = this->TestList[index];
+        if (key == "_BACKTRACE_TRIPLES"_s) {
+          // allow empty args in the triples
+          cmList triples{ val, cmList::EmptyElements::Yes };
+
+          // Ensure we have complete triples otherwise the data is corrupt.
+          if (triples.size() % 3 == 0) {
+            rt.Backtrace = cmListFileBacktrace();
+
+            // the first entry represents the top of the trace so we need to
+            // reconstruct the backtrace in reverse
+            for (auto i = triples.size(); i >= 3; i -= 3) {
+              cmListFileContext fc;
+              fc.FilePath = triples[i - 3];
+              long line = 0;
+              if (!cmStrToLong(triples[i - 2], &line)) {
+                line = 0;
               }
+              fc.Line = line;
+              fc.Name = triples[i - 1];
+              rt.Backtrace = rt.Backtrace.Push(fc);
             }
-          } else if (key == "WILL_FAIL"_s) {
-            rt.WillFail = cmIsOn(val);
-          } else if (key == "DISABLED"_s) {
-            rt.Disabled = cmIsOn(val);
-          } else if (key == "ATTACHED_FILES"_s) {
-            cmExpandList(val, rt.AttachedFiles);
-          } else if (key == "ATTACHED_FILES_ON_FAIL"_s) {
-            cmExpandList(val, rt.AttachOnFail);
-          } else if (key == "RESOURCE_LOCK"_s) {
-            cmList lval{ val };
-
-            rt.ProjectResources.insert(lval.begin(), lval.end());
-          } else if (key == "FIXTURES_SETUP"_s) {
-            cmList lval{ val };
-
-            rt.FixturesSetup.insert(lval.begin(), lval.end());
-          } else if (key == "FIXTURES_CLEANUP"_s) {
-            cmList lval{ val };
-
-            rt.FixturesCleanup.insert(lval.begin(), lval.end());
-          } else if (key == "FIXTURES_REQUIRED"_s) {
-            cmList lval{ val };
-
-            rt.FixturesRequired.insert(lval.begin(), lval.end());
-          } else if (key == "TIMEOUT"_s) {
-            rt.Timeout = cmDuration(atof(val.c_str()));
-          } else if (key == "TIMEOUT_SIGNAL_NAME"_s) {
+          }
+        } else if (key == "WILL_FAIL"_s) {
+          rt.WillFail = cmIsOn(val);
+        } else if (key == "DISABLED"_s) {
+          rt.Disabled = cmIsOn(val);
+        } else if (key == "ATTACHED_FILES"_s) {
+          cmExpandList(val, rt.AttachedFiles);
+        } else if (key == "ATTACHED_FILES_ON_FAIL"_s) {
+          cmExpandList(val, rt.AttachOnFail);
+        } else if (key == "RESOURCE_LOCK"_s) {
+          cmList lval{ val };
+
+          rt.ProjectResources.insert(lval.begin(), lval.end());
+        } else if (key == "FIXTURES_SETUP"_s) {
+          cmList lval{ val };
+
+          rt.FixturesSetup.insert(lval.begin(), lval.end());
+        } else if (key == "FIXTURES_CLEANUP"_s) {
+          cmList lval{ val };
+
+          rt.FixturesCleanup.insert(lval.begin(), lval.end());
+        } else if (key == "FIXTURES_REQUIRED"_s) {
+          cmList lval{ val };
+
+          rt.FixturesRequired.insert(lval.begin(), lval.end());
+        } else if (key == "TIMEOUT"_s) {
+          rt.Timeout = cmDuration(atof(val.c_str()));
+        } else if (key == "TIMEOUT_SIGNAL_NAME"_s) {
 #ifdef _WIN32
-            rt.AppendError("TIMEOUT_SIGNAL_NAME is not supported on Windows.");
+          rt.AppendError("TIMEOUT_SIGNAL_NAME is not supported on Windows.");
 #else
-            std::string const& signalName = val;
-            Signal s;
-            if (signalName == "SIGINT"_s) {
-              s.Number = SIGINT;
-            } else if (signalName == "SIGQUIT"_s) {
-              s.Number = SIGQUIT;
-            } else if (signalName == "SIGTERM"_s) {
-              s.Number = SIGTERM;
-            } else if (signalName == "SIGUSR1"_s) {
-              s.Number = SIGUSR1;
-            } else if (signalName == "SIGUSR2"_s) {
-              s.Number = SIGUSR2;
-            }
-            if (s.Number) {
-              s.Name = signalName;
-              rt.TimeoutSignal = std::move(s);
-            } else {
-              rt.AppendError(cmStrCat("TIMEOUT_SIGNAL_NAME \"", signalName,
-                                      "\" not supported on this platform."));
-            }
+          std::string const& signalName = val;
+          Signal s;
+          if (signalName == "SIGINT"_s) {
+            s.Number = SIGINT;
+          } else if (signalName == "SIGQUIT"_s) {
+            s.Number = SIGQUIT;
+          } else if (signalName == "SIGTERM"_s) {
+            s.Number = SIGTERM;
+          } else if (signalName == "SIGUSR1"_s) {
+            s.Number = SIGUSR1;
+          } else if (signalName == "SIGUSR2"_s) {
+            s.Number = SIGUSR2;
+          }
+          if (s.Number) {
+            s.Name = signalName;
+            rt.TimeoutSignal = std::move(s);
+          } else {
+            rt.AppendError(cmStrCat("TIMEOUT_SIGNAL_NAME \"", signalName,
+                                    "\" not supported on this platform."));
+          }
 #endif
-          } else if (key == "TIMEOUT_SIGNAL_GRACE_PERIOD"_s) {
+        } else if (key == "TIMEOUT_SIGNAL_GRACE_PERIOD"_s) {
 #ifdef _WIN32
-            rt.AppendError(
-              "TIMEOUT_SIGNAL_GRACE_PERIOD is not supported on Windows.");
+          rt.AppendError(
+            "TIMEOUT_SIGNAL_GRACE_PERIOD is not supported on Windows.");
 #else
-            std::string const& gracePeriod = val;
-            static cmDuration minGracePeriod{ 0 };
-            static cmDuration maxGracePeriod{ 60 };
-            cmDuration gp = cmDuration(atof(gracePeriod.c_str()));
-            if (gp <= minGracePeriod) {
-              rt.AppendError(cmStrCat("TIMEOUT_SIGNAL_GRACE_PERIOD \"",
-                                      gracePeriod, "\" is not greater than \"",
-                                      minGracePeriod.count(), "\" seconds."));
-            } else if (gp > maxGracePeriod) {
-              rt.AppendError(cmStrCat("TIMEOUT_SIGNAL_GRACE_PERIOD \"",
-                                      gracePeriod,
-                                      "\" is not less than the maximum of \"",
-                                      maxGracePeriod.count(), "\" seconds."));
-            } else {
-              rt.TimeoutGracePeriod = gp;
-            }
+          std::string const& gracePeriod = val;
+          static cmDuration minGracePeriod{ 0 };
+          static cmDuration maxGracePeriod{ 60 };
+          cmDuration gp = cmDuration(atof(gracePeriod.c_str()));
+          if (gp <= minGracePeriod) {
+            rt.AppendError(cmStrCat("TIMEOUT_SIGNAL_GRACE_PERIOD \"",
+                                    gracePeriod, "\" is not greater than \"",
+                                    minGracePeriod.count(), "\" seconds."));
+          } else if (gp > maxGracePeriod) {
+            rt.AppendError(cmStrCat("TIMEOUT_SIGNAL_GRACE_PERIOD \"",
+                                    gracePeriod,
+                                    "\" is not less than the maximum of \"",
+                                    maxGracePeriod.count(), "\" seconds."));
+          } else {
+            rt.TimeoutGracePeriod = gp;
+          }
 #endif
-          } else if (key == "COST"_s) {
-            rt.Cost = static_cast<float>(atof(val.c_str()));
-          } else if (key == "REQUIRED_FILES"_s) {
-            cmExpandList(val, rt.RequiredFiles);
-          } else if (key == "RUN_SERIAL"_s) {
-            rt.RunSerial = cmIsOn(val);
-          } else if (key == "FAIL_REGULAR_EXPRESSION"_s) {
-            cmList lval{ val };
-            for (std::string const& cr : lval) {
-              rt.ErrorRegularExpressions.emplace_back(cr, cr);
-            }
-          } else if (key == "SKIP_REGULAR_EXPRESSION"_s) {
-            cmList lval{ val };
-            for (std::string const& cr : lval) {
-              rt.SkipRegularExpressions.emplace_back(cr, cr);
-            }
-          } else if (key == "PROCESSORS"_s) {
-            rt.Processors = atoi(val.c_str());
-            if (rt.Processors < 1) {
-              rt.Processors = 1;
-            }
-          } else if (key == "PROCESSOR_AFFINITY"_s) {
-            rt.WantAffinity = cmIsOn(val);
-          } else if (key == "RESOURCE_GROUPS"_s) {
-            if (!ParseResourceGroupsProperty(val, rt.ResourceGroups)) {
-              return false;
-            }
-          } else if (key == "GENERATED_RESOURCE_SPEC_FILE"_s) {
-            rt.GeneratedResourceSpecFile = val;
-          } else if (key == "SKIP_RETURN_CODE"_s) {
-            rt.SkipReturnCode = atoi(val.c_str());
-            if (rt.SkipReturnCode < 0 || rt.SkipReturnCode > 255) {
-              rt.SkipReturnCode = -1;
-            }
-          } else if (key == "DEPENDS"_s) {
-            cmExpandList(val, rt.Depends);
-          } else if (key == "ENVIRONMENT"_s) {
-            cmExpandList(val, rt.Environment);
-          } else if (key == "ENVIRONMENT_MODIFICATION"_s) {
-            cmExpandList(val, rt.EnvironmentModification);
-          } else if (key == "LABELS"_s) {
-            cmList Labels{ val };
-            rt.Labels.insert(rt.Labels.end(), Labels.begin(), Labels.end());
-            // sort the array
-            std::sort(rt.Labels.begin(), rt.Labels.end());
-            // remove duplicates
-            auto new_end = std::unique(rt.Labels.begin(), rt.Labels.end());
-            rt.Labels.erase(new_end, rt.Labels.end());
-          } else if (key == "MEASUREMENT"_s) {
-            size_t pos = val.find_first_of('=');
-            if (pos != std::string::npos) {
-              std::string mKey = val.substr(0, pos);
-              std::string mVal = val.substr(pos + 1);
-              rt.Measurements[mKey] = std::move(mVal);
-            } else {
-              rt.Measurements[val] = "1";
-            }
-          } else if (key == "PASS_REGULAR_EXPRESSION"_s) {
-            cmList lval{ val };
+        } else if (key == "COST"_s) {
+          rt.Cost = static_cast<float>(atof(val.c_str()));
+        } else if (key == "REQUIRED_FILES"_s) {
+          cmExpandList(val, rt.RequiredFiles);
+        } else if (key == "RUN_SERIAL"_s) {
+          rt.RunSerial = cmIsOn(val);
+        } else if (key == "FAIL_REGULAR_EXPRESSION"_s) {
+          cmList lval{ val };
+          for (std::string const& cr : lval) {
+            rt.ErrorRegularExpressions.emplace_back(cr, cr);
+          }
+        } else if (key == "SKIP_REGULAR_EXPRESSION"_s) {
+          cmList lval{ val };
+          for (std::string const& cr : lval) {
+            rt.SkipRegularExpressions.emplace_back(cr, cr);
+          }
+        } else if (key == "PROCESSORS"_s) {
+          rt.Processors = atoi(val.c_str());
+          if (rt.Processors < 1) {
+            rt.Processors = 1;
+          }
+        } else if (key == "PROCESSOR_AFFINITY"_s) {
+          rt.WantAffinity = cmIsOn(val);
+        } else if (key == "RESOURCE_GROUPS"_s) {
+          if (!ParseResourceGroupsProperty(val, rt.ResourceGroups)) {
+            return false;
+          }
+        } else if (key == "GENERATED_RESOURCE_SPEC_FILE"_s) {
+          rt.GeneratedResourceSpecFile = val;
+        } else if (key == "SKIP_RETURN_CODE"_s) {
+          rt.SkipReturnCode = atoi(val.c_str());
+          if (rt.SkipReturnCode < 0 || rt.SkipReturnCode > 255) {
+            rt.SkipReturnCode = -1;
+          }
+        } else if (key == "DEPENDS"_s) {
+          cmExpandList(val, rt.Depends);
+        } else if (key == "ENVIRONMENT"_s) {
+          cmExpandList(val, rt.Environment);
+        } else if (key == "ENVIRONMENT_MODIFICATION"_s) {
+          cmExpandList(val, rt.EnvironmentModification);
+        } else if (key == "LABELS"_s) {
+          cmList Labels{ val };
+          rt.Labels.insert(rt.Labels.end(), Labels.begin(), Labels.end());
+          // sort the array
+          std::sort(rt.Labels.begin(), rt.Labels.end());
+          // remove duplicates
+          auto new_end = std::unique(rt.Labels.begin(), rt.Labels.end());
+          rt.Labels.erase(new_end, rt.Labels.end());
+        } else if (key == "MEASUREMENT"_s) {
+          size_t pos = val.find_first_of('=');
+          if (pos != std::string::npos) {
+            std::string mKey = val.substr(0, pos);
+            std::string mVal = val.substr(pos + 1);
+            rt.Measurements[mKey] = std::move(mVal);
+          } else {
+            rt.Measurements[val] = "1";
+          }
+        } else if (key == "PASS_REGULAR_EXPRESSION"_s) {
+          cmList lval{ val };
+          for (std::string const& cr : lval) {
+            rt.RequiredRegularExpressions.emplace_back(cr, cr);
+          }
+        } else if (key == "WORKING_DIRECTORY"_s) {
+          cm::erase(this->TestListIndexesByDirectory[rt.Directory], index);
+          rt.Directory = val;
+          this->TestListIndexesByDirectory[rt.Directory].push_back(index);
+        } else if (key == "TIMEOUT_AFTER_MATCH"_s) {
+          cmList propArgs{ val };
+          if (propArgs.size() != 2) {
+            cmCTestLog(this->CTest, WARNING,
+                       "TIMEOUT_AFTER_MATCH expects two arguments, found "
+                         << propArgs.size() << std::endl);
+          } else {
+            rt.AlternateTimeout = cmDuration(atof(propArgs[0].c_str()));
+            cmList lval{ propArgs[1] };
             for (std::string const& cr : lval) {
-              rt.RequiredRegularExpressions.emplace_back(cr, cr);
+              rt.TimeoutRegularExpressions.emplace_back(cr, cr);
             }
-          } else if (key == "WORKING_DIRECTORY"_s) {
-            rt.Directory = val;
-          } else if (key == "TIMEOUT_AFTER_MATCH"_s) {
-            cmList propArgs{ val };
-            if (propArgs.size() != 2) {
-              cmCTestLog(this->CTest, WARNING,
-                         "TIMEOUT_AFTER_MATCH expects two arguments, found "
-                           << propArgs.size() << std::endl);
-            } else {
-              rt.AlternateTimeout = cmDuration(atof(propArgs[0].c_str()));
-              cmList lval{ propArgs[1] };
-              for (std::string const& cr : lval) {
-                rt.TimeoutRegularExpressions.emplace_back(cr, cr);
-              }
-            }
-          } else {
-            rt.CustomProperties[key] = val;
           }
+        } else {
+          rt.CustomProperties[key] = val;
         }
       }
     }
@@ -2380,8 +3170,11 @@ bool cmCTestTestHandler::SetTestsProperties(
 }
 
 bool cmCTestTestHandler::SetDirectoryProperties(
-  std::vector<std::string> const& args)
+  std::vector<std::string> const& args, std::string const& directory)
 {
+  this->AddTestFileCommand(TestFileCommandKind::SetDirectoryProperties,
+                           directory, args);
+
   std::vector<std::string>::const_iterator it;
   std::vector<std::string> tests;
   bool found = false;
@@ -2404,28 +3197,33 @@ bool cmCTestTestHandler::SetDirectoryProperties(
       break;
     }
     std::string const& val = *it;
-    for (cmCTestTestProperties& rt : this->TestList) {
-      std::string cwd = cmSystemTools::GetLogicalWorkingDirectory();
-      if (cwd == rt.Directory) {
-        if (key == "LABELS"_s) {
-          cmList DirectoryLabels{ val };
-          rt.Labels.insert(rt.Labels.end(), DirectoryLabels.begin(),
-                           DirectoryLabels.end());
-
-          // sort the array
-          std::sort(rt.Labels.begin(), rt.Labels.end());
-          // remove duplicates
-          auto new_end = std::unique(rt.Labels.begin(), rt.Labels.end());
-          rt.Labels.erase(new_end, rt.Labels.end());
-        }
+    auto indexes = this->TestListIndexesByDirectory.find(directory);
+    if (indexes == this->TestListIndexesByDirectory.end()) {
+      continue;
+    }
+    for (std::size_t index : indexes->second) {
+      cmCTestTestProperties& rt = this->TestList[index];
+      if (key == "LABELS"_s) {
+        cmList DirectoryLabels{ val };
+        rt.Labels.insert(rt.Labels.end(), DirectoryLabels.begin(),
+                         DirectoryLabels.end());
+
+        // sort the array
+        std::sort(rt.Labels.begin(), rt.Labels.end());
+        // remove duplicates
+        auto new_end = std::unique(rt.Labels.begin(), rt.Labels.end());
+        rt.Labels.erase(new_end, rt.Labels.end());
       }
     }
   }
   return true;
 }
 
-bool cmCTestTestHandler::AddTest(std::vector<std::string> const& args)
+bool cmCTestTestHandler::AddTest(std::vector<std::string> const& args,
+                                 std::string const& directory)
 {
+  this->AddTestFileCommand(TestFileCommandKind::AddTest, directory, args);
+
   std::string const& testname = args[0];
   cmCTestOptionalLog(this->CTest, DEBUG, "Add test: " << args[0] << std::endl,
                      this->Quiet);
@@ -2469,7 +3267,7 @@ bool cmCTestTestHandler::AddTest(std::vector<std::string> const& args)
   cmCTestTestProperties test;
   test.Name = testname;
   test.Args = args;
-  test.Directory = cmSystemTools::GetLogicalWorkingDirectory();
+  test.Directory = directory;
   cmCTestOptionalLog(this->CTest, DEBUG,
                      "Set test directory: " << test.Directory << std::endl,
                      this->Quiet);
@@ -2480,6 +3278,9 @@ bool cmCTestTestHandler::AddTest(std::vector<std::string> const& args)
         this->ExcludeTestsRegularExpression.find(testname)))) {
     test.IsInBasedOnREOptions = false;
   }
+  this->TestListIndexesByName[test.Name].push_back(this->TestList.size());
+  this->TestListIndexesByDirectory[test.Directory].push_back(
+    this->TestList.size());
   this->TestList.push_back(test);
   return true;
 }
@@ -2505,7 +3306,9 @@ void cmCTestTestHandler::SetJUnitXMLFileName(std::string const& filename)
 
 bool cmCTestTestHandler::WriteJUnitXML()
 {
-  if (this->TestOptions.JUnitXMLFileName.empty()) {
+  // The results of all shards are written by --merge-shards.
+  if (this->TestOptions.JUnitXMLFileName.empty() ||
+      this->TestOptions.ShardCount) {
     return true;
   }
 
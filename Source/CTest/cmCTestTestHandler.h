@@ -11,6 +11,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -23,6 +24,7 @@
 #include "cmCTestGenericHandler.h"
 #include "cmCTestTypes.h" // IWYU pragma: keep
 #include "cmDuration.h"
+#include "cmFileTime.h"
 #include "cmListFileCache.h"
 
 class cmMakefile;
@@ -32,9 +34,13 @@ struct cmCTestTestOptions
 {
   bool RerunFailed = false;
   bool ScheduleRandom = false;
+  bool ScheduleCriticalPath = false;
   bool StopOnFailure = false;
   bool UseUnion = false;
   cm::optional<unsigned int> ScheduleRandomSeed;
+  unsigned int ShardIndex = 0;
+  unsigned int ShardCount = 0;
+  unsigned int MergeShards = 0;
 
   int OutputSizePassed = 1 * 1024;
   int OutputSizeFailed = 300 * 1024;
@@ -97,7 +103,8 @@ public:
   /*
    * Add the test to the list of tests to be executed
    */
-  bool AddTest(std::vector<std::string> const& args);
+  bool AddTest(std::vector<std::string> const& args,
+               std::string const& directory);
 
   /*
    * Set tests properties
@@ -107,7 +114,28 @@ public:
   /**
    * Set directory properties
    */
-  bool SetDirectoryProperties(std::vector<std::string> const& args);
+  bool SetDirectoryProperties(std::vector<std::string> const& args,
+                              std::string const& directory);
+
+  /**
+   * Replay the commands recorded for a test file in the test manifest
+   * while the file is unchanged.  Returns false if the file must be
+   * evaluated instead.
+   */
+  bool ReplayTestFile(std::string const& file, cmMakefile& mf);
+
+  /**
+   * Record the commands of a test file evaluated between these calls,
+   * so that later runs can replay them while the file is unchanged.
+   */
+  void BeginTestFile(std::string const& file);
+  void EndTestFile(cmMakefile const& mf);
+
+  /**
+   * Record a subdirectory read by the current test file.  Its test file
+   * is replayed or evaluated on its own.
+   */
+  void AddTestSubdirectory(std::string const& directory);
 
   struct cmCTestTestResourceRequirement
   {
@@ -315,6 +343,16 @@ private:
    * Get the list of tests in directory and subdirectories.
    */
   bool GetListOfTests();
+  bool FinishListOfTests();
+
+  /**
+   * The test manifest records the commands of each test file evaluated
+   * by GetListOfTests, so they can be replayed without evaluating the
+   * file again until it changes.
+   */
+  std::string GetTestManifestFile() const;
+  void ReadTestManifest();
+  void WriteTestManifest() const;
   // compute the lists of tests that will actually run
   // based on union regex and -I stuff
   bool ComputeTestList();
@@ -328,6 +366,25 @@ private:
   // tests to account for fixture setup/cleanup
   void UpdateForFixtures(ListOfTests& tests) const;
 
+  // with --shard, keep only the tests of this shard, assigned to shards
+  // by decreasing cost, each to the shard with the lowest total cost
+  void SelectShard(ListOfTests& tests) const;
+
+  /**
+   * Name files written by a shard so they do not collide with the files
+   * of other shards run on the same build tree.  The results of the
+   * shards are combined by --merge-shards.
+   */
+  std::string GetShardFileName(std::string const& file) const;
+  static std::string GetShardFileName(std::string const& file,
+                                      unsigned int index, unsigned int count);
+  std::string GetShardResultsFile() const;
+  bool WriteShardResults(std::vector<std::string> const& passed,
+                         std::vector<std::string> const& failed);
+  bool MergeShards(std::vector<std::string>& passed,
+                   std::vector<std::string>& failed);
+  void RemoveShardLogs(unsigned int count) const;
+
   void UpdateMaxTestNameWidth();
 
   bool GetValue(char const* tag, std::string& value, std::istream& fin);
@@ -370,6 +427,41 @@ private:
 
   std::string TestsToRunString;
   ListOfTests TestList;
+  std::unordered_map<std::string, std::vector<std::size_t>>
+    TestListIndexesByName;
+  std::unordered_map<std::string, std::vector<std::size_t>>
+    TestListIndexesByDirectory;
+
+  enum class TestFileCommandKind
+  {
+    AddTest,
+    SetTestsProperties,
+    SetDirectoryProperties,
+    Subdirectory,
+  };
+  struct TestFileCommand
+  {
+    TestFileCommandKind Kind;
+    std::string Directory;
+    std::vector<std::string> Args;
+  };
+  struct TestFile
+  {
+    std::string Path;
+    cmFileTime::TimeType Time = 0;
+    bool Replayable = false;
+    std::vector<TestFileCommand> Commands;
+  };
+  void AddTestFileCommand(TestFileCommandKind kind,
+                          std::string const& directory,
+                          std::vector<std::string> const& args);
+  void BeginTestFile(std::string const& file, cmFileTime const& time);
+  // Test files recorded by the manifest of a previous run, by path.
+  std::unordered_map<std::string, TestFile> TestManifest;
+  // Test files replayed or evaluated by this run, and those in progress.
+  std::vector<TestFile> TestFiles;
+  std::vector<std::size_t> ActiveTestFiles;
+  bool TestFilesEvaluated = false;
   size_t TotalNumberOfTests;
   cmsys::RegularExpression AllTestMeasurementsRegex;
   cmsys::RegularExpression SingleTestMeasurementRegex;
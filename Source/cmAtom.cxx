@@ -0,0 +1,51 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmAtom.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <cm/memory>
+
+namespace {
+struct AtomTable
+{
+  // Guards the names against concurrent use by parallel generate steps.
+  std::mutex Mutex;
+  // Keys view the strings they map to, whose addresses never change.
+  std::unordered_map<cm::string_view, std::unique_ptr<std::string const>>
+    Names;
+};
+
+AtomTable& GetAtomTable()
+{
+  static AtomTable table;
+  return table;
+}
+}
+
+cmAtom cmAtom::Intern(cm::string_view name)
+{
+  AtomTable& table = GetAtomTable();
+  std::lock_guard<std::mutex> lock(table.Mutex);
+  auto it = table.Names.find(name);
+  if (it == table.Names.end()) {
+    auto str = cm::make_unique<std::string const>(name);
+    cm::string_view const key = *str;
+    it = table.Names.emplace(key, std::move(str)).first;
+  }
+  return cmAtom(it->second.get());
+}
+
+cmAtom cmAtom::Lookup(cm::string_view name)
+{
+  AtomTable& table = GetAtomTable();
+  std::lock_guard<std::mutex> lock(table.Mutex);
+  auto it = table.Names.find(name);
+  if (it == table.Names.end()) {
+    return cmAtom();
+  }
+  return cmAtom(it->second.get());
+}
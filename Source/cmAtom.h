@@ -0,0 +1,70 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include <cm/string_view>
+
+/** \class cmAtom
+ * \brief Handle to an interned name.
+ *
+ * Atoms of equal names refer to the same interned string, so atoms
+ * compare and hash by address without looking at the characters.  The
+ * atom table is shared by the whole process and may be used from several
+ * threads.  It never shrinks, so that atoms stay valid for the lifetime
+ * of the process, and should hold only names from a bounded set, such as
+ * property, configuration and language names.
+ */
+class cmAtom
+{
+public:
+  cmAtom() noexcept = default;
+
+  /** Get the atom of a name, adding the name to the table if needed.  */
+  static cmAtom Intern(cm::string_view name);
+
+  /** Get the atom of a name if it has been interned, or a null atom.  */
+  static cmAtom Lookup(cm::string_view name);
+
+  explicit operator bool() const noexcept { return this->Name != nullptr; }
+
+  /** Get the interned name.  The atom must not be null.  */
+  std::string const& str() const noexcept { return *this->Name; }
+
+  friend bool operator==(cmAtom l, cmAtom r) noexcept
+  {
+    return l.Name == r.Name;
+  }
+  friend bool operator!=(cmAtom l, cmAtom r) noexcept
+  {
+    return l.Name != r.Name;
+  }
+
+private:
+  explicit cmAtom(std::string const* name) noexcept
+    : Name(name)
+  {
+  }
+
+  std::string const* Name = nullptr;
+
+  friend struct std::hash<cmAtom>;
+};
+
+namespace std {
+
+template <>
+struct hash<cmAtom>
+{
+  size_t operator()(cmAtom a) const noexcept
+  {
+    return std::hash<std::string const*>{}(a.Name);
+  }
+};
+
+} // namespace std
@@ -2526,6 +2526,41 @@ int cmCTest::Run(std::vector<std::string> const& args)
                        this->Impl->TestOptions.ScheduleRandom = true;
                        return true;
                      } },
+    CommandArgument{ "--schedule-critical-path", CommandArgument::Values::Zero,
+                     [this](std::string const&) -> bool {
+                       this->Impl->TestOptions.ScheduleCriticalPath = true;
+                       return true;
+                     } },
+    CommandArgument{
+      "--shard", CommandArgument::Values::One,
+      [this](std::string const& shard) -> bool {
+        cmsys::RegularExpression shardRegex("^([0-9]+)/([0-9]+)$");
+        unsigned long index = 0;
+        unsigned long count = 0;
+        if (!shardRegex.find(shard) ||
+            !cmStrToULong(shardRegex.match(1), &index) ||
+            !cmStrToULong(shardRegex.match(2), &count) || index < 1 ||
+            index > count) {
+          cmSystemTools::Error(
+            cmStrCat("'--shard' given invalid value '", shard, '\''));
+          return false;
+        }
+        this->Impl->TestOptions.ShardIndex = static_cast<unsigned int>(index);
+        this->Impl->TestOptions.ShardCount = static_cast<unsigned int>(count);
+        return true;
+      } },
+    CommandArgument{
+      "--merge-shards", CommandArgument::Values::One,
+      [this](std::string const& shards) -> bool {
+        unsigned long count = 0;
+        if (!cmStrToULong(shards, &count) || count < 1) {
+          cmSystemTools::Error(
+            cmStrCat("'--merge-shards' given invalid value '", shards, '\''));
+          return false;
+        }
+        this->Impl->TestOptions.MergeShards = static_cast<unsigned int>(count);
+        return true;
+      } },
     CommandArgument{
       "--schedule-random-seed", CommandArgument::Values::One,
       [this](std::string const& sz) -> bool {
@@ -0,0 +1,337 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmCompilerIdCache.h"
+
+#include <iterator>
+#include <utility>
+
+#include <cm/memory>
+#include <cm/optional>
+#include <cm/string_view>
+
+#include <cm3p/json/reader.h>
+#include <cm3p/json/value.h>
+#include <cm3p/json/writer.h>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmFileLock.h"
+#include "cmFileLockResult.h"
+#include "cmFileTime.h"
+#include "cmGeneratedFileStream.h"
+#include "cmGlobalGenerator.h"
+#include "cmMakefile.h"
+#include "cmState.h"
+#include "cmStateTypes.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+#include "cmValue.h"
+#include "cmVersion.h"
+
+namespace {
+
+int const Version = 1;
+
+// Waiting longer than this for another process to finish with an entry
+// costs more than determining the compiler.
+unsigned long const LockTimeout = 10;
+
+// Variables that select the compiler of a language or affect what is
+// found out about it.  "<LANG>" is replaced by the language.
+char const* const KeyVariables[] = {
+  "CMAKE_<LANG>_COMPILER",
+  "CMAKE_<LANG>_COMPILER_ARG1",
+  "CMAKE_<LANG>_COMPILER_EXTERNAL_TOOLCHAIN",
+  "CMAKE_<LANG>_COMPILER_TARGET",
+  "CMAKE_<LANG>_FLAGS",
+  "CMAKE_<LANG>_FLAGS_INIT",
+  "CMAKE_<LANG>_HOST_COMPILER",
+  "CMAKE_<LANG>_ARCHITECTURES",
+  "CMAKE_<LANG>_PLATFORM",
+  "CMAKE_<LANG>_USING_LINKER_MODE",
+  "CMAKE_AR",
+  "CMAKE_CROSSCOMPILING_EMULATOR",
+  "CMAKE_EXE_LINKER_FLAGS",
+  "CMAKE_EXE_LINKER_FLAGS_INIT",
+  "CMAKE_LINKER",
+  "CMAKE_LINKER_TYPE",
+  "CMAKE_MAKE_PROGRAM",
+  "CMAKE_OSX_ARCHITECTURES",
+  "CMAKE_OSX_DEPLOYMENT_TARGET",
+  "CMAKE_OSX_SYSROOT",
+  "CMAKE_PROGRAM_PATH",
+  "CMAKE_RANLIB",
+  "CMAKE_SYSROOT",
+  "CMAKE_SYSROOT_COMPILE",
+  "CMAKE_SYSROOT_LINK",
+  "CMAKE_TRY_COMPILE_CONFIGURATION",
+  "CMAKE_TRY_COMPILE_TARGET_TYPE",
+};
+
+// Environment variables that select compilers or are read by them.
+char const* const KeyEnvironment[] = {
+  "ASM", "ASMFLAGS", "ASM_NASM", "CC", "CFLAGS", "COMPILER_PATH", "CPATH",
+  "CPLUS_INCLUDE_PATH", "CUDAARCHS", "CUDACXX", "CUDAFLAGS", "CUDAHOSTCXX",
+  "CXX", "CXXFLAGS", "C_INCLUDE_PATH", "DEVELOPER_DIR", "FC", "FFLAGS",
+  "GCC_EXEC_PREFIX", "HIPCXX", "HIPFLAGS", "HIPHOSTCXX", "INCLUDE", "ISPC",
+  "ISPCFLAGS", "LDFLAGS", "LIB", "LIBRARY_PATH", "OBJC", "OBJCFLAGS", "OBJCXX",
+  "OBJCXXFLAGS", "PATH", "RC", "RCFLAGS", "SDKROOT", "SWIFTC", "SWIFTFLAGS",
+};
+
+bool ReadFile(std::string const& file, std::string& content)
+{
+  cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  content.assign(std::istreambuf_iterator<char>(fin),
+                 std::istreambuf_iterator<char>());
+  return !fin.bad();
+}
+
+std::string FileTime(std::string const& file)
+{
+  cmFileTime time;
+  if (!time.Load(file)) {
+    return std::string();
+  }
+  return std::to_string(time.GetTime());
+}
+
+bool LockEntry(std::string const& entry, cmFileLock& lock)
+{
+  std::string const lockName = cmStrCat(entry, "/lock");
+  return cmSystemTools::Touch(lockName, true) &&
+    lock.Lock(lockName, LockTimeout).IsOk();
+}
+
+// Check the compiler named by an entry cheaply.  Its content is hashed
+// only if its size is unchanged but its modification time is not.
+bool CompilerUnchanged(Json::Value const& compiler)
+{
+  std::string const path = compiler["path"].asString();
+  if (!cmSystemTools::FileExists(path, true) ||
+      std::to_string(cmSystemTools::FileLength(path)) !=
+        compiler["size"].asString()) {
+    return false;
+  }
+  if (FileTime(path) == compiler["time"].asString()) {
+    return true;
+  }
+  cmCryptoHash hash(cmCryptoHash::AlgoSHA256);
+  return hash.HashFile(path) == compiler["sha256"].asString();
+}
+}
+
+std::unique_ptr<cmCompilerIdCache> cmCompilerIdCache::Create(
+  cmMakefile const& mf)
+{
+  std::string directory = mf.GetSafeDefinition("CMAKE_COMPILER_ID_CACHE");
+  if (directory.empty()) {
+    if (cm::optional<std::string> env =
+          cmSystemTools::GetEnvVar("CMAKE_COMPILER_ID_CACHE")) {
+      directory = std::move(*env);
+    }
+  }
+  if (directory.empty() || !cmSystemTools::FileIsFullPath(directory)) {
+    return nullptr;
+  }
+  return cm::make_unique<cmCompilerIdCache>(
+    cmSystemTools::CollapseFullPath(directory));
+}
+
+cmCompilerIdCache::cmCompilerIdCache(std::string directory)
+  : Directory(std::move(directory))
+{
+}
+
+std::string cmCompilerIdCache::ComputeKey(cmMakefile const& mf,
+                                          std::string const& lang) const
+{
+  cmCryptoHash contentHash(cmCryptoHash::AlgoSHA256);
+  cmCryptoHash hash(cmCryptoHash::AlgoSHA256);
+  hash.Initialize();
+  auto append = [&hash](cm::string_view name, cm::string_view value) {
+    hash.Append(name);
+    hash.Append(cm::string_view("=", 1));
+    hash.Append(value);
+    hash.Append(cm::string_view("\n", 1));
+  };
+
+  append("version", std::to_string(Version));
+  append("cmake", cmVersion::GetCMakeVersion());
+  append("language", lang);
+  append("generator", mf.GetGlobalGenerator()->GetName());
+  for (char const* var :
+       { "CMAKE_GENERATOR_INSTANCE", "CMAKE_GENERATOR_PLATFORM",
+         "CMAKE_GENERATOR_TOOLSET" }) {
+    append(var, mf.GetSafeDefinition(var));
+  }
+
+  // The target system and the toolchain file describing it.
+  std::string content;
+  if (!ReadFile(cmStrCat(mf.GetSafeDefinition("CMAKE_PLATFORM_INFO_DIR"),
+                         "/CMakeSystem.cmake"),
+                content)) {
+    return std::string();
+  }
+  append("system", contentHash.HashString(content));
+  if (cmValue toolchain = mf.GetDefinition("CMAKE_TOOLCHAIN_FILE")) {
+    if (!ReadFile(*toolchain, content)) {
+      return std::string();
+    }
+    append("toolchain", *toolchain);
+    append("content", contentHash.HashString(content));
+  }
+
+  for (char const* var : KeyVariables) {
+    std::string name = var;
+    cmSystemTools::ReplaceString(name, "<LANG>", lang);
+    if (cmValue value = mf.GetDefinition(name)) {
+      append(name, *value);
+    }
+  }
+  for (char const* var : KeyEnvironment) {
+    if (cm::optional<std::string> value = cmSystemTools::GetEnvVar(var)) {
+      append(cmStrCat("ENV{", var, '}'), *value);
+    }
+  }
+
+  return hash.FinalizeHex();
+}
+
+bool cmCompilerIdCache::Load(std::string const& key, cmMakefile& mf,
+                             std::string const& compilerFile) const
+{
+  std::string const entry = this->GetEntryDirectory(key);
+  std::string const entryFile = cmStrCat(entry, "/entry.json");
+  if (!cmSystemTools::FileExists(entryFile, true)) {
+    return false;
+  }
+
+  cmFileLock lock;
+  if (!LockEntry(entry, lock)) {
+    return false;
+  }
+
+  cmsys::ifstream fin(entryFile.c_str(), std::ios::in | std::ios::binary);
+  Json::CharReaderBuilder builder;
+  Json::Value root;
+  std::string errors;
+  if (!fin || !Json::parseFromStream(builder, fin, &root, &errors) ||
+      !root.isObject() || root["version"] != Version ||
+      !root["compiler"].isObject() || !root["cacheEntries"].isArray() ||
+      !CompilerUnchanged(root["compiler"])) {
+    return false;
+  }
+
+  std::string content;
+  if (!ReadFile(cmStrCat(entry, "/compiler.cmake"), content)) {
+    return false;
+  }
+  cmGeneratedFileStream fout;
+  fout.Open(compilerFile, false, true);
+  fout << content;
+  if (!fout.Close()) {
+    return false;
+  }
+
+  // Entries given by the user, e.g. on the command line, win.
+  cmState* state = mf.GetState();
+  for (Json::Value const& e : root["cacheEntries"]) {
+    std::string const name = e["name"].asString();
+    if (name.empty() || state->GetInitializedCacheValue(name)) {
+      continue;
+    }
+    mf.AddCacheDefinition(
+      name, e["value"].asString(), e["help"].asString(),
+      cmState::StringToCacheEntryType(e["type"].asString()));
+    if (e["advanced"].asBool()) {
+      state->SetCacheEntryProperty(name, "ADVANCED", "1");
+    }
+  }
+  return true;
+}
+
+void cmCompilerIdCache::Store(
+  std::string const& key, cmMakefile const& mf, std::string const& lang,
+  std::string const& compilerFile,
+  std::vector<std::string> const& cacheEntries) const
+{
+  std::string const compiler =
+    mf.GetSafeDefinition(cmStrCat("CMAKE_", lang, "_COMPILER"));
+  if (!cmSystemTools::FileIsFullPath(compiler) ||
+      !cmSystemTools::FileExists(compiler, true)) {
+    return;
+  }
+
+  // Information naming the build tree cannot be used by others.
+  std::string content;
+  if (!ReadFile(compilerFile, content) ||
+      content.find(mf.GetHomeOutputDirectory()) != std::string::npos) {
+    return;
+  }
+
+  cmCryptoHash hash(cmCryptoHash::AlgoSHA256);
+  Json::Value root(Json::objectValue);
+  root["version"] = Version;
+  Json::Value& compilerValue = root["compiler"] = Json::objectValue;
+  compilerValue["path"] = compiler;
+  compilerValue["size"] = std::to_string(cmSystemTools::FileLength(compiler));
+  compilerValue["time"] = FileTime(compiler);
+  compilerValue["sha256"] = hash.HashFile(compiler);
+
+  cmState* state = mf.GetState();
+  Json::Value& entries = root["cacheEntries"] = Json::arrayValue;
+  for (std::string const& name : cacheEntries) {
+    cmValue const value = state->GetCacheEntryValue(name);
+    if (!value || value->find(mf.GetHomeOutputDirectory()) !=
+          std::string::npos) {
+      continue;
+    }
+    Json::Value e(Json::objectValue);
+    e["name"] = name;
+    e["value"] = *value;
+    e["type"] =
+      cmState::CacheEntryTypeToString(state->GetCacheEntryType(name));
+    cmValue const help = state->GetCacheEntryProperty(name, "HELPSTRING");
+    e["help"] = help ? *help : std::string();
+    e["advanced"] = state->GetCacheEntryPropertyAsBool(name, "ADVANCED");
+    entries.append(std::move(e));
+  }
+
+  std::string const entry = this->GetEntryDirectory(key);
+  if (!cmSystemTools::MakeDirectory(entry)) {
+    return;
+  }
+  cmFileLock lock;
+  if (!LockEntry(entry, lock)) {
+    return;
+  }
+
+  // Readers look for the entry file, so write it last.  An existing
+  // entry is replaced because it did not match the compiler.
+  {
+    cmGeneratedFileStream fout;
+    fout.Open(cmStrCat(entry, "/compiler.cmake"), true, true);
+    fout << content;
+    if (!fout.Close()) {
+      return;
+    }
+  }
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "  ";
+  std::unique_ptr<Json::StreamWriter> const writer(builder.newStreamWriter());
+  cmGeneratedFileStream fout;
+  fout.Open(cmStrCat(entry, "/entry.json"), true, true);
+  writer->write(root, &fout);
+  fout << '\n';
+  fout.Close();
+}
+
+std::string cmCompilerIdCache::GetEntryDirectory(std::string const& key) const
+{
+  return cmStrCat(this->Directory, '/', cm::string_view(key).substr(0, 2), '/',
+                  key);
+}
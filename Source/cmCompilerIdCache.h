@@ -0,0 +1,60 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class cmMakefile;
+
+/** \class cmCompilerIdCache
+ * \brief Toolchain information of enabled languages shared by build trees
+ *        on a machine.
+ *
+ * Enabling a language in a fresh build tree identifies its compiler,
+ * checks that it works and inspects its ABI and implicit directories.
+ * The resulting CMake<LANG>Compiler.cmake file and the cache entries
+ * created while the compiler was determined are stored under a key that
+ * hashes the inputs known before the compiler is found: the toolchain
+ * file, the variables and environment variables selecting the compiler
+ * and its flags, the target system and the generator.  A later build tree
+ * with the same key takes the stored information instead of determining
+ * it again, as long as the compiler it names has not changed since.
+ */
+class cmCompilerIdCache
+{
+public:
+  /** Returns the cache selected by the CMAKE_COMPILER_ID_CACHE variable
+      or environment variable, if any.  */
+  static std::unique_ptr<cmCompilerIdCache> Create(cmMakefile const& mf);
+
+  cmCompilerIdCache(std::string directory);
+
+  /** Computes the key of the toolchain of a language before its compiler
+      is determined.  */
+  std::string ComputeKey(cmMakefile const& mf, std::string const& lang) const;
+
+  /**
+   * @brief Writes the compiler information file stored for a key and
+   *        adds the cache entries stored with it.
+   *
+   * Returns false if there is no entry for the key or the compiler named
+   * by the entry has changed since it was stored.
+   */
+  bool Load(std::string const& key, cmMakefile& mf,
+            std::string const& compilerFile) const;
+
+  /** Stores the compiler information file of a working compiler and the
+      given cache entries created while the compiler was determined.  */
+  void Store(std::string const& key, cmMakefile const& mf,
+             std::string const& lang, std::string const& compilerFile,
+             std::vector<std::string> const& cacheEntries) const;
+
+private:
+  std::string GetEntryDirectory(std::string const& key) const;
+
+  std::string Directory;
+};
@@ -593,6 +593,20 @@ private:
   std::set<size_t> Emitted;
   std::map<size_t, std::vector<size_t>> const* Groups = nullptr;
 };
+
+// Whether a link implementation or interface names the runtime libraries
+// of a language, which are selected by configuration.
+template <typename T>
+bool HasLanguageRuntimeLibraries(T const& libraries)
+{
+  return std::any_of(libraries.Languages.begin(), libraries.Languages.end(),
+                     [&libraries](std::string const& language) {
+                       auto i =
+                         libraries.LanguageRuntimeLibraries.find(language);
+                       return i != libraries.LanguageRuntimeLibraries.end() &&
+                         !i->second.empty();
+                     });
+}
 }
 
 std::string const& cmComputeLinkDepends::LinkEntry::DEFAULT =
@@ -625,6 +639,9 @@ cmComputeLinkDepends::cmComputeLinkDepends(cmGeneratorTarget const* target,
       if (cmHasPrefix(key, lloPrefix)) {
         if (cmValue feature = this->Target->GetProperty(key)) {
           if (!feature->empty() && key.length() > lloPrefix.length()) {
+            if (!cmGeneratorExpression::IsConfigIndependent(*feature)) {
+              this->LinkLibraryOverrideIsConfigIndependent = false;
+            }
             auto item = key.substr(lloPrefix.length());
             cmGeneratorExpressionDAGChecker dagChecker{
               this->Target,
@@ -646,6 +663,9 @@ cmComputeLinkDepends::cmComputeLinkDepends(cmGeneratorTarget const* target,
   // global override property
   if (cmValue linkLibraryOverride =
         this->Target->GetProperty("LINK_LIBRARY_OVERRIDE")) {
+    if (!cmGeneratorExpression::IsConfigIndependent(*linkLibraryOverride)) {
+      this->LinkLibraryOverrideIsConfigIndependent = false;
+    }
     cmGeneratorExpressionDAGChecker dagChecker{
       target,
       "LINK_LIBRARY_OVERRIDE",
@@ -676,6 +696,15 @@ cmComputeLinkDepends::~cmComputeLinkDepends() = default;
 std::vector<cmComputeLinkDepends::LinkEntry> const&
 cmComputeLinkDepends::Compute()
 {
+#ifndef CMAKE_BOOTSTRAP
+  auto profilingRAII = this->CMakeInstance->CreateProfilingEntry(
+    "link_depends", this->Target->GetName(), [this]() -> Json::Value {
+      Json::Value args = Json::objectValue;
+      args["config"] = this->Config;
+      return args;
+    });
+#endif
+
   // Follow the link dependencies of the target to be linked.
   this->AddDirectLinkEntries();
 
@@ -757,6 +786,72 @@ cmComputeLinkDepends::Compute()
   return this->FinalLinkEntries;
 }
 
+bool cmComputeLinkDepends::IsConfigIndependent() const
+{
+  // The debug mode reports the analysis of every configuration.
+  if (this->DebugMode || !this->LinkLibraryOverrideIsConfigIndependent) {
+    return false;
+  }
+
+  cmLinkImplementation const* impl = this->Target->GetLinkImplementation(
+    this->Config, cmGeneratorTarget::UseTo::Link);
+  if (!impl || !impl->ConfigIndependent ||
+      HasLanguageRuntimeLibraries(*impl)) {
+    return false;
+  }
+
+  // Follow the items the way Compute() does.  Values that may differ
+  // between configurations qualify only if they are empty, and so are
+  // the same in every configuration for which this returns true.
+  std::vector<cmLinkItem> queue(impl->Libraries.begin(),
+                                impl->Libraries.end());
+  std::set<cmGeneratorTarget const*> followed;
+  while (!queue.empty()) {
+    cmLinkItem const item = std::move(queue.back());
+    queue.pop_back();
+    cmGeneratorTarget const* target = item.Target;
+    if (!target) {
+      // Old-style <item>_LIB_DEPENDS lists select items by link type.
+      if (this->Makefile->GetDefinition(
+            cmStrCat(item.AsStr(), "_LIB_DEPENDS"))) {
+        return false;
+      }
+      continue;
+    }
+    if (!followed.insert(target).second) {
+      continue;
+    }
+    if (!target->IsLinkInterfaceConfigIndependent()) {
+      return false;
+    }
+    cmLinkInterface const* iface =
+      target->GetLinkInterface(this->Config, this->Target);
+    if (!iface) {
+      continue;
+    }
+    if (iface->Multiplicity > 0 || HasLanguageRuntimeLibraries(*iface)) {
+      return false;
+    }
+    if (!iface->SharedDeps.empty()) {
+      // The dependent shared libraries of a target come from its link
+      // implementation or the import information of this configuration.
+      if (target->IsImported()) {
+        return false;
+      }
+      cmLinkImplementation const* targetImpl = target->GetLinkImplementation(
+        this->Config, cmGeneratorTarget::UseTo::Link);
+      if (!targetImpl || !targetImpl->ConfigIndependent) {
+        return false;
+      }
+    }
+    queue.insert(queue.end(), iface->Libraries.begin(),
+                 iface->Libraries.end());
+    queue.insert(queue.end(), iface->SharedDeps.begin(),
+                 iface->SharedDeps.end());
+  }
+  return true;
+}
+
 std::string const& cmComputeLinkDepends::GetCurrentFeature(
   std::string const& item, std::string const& defaultFeature) const
 {
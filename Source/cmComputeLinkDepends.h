@@ -85,6 +85,10 @@ public:
   using EntryVector = std::vector<LinkEntry>;
   EntryVector const& Compute();
 
+  /** Whether Compute() returns the same entries in every configuration
+      for which this is true.  */
+  bool IsConfigIndependent() const;
+
 private:
   // Context information.
   cmGeneratorTarget const* Target = nullptr;
@@ -99,6 +103,7 @@ private:
 
   EntryVector FinalLinkEntries;
   std::map<std::string, std::string> LinkLibraryOverride;
+  bool LinkLibraryOverrideIsConfigIndependent = true;
 
   std::string const& GetCurrentFeature(
     std::string const& item, std::string const& defaultFeature) const;
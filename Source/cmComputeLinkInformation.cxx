@@ -545,6 +545,16 @@ bool cmComputeLinkInformation::Compute()
     return false;
   }
 
+#ifndef CMAKE_BOOTSTRAP
+  auto profilingRAII = this->CMakeInstance->CreateProfilingEntry(
+    "link_information", this->Target->GetName(), [this]() -> Json::Value {
+      Json::Value args = Json::objectValue;
+      args["config"] = this->Config;
+      args["language"] = this->LinkLanguage;
+      return args;
+    });
+#endif
+
   LinkLibrariesStrategy strategy = LinkLibrariesStrategy::REORDER_MINIMALLY;
   if (cmValue s = this->Target->GetProperty("LINK_LIBRARIES_STRATEGY")) {
     if (*s == "REORDER_MINIMALLY"_s) {
@@ -561,10 +571,22 @@ bool cmComputeLinkInformation::Compute()
     }
   }
 
-  // Compute the ordered link line items.
+  // Compute the ordered link line items.  Multi-config generators take
+  // them from another configuration if they are the same in every one.
   cmComputeLinkDepends cld(this->Target, this->Config, this->LinkLanguage,
                            strategy);
-  cmComputeLinkDepends::EntryVector const& linkEntries = cld.Compute();
+  if (this->GlobalGenerator->IsMultiConfig() && cld.IsConfigIndependent()) {
+    this->LinkEntriesAreConfigIndependent = true;
+    if (cmComputeLinkInformation const* other =
+          this->Target->FindConfigIndependentLinkInformation(
+            this->LinkLanguage)) {
+      this->LinkEntries = other->LinkEntries;
+    } else {
+      this->LinkEntries = cld.Compute();
+    }
+  }
+  cmComputeLinkDepends::EntryVector const& linkEntries =
+    this->LinkEntriesAreConfigIndependent ? this->LinkEntries : cld.Compute();
   FeatureDescriptor const* currentFeature = nullptr;
 
   // Add the link line items.
@@ -124,6 +124,13 @@ public:
 
   std::string GetConfig() const { return this->Config; }
 
+  /** Whether the link entries computed for this configuration are the
+      same in every configuration.  */
+  bool HasConfigIndependentLinkEntries() const
+  {
+    return this->LinkEntriesAreConfigIndependent;
+  }
+
   cmGeneratorTarget const* GetTarget() { return this->Target; }
 
 private:
@@ -133,6 +140,11 @@ private:
   void AddSharedDepItem(LinkEntry const& entry);
   void AddRuntimeDLL(cmGeneratorTarget const* tgt);
 
+  // Link entries kept to share with the other configurations of the
+  // target when they are the same in every configuration.
+  cmComputeLinkDepends::EntryVector LinkEntries;
+  bool LinkEntriesAreConfigIndependent = false;
+
   // Output information.
   ItemVector Items;
   std::vector<std::string> Directories;
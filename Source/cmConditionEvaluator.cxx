@@ -26,6 +26,11 @@
 #include "cmSystemTools.h"
 #include "cmValue.h"
 
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmFindPackageCache.h"
+#  include "cmake.h"
+#endif
+
 namespace {
 auto const keyAND = "AND"_s;
 auto const keyCOMMAND = "COMMAND"_s;
@@ -113,6 +118,24 @@ bool looksLikeSpecialVariable(std::string const& var,
   return ((prefix.size() + 3) <= varNameLen) &&
     cmHasPrefix(var, cmStrCat(prefix, '{')) && var[varNameLen - 1] == '}';
 }
+
+// Tests of the file system are inputs of a package configuration file
+// being recorded.
+bool RecordFileTest(cmMakefile const& mf, cm::string_view test,
+                    std::string const& path, bool result)
+{
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        mf.GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordFileTest(test, path, result);
+  }
+#else
+  static_cast<void>(mf);
+  static_cast<void>(test);
+  static_cast<void>(path);
+#endif
+  return result;
+}
 } // anonymous namespace
 
 #if defined(__SUNPRO_CC)
@@ -433,35 +456,51 @@ bool cmConditionEvaluator::HandleLevel1(cmArgumentList& newArgs, std::string&,
 
     // does a file exist
     if (this->IsKeyword(keyEXISTS, *args.current)) {
-      newArgs.ReduceOneArg(cmSystemTools::FileExists(args.next->GetValue()),
+      auto const& path = args.next->GetValue();
+      newArgs.ReduceOneArg(RecordFileTest(this->Makefile, keyEXISTS, path,
+                                          cmSystemTools::FileExists(path)),
                            args);
     }
     // check if a file is readable
     else if (this->IsKeyword(keyIS_READABLE, *args.current)) {
-      newArgs.ReduceOneArg(cmSystemTools::TestFileAccess(
-                             args.next->GetValue(), cmsys::TEST_FILE_READ),
-                           args);
+      auto const& path = args.next->GetValue();
+      newArgs.ReduceOneArg(
+        RecordFileTest(
+          this->Makefile, keyIS_READABLE, path,
+          cmSystemTools::TestFileAccess(path, cmsys::TEST_FILE_READ)),
+        args);
     }
     // check if a file is writable
     else if (this->IsKeyword(keyIS_WRITABLE, *args.current)) {
-      newArgs.ReduceOneArg(cmSystemTools::TestFileAccess(
-                             args.next->GetValue(), cmsys::TEST_FILE_WRITE),
-                           args);
+      auto const& path = args.next->GetValue();
+      newArgs.ReduceOneArg(
+        RecordFileTest(
+          this->Makefile, keyIS_WRITABLE, path,
+          cmSystemTools::TestFileAccess(path, cmsys::TEST_FILE_WRITE)),
+        args);
     }
     // check if a file is executable
     else if (this->IsKeyword(keyIS_EXECUTABLE, *args.current)) {
-      newArgs.ReduceOneArg(cmSystemTools::TestFileAccess(
-                             args.next->GetValue(), cmsys::TEST_FILE_EXECUTE),
-                           args);
+      auto const& path = args.next->GetValue();
+      newArgs.ReduceOneArg(
+        RecordFileTest(
+          this->Makefile, keyIS_EXECUTABLE, path,
+          cmSystemTools::TestFileAccess(path, cmsys::TEST_FILE_EXECUTE)),
+        args);
     }
     // does a directory with this name exist
     else if (this->IsKeyword(keyIS_DIRECTORY, *args.current)) {
+      auto const& path = args.next->GetValue();
       newArgs.ReduceOneArg(
-        cmSystemTools::FileIsDirectory(args.next->GetValue()), args);
+        RecordFileTest(this->Makefile, keyIS_DIRECTORY, path,
+                       cmSystemTools::FileIsDirectory(path)),
+        args);
     }
     // does a symlink with this name exist
     else if (this->IsKeyword(keyIS_SYMLINK, *args.current)) {
-      newArgs.ReduceOneArg(cmSystemTools::FileIsSymlink(args.next->GetValue()),
+      auto const& path = args.next->GetValue();
+      newArgs.ReduceOneArg(RecordFileTest(this->Makefile, keyIS_SYMLINK, path,
+                                          cmSystemTools::FileIsSymlink(path)),
                            args);
     }
     // is the given path an absolute path ?
@@ -496,11 +535,23 @@ bool cmConditionEvaluator::HandleLevel1(cmArgumentList& newArgs, std::string&,
       auto result = false;
       if (looksLikeSpecialVariable(var, "ENV"_s, varNameLen)) {
         auto const env = args.next->GetValue().substr(4, varNameLen - 5);
+#ifndef CMAKE_BOOTSTRAP
+        if (cmFindPackageCache* cache =
+              this->Makefile.GetCMakeInstance()->GetFindPackageCache()) {
+          cache->RecordEnvironmentRead(env);
+        }
+#endif
         result = cmSystemTools::HasEnv(env);
       }
 
       else if (looksLikeSpecialVariable(var, "CACHE"_s, varNameLen)) {
         auto const cache = args.next->GetValue().substr(6, varNameLen - 7);
+#ifndef CMAKE_BOOTSTRAP
+        if (cmFindPackageCache* fpCache =
+              this->Makefile.GetCMakeInstance()->GetFindPackageCache()) {
+          fpCache->RecordCacheRead(cache);
+        }
+#endif
         result = static_cast<bool>(
           this->Makefile.GetState()->GetCacheEntryValue(cache));
       }
@@ -635,7 +686,10 @@ bool cmConditionEvaluator::HandleLevel2(cmArgumentList& newArgs,
       cmsys::Status ftcStatus = cmSystemTools::FileTimeCompare(
         args.current->GetValue(), args.nextnext->GetValue(), &fileIsNewer);
       newArgs.ReduceTwoArgs(
-        (!ftcStatus || fileIsNewer == 1 || fileIsNewer == 0), args);
+        RecordFileTest(this->Makefile, keyIS_NEWER_THAN,
+                       args.current->GetValue(),
+                       (!ftcStatus || fileIsNewer == 1 || fileIsNewer == 0)),
+        args);
     }
 
     else if (this->IsKeyword(keyIN_LIST, *args.next)) {
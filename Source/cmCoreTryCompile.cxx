@@ -2,11 +2,15 @@
    file LICENSE.rst or https://cmake.org/licensing for details.  */
 #include "cmCoreTryCompile.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdio>
 #include <cstring>
+#include <iterator>
+#include <memory>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <utility>
 
 #include <cm/string_view>
@@ -35,6 +39,10 @@
 #include "cmVersion.h"
 #include "cmake.h"
 
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmTryCompileCache.h"
+#endif
+
 namespace {
 constexpr char const* unique_binary_directory = "CMAKE_BINARY_DIR_USE_MKDTEMP";
 constexpr size_t lang_property_start = 0;
@@ -213,7 +221,8 @@ auto const TryCompileProjectArgParser =
   makeTryCompileParser(TryCompileBaseProjectArgParser);
 
 auto const TryCompileSourcesArgParser =
-  makeTryCompileParser(TryCompileBaseNewSourcesArgParser);
+  makeTryCompileParser(TryCompileBaseNewSourcesArgParser)
+    .Bind("BATCH"_s, &Arguments::Batch);
 
 auto const TryCompileOldArgParser =
   makeTryCompileParser(TryCompileBaseSourcesArgParser)
@@ -231,6 +240,33 @@ auto const TryRunOldArgParser = makeTryRunParser(TryCompileOldArgParser);
 #undef BIND_LANG_PROPS
 
 std::string const TryCompileDefaultConfig = "DEBUG";
+
+// Cache entries of a try_compile project that only its generated
+// CMakeLists.txt file reads.  The projects of a batch get them as
+// directory variables so that they can be built together.
+bool ParseProjectVariableFlag(std::string const& flag, std::string& var,
+                              std::string& value)
+{
+  static std::set<cm::string_view> const projectVariables{
+    "COMPILE_DEFINITIONS"_s, "EXE_LINKER_FLAGS"_s, "INCLUDE_DIRECTORIES"_s,
+    "LINK_DIRECTORIES"_s, "LINK_LIBRARIES"_s
+  };
+  if (!cmHasLiteralPrefix(flag, "-D")) {
+    return false;
+  }
+  std::string::size_type const eq = flag.find('=');
+  if (eq == std::string::npos) {
+    return false;
+  }
+  std::string::size_type const end = std::min(flag.find(':'), eq);
+  cm::string_view const name = cm::string_view(flag).substr(2, end - 2);
+  if (projectVariables.count(name) == 0) {
+    return false;
+  }
+  var = std::string(name);
+  value = flag.substr(eq + 1);
+  return true;
+}
 }
 
 ArgumentParser::Continue cmCoreTryCompile::Arguments::SetSourceType(
@@ -360,8 +396,13 @@ cm::optional<cmTryCompileResult> cmCoreTryCompile::TryCompileCode(
     /* Use a random file name to avoid rapid creation and deletion
        of the same executable name (some filesystems fail on that).  */
     char targetNameBuf[64];
-    snprintf(targetNameBuf, sizeof(targetNameBuf), "cmTC_%05x",
-             cmSystemTools::RandomNumber() & 0xFFFFF);
+    do {
+      snprintf(targetNameBuf, sizeof(targetNameBuf), "cmTC_%05x",
+               cmSystemTools::RandomNumber() & 0xFFFFF);
+      /* Projects built together in a batch need distinct names.  */
+    } while (arguments.Batch &&
+             this->Makefile->GetTryCompileBatch(*arguments.Batch)
+               .HasTarget(targetNameBuf));
     targetName = targetNameBuf;
   }
 
@@ -392,9 +433,11 @@ cm::optional<cmTryCompileResult> cmCoreTryCompile::TryCompileCode(
   }
 
   std::vector<std::string> targets;
+  bool linksTargets = false;
   if (arguments.LinkLibraries) {
     for (std::string const& i : *arguments.LinkLibraries) {
       if (cmTarget* tgt = this->Makefile->FindTargetToUse(i)) {
+        linksTargets = true;
         switch (tgt->GetType()) {
           case cmStateEnums::SHARED_LIBRARY:
           case cmStateEnums::STATIC_LIBRARY:
@@ -517,6 +560,7 @@ cm::optional<cmTryCompileResult> cmCoreTryCompile::TryCompileCode(
   }
 
   std::map<std::string, std::string> cmakeVariables;
+  std::vector<std::string> sourceFiles;
 
   std::string outFileName = cmStrCat(this->BinaryDirectory, "/CMakeLists.txt");
   // which signature are we using? If we are using var srcfile bindir
@@ -587,6 +631,9 @@ cm::optional<cmTryCompileResult> cmCoreTryCompile::TryCompileCode(
       }
     }
     // TODO: ensure sources is not empty
+    for (auto const& source : sources) {
+      sourceFiles.push_back(source.first);
+    }
 
     // Detect languages to enable.
     cmGlobalGenerator* gg = this->Makefile->GetGlobalGenerator();
@@ -949,8 +996,9 @@ cm::optional<cmTryCompileResult> cmCoreTryCompile::TryCompileCode(
     }
     fprintf(fout,
             "file(GENERATE OUTPUT "
-            "\"${CMAKE_BINARY_DIR}/%s%s_loc\"\n",
-            targetName.c_str(), perConfigGenex.c_str());
+            "\"%s/%s%s_loc\"\n",
+            this->BinaryDirectory.c_str(), targetName.c_str(),
+            perConfigGenex.c_str());
     fprintf(fout, "     CONTENT $<TARGET_FILE:%s>)\n", targetName.c_str());
 
     bool warnCMP0067 = false;
@@ -1240,18 +1288,77 @@ cm::optional<cmTryCompileResult> cmCoreTryCompile::TryCompileCode(
     this->Makefile->IssueMessage(MessageType::LOG, msg);
   }
 
-  bool erroroc = cmSystemTools::GetErrorOccurredFlag();
-  cmSystemTools::ResetErrorOccurredFlag();
   std::string output;
-  // actually do the try compile now that everything is setup
-  int res = this->Makefile->TryCompile(
-    sourceDirectory, this->BinaryDirectory, projectName, targetName,
-    this->SrcFileSignature, cmake::NO_BUILD_PARALLEL_LEVEL,
-    &arguments.CMakeFlags, output);
-  if (erroroc) {
-    cmSystemTools::SetErrorOccurred();
+  int res = 1;
+  bool restored = false;
+  std::string cacheKey;
+#ifndef CMAKE_BOOTSTRAP
+  // Take the result of an identical check from the try_compile cache.
+  // Checks made by CMake itself and projects linking to targets of the
+  // calling project are not cached.
+  std::unique_ptr<cmTryCompileCache> cache;
+  if (this->SrcFileSignature && arguments.CMakeInternal.empty() &&
+      !linksTargets &&
+      !this->Makefile->GetCMakeInstance()->GetDebugTryCompile()) {
+    cache = cmTryCompileCache::Create(*this->Makefile);
+  }
+  if (cache) {
+    cacheKey = cache->ComputeKey(
+      *this->Makefile, this->BinaryDirectory, targetName,
+      arguments.CMakeFlags, sourceFiles,
+      arguments.LinkLibraries ? *arguments.LinkLibraries
+                              : std::vector<std::string>());
+  }
+  if (!cacheKey.empty()) {
+    if (cm::optional<cmTryCompileCache::Result> cached =
+          cache->Load(cacheKey, this->BinaryDirectory, targetName)) {
+      res = cached->ExitCode;
+      output = std::move(cached->Output);
+      this->OutputFile = std::move(cached->OutputFile);
+      restored = true;
+    }
+  }
+#else
+  static_cast<void>(linksTargets);
+#endif
+
+  if (!restored && arguments.Batch) {
+    // Leave the project to be built later with the others of its batch.
+    BatchProbe probe(arguments);
+    probe.TargetName = targetName;
+    probe.BinaryDirectory = this->BinaryDirectory;
+    probe.CMakeVariables = std::move(cmakeVariables);
+    probe.CacheKey = std::move(cacheKey);
+    this->Makefile->GetTryCompileBatch(*arguments.Batch)
+      .Probes.emplace_back(std::move(probe));
+    this->Queued = true;
+    return cm::nullopt;
   }
 
+  if (!restored) {
+    bool erroroc = cmSystemTools::GetErrorOccurredFlag();
+    cmSystemTools::ResetErrorOccurredFlag();
+    // actually do the try compile now that everything is setup
+    res = this->Makefile->TryCompile(
+      sourceDirectory, this->BinaryDirectory, projectName, targetName,
+      this->SrcFileSignature, cmake::NO_BUILD_PARALLEL_LEVEL,
+      &arguments.CMakeFlags, output);
+    if (erroroc) {
+      cmSystemTools::SetErrorOccurred();
+    }
+  }
+
+  return this->FinishTryCompile(arguments, sourceDirectory, targetName,
+                                std::move(cmakeVariables), cacheKey,
+                                restored, res, std::move(output));
+}
+
+cm::optional<cmTryCompileResult> cmCoreTryCompile::FinishTryCompile(
+  Arguments const& arguments, std::string const& sourceDirectory,
+  std::string const& targetName,
+  std::map<std::string, std::string> cmakeVariables,
+  std::string const& cacheKey, bool restored, int res, std::string output)
+{
   // set the result var to the return value to indicate success or failure
   if (arguments.NoCache) {
     this->Makefile->AddDefinition(*arguments.CompileResultVariable,
@@ -1268,7 +1375,28 @@ cm::optional<cmTryCompileResult> cmCoreTryCompile::TryCompileCode(
 
   if (this->SrcFileSignature) {
     std::string copyFileErrorMessage;
-    this->FindOutputFile(targetName);
+    if (restored) {
+      this->FindErrorMessage.clear();
+    } else {
+      this->FindOutputFile(targetName);
+    }
+
+#ifndef CMAKE_BOOTSTRAP
+    if (!cacheKey.empty() && !restored &&
+        !cmSystemTools::GetFatalErrorOccurred()) {
+      if (std::unique_ptr<cmTryCompileCache> cache =
+            cmTryCompileCache::Create(*this->Makefile)) {
+        cmTryCompileCache::Result cacheResult;
+        cacheResult.ExitCode = res;
+        cacheResult.Output = output;
+        cacheResult.OutputFile = this->OutputFile;
+        cache->Store(cacheKey, this->BinaryDirectory, targetName,
+                     cacheResult);
+      }
+    }
+#else
+    static_cast<void>(cacheKey);
+#endif
 
     if ((res == 0) && arguments.CopyFileTo) {
       std::string const& copyFile = *arguments.CopyFileTo;
@@ -1324,6 +1452,168 @@ cm::optional<cmTryCompileResult> cmCoreTryCompile::TryCompileCode(
   return cm::optional<cmTryCompileResult>(std::move(result));
 }
 
+std::vector<cmTryCompileResult> cmCoreTryCompile::BuildBatch(
+  std::string const& name)
+{
+  std::vector<cmTryCompileResult> results;
+  std::unique_ptr<cmTryCompileBatch> batch =
+    this->Makefile->TakeTryCompileBatch(name);
+  if (!batch) {
+    return results;
+  }
+
+  // Projects that pass different cache entries to the build system
+  // cannot share one.
+  std::vector<std::pair<std::vector<std::string>, std::vector<BatchProbe*>>>
+    groups;
+  for (BatchProbe& probe : batch->Probes) {
+    std::vector<std::string> flags;
+    std::string var;
+    std::string value;
+    for (std::string const& flag : probe.Args.CMakeFlags) {
+      if (!ParseProjectVariableFlag(flag, var, value)) {
+        flags.push_back(flag);
+      }
+    }
+    auto group = std::find_if(
+      groups.begin(), groups.end(),
+      [&flags](std::pair<std::vector<std::string>,
+                         std::vector<BatchProbe*>> const& g) {
+        return g.first == flags;
+      });
+    if (group == groups.end()) {
+      groups.emplace_back(std::move(flags), std::vector<BatchProbe*>());
+      group = std::prev(groups.end());
+    }
+    group->second.push_back(&probe);
+  }
+
+  for (auto const& group : groups) {
+    this->BuildBatchProbes(group.first, group.second, name, results);
+  }
+  return results;
+}
+
+void cmCoreTryCompile::BuildBatchProbes(
+  std::vector<std::string> const& cmakeFlags,
+  std::vector<BatchProbe*> const& probes, std::string const& name,
+  std::vector<cmTryCompileResult>& results)
+{
+  cmGlobalGenerator* gg = this->Makefile->GetGlobalGenerator();
+  bool const debug = this->Makefile->GetCMakeInstance()->GetDebugTryCompile();
+  std::vector<std::string> const keepGoing = gg->GetKeepGoingBuildOptions();
+  std::vector<int> exitCodes(probes.size(), 1);
+  std::vector<std::string> outputs(probes.size());
+
+  // Generate one project adding the projects of the batch as
+  // subdirectories.  The build has to go on after a project fails to
+  // build to tell which others succeed.  Otherwise, build the projects
+  // one after the other.
+  std::string batchDirectory;
+  if (probes.size() > 1 && !keepGoing.empty()) {
+    batchDirectory =
+      cmStrCat(this->Makefile->GetHomeOutputDirectory(),
+               "/CMakeFiles/CMakeScratch/TryCompileBatch-XXXXXX");
+    cmSystemTools::MakeTempDirectory(batchDirectory);
+
+    std::string const listFile = cmStrCat(batchDirectory, "/CMakeLists.txt");
+    cmsys::ofstream fout(listFile.c_str(), std::ios::out);
+    fout << "cmake_minimum_required(VERSION " << cmVersion::GetMajorVersion()
+         << '.' << cmVersion::GetMinorVersion() << '.'
+         << cmVersion::GetPatchVersion() << '.'
+         << cmVersion::GetTweakVersion()
+         << ")\n"
+            "project(CMAKE_TRY_COMPILE_BATCH NONE)\n"
+            "set(CMAKE_SUPPRESS_REGENERATION 1)\n";
+    for (std::size_t i = 0; i < probes.size(); ++i) {
+      fout << "block()\n";
+      std::string var;
+      std::string value;
+      for (std::string const& flag : probes[i]->Args.CMakeFlags) {
+        if (ParseProjectVariableFlag(flag, var, value)) {
+          fout << "  set(" << var << ' '
+               << cmOutputConverter::EscapeForCMake(value) << ")\n";
+        }
+      }
+      fout << "  add_subdirectory("
+           << cmOutputConverter::EscapeForCMake(probes[i]->BinaryDirectory)
+           << ' ' << i << ")\nendblock()\n";
+    }
+    fout.close();
+    if (!fout) {
+      this->Makefile->IssueMessage(
+        MessageType::FATAL_ERROR,
+        cmStrCat("Failed to write\n  ", listFile, '\n',
+                 cmSystemTools::GetLastSystemError()));
+      return;
+    }
+
+    if (debug) {
+      this->Makefile->IssueMessage(
+        MessageType::LOG,
+        cmStrCat("Executing try_compile batch (", name, ") in:\n  ",
+                 batchDirectory));
+    }
+
+    unsigned int const processors = std::thread::hardware_concurrency();
+    int const jobs = processors > 0 ? static_cast<int>(processors)
+                                    : cmake::DEFAULT_BUILD_PARALLEL_LEVEL;
+    std::string output;
+    bool erroroc = cmSystemTools::GetErrorOccurredFlag();
+    cmSystemTools::ResetErrorOccurredFlag();
+    int const res = this->Makefile->TryCompile(
+      batchDirectory, batchDirectory, "CMAKE_TRY_COMPILE_BATCH", std::string(),
+      true, jobs, &cmakeFlags, output, keepGoing);
+    if (erroroc) {
+      cmSystemTools::SetErrorOccurred();
+    }
+    for (std::size_t i = 0; i < probes.size(); ++i) {
+      exitCodes[i] = res;
+      outputs[i] = output;
+    }
+  } else {
+    for (std::size_t i = 0; i < probes.size(); ++i) {
+      BatchProbe& probe = *probes[i];
+      bool erroroc = cmSystemTools::GetErrorOccurredFlag();
+      cmSystemTools::ResetErrorOccurredFlag();
+      exitCodes[i] = this->Makefile->TryCompile(
+        probe.BinaryDirectory, probe.BinaryDirectory, "CMAKE_TRY_COMPILE",
+        probe.TargetName, true, cmake::NO_BUILD_PARALLEL_LEVEL,
+        &probe.Args.CMakeFlags, outputs[i]);
+      if (erroroc) {
+        cmSystemTools::SetErrorOccurred();
+      }
+    }
+  }
+
+  for (std::size_t i = 0; i < probes.size(); ++i) {
+    BatchProbe& probe = *probes[i];
+    this->BinaryDirectory = probe.BinaryDirectory;
+    this->SrcFileSignature = true;
+    int res = exitCodes[i];
+    if (res != 0 && !batchDirectory.empty()) {
+      // The projects whose file exists built despite the failure of others.
+      this->FindOutputFile(probe.TargetName);
+      if (!this->OutputFile.empty()) {
+        res = 0;
+      }
+    }
+    cm::optional<cmTryCompileResult> result = this->FinishTryCompile(
+      probe.Args, probe.BinaryDirectory, probe.TargetName,
+      std::move(probe.CMakeVariables), probe.CacheKey, false, res,
+      std::move(outputs[i]));
+    if (result && !probe.Args.NoLog) {
+      results.emplace_back(std::move(*result));
+    }
+    if (!debug) {
+      this->CleanupFiles(probe.BinaryDirectory);
+    }
+  }
+  if (!batchDirectory.empty() && !debug) {
+    this->CleanupFiles(batchDirectory);
+  }
+}
+
 bool cmCoreTryCompile::IsTemporary(std::string const& path)
 {
   return ((path.find("CMakeTmp") != std::string::npos) ||
@@ -1391,6 +1681,14 @@ void cmCoreTryCompile::CleanupFiles(std::string const& binDir)
   }
 }
 
+bool cmTryCompileBatch::HasTarget(std::string const& name) const
+{
+  return std::any_of(Probes.begin(), Probes.end(),
+                     [&name](cmCoreTryCompile::BatchProbe const& probe) {
+                       return probe.TargetName == name;
+                     });
+}
+
 void cmCoreTryCompile::FindOutputFile(std::string const& targetName)
 {
   this->FindErrorMessage.clear();
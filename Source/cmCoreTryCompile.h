@@ -98,6 +98,7 @@ public:
     cm::optional<std::string> CopyFileTo;
     cm::optional<std::string> CopyFileError;
     cm::optional<ArgumentParser::NonEmpty<std::string>> LogDescription;
+    cm::optional<ArgumentParser::NonEmpty<std::string>> Batch;
     bool NoCache = false;
     bool NoLog = false;
 
@@ -128,6 +129,31 @@ public:
   cm::optional<cmTryCompileResult> TryCompileCode(
     Arguments& arguments, cmStateEnums::TargetType targetType);
 
+  /**
+   * A project generated by a try_compile call with BATCH.  It is built
+   * later together with the other projects of the same batch.
+   */
+  struct BatchProbe
+  {
+    BatchProbe(Arguments arguments)
+      : Args(std::move(arguments))
+    {
+    }
+
+    Arguments Args;
+    std::string TargetName;
+    std::string BinaryDirectory;
+    std::map<std::string, std::string> CMakeVariables;
+    std::string CacheKey;
+  };
+
+  /**
+   * Builds the projects of a batch and sets the variables of the
+   * try_compile calls that generated them.  Returns the results to be
+   * written to the configure log.
+   */
+  std::vector<cmTryCompileResult> BuildBatch(std::string const& name);
+
   /**
    * Returns \c true if \p path resides within a CMake temporary directory,
    * otherwise returns \c false.
@@ -155,9 +181,22 @@ public:
   std::string OutputFile;
   std::string FindErrorMessage;
   bool SrcFileSignature = false;
+  // Whether TryCompileCode left the project to be built with its batch.
+  bool Queued = false;
   cmMakefile* Makefile;
 
 private:
+  cm::optional<cmTryCompileResult> FinishTryCompile(
+    Arguments const& arguments, std::string const& sourceDirectory,
+    std::string const& targetName,
+    std::map<std::string, std::string> cmakeVariables,
+    std::string const& cacheKey, bool restored, int res, std::string output);
+
+  void BuildBatchProbes(std::vector<std::string> const& cmakeFlags,
+                        std::vector<BatchProbe*> const& probes,
+                        std::string const& name,
+                        std::vector<cmTryCompileResult>& results);
+
   std::string WriteSource(std::string const& name, std::string const& content,
                           char const* command) const;
 
@@ -166,3 +205,12 @@ private:
     cmArgumentParser<Arguments> const& parser,
     std::vector<std::string>& unparsedArguments);
 };
+
+/** The projects generated by try_compile calls with the same BATCH name
+    that wait to be built.  */
+struct cmTryCompileBatch
+{
+  bool HasTarget(std::string const& name) const;
+
+  std::vector<cmCoreTryCompile::BatchProbe> Probes;
+};
@@ -2,7 +2,9 @@
    file LICENSE.rst or https://cmake.org/licensing for details.  */
 #include "cmDefinitions.h"
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
 #include <unordered_set>
 #include <utility>
 
@@ -10,6 +12,65 @@
 
 cmDefinitions::Def cmDefinitions::NoDef;
 
+namespace {
+// Bits of the key filter per key of a scope.
+std::size_t const KeyFilterBitsPerKey = 8;
+
+// Two bits of one filter word selected by a key hash.
+std::uint64_t KeyBits(std::size_t hash)
+{
+  return (std::uint64_t(1) << (hash & 63)) |
+    (std::uint64_t(1) << ((hash >> 6) & 63));
+}
+}
+
+std::size_t cmDefinitions::KeyHash(cm::string_view key)
+{
+  return std::hash<cm::string_view>{}(key);
+}
+
+inline bool cmDefinitions::MayContain(std::size_t hash) const
+{
+  std::uint64_t const bits = KeyBits(hash);
+  std::uint64_t const word = this->LargeKeyFilter.empty()
+    ? this->KeyFilter
+    : this->LargeKeyFilter[(hash >> 12) & (this->LargeKeyFilter.size() - 1)];
+  return (word & bits) == bits;
+}
+
+void cmDefinitions::AddToFilter(std::size_t hash)
+{
+  std::uint64_t& word = this->LargeKeyFilter.empty()
+    ? this->KeyFilter
+    : this->LargeKeyFilter[(hash >> 12) & (this->LargeKeyFilter.size() - 1)];
+  word |= KeyBits(hash);
+}
+
+void cmDefinitions::AddKey(cm::string_view key)
+{
+  std::size_t const bits = this->Map.size() * KeyFilterBitsPerKey;
+  std::size_t words = std::max<std::size_t>(this->LargeKeyFilter.size(), 1);
+  if (words * 64 >= bits) {
+    this->AddToFilter(cmDefinitions::KeyHash(key));
+    return;
+  }
+  // Double the number of filter words and add all keys again.
+  while (words * 64 < bits) {
+    words *= 2;
+  }
+  this->LargeKeyFilter.assign(words, 0);
+  for (auto const& mi : this->Map) {
+    this->AddToFilter(cmDefinitions::KeyHash(mi.first.view()));
+  }
+}
+
+cmDefinitions::Def& cmDefinitions::Emplace(std::string const& key, Def def)
+{
+  Def& result = this->Map.emplace(key, std::move(def)).first->second;
+  this->AddKey(key);
+  return result;
+}
+
 cmDefinitions::Def const& cmDefinitions::GetInternal(std::string const& key,
                                                      StackIter begin,
                                                      StackIter end, bool raise)
@@ -26,11 +87,22 @@ cmDefinitions::Def const& cmDefinitions::GetInternal(std::string const& key,
   if (it == end) {
     return cmDefinitions::NoDef;
   }
-  Def const& def = cmDefinitions::GetInternal(key, it, end, raise);
   if (!raise) {
-    return def;
+    // Look only in the parent scopes whose filter admits the key.
+    std::size_t const hash = cmDefinitions::KeyHash(key);
+    for (; it != end; ++it) {
+      if (!it->MayContain(hash)) {
+        continue;
+      }
+      auto di = it->Map.find(cm::String::borrow(key));
+      if (di != it->Map.end()) {
+        return di->second;
+      }
+    }
+    return cmDefinitions::NoDef;
   }
-  return begin->Map.emplace(key, def).first->second;
+  Def const& def = cmDefinitions::GetInternal(key, it, end, raise);
+  return begin->Emplace(key, def);
 }
 
 cmValue cmDefinitions::Get(std::string const& key, StackIter begin,
@@ -49,8 +121,10 @@ void cmDefinitions::Raise(std::string const& key, StackIter begin,
 bool cmDefinitions::HasKey(std::string const& key, StackIter begin,
                            StackIter end)
 {
+  std::size_t const hash = cmDefinitions::KeyHash(key);
   for (StackIter it = begin; it != end; ++it) {
-    if (it->Map.find(cm::String::borrow(key)) != it->Map.end()) {
+    if (it->MayContain(hash) &&
+        it->Map.find(cm::String::borrow(key)) != it->Map.end()) {
       return true;
     }
   }
@@ -69,6 +143,7 @@ cmDefinitions cmDefinitions::MakeClosure(StackIter begin, StackIter end)
           undefined.find(mi.first.view()) == undefined.end()) {
         if (mi.second.Value) {
           closure.Map.insert(mi);
+          closure.AddKey(mi.first.view());
         } else {
           undefined.emplace(mi.first.view());
         }
@@ -100,9 +175,11 @@ std::vector<std::string> cmDefinitions::ClosureKeys(StackIter begin,
 void cmDefinitions::Set(std::string const& key, cm::string_view value)
 {
   this->Map[key] = Def(value);
+  this->AddKey(key);
 }
 
 void cmDefinitions::Unset(std::string const& key)
 {
   this->Map[key] = Def();
+  this->AddKey(key);
 }
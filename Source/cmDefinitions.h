@@ -4,6 +4,8 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -19,7 +21,10 @@
  *
  * This stores the state of variable definitions (set or unset) for
  * one scope.  Sets are always local.  Gets search parent scopes
- * transitively and save results locally.
+ * transitively.  Each scope keeps a Bloom filter of its keys so that
+ * gets skip the scopes that cannot contain a key.  The filter grows with
+ * the scope to keep at least 8 bits per key, so it rejects most of the
+ * keys a scope does not contain however many keys the scope defines.
  */
 class cmDefinitions
 {
@@ -61,6 +66,17 @@ private:
   static Def NoDef;
 
   std::unordered_map<cm::String, Def> Map;
+  // Filter of the keys while they fit one word, kept inline so that gets
+  // through small scopes do not follow another pointer.
+  std::uint64_t KeyFilter = 0;
+  // Filter of the keys once the scope has outgrown KeyFilter.
+  std::vector<std::uint64_t> LargeKeyFilter;
+
+  static std::size_t KeyHash(cm::string_view key);
+  bool MayContain(std::size_t hash) const;
+  void AddToFilter(std::size_t hash);
+  void AddKey(cm::string_view key);
+  Def& Emplace(std::string const& key, Def def);
 
   static Def const& GetInternal(std::string const& key, StackIter begin,
                                 StackIter end, bool raise);
@@ -2,6 +2,8 @@
    file LICENSE.rst or https://cmake.org/licensing for details.  */
 #include "cmDependsC.h"
 
+#include <iterator>
+#include <sstream>
 #include <utility>
 
 #include "cmsys/FStream.hxx"
@@ -15,6 +17,13 @@
 #include "cmSystemTools.h"
 #include "cmValue.h"
 
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmCryptoHash.h"
+#  include "cmFileLock.h"
+#  include "cmFileLockResult.h"
+#  include "cmGeneratedFileStream.h"
+#endif
+
 #define INCLUDE_REGEX_LINE                                                    \
   "^[ \t]*[#%][ \t]*(include|import)[ \t]*[<\"]([^\">]+)([\">])"
 
@@ -66,11 +75,25 @@ cmDependsC::cmDependsC(cmLocalUnixMakefileGenerator3* lg,
     cmStrCat(this->TargetDirectory, '/', lang, ".includecache");
 
   this->ReadCacheFile();
+
+#ifndef CMAKE_BOOTSTRAP
+  // Share the include lines of scanned files with the other targets in
+  // the build tree that use the same rules to scan them.
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  std::string const rules = hasher.HashString(
+    cmStrCat(this->IncludeRegexLineString, '\n', this->IncludeRegexScanString,
+             '\n', this->IncludeRegexTransformString));
+  this->SharedCacheFileName =
+    cmStrCat(lg->GetBinaryDirectory(), "/CMakeFiles/CMakeScanCache/",
+             rules.substr(0, 16), ".includecache");
+  ReadSharedCacheFile(this->SharedCacheFileName, this->SharedCache);
+#endif
 }
 
 cmDependsC::~cmDependsC()
 {
   this->WriteCacheFile();
+  this->WriteSharedCacheFile();
 }
 
 bool cmDependsC::WriteDependencies(std::set<std::string> const& sources,
@@ -196,7 +219,11 @@ bool cmDependsC::WriteDependencies(std::set<std::string> const& sources,
               // Scan this file for new dependencies.  Pass the directory
               // containing the file to handle double-quote includes.
               std::string dir = cmSystemTools::GetFilenamePath(fullName);
-              this->Scan(fin, dir, fullName);
+              if (this->SharedCacheFileName.empty()) {
+                this->Scan(fin, dir, fullName);
+              } else {
+                this->ScanShared(fin, dir, fullName);
+              }
             } else {
               // Skip file with encoding we do not implement.
             }
@@ -340,6 +367,124 @@ void cmDependsC::WriteCacheFile() const
   }
 }
 
+void cmDependsC::ScanShared(std::istream& is, std::string const& directory,
+                            std::string const& fullName)
+{
+#ifndef CMAKE_BOOTSTRAP
+  // Look up the include lines by the hash of the content, so that a file
+  // is scanned again only when its content changes, and the same content
+  // is scanned once for all targets.
+  std::string const content((std::istreambuf_iterator<char>(is)),
+                            std::istreambuf_iterator<char>());
+  std::string const hash =
+    cmCryptoHash(cmCryptoHash::AlgoSHA256).HashString(content);
+  auto const sharedIt = this->SharedCache.find(hash);
+  if (sharedIt == this->SharedCache.end()) {
+    std::istringstream contentStream(content);
+    this->Scan(contentStream, directory, fullName);
+    std::vector<cmSharedInclude> includes;
+    for (UnscannedEntry const& inc :
+         this->FileCache[fullName].UnscannedEntries) {
+      includes.push_back({ inc.FileName, !inc.QuotedLocation.empty() });
+    }
+    this->SharedCacheAdditions[hash] = includes;
+    this->SharedCache[hash] = std::move(includes);
+    return;
+  }
+
+  cmIncludeLines& newCacheEntry = this->FileCache[fullName];
+  newCacheEntry.Used = true;
+  for (cmSharedInclude const& inc : sharedIt->second) {
+    UnscannedEntry entry;
+    entry.FileName = inc.FileName;
+    if (inc.Quoted) {
+      entry.QuotedLocation =
+        cmSystemTools::CollapseFullPath(entry.FileName, directory);
+    }
+    newCacheEntry.UnscannedEntries.push_back(entry);
+    if (this->Encountered.find(entry.FileName) == this->Encountered.end()) {
+      this->Encountered.insert(entry.FileName);
+      this->Unscanned.push(std::move(entry));
+    }
+  }
+#else
+  this->Scan(is, directory, fullName);
+#endif
+}
+
+void cmDependsC::ReadSharedCacheFile(std::string const& fileName,
+                                     SharedCacheType& cache)
+{
+  cmsys::ifstream fin(fileName.c_str());
+  if (!fin) {
+    return;
+  }
+
+  // Each entry is the hash of the content of a scanned file, and pairs of
+  // lines for the files it includes and whether they are relative
+  // double-quote includes, followed by an empty line.
+  std::string line;
+  std::string quoted;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::vector<cmSharedInclude>& includes = cache[line];
+    includes.clear();
+    cmSharedInclude inc;
+    while (cmSystemTools::GetLineFromStream(fin, inc.FileName) &&
+           !inc.FileName.empty() &&
+           cmSystemTools::GetLineFromStream(fin, quoted)) {
+      inc.Quoted = quoted == "\"";
+      includes.push_back(inc);
+    }
+  }
+}
+
+void cmDependsC::WriteSharedCacheFile() const
+{
+#ifndef CMAKE_BOOTSTRAP
+  if (this->SharedCacheAdditions.empty()) {
+    return;
+  }
+
+  // Serialize the processes updating the cache, for example those of
+  // a parallel build.  The cache file is replaced atomically, so
+  // readers do not need the lock.
+  cmSystemTools::MakeDirectory(
+    cmSystemTools::GetFilenamePath(this->SharedCacheFileName));
+  std::string const lockName = cmStrCat(this->SharedCacheFileName, ".lock");
+  if (!cmSystemTools::Touch(lockName, true)) {
+    return;
+  }
+  cmFileLock lock;
+  if (!lock.Lock(lockName, 10).IsOk()) {
+    return;
+  }
+
+  // Merge the files scanned here with those other processes scanned
+  // since the cache was read.
+  SharedCacheType cache;
+  ReadSharedCacheFile(this->SharedCacheFileName, cache);
+  for (auto const& addition : this->SharedCacheAdditions) {
+    cache[addition.first] = addition.second;
+  }
+
+  cmGeneratedFileStream cacheOut(this->SharedCacheFileName);
+  cacheOut << "# CMake include scan cache for:\n"
+           << "# " << this->IncludeRegexLineString << "\n"
+           << "# " << this->IncludeRegexScanString << "\n"
+           << "# " << this->IncludeRegexTransformString << "\n\n";
+  for (auto const& entry : cache) {
+    cacheOut << entry.first << '\n';
+    for (cmSharedInclude const& inc : entry.second) {
+      cacheOut << inc.FileName << '\n' << (inc.Quoted ? '"' : '-') << '\n';
+    }
+    cacheOut << '\n';
+  }
+#endif
+}
+
 void cmDependsC::Scan(std::istream& is, std::string const& directory,
                       std::string const& fullName)
 {
@@ -91,4 +91,25 @@ protected:
 
   void WriteCacheFile() const;
   void ReadCacheFile();
+
+  // Include lines of files scanned by any target in the build tree with
+  // the same scanning rules, by the hash of the file content.  Relative
+  // double-quote includes are resolved against the directory of each
+  // file with that content.
+  struct cmSharedInclude
+  {
+    std::string FileName;
+    bool Quoted = false;
+  };
+  using SharedCacheType =
+    std::map<std::string, std::vector<cmSharedInclude>>;
+  SharedCacheType SharedCache;
+  SharedCacheType SharedCacheAdditions;
+  std::string SharedCacheFileName;
+
+  void ScanShared(std::istream& is, std::string const& directory,
+                  std::string const& fullName);
+  static void ReadSharedCacheFile(std::string const& fileName,
+                                  SharedCacheType& cache);
+  void WriteSharedCacheFile() const;
 };
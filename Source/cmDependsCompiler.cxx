@@ -4,8 +4,12 @@
 #include "cmDependsCompiler.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
@@ -14,6 +18,11 @@
 #include <cm/vector>
 #include <cmext/string_view>
 
+#ifndef CMAKE_BOOTSTRAP
+#  include <atomic>
+#  include <thread>
+#endif
+
 #include "cmsys/FStream.hxx"
 
 #include "cmFileTime.h"
@@ -24,169 +33,379 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
-bool cmDependsCompiler::CheckDependencies(
-  std::string const& internalDepFile, std::vector<std::string> const& depFiles,
-  cmDepends::DependencyMap& dependencies,
+namespace {
+// The internal dependencies file is a binary index which stores each path
+// once and refers to it by number: the objects of a target mostly share the
+// same headers.  Layout, using native 32-bit unsigned integers:
+//   magic, version,
+//   path count, { path length, path bytes }...,
+//   depender count, { depender path, dependee count, dependee paths... }...
+char const IndexMagic[8] = { 'C', 'M', 'D', 'E', 'P', 'I', 'D', 'X' };
+std::uint32_t const IndexVersion = 1;
+
+#ifndef CMAKE_BOOTSTRAP
+// Do not spawn a thread for fewer dependencies files than this.
+std::size_t const MinDepFilesPerThread = 8;
+#endif
+
+using DependencyList =
+  std::vector<std::pair<std::string, std::vector<std::string>>>;
+
+struct DepFileInfo
+{
+  std::string const* Source = nullptr;
+  std::string const* Target = nullptr;
+  std::string const* Format = nullptr;
+  std::string const* DepFile = nullptr;
+  bool Changed = false;
+  DependencyList Dependencies;
+};
+
+void AppendIndexInteger(std::string& buffer, std::uint32_t value)
+{
+  char bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  buffer.append(bytes, sizeof(value));
+}
+
+class IndexReader
+{
+public:
+  IndexReader(cm::string_view data)
+    : Data(data)
+  {
+  }
+
+  bool ReadMagic()
+  {
+    if (this->Data.substr(0, sizeof(IndexMagic)) !=
+        cm::string_view(IndexMagic, sizeof(IndexMagic))) {
+      return false;
+    }
+    this->Position = sizeof(IndexMagic);
+    std::uint32_t version;
+    return this->ReadInteger(version) && version == IndexVersion;
+  }
+
+  bool ReadInteger(std::uint32_t& value)
+  {
+    if (this->Data.size() - this->Position < sizeof(value)) {
+      return false;
+    }
+    std::memcpy(&value, this->Data.data() + this->Position, sizeof(value));
+    this->Position += sizeof(value);
+    return true;
+  }
+
+  // Checks that the rest of the data can hold count items of at least
+  // the given size each, before they are allocated.
+  bool CanHold(std::uint32_t count, std::size_t size) const
+  {
+    return (this->Data.size() - this->Position) / size >= count;
+  }
+
+  bool ReadString(std::string& value)
+  {
+    std::uint32_t length;
+    if (!this->ReadInteger(length) ||
+        this->Data.size() - this->Position < length) {
+      return false;
+    }
+    value.assign(this->Data.data() + this->Position, length);
+    this->Position += length;
+    return true;
+  }
+
+private:
+  cm::string_view Data;
+  std::size_t Position = 0;
+};
+
+bool ReadIndex(std::string const& indexFile,
+               cmDepends::DependencyMap& dependencies)
+{
+  std::string content;
+  {
+    cmsys::ifstream fin(indexFile.c_str(), std::ios::in | std::ios::binary);
+    if (!fin) {
+      return false;
+    }
+    fin.seekg(0, std::ios::end);
+    content.resize(static_cast<std::size_t>(fin.tellg()));
+    fin.seekg(0, std::ios::beg);
+    if (!fin.read(&content[0], content.size())) {
+      return false;
+    }
+  }
+
+  IndexReader reader(content);
+  std::uint32_t pathCount;
+  if (!reader.ReadMagic() || !reader.ReadInteger(pathCount) ||
+      !reader.CanHold(pathCount, sizeof(std::uint32_t))) {
+    return false;
+  }
+  std::vector<std::string> paths(pathCount);
+  for (auto& path : paths) {
+    if (!reader.ReadString(path)) {
+      return false;
+    }
+  }
+  auto readPath = [&reader, &paths](std::string const*& path) -> bool {
+    std::uint32_t id;
+    if (!reader.ReadInteger(id) || id >= paths.size()) {
+      return false;
+    }
+    path = &paths[id];
+    return true;
+  };
+
+  std::uint32_t dependerCount;
+  if (!reader.ReadInteger(dependerCount)) {
+    return false;
+  }
+  for (std::uint32_t i = 0; i < dependerCount; ++i) {
+    std::string const* depender;
+    std::uint32_t dependeeCount;
+    if (!readPath(depender) || !reader.ReadInteger(dependeeCount) ||
+        !reader.CanHold(dependeeCount, sizeof(std::uint32_t))) {
+      return false;
+    }
+    auto& depends = dependencies[*depender];
+    depends.clear();
+    depends.reserve(dependeeCount);
+    for (std::uint32_t j = 0; j < dependeeCount; ++j) {
+      std::string const* dependee;
+      if (!readPath(dependee)) {
+        return false;
+      }
+      depends.push_back(*dependee);
+    }
+  }
+  return true;
+}
+
+DependencyList ParseDepFile(
+  DepFileInfo const& info, std::string const& binaryDir,
   std::function<bool(std::string const&)> const& isValidPath)
 {
-  bool status = true;
-  bool forceReadDeps = true;
+  auto const& source = *info.Source;
+  auto const& target = *info.Target;
+  auto const& format = *info.Format;
+  auto const& depFile = *info.DepFile;
 
-  cmFileTime internalDepFileTime;
-  // read cached dependencies stored in internal file
-  if (cmSystemTools::FileExists(internalDepFile)) {
-    internalDepFileTime.Load(internalDepFile);
-    forceReadDeps = false;
-
-    // read current dependencies
-    cmsys::ifstream fin(internalDepFile.c_str());
-    if (fin) {
-      std::string line;
-      std::string depender;
-      std::vector<std::string>* currentDependencies = nullptr;
-      while (std::getline(fin, line)) {
-        if (line.empty() || line.front() == '#') {
-          continue;
-        }
-        // Drop carriage return character at the end
-        if (line.back() == '\r') {
-          line.pop_back();
-          if (line.empty()) {
-            continue;
-          }
-        }
-        // Check if this a depender line
-        if (line.front() != ' ') {
-          depender = std::move(line);
-          currentDependencies = &dependencies[depender];
-          continue;
-        }
-        // This is a dependee line
-        if (currentDependencies) {
-          currentDependencies->emplace_back(line.substr(1));
+  DependencyList dependencies;
+  std::vector<std::string> depends;
+  if (format == "custom"_s) {
+    auto deps = cmReadGccDepfile(depFile.c_str(), binaryDir);
+    if (!deps) {
+      return dependencies;
+    }
+
+    for (auto& entry : *deps) {
+      depends = std::move(entry.paths);
+      if (isValidPath) {
+        cm::erase_if(depends, isValidPath);
+      }
+      // copy depends for each target, except first one, which can be
+      // moved
+      for (auto index = entry.rules.size() - 1; index > 0; --index) {
+        dependencies.emplace_back(entry.rules[index], depends);
+      }
+      dependencies.emplace_back(entry.rules.front(), std::move(depends));
+    }
+    return dependencies;
+  }
+
+  if (format == "msvc"_s) {
+    cmsys::ifstream fin(depFile.c_str());
+    if (!fin) {
+      return dependencies;
+    }
+
+    std::string line;
+    if (!isValidPath && !source.empty()) {
+      // insert source as first dependency
+      depends.push_back(source);
+    }
+    while (cmSystemTools::GetLineFromStream(fin, line)) {
+      depends.emplace_back(std::move(line));
+    }
+  } else if (format == "gcc"_s) {
+    auto deps = cmReadGccDepfile(depFile.c_str(), binaryDir,
+                                 GccDepfilePrependPaths::Deps);
+    if (!deps) {
+      return dependencies;
+    }
+
+    // dependencies generated by the compiler contains only one target
+    depends = std::move(deps->front().paths);
+    if (depends.empty()) {
+      // unexpectedly empty, ignore it and continue
+      return dependencies;
+    }
+
+    // depending of the effective format of the dependencies file
+    // generated by the compiler, the target can be wrongly identified
+    // as a dependency so remove it from the list
+    if (depends.front() == target) {
+      depends.erase(depends.begin());
+    }
+
+    // ensure source file is the first dependency
+    if (!source.empty()) {
+      if (depends.front() != source) {
+        cm::erase(depends, source);
+        if (!isValidPath) {
+          depends.insert(depends.begin(), source);
         }
+      } else if (isValidPath) {
+        // remove first dependency because it must not be filtered out
+        depends.erase(depends.begin());
       }
-      fin.close();
     }
+  } else {
+    // unknown format, ignore it
+    return dependencies;
   }
 
-  // Now, update dependencies map with all new compiler generated
-  // dependencies files
+  if (isValidPath) {
+    cm::erase_if(depends, isValidPath);
+    if (!source.empty()) {
+      // insert source as first dependency
+      depends.insert(depends.begin(), source);
+    }
+  }
+
+  dependencies.emplace_back(target, std::move(depends));
+  return dependencies;
+}
+
+void ParseDepFiles(std::vector<DepFileInfo>& infos,
+                   std::string const& binaryDir,
+                   std::function<bool(std::string const&)> const& isValidPath)
+{
+  auto parse = [&](DepFileInfo& info) {
+    info.Dependencies = ParseDepFile(info, binaryDir, isValidPath);
+  };
+
+#ifndef CMAKE_BOOTSTRAP
+  // The files are independent of each other, so a large batch, e.g. after
+  // a full build of a big target, is spread over several threads.
+  std::size_t const threadCount =
+    std::min<std::size_t>(std::thread::hardware_concurrency(),
+                          infos.size() / MinDepFilesPerThread);
+  if (threadCount > 1) {
+    std::atomic<std::size_t> next(0);
+    auto work = [&]() {
+      for (std::size_t i = next++; i < infos.size(); i = next++) {
+        parse(infos[i]);
+      }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (std::size_t i = 1; i < threadCount; ++i) {
+      threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    return;
+  }
+#endif
+
+  for (auto& info : infos) {
+    parse(info);
+  }
+}
+}
+
+bool cmDependsCompiler::CheckDependencies(
+  std::string const& internalDepFile, std::vector<std::string> const& depFiles,
+  cmDepends::DependencyMap& dependencies,
+  std::function<bool(std::string const&)> const& isValidPath)
+{
+  return this->CollectDependencies(internalDepFile, depFiles, dependencies,
+                                   isValidPath, false);
+}
+
+void cmDependsCompiler::ReadDependencies(
+  std::string const& internalDepFile, std::vector<std::string> const& depFiles,
+  cmDepends::DependencyMap& dependencies)
+{
+  this->CollectDependencies(internalDepFile, depFiles, dependencies,
+                            std::function<bool(std::string const&)>(), true);
+}
+
+bool cmDependsCompiler::CollectDependencies(
+  std::string const& internalDepFile, std::vector<std::string> const& depFiles,
+  cmDepends::DependencyMap& dependencies,
+  std::function<bool(std::string const&)> const& isValidPath,
+  bool readUnchanged)
+{
+  cmFileTime internalDepFileTime;
+  bool const haveIndex = internalDepFileTime.Load(internalDepFile);
+
+  // Look for compiler generated dependencies files newer than the
+  // consolidated dependencies.  This only needs the modification times,
+  // so nothing is read when all files are up to date.
+  std::vector<DepFileInfo> depFileInfos;
+  bool changed = false;
   cmFileTime depFileTime;
   for (auto dep = depFiles.begin(); dep != depFiles.end(); dep++) {
-    auto const& source = *dep++;
-    auto const& target = *dep++;
-    auto const& format = *dep++;
-    auto const& depFile = *dep;
+    DepFileInfo info;
+    info.Source = &*dep++;
+    info.Target = &*dep++;
+    info.Format = &*dep++;
+    info.DepFile = &*dep;
 
-    if (!cmSystemTools::FileExists(depFile)) {
+    if (!depFileTime.Load(*info.DepFile)) {
       continue;
     }
-
-    if (!forceReadDeps) {
-      depFileTime.Load(depFile);
-    }
-    if (forceReadDeps || depFileTime.Compare(internalDepFileTime) >= 0) {
-      status = false;
+    if (!haveIndex || depFileTime.Compare(internalDepFileTime) >= 0) {
+      info.Changed = true;
+      changed = true;
       if (this->Verbose) {
-        cmSystemTools::Stdout(cmStrCat("Dependencies file \"", depFile,
+        cmSystemTools::Stdout(cmStrCat("Dependencies file \"", *info.DepFile,
                                        "\" is newer than depends file \"",
                                        internalDepFile, "\".\n"));
       }
+    }
+    depFileInfos.push_back(std::move(info));
+  }
+  if (!changed && !readUnchanged) {
+    return true;
+  }
 
-      std::vector<std::string> depends;
-      if (format == "custom"_s) {
-        auto deps = cmReadGccDepfile(
-          depFile.c_str(), this->LocalGenerator->GetCurrentBinaryDirectory());
-        if (!deps) {
-          continue;
-        }
-
-        for (auto& entry : *deps) {
-          depends = std::move(entry.paths);
-          if (isValidPath) {
-            cm::erase_if(depends, isValidPath);
-          }
-          // copy depends for each target, except first one, which can be
-          // moved
-          for (auto index = entry.rules.size() - 1; index > 0; --index) {
-            dependencies[entry.rules[index]] = depends;
-          }
-          dependencies[entry.rules.front()] = std::move(depends);
-        }
-      } else {
-        if (format == "msvc"_s) {
-          cmsys::ifstream fin(depFile.c_str());
-          if (!fin) {
-            continue;
-          }
-
-          std::string line;
-          if (!isValidPath && !source.empty()) {
-            // insert source as first dependency
-            depends.push_back(source);
-          }
-          while (cmSystemTools::GetLineFromStream(fin, line)) {
-            depends.emplace_back(std::move(line));
-          }
-        } else if (format == "gcc"_s) {
-          auto deps = cmReadGccDepfile(
-            depFile.c_str(), this->LocalGenerator->GetCurrentBinaryDirectory(),
-            GccDepfilePrependPaths::Deps);
-          if (!deps) {
-            continue;
-          }
-
-          // dependencies generated by the compiler contains only one target
-          depends = std::move(deps->front().paths);
-          if (depends.empty()) {
-            // unexpectedly empty, ignore it and continue
-            continue;
-          }
-
-          // depending of the effective format of the dependencies file
-          // generated by the compiler, the target can be wrongly identified
-          // as a dependency so remove it from the list
-          if (depends.front() == target) {
-            depends.erase(depends.begin());
-          }
-
-          // ensure source file is the first dependency
-          if (!source.empty()) {
-            if (depends.front() != source) {
-              cm::erase(depends, source);
-              if (!isValidPath) {
-                depends.insert(depends.begin(), source);
-              }
-            } else if (isValidPath) {
-              // remove first dependency because it must not be filtered out
-              depends.erase(depends.begin());
-            }
-          }
-        } else {
-          // unknown format, ignore it
-          continue;
-        }
-
-        if (isValidPath) {
-          cm::erase_if(depends, isValidPath);
-          if (!source.empty()) {
-            // insert source as first dependency
-            depends.insert(depends.begin(), source);
-          }
-        }
+  // read cached dependencies stored in internal file.  If it cannot be
+  // used, e.g. it has been written by an older version, read all
+  // dependencies files again.
+  if (!haveIndex || !ReadIndex(internalDepFile, dependencies)) {
+    dependencies.clear();
+    for (auto& info : depFileInfos) {
+      info.Changed = true;
+    }
+  }
 
-        dependencies[target] = std::move(depends);
-      }
+  // Now, update dependencies map with all new compiler generated
+  // dependencies files
+  cm::erase_if(depFileInfos,
+               [](DepFileInfo const& info) { return !info.Changed; });
+  ParseDepFiles(depFileInfos,
+                this->LocalGenerator->GetCurrentBinaryDirectory(),
+                isValidPath);
+  for (auto& info : depFileInfos) {
+    for (auto& entry : info.Dependencies) {
+      dependencies[entry.first] = std::move(entry.second);
     }
   }
 
-  return status;
+  return !changed;
 }
 
-void cmDependsCompiler::WriteDependencies(
+bool cmDependsCompiler::WriteDependencies(
   cmDepends::DependencyMap const& dependencies, std::ostream& makeDepends,
-  std::ostream& internalDepends)
+  std::string const& internalDepFile)
 {
   // dependencies file consumed by make tool
   auto const& lineContinue = static_cast<cmGlobalUnixMakefileGenerator3*>(
@@ -195,25 +414,34 @@ void cmDependsCompiler::WriteDependencies(
   bool supportLongLineDepend = static_cast<cmGlobalUnixMakefileGenerator3*>(
                                  this->LocalGenerator->GetGlobalGenerator())
                                  ->SupportsLongLineDependencies();
-  cmDepends::DependencyMap makeDependencies(dependencies);
   std::unordered_set<cm::string_view> phonyTargets;
 
+  // Objects of a target mostly share the same headers, so convert each
+  // path only once.
+  std::unordered_map<std::string, std::string> makefilePaths;
+  auto makefilePath =
+    [this, &makefilePaths](std::string const& path) -> std::string const& {
+    auto it = makefilePaths.find(path);
+    if (it == makefilePaths.end()) {
+      it = makefilePaths
+             .emplace(path,
+                      this->LocalGenerator->ConvertToMakefilePath(
+                        this->LocalGenerator->MaybeRelativeToTopBinDir(path)))
+             .first;
+    }
+    return it->second;
+  };
+
   // external dependencies file
-  for (auto& node : makeDependencies) {
-    auto target = this->LocalGenerator->ConvertToMakefilePath(
-      this->LocalGenerator->MaybeRelativeToTopBinDir(node.first));
-    auto& deps = node.second;
-    std::transform(deps.cbegin(), deps.cend(), deps.begin(),
-                   [this](std::string const& dep) {
-                     return this->LocalGenerator->ConvertToMakefilePath(
-                       this->LocalGenerator->MaybeRelativeToTopBinDir(dep));
-                   });
+  for (auto const& node : dependencies) {
+    auto const& target = makefilePath(node.first);
 
     bool first_dep = true;
     if (supportLongLineDepend) {
       makeDepends << target << ": ";
     }
-    for (auto const& dep : deps) {
+    for (auto const& path : node.second) {
+      auto const& dep = makefilePath(path);
       if (supportLongLineDepend) {
         if (first_dep) {
           first_dep = false;
@@ -222,27 +450,56 @@ void cmDependsCompiler::WriteDependencies(
           makeDepends << ' ' << lineContinue << "  " << dep;
         }
       } else {
-        makeDepends << target << ": " << dep << std::endl;
+        makeDepends << target << ": " << dep << '\n';
       }
 
       phonyTargets.emplace(dep.data(), dep.length());
     }
-    makeDepends << std::endl << std::endl;
+    makeDepends << "\n\n";
   }
 
   // add phony targets
   for (auto const& target : phonyTargets) {
-    makeDepends << std::endl << target << ':' << std::endl;
+    makeDepends << '\n' << target << ":\n";
   }
 
   // internal dependencies file
+  std::vector<cm::string_view> paths;
+  std::unordered_map<cm::string_view, std::uint32_t> pathIds;
+  auto pathId = [&paths, &pathIds](std::string const& path) {
+    auto const inserted = pathIds.emplace(
+      path, static_cast<std::uint32_t>(paths.size()));
+    if (inserted.second) {
+      paths.emplace_back(path);
+    }
+    return inserted.first->second;
+  };
+  std::vector<std::uint32_t> nodes;
   for (auto const& node : dependencies) {
-    internalDepends << node.first << std::endl;
+    nodes.push_back(pathId(node.first));
+    nodes.push_back(static_cast<std::uint32_t>(node.second.size()));
     for (auto const& dep : node.second) {
-      internalDepends << ' ' << dep << std::endl;
+      nodes.push_back(pathId(dep));
     }
-    internalDepends << std::endl;
   }
+
+  std::string index(IndexMagic, sizeof(IndexMagic));
+  AppendIndexInteger(index, IndexVersion);
+  AppendIndexInteger(index, static_cast<std::uint32_t>(paths.size()));
+  for (auto const& path : paths) {
+    AppendIndexInteger(index, static_cast<std::uint32_t>(path.size()));
+    index.append(path.data(), path.size());
+  }
+  AppendIndexInteger(index, static_cast<std::uint32_t>(dependencies.size()));
+  for (auto const value : nodes) {
+    AppendIndexInteger(index, value);
+  }
+
+  // This is not copy-if-different because dependencies are re-scanned when
+  // it is older than the compiler generated dependencies files.
+  cmsys::ofstream fout(internalDepFile.c_str(),
+                       std::ios::out | std::ios::binary);
+  return fout && fout.write(index.data(), index.size());
 }
 
 void cmDependsCompiler::ClearDependencies(
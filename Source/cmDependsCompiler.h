@@ -46,15 +46,31 @@ public:
     cmDepends::DependencyMap& dependencies,
     std::function<bool(std::string const&)> const& isValidPath);
 
-  /** Write dependencies for the target file.  */
-  void WriteDependencies(cmDepends::DependencyMap const& dependencies,
+  /** Read all dependencies for the target file, both those already
+      consolidated in the internal file and those of the compiler
+      generated dependencies files newer than it.  Nothing is written.  */
+  void ReadDependencies(std::string const& internalDepFile,
+                        std::vector<std::string> const& depFiles,
+                        cmDepends::DependencyMap& dependencies);
+
+  /** Write dependencies for the target file and the index of the
+      consolidated dependencies read back by CheckDependencies.
+      Return false if the index could not be written.  */
+  bool WriteDependencies(cmDepends::DependencyMap const& dependencies,
                          std::ostream& makeDepends,
-                         std::ostream& internalDepends);
+                         std::string const& internalDepFile);
 
   /** Clear dependencies for the target so they will be regenerated.  */
   void ClearDependencies(std::vector<std::string> const& depFiles);
 
 private:
+  bool CollectDependencies(
+    std::string const& internalDepFile,
+    std::vector<std::string> const& depFiles,
+    cmDepends::DependencyMap& dependencies,
+    std::function<bool(std::string const&)> const& isValidPath,
+    bool readUnchanged);
+
   bool Verbose = false;
   cmLocalUnixMakefileGenerator3* LocalGenerator = nullptr;
 };
@@ -9,6 +9,9 @@
 #include "cmGeneratorTarget.h"
 #include "cmLinkItem.h"
 #include "cmList.h"
+#include "cmLocalGenerator.h"
+#include "cmStringAlgorithms.h"
+#include "cmake.h"
 
 struct cmGeneratorExpressionDAGChecker;
 
@@ -109,3 +112,21 @@ void AddInterfaceEntries(cmGeneratorTarget const* headTarget,
     }
   }
 }
+
+#if !defined(CMAKE_BOOTSTRAP)
+cm::optional<cmMakefileProfilingData::RAII> ProfileTargetPropertyEvaluation(
+  cmGeneratorTarget const* target, std::string const& prop,
+  std::string const& config, std::string const& lang)
+{
+  return target->GetLocalGenerator()->GetCMakeInstance()->CreateProfilingEntry(
+    "usage_requirements", cmStrCat(target->GetName(), ' ', prop),
+    [&config, &lang]() -> Json::Value {
+      Json::Value args = Json::objectValue;
+      args["config"] = config;
+      if (!lang.empty()) {
+        args["language"] = lang;
+      }
+      return args;
+    });
+}
+#endif
@@ -2,13 +2,21 @@
    file LICENSE.rst or https://cmake.org/licensing for details.  */
 #pragma once
 
+#include "cmConfigure.h" // IWYU pragma: keep
+
 #include <memory>
 #include <string>
 #include <vector>
 
+#include <cm/optional>
+
 #include "cmGeneratorTarget.h"
 #include "cmListFileCache.h"
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include "cmMakefileProfilingData.h"
+#endif
+
 class cmLinkImplItem;
 struct cmGeneratorExpressionDAGChecker;
 
@@ -77,3 +85,11 @@ void AddInterfaceEntries(
   EvaluatedTargetPropertyEntries& entries,
   IncludeRuntimeInterface searchRuntime,
   cmGeneratorTarget::UseTo usage = cmGeneratorTarget::UseTo::Compile);
+
+#if !defined(CMAKE_BOOTSTRAP)
+// Record the computation of a usage requirement of a target in the
+// profiling output, if enabled.
+cm::optional<cmMakefileProfilingData::RAII> ProfileTargetPropertyEvaluation(
+  cmGeneratorTarget const* target, std::string const& prop,
+  std::string const& config, std::string const& lang);
+#endif
@@ -0,0 +1,302 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmFileSystemCache.h"
+
+#include <chrono>
+#include <ratio>
+#include <utility>
+
+#include "cmsys/Directory.hxx"
+
+#include "cmStringAlgorithms.h"
+
+namespace {
+
+// Directories changed less than this long ago are listed again by the
+// next search because a change within the granularity of the file system
+// time stamps would go unnoticed.  FAT file systems store modification
+// times with a granularity of two seconds.
+cmFileTime::TimeType const RacyInterval = 2 * cmFileTime::UtPerS;
+
+cmFileTime::TimeType CurrentFileTime()
+{
+  auto const sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+#if !defined(_WIN32) || defined(__CYGWIN__)
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch)
+    .count();
+#else
+  // Windows file times count 100 nanosecond intervals since 1601.
+  using FileTimeDuration =
+    std::chrono::duration<cmFileTime::TimeType, std::ratio<1, 10000000>>;
+  return std::chrono::duration_cast<FileTimeDuration>(sinceEpoch).count() +
+    116444736000000000LL;
+#endif
+}
+
+std::string DirectoryKey(std::string const& dir)
+{
+  std::string::size_type const end = dir.find_last_not_of('/');
+  if (end == std::string::npos) {
+    return "/";
+  }
+  std::string key = dir.substr(0, end + 1);
+#if defined(_WIN32)
+  if (key.size() == 2 && key[1] == ':') {
+    key += '/';
+  }
+#endif
+  return key;
+}
+
+std::string RemoveTrailingSlashes(std::string const& path)
+{
+  std::string::size_type const end = path.find_last_not_of('/');
+  if (end == std::string::npos || end + 1 == path.size()) {
+    return path;
+  }
+#if defined(_WIN32)
+  if (end == 1 && path[1] == ':') {
+    return path.substr(0, 3);
+  }
+#endif
+  return path.substr(0, end + 1);
+}
+}
+
+cmFileSystemCache::cmFileSystemCache() = default;
+
+cmFileSystemCache::~cmFileSystemCache() = default;
+
+void cmFileSystemCache::Revalidate()
+{
+  ++this->Epoch;
+}
+
+void cmFileSystemCache::Clear()
+{
+  this->Directories.clear();
+  this->Stats = Statistics();
+}
+
+std::vector<std::string> const& cmFileSystemCache::GetDirectoryEntries(
+  std::string const& dir)
+{
+  if (!cmSystemTools::FileIsFullPath(dir)) {
+    // Relative paths depend on the working directory.  Do not cache them.
+    this->UncachedNames.clear();
+    ++this->Stats.SystemCalls;
+    cmsys::Directory listing;
+    if (listing.Load(dir)) {
+      for (unsigned long i = 0; i < listing.GetNumberOfFiles(); ++i) {
+        std::string const& name = listing.GetFileName(i);
+        if (name != "." && name != "..") {
+          this->UncachedNames.push_back(name);
+        }
+      }
+    }
+    return this->UncachedNames;
+  }
+  bool loaded = false;
+  Directory& d = this->GetDirectory(DirectoryKey(dir), &loaded);
+  if (!loaded) {
+    ++this->Stats.SavedSystemCalls;
+  }
+  return d.Names;
+}
+
+bool cmFileSystemCache::FileExists(std::string const& file)
+{
+  Entry* entry = nullptr;
+  if (!this->LookupEntry(file, entry)) {
+    ++this->Stats.SystemCalls;
+    return cmSystemTools::FileExists(file);
+  }
+  if (!entry) {
+    ++this->Stats.SavedSystemCalls;
+    return false;
+  }
+  if (entry->Exists == Answer::Unknown) {
+    ++this->Stats.SystemCalls;
+    entry->Exists = cmSystemTools::FileExists(file) ? Answer::Yes : Answer::No;
+  } else {
+    ++this->Stats.SavedSystemCalls;
+  }
+  return entry->Exists == Answer::Yes;
+}
+
+bool cmFileSystemCache::FileExists(std::string const& file, bool isFile)
+{
+  if (this->FileExists(file)) {
+    return !isFile || !this->FileIsDirectory(file);
+  }
+  return false;
+}
+
+bool cmFileSystemCache::FileIsDirectory(std::string const& path)
+{
+  std::string const name = RemoveTrailingSlashes(path);
+  Entry* entry = nullptr;
+  if (!this->LookupEntry(name, entry)) {
+    ++this->Stats.SystemCalls;
+    return cmSystemTools::FileIsDirectory(name);
+  }
+  if (!entry) {
+    ++this->Stats.SavedSystemCalls;
+    return false;
+  }
+  if (entry->IsDirectory == Answer::Unknown) {
+    ++this->Stats.SystemCalls;
+    entry->IsDirectory =
+      cmSystemTools::FileIsDirectory(name) ? Answer::Yes : Answer::No;
+  } else {
+    ++this->Stats.SavedSystemCalls;
+  }
+  return entry->IsDirectory == Answer::Yes;
+}
+
+bool cmFileSystemCache::FileMayExist(std::string const& file)
+{
+  Entry* entry = nullptr;
+  if (this->LookupEntry(file, entry) && !entry) {
+    ++this->Stats.SavedSystemCalls;
+    return false;
+  }
+  return true;
+}
+
+cm::optional<cmSystemTools::DirCase> cmFileSystemCache::GetDirCase(
+  std::string const& dir)
+{
+  if (!cmSystemTools::FileIsFullPath(dir)) {
+    ++this->Stats.SystemCalls;
+    return cmSystemTools::GetDirCase(dir);
+  }
+  Directory& d = this->GetDirectory(DirectoryKey(dir));
+  if (d.State == Directory::StateType::Missing) {
+    ++this->Stats.SavedSystemCalls;
+    return cm::nullopt;
+  }
+  if (!d.Case) {
+    ++this->Stats.SystemCalls;
+    d.Case = cmSystemTools::GetDirCase(dir);
+  } else {
+    ++this->Stats.SavedSystemCalls;
+  }
+  return *d.Case;
+}
+
+cmFileSystemCache::Directory& cmFileSystemCache::GetDirectory(
+  std::string const& dir, bool* loaded)
+{
+  Directory& d = this->Directories[dir];
+  if (d.Epoch == this->Epoch) {
+    return d;
+  }
+  if (d.Epoch != 0 && !d.Racy) {
+    // Keep the listing if the directory has not changed since.
+    ++this->Stats.SystemCalls;
+    cmFileTime time;
+    bool const exists = time.Load(dir);
+    if (d.State == Directory::StateType::Missing
+          ? !exists
+          : exists && time.Equal(d.Time)) {
+      d.Epoch = this->Epoch;
+      return d;
+    }
+  }
+  this->LoadDirectory(dir, d);
+  if (loaded) {
+    *loaded = true;
+  }
+  return d;
+}
+
+void cmFileSystemCache::LoadDirectory(std::string const& dir, Directory& d)
+{
+  d = Directory();
+  d.Epoch = this->Epoch;
+
+  // Read the modification time first so that changes made while the
+  // directory is listed are noticed later.
+  ++this->Stats.SystemCalls;
+  if (!d.Time.Load(dir)) {
+    return;
+  }
+  ++this->Stats.SystemCalls;
+  cmsys::Directory listing;
+  if (!listing.Load(dir)) {
+    ++this->Stats.SystemCalls;
+    if (cmSystemTools::FileIsDirectory(dir)) {
+      d.State = Directory::StateType::Unreadable;
+    }
+    return;
+  }
+
+  d.State = Directory::StateType::Listed;
+  d.Racy = CurrentFileTime() - d.Time.GetTime() < RacyInterval;
+  unsigned long const n = listing.GetNumberOfFiles();
+  d.Names.reserve(n);
+  for (unsigned long i = 0; i < n; ++i) {
+    std::string const& name = listing.GetFileName(i);
+    if (name == "." || name == "..") {
+      continue;
+    }
+    d.Names.push_back(name);
+    d.Entries.emplace(name, Entry());
+    d.LowerNames.insert(cmSystemTools::LowerCase(name));
+  }
+}
+
+bool cmFileSystemCache::LookupEntry(std::string const& file, Entry*& entry)
+{
+  entry = nullptr;
+  if (file.empty() || file.back() == '/' ||
+      !cmSystemTools::FileIsFullPath(file)) {
+    return false;
+  }
+#if defined(_WIN32)
+  // Network shares cannot be listed by their server and native
+  // separators are not split.
+  if (cmHasLiteralPrefix(file, "//") || file.find('\\') != std::string::npos) {
+    return false;
+  }
+#endif
+  std::string::size_type const slash = file.rfind('/');
+  if (slash == std::string::npos) {
+    return false;
+  }
+  std::string const name = file.substr(slash + 1);
+  if (name == "." || name == "..") {
+    return false;
+  }
+  for (char c : name) {
+    // The case of non-ASCII names cannot be folded reliably below.
+    if (static_cast<unsigned char>(c) >= 0x80) {
+      return false;
+    }
+#if defined(_WIN32)
+    // Short 8.3 names are not listed.
+    if (c == '~') {
+      return false;
+    }
+#endif
+  }
+#if defined(_WIN32)
+  // Windows ignores trailing dots and spaces in names.
+  if (name.back() == '.' || name.back() == ' ') {
+    return false;
+  }
+#endif
+
+  Directory& d = this->GetDirectory(DirectoryKey(file.substr(0, slash)));
+  if (d.State == Directory::StateType::Unreadable) {
+    return false;
+  }
+  auto const i = d.Entries.find(name);
+  if (i != d.Entries.end()) {
+    entry = &i->second;
+    return true;
+  }
+  // The name may still match an entry on a case-insensitive file system.
+  return d.LowerNames.count(cmSystemTools::LowerCase(name)) == 0;
+}
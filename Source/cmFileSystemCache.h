@@ -0,0 +1,146 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <cm/optional>
+
+#include "cmFileTime.h"
+#include "cmSystemTools.h"
+
+/** \class cmFileSystemCache
+ * \brief Caches directory listings and file queries of the find commands.
+ *
+ * Each directory is listed once and the queries for files in it are
+ * answered from the listing.  The result of a query for a file that is
+ * in the listing is remembered for as long as the listing is valid.
+ *
+ * A listing stays valid while the modification time of its directory does
+ * not change, which covers files written by CMake as well as by other
+ * processes.  That time is checked once after each call to Revalidate(),
+ * so a single search costs at most one stat of each directory it touches.
+ */
+class cmFileSystemCache
+{
+public:
+  cmFileSystemCache();
+  ~cmFileSystemCache();
+
+  cmFileSystemCache(cmFileSystemCache const&) = delete;
+  cmFileSystemCache& operator=(cmFileSystemCache const&) = delete;
+
+  /**
+   * @brief Checks the listings again before they are used next.
+   *
+   * The find commands call this when they start a search.
+   */
+  void Revalidate();
+
+  /**
+   * @brief Forgets everything.
+   */
+  void Clear();
+
+  /**
+   * @brief Returns the names of the entries of a directory, other than
+   *        `.` and `..`, in the order of the file system.
+   *
+   * The result is empty if the directory cannot be read.
+   */
+  std::vector<std::string> const& GetDirectoryEntries(std::string const& dir);
+
+  /**
+   * @brief Cached version of cmSystemTools::FileExists.
+   */
+  bool FileExists(std::string const& file);
+
+  /**
+   * @brief Cached version of cmSystemTools::FileExists with isFile.
+   */
+  bool FileExists(std::string const& file, bool isFile);
+
+  /**
+   * @brief Cached version of cmSystemTools::FileIsDirectory.
+   */
+  bool FileIsDirectory(std::string const& path);
+
+  /**
+   * @brief Returns false if the file certainly does not exist.
+   *
+   * This never queries more than the listing of the parent directory.
+   */
+  bool FileMayExist(std::string const& file);
+
+  /**
+   * @brief Cached version of cmSystemTools::GetDirCase.
+   */
+  cm::optional<cmSystemTools::DirCase> GetDirCase(std::string const& dir);
+
+  /**
+   * @brief Counts the file system queries made by the cache
+   *        and those it answered without a query.
+   */
+  struct Statistics
+  {
+    unsigned long long SystemCalls = 0;
+    unsigned long long SavedSystemCalls = 0;
+  };
+  Statistics const& GetStatistics() const { return this->Stats; }
+
+private:
+  enum class Answer : unsigned char
+  {
+    Unknown,
+    No,
+    Yes,
+  };
+
+  struct Entry
+  {
+    Answer Exists = Answer::Unknown;
+    Answer IsDirectory = Answer::Unknown;
+  };
+
+  struct Directory
+  {
+    enum class StateType : unsigned char
+    {
+      // The directory has been listed.
+      Listed,
+      // The directory does not exist or is not a directory.
+      Missing,
+      // The directory exists but cannot be listed.
+      Unreadable,
+    };
+
+    StateType State = StateType::Missing;
+    // Whether the directory changed too recently for its modification time
+    // to tell later changes apart.
+    bool Racy = false;
+    unsigned long Epoch = 0;
+    cmFileTime Time;
+    std::vector<std::string> Names;
+    std::unordered_map<std::string, Entry> Entries;
+    std::unordered_set<std::string> LowerNames;
+    cm::optional<cm::optional<cmSystemTools::DirCase>> Case;
+  };
+
+  Directory& GetDirectory(std::string const& dir, bool* loaded = nullptr);
+  void LoadDirectory(std::string const& dir, Directory& d);
+
+  // Find the entry for a file in the listing of its directory.  Returns
+  // false if the file system has to be queried instead.  Otherwise, entry
+  // is null if the file does not exist.
+  bool LookupEntry(std::string const& file, Entry*& entry);
+
+  std::unordered_map<std::string, Directory> Directories;
+  std::vector<std::string> UncachedNames;
+  unsigned long Epoch = 1;
+  Statistics Stats;
+};
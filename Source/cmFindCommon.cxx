@@ -9,6 +9,7 @@
 #include <cmext/algorithm>
 
 #include "cmExecutionStatus.h"
+#include "cmFileSystemCache.h"
 #include "cmList.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
@@ -33,7 +34,11 @@ cmFindCommon::PathLabel cmFindCommon::PathLabel::Guess("GUESS");
 cmFindCommon::cmFindCommon(cmExecutionStatus& status)
   : Makefile(&status.GetMakefile())
   , Status(status)
+  , FileSystemCache(this->Makefile->GetCMakeInstance()->GetFileSystemCache())
 {
+  // Notice changes to the file system since the last search.
+  this->FileSystemCache.Revalidate();
+
   this->FindRootPathMode = RootPathModeBoth;
   this->NoDefaultPath = false;
   this->NoPackageRootPath = false;
@@ -17,6 +17,7 @@
 class cmConfigureLog;
 class cmFindCommonDebugState;
 class cmExecutionStatus;
+class cmFileSystemCache;
 class cmMakefile;
 
 /** \class cmFindCommon
@@ -164,6 +165,7 @@ protected:
 
   cmMakefile* Makefile;
   cmExecutionStatus& Status;
+  cmFileSystemCache& FileSystemCache;
 };
 
 class cmFindCommonDebugState
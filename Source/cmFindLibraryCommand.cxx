@@ -6,16 +6,16 @@
 #include <cctype>
 #include <cstdio>
 #include <cstring>
-#include <set>
 #include <utility>
+#include <vector>
 
 #include <cm/memory>
 #include <cm/optional>
 
 #include "cmsys/RegularExpression.hxx"
 
+#include "cmFileSystemCache.h"
 #include "cmFindCommon.h"
-#include "cmGlobalGenerator.h"
 #include "cmList.h"
 #include "cmMakefile.h"
 #include "cmState.h"
@@ -23,6 +23,7 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmValue.h"
+#include "cmake.h"
 
 class cmExecutionStatus;
 
@@ -120,11 +121,11 @@ void cmFindLibraryCommand::AddArchitecturePath(
   if (pos != std::string::npos) {
     // Check for "lib".
     std::string lib = dir.substr(0, pos + 3);
-    bool use_lib = cmSystemTools::FileIsDirectory(lib);
+    bool use_lib = this->FileSystemCache.FileIsDirectory(lib);
 
     // Check for "lib<suffix>" and use it first.
     std::string libX = lib + suffix;
-    bool use_libX = cmSystemTools::FileIsDirectory(libX);
+    bool use_libX = this->FileSystemCache.FileIsDirectory(libX);
 
     // Avoid copies of the same directory due to symlinks.
     if (use_libX && use_lib && cmLibDirsLinked(libX, lib)) {
@@ -144,11 +145,11 @@ void cmFindLibraryCommand::AddArchitecturePath(
 
   if (fresh) {
     // Check for the original unchanged path.
-    bool use_dir = cmSystemTools::FileIsDirectory(dir);
+    bool use_dir = this->FileSystemCache.FileIsDirectory(dir);
 
     // Check for <dir><suffix>/ and use it first.
     std::string dirX = dir + suffix;
-    bool use_dirX = cmSystemTools::FileIsDirectory(dirX);
+    bool use_dirX = this->FileSystemCache.FileIsDirectory(dirX);
 
     // Avoid copies of the same directory due to symlinks.
     if (use_dirX && use_dir && cmLibDirsLinked(dirX, dir)) {
@@ -201,7 +202,7 @@ struct cmFindLibraryHelper
   // Context information.
   cmMakefile* Makefile;
   cmFindBase const* FindBase;
-  cmGlobalGenerator* GG;
+  cmFileSystemCache& FileSystemCache;
 
   // List of valid prefixes and suffixes.
   cmList Prefixes;
@@ -313,10 +314,9 @@ cmFindLibraryHelper::cmFindLibraryHelper(cmMakefile* mf,
                                          cmFindCommonDebugState* debugState)
   : Makefile(mf)
   , FindBase(base)
+  , FileSystemCache(mf->GetCMakeInstance()->GetFileSystemCache())
   , DebugState(debugState)
 {
-  this->GG = this->Makefile->GetGlobalGenerator();
-
   // Collect the list of library name prefixes/suffixes to try.
   std::string const& prefixes_list = get_prefixes(this->Makefile);
   std::string const& suffixes_list = get_suffixes(this->Makefile);
@@ -455,7 +455,7 @@ bool cmFindLibraryHelper::CheckDirectoryForName(std::string const& path,
   if (name.TryRaw) {
     std::string testPath = cmStrCat(path, name.Raw);
 
-    if (cmSystemTools::FileExists(testPath, true)) {
+    if (this->FileSystemCache.FileExists(testPath, true)) {
       testPath = cmSystemTools::ToNormalizedPathOnDisk(testPath);
       if (this->Validate(testPath)) {
         this->DebugLibraryFound(name.Raw, path);
@@ -474,12 +474,14 @@ bool cmFindLibraryHelper::CheckDirectoryForName(std::string const& path,
 
   // Search for a file matching the library name regex.
   cm::optional<cmSystemTools::DirCase> dirCase =
-    cmSystemTools::GetDirCase(path).value_or(
+    this->FileSystemCache.GetDirCase(path).value_or(
       cmSystemTools::DirCase::Sensitive);
   cmsys::RegularExpression& regex =
     dirCase == cmSystemTools::DirCase::Insensitive ? name.ICaseRegex
                                                    : name.Regex;
-  std::set<std::string> const& files = this->GG->GetDirectoryContent(path);
+  // Copy the names because a validator may run other searches.
+  std::vector<std::string> const files =
+    this->FileSystemCache.GetDirectoryEntries(path);
   for (std::string const& origName : files) {
     std::string testName = dirCase == cmSystemTools::DirCase::Insensitive
       ? cmSystemTools::LowerCase(origName)
@@ -488,7 +490,7 @@ bool cmFindLibraryHelper::CheckDirectoryForName(std::string const& path,
     if (regex.find(testName)) {
       std::string testPath = cmStrCat(path, origName);
       // Make sure the path is readable and is not a directory.
-      if (cmSystemTools::FileExists(testPath, true)) {
+      if (this->FileSystemCache.FileExists(testPath, true)) {
         testPath = cmSystemTools::ToNormalizedPathOnDisk(testPath);
         if (!this->Validate(testPath)) {
           continue;
@@ -590,7 +592,7 @@ std::string cmFindLibraryCommand::FindFrameworkLibraryNamesPerDir()
   for (std::string const& d : this->SearchPaths) {
     for (std::string const& n : this->Names) {
       fwPath = cmStrCat(d, n, ".xcframework");
-      if (cmSystemTools::FileIsDirectory(fwPath)) {
+      if (this->FileSystemCache.FileIsDirectory(fwPath)) {
         auto finalPath = cmSystemTools::ToNormalizedPathOnDisk(fwPath);
         if (this->Validate(finalPath)) {
           return finalPath;
@@ -598,7 +600,7 @@ std::string cmFindLibraryCommand::FindFrameworkLibraryNamesPerDir()
       }
 
       fwPath = cmStrCat(d, n, ".framework");
-      if (cmSystemTools::FileIsDirectory(fwPath)) {
+      if (this->FileSystemCache.FileIsDirectory(fwPath)) {
         auto finalPath = cmSystemTools::ToNormalizedPathOnDisk(fwPath);
         if (this->Validate(finalPath)) {
           return finalPath;
@@ -618,7 +620,7 @@ std::string cmFindLibraryCommand::FindFrameworkLibraryDirsPerName()
   for (std::string const& n : this->Names) {
     for (std::string const& d : this->SearchPaths) {
       fwPath = cmStrCat(d, n, ".xcframework");
-      if (cmSystemTools::FileIsDirectory(fwPath)) {
+      if (this->FileSystemCache.FileIsDirectory(fwPath)) {
         auto finalPath = cmSystemTools::ToNormalizedPathOnDisk(fwPath);
         if (this->Validate(finalPath)) {
           return finalPath;
@@ -626,7 +628,7 @@ std::string cmFindLibraryCommand::FindFrameworkLibraryDirsPerName()
       }
 
       fwPath = cmStrCat(d, n, ".framework");
-      if (cmSystemTools::FileIsDirectory(fwPath)) {
+      if (this->FileSystemCache.FileIsDirectory(fwPath)) {
         auto finalPath = cmSystemTools::ToNormalizedPathOnDisk(fwPath);
         if (this->Validate(finalPath)) {
           return finalPath;
@@ -0,0 +1,1432 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmFindPackageCache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <cm/memory>
+#include <cm/optional>
+#include <cmext/string_view>
+
+#include <cm3p/json/reader.h>
+#include <cm3p/json/writer.h>
+
+#include "cmsys/FStream.hxx"
+#include "cmsys/SystemTools.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmFileSystemCache.h"
+#include "cmFunctionCommand.h"
+#include "cmGeneratedFileStream.h"
+#include "cmListFileCache.h"
+#include "cmMacroCommand.h"
+#include "cmMakefile.h"
+#include "cmState.h"
+#include "cmStateDirectory.h"
+#include "cmStateSnapshot.h"
+#include "cmStateTypes.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+#include "cmTarget.h"
+#include "cmValue.h"
+#include "cmVersion.h"
+#include "cmake.h"
+
+namespace {
+
+int const Version = 3;
+
+// Keep a few recordings of each file for loads with different inputs,
+// such as calls with different components.
+std::size_t const MaxRecordings = 4;
+
+std::string MakeKey(std::string const& package, std::string const& file,
+                    bool globalScope)
+{
+  return cmStrCat(package, '\n', file, '\n', globalScope ? '1' : '0');
+}
+
+// Variables that each listfile or function sets for itself.
+bool IsScopeVariable(std::string const& name)
+{
+  static std::unordered_set<std::string> const names{
+    "ARGC",
+    "ARGN",
+    "ARGV",
+    "CMAKE_CURRENT_FUNCTION",
+    "CMAKE_CURRENT_FUNCTION_LIST_DIR",
+    "CMAKE_CURRENT_FUNCTION_LIST_FILE",
+    "CMAKE_CURRENT_FUNCTION_LIST_LINE",
+    "CMAKE_CURRENT_LIST_DIR",
+    "CMAKE_CURRENT_LIST_FILE",
+    "CMAKE_CURRENT_LIST_LINE",
+    "CMAKE_PARENT_LIST_FILE",
+  };
+  if (names.count(name)) {
+    return true;
+  }
+  return cmHasLiteralPrefix(name, "ARGV") && name.size() > 4 &&
+    std::all_of(name.begin() + 4, name.end(),
+                [](char c) { return c >= '0' && c <= '9'; });
+}
+
+// Commands whose inputs and effects are recorded, possibly depending on
+// their arguments.  Any other command built into CMake may depend on or
+// change state that a replay does not know about, such as files found on
+// disk or the results of running tools.
+bool IsRecordedCommand(std::string const& name)
+{
+  static std::unordered_set<std::string> const names{
+    "add_executable",
+    "add_library",
+    "block",
+    "break",
+    "cmake_language",
+    "cmake_minimum_required",
+    "cmake_parse_arguments",
+    "cmake_path",
+    "cmake_policy",
+    "continue",
+    "file",
+    "find_package",
+    "foreach",
+    "function",
+    "get_cmake_property",
+    "get_directory_property",
+    "get_filename_component",
+    "get_property",
+    "get_target_property",
+    "if",
+    "include",
+    "include_guard",
+    "list",
+    "macro",
+    "mark_as_advanced",
+    "math",
+    "message",
+    "option",
+    "return",
+    "separate_arguments",
+    "set",
+    "set_property",
+    "set_target_properties",
+    "string",
+    "target_compile_definitions",
+    "target_compile_features",
+    "target_compile_options",
+    "target_include_directories",
+    "target_link_directories",
+    "target_link_libraries",
+    "target_link_options",
+    "target_precompile_headers",
+    "target_sources",
+    "unset",
+    "while",
+  };
+  return names.count(name) != 0;
+}
+
+// Evaluates a file test of the if() command.  Returns nothing for tests
+// that are not recorded.
+cm::optional<bool> EvaluateFileTest(cm::string_view test,
+                                    std::string const& path)
+{
+  if (test == "EXISTS"_s) {
+    return cmSystemTools::FileExists(path);
+  }
+  if (test == "IS_DIRECTORY"_s) {
+    return cmSystemTools::FileIsDirectory(path);
+  }
+  if (test == "IS_SYMLINK"_s) {
+    return cmSystemTools::FileIsSymlink(path);
+  }
+  if (test == "IS_READABLE"_s) {
+    return cmSystemTools::TestFileAccess(path, cmsys::TEST_FILE_READ);
+  }
+  if (test == "IS_WRITABLE"_s) {
+    return cmSystemTools::TestFileAccess(path, cmsys::TEST_FILE_WRITE);
+  }
+  if (test == "IS_EXECUTABLE"_s) {
+    return cmSystemTools::TestFileAccess(path, cmsys::TEST_FILE_EXECUTE);
+  }
+  return cm::nullopt;
+}
+
+// Returns the literal value of an argument, or nothing if it references
+// variables.
+cm::optional<std::string> LiteralArgument(cmListFileFunction const& lff,
+                                          std::size_t i)
+{
+  if (i >= lff.Arguments().size() ||
+      lff.Arguments()[i].Value.find('$') != std::string::npos) {
+    return cm::nullopt;
+  }
+  return lff.Arguments()[i].Value;
+}
+
+struct FileStat
+{
+  std::uint64_t Size = 0;
+  std::uint64_t MTime = 0;
+};
+
+bool LoadFileStat(std::string const& path, FileStat& stat)
+{
+  cmsys::SystemTools::Stat_t st;
+  if (cmsys::SystemTools::Stat(path, &st) != 0) {
+    return false;
+  }
+  stat.Size = static_cast<std::uint64_t>(st.st_size);
+  stat.MTime = static_cast<std::uint64_t>(st.st_mtime);
+  // A file modified within the last seconds may be modified again
+  // without a change of its modification time.
+  std::uint64_t const now = static_cast<std::uint64_t>(std::time(nullptr));
+  if (stat.MTime + 2 >= now) {
+    stat.MTime = 0;
+  }
+  return true;
+}
+
+std::string HashFile(std::string const& path)
+{
+  cmCryptoHash md5(cmCryptoHash::AlgoMD5);
+  return md5.HashFile(path);
+}
+
+std::string HashDirectory(cmFileSystemCache& fsCache, std::string const& dir)
+{
+  std::vector<std::string> names = fsCache.GetDirectoryEntries(dir);
+  std::sort(names.begin(), names.end());
+  cmCryptoHash md5(cmCryptoHash::AlgoMD5);
+  return md5.HashString(cmJoin(names, "\n"_s));
+}
+
+Json::Value ValueToJson(std::string const& name, cmValue value)
+{
+  Json::Value v(Json::objectValue);
+  v["name"] = name;
+  if (value) {
+    v["value"] = *value;
+  }
+  return v;
+}
+
+bool ValueMatches(Json::Value const& v, cmValue value)
+{
+  Json::Value const& recorded = v["value"];
+  return recorded.isString() ? value && *value == recorded.asString()
+                             : !value;
+}
+
+// Record a property change as an append when the old value is a prefix
+// of the new one, so that it can be replayed onto a different value.
+Json::Value PropertyChangeToJson(std::string const& name,
+                                 std::string const* before,
+                                 std::string const* after)
+{
+  Json::Value v(Json::objectValue);
+  v["name"] = name;
+  if (after) {
+    if (before && !before->empty() && cmHasPrefix(*after, *before)) {
+      v["append"] = after->substr(before->size());
+    } else {
+      v["value"] = *after;
+    }
+  }
+  return v;
+}
+
+cm::optional<std::string> ApplyPropertyChange(Json::Value const& v,
+                                              cmValue current)
+{
+  if (v.isMember("append")) {
+    return cmStrCat(current ? *current : std::string(),
+                    v["append"].asString());
+  }
+  if (v.isMember("value")) {
+    return v["value"].asString();
+  }
+  return cm::nullopt;
+}
+
+std::string PoliciesToString(cmPolicies::PolicyMap const& policies)
+{
+  std::string s;
+  s.reserve(cmPolicies::CMPCOUNT);
+  for (int i = 0; i < cmPolicies::CMPCOUNT; ++i) {
+    auto const id = static_cast<cmPolicies::PolicyID>(i);
+    if (!policies.IsDefined(id)) {
+      s += ' ';
+      continue;
+    }
+    switch (policies.Get(id)) {
+      case cmPolicies::OLD:
+        s += 'O';
+        break;
+      case cmPolicies::WARN:
+        s += 'W';
+        break;
+      case cmPolicies::NEW:
+        s += 'N';
+        break;
+    }
+  }
+  return s;
+}
+
+cmPolicies::PolicyMap PoliciesFromString(std::string const& s)
+{
+  cmPolicies::PolicyMap policies;
+  for (int i = 0; i < cmPolicies::CMPCOUNT && i < static_cast<int>(s.size());
+       ++i) {
+    auto const id = static_cast<cmPolicies::PolicyID>(i);
+    switch (s[i]) {
+      case 'O':
+        policies.Set(id, cmPolicies::OLD);
+        break;
+      case 'W':
+        policies.Set(id, cmPolicies::WARN);
+        break;
+      case 'N':
+        policies.Set(id, cmPolicies::NEW);
+        break;
+      default:
+        break;
+    }
+  }
+  return policies;
+}
+
+std::size_t BacktraceDepth(cmListFileBacktrace bt)
+{
+  std::size_t depth = 0;
+  for (; !bt.Empty(); bt = bt.Pop()) {
+    ++depth;
+  }
+  return depth;
+}
+
+// Encode the frames a backtrace has above the given depth, outermost first.
+Json::Value BacktraceToJson(cmListFileBacktrace bt, std::size_t baseDepth)
+{
+  std::vector<cmListFileContext> frames;
+  for (std::size_t depth = BacktraceDepth(bt); depth > baseDepth; --depth) {
+    frames.push_back(bt.Top());
+    bt = bt.Pop();
+  }
+  Json::Value json = Json::arrayValue;
+  for (auto f = frames.rbegin(); f != frames.rend(); ++f) {
+    Json::Value frame(Json::objectValue);
+    frame["name"] = f->Name;
+    frame["file"] = f->FilePath;
+    frame["line"] = static_cast<Json::Int64>(f->Line);
+    json.append(std::move(frame));
+  }
+  return json;
+}
+
+cmListFileBacktrace BacktraceFromJson(cmListFileBacktrace bt,
+                                      Json::Value const& json)
+{
+  for (Json::Value const& frame : json) {
+    cmListFileContext context;
+    context.Name = frame["name"].asString();
+    context.FilePath = frame["file"].asString();
+    context.Line = static_cast<long>(frame["line"].asInt64());
+    bt = bt.Push(std::move(context));
+  }
+  return bt;
+}
+
+Json::Value FunctionToJson(cmListFileFunction const& function)
+{
+  Json::Value args(Json::arrayValue);
+  for (cmListFileArgument const& arg : function.Arguments()) {
+    Json::Value a(Json::arrayValue);
+    a.append(arg.Value);
+    a.append(static_cast<int>(arg.Delim));
+    a.append(static_cast<Json::Int64>(arg.Line));
+    args.append(std::move(a));
+  }
+  Json::Value f(Json::arrayValue);
+  f.append(function.OriginalName());
+  f.append(static_cast<Json::Int64>(function.Line()));
+  f.append(static_cast<Json::Int64>(function.LineEnd()));
+  f.append(std::move(args));
+  return f;
+}
+
+cmListFileFunction FunctionFromJson(Json::Value const& f)
+{
+  std::vector<cmListFileArgument> args;
+  args.reserve(f[3].size());
+  for (Json::Value const& a : f[3]) {
+    args.emplace_back(a[0].asString(),
+                      static_cast<cmListFileArgument::Delimiter>(a[1].asInt()),
+                      static_cast<long>(a[2].asInt64()));
+  }
+  return cmListFileFunction(f[0].asString(),
+                            static_cast<long>(f[1].asInt64()),
+                            static_cast<long>(f[2].asInt64()),
+                            std::move(args));
+}
+
+// Target properties that are not stored in the property map of a target.
+std::vector<std::string> const& SpecialTargetProperties()
+{
+  static std::vector<std::string> const names{
+    "INCLUDE_DIRECTORIES",
+    "COMPILE_OPTIONS",
+    "COMPILE_FEATURES",
+    "COMPILE_DEFINITIONS",
+    "PRECOMPILE_HEADERS",
+    "SOURCES",
+    "LINK_OPTIONS",
+    "LINK_DIRECTORIES",
+    "LINK_LIBRARIES",
+    "C_STANDARD",
+    "CXX_STANDARD",
+    "CUDA_STANDARD",
+    "HIP_STANDARD",
+    "OBJC_STANDARD",
+    "OBJCXX_STANDARD",
+    "INTERFACE_LINK_LIBRARIES",
+    "INTERFACE_LINK_LIBRARIES_DIRECT",
+    "INTERFACE_LINK_LIBRARIES_DIRECT_EXCLUDE",
+    "IMPORTED_CXX_MODULES_INCLUDE_DIRECTORIES",
+    "IMPORTED_CXX_MODULES_COMPILE_DEFINITIONS",
+    "IMPORTED_CXX_MODULES_COMPILE_FEATURES",
+    "IMPORTED_CXX_MODULES_COMPILE_OPTIONS",
+    "IMPORTED_CXX_MODULES_LINK_LIBRARIES",
+  };
+  return names;
+}
+
+struct CacheEntryState
+{
+  cmStateEnums::CacheEntryType Type = cmStateEnums::UNINITIALIZED;
+  std::string Value;
+  bool Initialized = false;
+  std::map<std::string, std::string> Properties;
+};
+
+CacheEntryState GetCacheEntryState(cmState* state, std::string const& key)
+{
+  CacheEntryState entry;
+  entry.Type = state->GetCacheEntryType(key);
+  entry.Value = *state->GetCacheEntryValue(key);
+  entry.Initialized = state->GetInitializedCacheValue(key) != nullptr;
+  for (std::string const& prop : state->GetCacheEntryPropertyList(key)) {
+    entry.Properties.emplace(prop, *state->GetCacheEntryProperty(key, prop));
+  }
+  return entry;
+}
+
+bool operator==(CacheEntryState const& l, CacheEntryState const& r)
+{
+  return l.Type == r.Type && l.Value == r.Value &&
+    l.Initialized == r.Initialized && l.Properties == r.Properties;
+}
+
+Json::Value CacheValueToJson(CacheEntryState const& entry)
+{
+  Json::Value v(Json::objectValue);
+  v["type"] = cmState::CacheEntryTypeToString(entry.Type);
+  v["value"] = entry.Value;
+  return v;
+}
+
+// Whether a cache entry has the type and value recorded in the given
+// object, or does not exist if the object is null.
+bool CacheValueMatches(cmState* state, std::string const& name,
+                       Json::Value const& v)
+{
+  cmValue value = state->GetInitializedCacheValue(name);
+  if (v.isNull()) {
+    return !value;
+  }
+  return value && *value == v["value"].asString() &&
+    cmState::CacheEntryTypeToString(state->GetCacheEntryType(name)) ==
+    v["type"].asString();
+}
+
+// Whether a cache entry has the value that a recorded load created it
+// with.  Such entries may exist from an earlier run.
+bool CreatedByLoad(cmState* state, Json::Value const& effects,
+                   std::string const& name)
+{
+  for (Json::Value const& c : effects["cache"]) {
+    if (c["name"] == name && !c.isMember("before") && c.isMember("after") &&
+        CacheValueMatches(state, name, c["after"])) {
+      return true;
+    }
+  }
+  return false;
+}
+}
+
+struct cmFindPackageCacheRecorder
+{
+  cmFindPackageCacheRecorder* Parent = nullptr;
+  cmMakefile* Makefile = nullptr;
+  std::string Package;
+  std::string File;
+  bool GlobalScope = false;
+  cmStateSnapshot Snapshot;
+  cmListFileBacktrace Backtrace;
+  bool Replayable = true;
+
+  // The state before the load.
+  std::unordered_map<std::string, std::string> Variables;
+  std::map<std::string, CacheEntryState> CacheEntries;
+  std::map<std::string, std::string> GlobalProperties;
+  std::map<std::string, std::string> DirectoryProperties;
+  std::size_t ImportedTargets = 0;
+  std::size_t Targets = 0;
+  std::map<std::string, std::string> Aliases;
+
+  // The inputs of the load.
+  std::set<std::string> ListFiles;
+  std::set<std::string> Directories;
+  std::set<std::string> VariableReads;
+  std::set<std::string> CacheReads;
+  std::map<std::string, cm::optional<std::string>> EnvironmentReads;
+  std::map<std::pair<std::string, std::string>, bool> FileTests;
+  std::set<std::string> TargetQueries;
+  std::set<std::string> GlobalPropertyReads;
+  std::set<std::string> DirectoryPropertyReads;
+
+  // The effects of the load that cannot be found by comparing the state
+  // before and after it.
+  std::set<cmTarget const*> ChangedTargets;
+  std::set<std::string> ChangedTargetNames;
+  Json::Value Commands = Json::arrayValue;
+};
+
+cmFindPackageCache::cmFindPackageCache(std::string cacheFile)
+  : CacheFile(std::move(cacheFile))
+{
+}
+
+cmFindPackageCache::~cmFindPackageCache() = default;
+
+bool cmFindPackageCache::Load()
+{
+  cmsys::ifstream fin(this->CacheFile.c_str(),
+                      std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  Json::CharReaderBuilder builder;
+  Json::Value root;
+  std::string errors;
+  if (!Json::parseFromStream(builder, fin, &root, &errors) ||
+      !root.isObject() || root["version"] != Version ||
+      root["cmake"] != cmVersion::GetCMakeVersion() ||
+      !root["entries"].isArray()) {
+    return false;
+  }
+  for (Json::Value& entry : root["entries"]) {
+    if (!entry.isObject() || !entry["package"].isString() ||
+        !entry["file"].isString() || !entry["global"].isBool()) {
+      return false;
+    }
+    std::string const key =
+      MakeKey(entry["package"].asString(), entry["file"].asString(),
+              entry["global"].asBool());
+    this->Entries[key].emplace_back(std::move(entry));
+  }
+  return true;
+}
+
+bool cmFindPackageCache::Save() const
+{
+  if (!this->Modified) {
+    return true;
+  }
+
+  Json::Value root(Json::objectValue);
+  root["version"] = Version;
+  root["cmake"] = cmVersion::GetCMakeVersion();
+  Json::Value& entries = root["entries"] = Json::arrayValue;
+  for (auto const& e : this->Entries) {
+    for (Json::Value const& entry : e.second) {
+      entries.append(entry);
+    }
+  }
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  std::unique_ptr<Json::StreamWriter> const writer(builder.newStreamWriter());
+  cmGeneratedFileStream fout;
+  fout.Open(this->CacheFile, true, true);
+  writer->write(root, &fout);
+  return fout.Close();
+}
+
+bool cmFindPackageCache::Replay(cmMakefile& mf, std::string const& package,
+                                std::string const& file, bool globalScope)
+{
+  auto i = this->Entries.find(MakeKey(package, file, globalScope));
+  if (i == this->Entries.end()) {
+    return false;
+  }
+  std::vector<Json::Value>& entries = i->second;
+  for (auto e = entries.begin(); e != entries.end(); ++e) {
+    if (this->IsValid(mf, *e)) {
+      if (e != entries.begin()) {
+        std::rotate(entries.begin(), e, e + 1);
+        this->Modified = true;
+      }
+      this->Apply(mf, entries.front());
+      return true;
+    }
+  }
+  return false;
+}
+
+bool cmFindPackageCache::IsValid(cmMakefile& mf, Json::Value& entry)
+{
+  cmake* cm = mf.GetCMakeInstance();
+  cmState* state = mf.GetState();
+  cmFileSystemCache& fsCache = cm->GetFileSystemCache();
+
+  // The listfiles must have the recorded content.
+  for (Json::Value& f : entry["listFiles"]) {
+    std::string const path = f["path"].asString();
+    FileStat stat;
+    if (!LoadFileStat(path, stat)) {
+      return false;
+    }
+    if (f["mtime"].asUInt64() == 0 || stat.Size != f["size"].asUInt64() ||
+        stat.MTime != f["mtime"].asUInt64()) {
+      if (HashFile(path) != f["hash"].asString()) {
+        return false;
+      }
+      f["size"] = static_cast<Json::UInt64>(stat.Size);
+      f["mtime"] = static_cast<Json::UInt64>(stat.MTime);
+      this->Modified = true;
+    }
+  }
+
+  // The directories searched for listfiles must have the recorded entries.
+  for (Json::Value const& d : entry["directories"]) {
+    if (HashDirectory(fsCache, d["path"].asString()) !=
+        d["hash"].asString()) {
+      return false;
+    }
+  }
+
+  Json::Value const& effects = entry["effects"];
+
+  // The variables read must have the recorded values.  Cache entries that
+  // the load creates itself may exist from an earlier run.
+  for (Json::Value const& v : entry["variables"]) {
+    std::string const name = v["name"].asString();
+    cmValue value = mf.GetDefinition(name);
+    if (ValueMatches(v, value)) {
+      continue;
+    }
+    if (v.isMember("value") || mf.GetStateSnapshot().GetDefinition(name) ||
+        !CreatedByLoad(state, effects, name)) {
+      return false;
+    }
+  }
+
+  for (Json::Value const& c : entry["cache"]) {
+    std::string const name = c["name"].asString();
+    if (!ValueMatches(c, state->GetCacheEntryValue(name)) &&
+        (c.isMember("value") || !CreatedByLoad(state, effects, name))) {
+      return false;
+    }
+  }
+  for (Json::Value const& v : entry["environment"]) {
+    std::string value;
+    bool const defined = cmSystemTools::GetEnv(v["name"].asString(), value);
+    if (!ValueMatches(v, defined ? cmValue(value) : cmValue(nullptr))) {
+      return false;
+    }
+  }
+  for (Json::Value const& f : entry["fileTests"]) {
+    if (EvaluateFileTest(f["test"].asString(), f["path"].asString()) !=
+        f["result"].asBool()) {
+      return false;
+    }
+  }
+
+  for (Json::Value const& t : entry["targets"]) {
+    if ((mf.FindTargetToUse(t["name"].asString()) != nullptr) !=
+        t["exists"].asBool()) {
+      return false;
+    }
+  }
+  for (Json::Value const& p : entry["globalProperties"]) {
+    if (!ValueMatches(p, cm->GetProperty(p["name"].asString()))) {
+      return false;
+    }
+  }
+  for (Json::Value const& p : entry["directoryProperties"]) {
+    if (!ValueMatches(p, mf.GetProperty(p["name"].asString()))) {
+      return false;
+    }
+  }
+
+  // Cache entries changed by the load must still have the value from
+  // before or after the load, because the load may or may not have
+  // overwritten another value.
+  for (Json::Value const& c : effects["cache"]) {
+    std::string const name = c["name"].asString();
+    if (!CacheValueMatches(state, name, c["before"]) &&
+        !CacheValueMatches(state, name, c["after"])) {
+      return false;
+    }
+    // Paths found by the load must still exist.
+    Json::Value const& after = c["after"];
+    if (!after.isNull() && !c.isMember("before") &&
+        (after["type"] == "FILEPATH" || after["type"] == "PATH")) {
+      std::string const path = after["value"].asString();
+      if (cmSystemTools::FileIsFullPath(path) && !fsCache.FileExists(path)) {
+        return false;
+      }
+    }
+  }
+
+  // The targets must not exist yet and their files must exist.
+  for (Json::Value const& t : effects["targets"]) {
+    if (mf.FindTargetToUse(t["name"].asString())) {
+      return false;
+    }
+    Json::Value const& properties = t["properties"];
+    for (auto p = properties.begin(); p != properties.end(); ++p) {
+      std::string const name = p.name();
+      if (!cmHasLiteralPrefix(name, "IMPORTED_LOCATION") &&
+          !cmHasLiteralPrefix(name, "IMPORTED_IMPLIB")) {
+        continue;
+      }
+      std::string const path = p->asString();
+      if (cmSystemTools::FileIsFullPath(path) &&
+          path.find("$<") == std::string::npos &&
+          !fsCache.FileExists(path)) {
+        return false;
+      }
+    }
+  }
+  for (Json::Value const& a : effects["aliases"]) {
+    if (mf.FindTargetToUse(a["name"].asString())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void cmFindPackageCache::Apply(cmMakefile& mf, Json::Value const& entry)
+{
+  cmake* cm = mf.GetCMakeInstance();
+  cmState* state = mf.GetState();
+
+  // The files are inputs of any load being recorded.
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    for (Json::Value const& f : entry["listFiles"]) {
+      r->ListFiles.insert(f["path"].asString());
+    }
+    for (Json::Value const& d : entry["directories"]) {
+      r->Directories.insert(d["path"].asString());
+    }
+  }
+
+  Json::Value const& effects = entry["effects"];
+
+  for (Json::Value const& c : effects["cache"]) {
+    std::string const name = c["name"].asString();
+    Json::Value const& after = c["after"];
+    if (after.isNull()) {
+      state->RemoveCacheEntry(name);
+      continue;
+    }
+    if (!CacheValueMatches(state, name, after)) {
+      cm->AddCacheEntry(name, after["value"].asString(), std::string(),
+                        cmState::StringToCacheEntryType(
+                          after["type"].asString()));
+    }
+    Json::Value const& properties = c["properties"];
+    for (std::string const& prop : state->GetCacheEntryPropertyList(name)) {
+      if (!properties.isMember(prop)) {
+        state->RemoveCacheEntryProperty(name, prop);
+      }
+    }
+    for (auto p = properties.begin(); p != properties.end(); ++p) {
+      state->SetCacheEntryProperty(name, p.name(), p->asString());
+    }
+  }
+
+  for (Json::Value const& v : effects["variables"]) {
+    std::string const name = v["name"].asString();
+    if (v.isMember("value")) {
+      mf.AddDefinition(name, v["value"].asString());
+    } else {
+      mf.RemoveDefinition(name);
+    }
+  }
+
+  for (Json::Value const& c : effects["commands"]) {
+    std::vector<std::string> args;
+    for (Json::Value const& a : c["args"]) {
+      args.emplace_back(a.asString());
+    }
+    std::vector<cmListFileFunction> body;
+    body.reserve(c["body"].size());
+    for (Json::Value const& f : c["body"]) {
+      body.emplace_back(FunctionFromJson(f));
+    }
+    cmListFileContext context;
+    context.Name = c["kind"].asString();
+    context.FilePath = c["file"].asString();
+    context.Line = static_cast<long>(c["line"].asInt64());
+    cmPolicies::PolicyMap const policies =
+      PoliciesFromString(c["policies"].asString());
+    if (c["kind"] == "macro") {
+      cmDefineMacro(mf, args, std::move(body), context, policies);
+    } else {
+      cmDefineFunction(mf, args, std::move(body), context, policies);
+    }
+  }
+
+  for (Json::Value const& t : effects["targets"]) {
+    // Create the target with the policies and backtrace it was created
+    // with, which are those of the package files rather than the caller.
+    cmMakefile::BacktracePushPop backtraceScope(
+      &mf, BacktraceFromJson(mf.GetBacktrace(), t["backtrace"]));
+    cmMakefile::PolicyPushPop policyScope(
+      &mf, PoliciesFromString(t["policies"].asString()));
+    cmTarget* target = mf.AddImportedTarget(
+      t["name"].asString(),
+      static_cast<cmStateEnums::TargetType>(t["type"].asInt()),
+      t["global"].asBool());
+    Json::Value const& properties = t["properties"];
+    for (auto p = properties.begin(); p != properties.end(); ++p) {
+      target->SetProperty(p.name(), p->asString());
+    }
+  }
+  for (Json::Value const& a : effects["aliases"]) {
+    std::string const name = a["target"].asString();
+    cmTarget* target = mf.FindTargetToUse(name);
+    mf.AddAlias(a["name"].asString(), name,
+                !target || !target->IsImported() ||
+                  target->IsImportedGloballyVisible());
+  }
+
+  for (Json::Value const& p : effects["globalProperties"]) {
+    std::string const name = p["name"].asString();
+    cm::optional<std::string> value =
+      ApplyPropertyChange(p, state->GetGlobalProperty(name));
+    if (value) {
+      cm->SetProperty(name, *value);
+    } else {
+      cm->SetProperty(name, nullptr);
+    }
+  }
+  for (Json::Value const& p : effects["directoryProperties"]) {
+    std::string const name = p["name"].asString();
+    cm::optional<std::string> value =
+      ApplyPropertyChange(p, mf.GetProperty(name));
+    if (value) {
+      mf.SetProperty(name, *value);
+    } else {
+      mf.SetProperty(name, nullptr);
+    }
+  }
+}
+
+cmFindPackageCache::Recording::Recording(cmFindPackageCache& cache,
+                                         cmMakefile& mf,
+                                         std::string const& package,
+                                         std::string const& file,
+                                         bool globalScope)
+  : Cache(cache)
+  , Recorder(cm::make_unique<cmFindPackageCacheRecorder>())
+{
+  cmFindPackageCacheRecorder& r = *this->Recorder;
+  r.Parent = cache.Active;
+  r.Makefile = &mf;
+  r.Package = package;
+  r.File = file;
+  r.GlobalScope = globalScope;
+  r.Snapshot = mf.GetStateSnapshot();
+  r.Backtrace = mf.GetBacktrace();
+  // An error issued before cannot be told apart from one in the load.
+  r.Replayable = !cmSystemTools::GetErrorOccurredFlag() &&
+    !cmSystemTools::GetFatalErrorOccurred();
+
+  for (std::string const& name : r.Snapshot.ClosureKeys()) {
+    if (cmValue value = r.Snapshot.GetDefinition(name)) {
+      r.Variables.emplace(name, *value);
+    }
+  }
+  cmState* state = mf.GetState();
+  for (std::string const& key : state->GetCacheEntryKeys()) {
+    r.CacheEntries.emplace(key, GetCacheEntryState(state, key));
+  }
+  for (auto& p : state->GetGlobalPropertyList()) {
+    r.GlobalProperties.emplace(std::move(p));
+  }
+  cmStateDirectory const dir = r.Snapshot.GetDirectory();
+  for (std::string const& key : dir.GetPropertyKeys()) {
+    if (cmValue value = dir.GetProperty(key)) {
+      r.DirectoryProperties.emplace(key, *value);
+    }
+  }
+  r.ImportedTargets = mf.GetOwnedImportedTargets().size();
+  r.Targets = mf.GetTargets().size();
+  r.Aliases = mf.GetAliasTargets();
+
+  cache.Active = &r;
+}
+
+cmFindPackageCache::Recording::~Recording()
+{
+  if (this->Recorder) {
+    this->Cache.Active = this->Recorder->Parent;
+  }
+}
+
+void cmFindPackageCache::Recording::Finish(bool success)
+{
+  if (!this->Recorder) {
+    return;
+  }
+  // Do not record the queries made to store the recording.
+  this->Cache.Active = nullptr;
+  if (success) {
+    this->Cache.Store(*this->Recorder);
+  }
+  this->Cache.Active = this->Recorder->Parent;
+  this->Recorder.reset();
+}
+
+void cmFindPackageCache::Store(cmFindPackageCacheRecorder& r)
+{
+  if (!r.Replayable || cmSystemTools::GetErrorOccurredFlag() ||
+      cmSystemTools::GetFatalErrorOccurred()) {
+    return;
+  }
+
+  cmMakefile& mf = *r.Makefile;
+  cmake* cm = mf.GetCMakeInstance();
+  cmState* state = mf.GetState();
+
+  // Only imported targets can be replayed, and only if the load created
+  // every target it changed.
+  if (mf.GetTargets().size() != r.Targets) {
+    return;
+  }
+  auto const& owned = mf.GetOwnedImportedTargets();
+  std::set<cmTarget const*> created;
+  for (std::size_t i = r.ImportedTargets; i < owned.size(); ++i) {
+    created.insert(owned[i].get());
+  }
+  for (cmTarget const* target : r.ChangedTargets) {
+    if (!created.count(target)) {
+      return;
+    }
+  }
+  for (std::string const& name : r.ChangedTargetNames) {
+    if (!created.count(mf.FindTargetToUse(name))) {
+      return;
+    }
+  }
+  std::map<std::string, std::string> const aliases = mf.GetAliasTargets();
+
+  Json::Value entry(Json::objectValue);
+  entry["package"] = r.Package;
+  entry["file"] = r.File;
+  entry["global"] = r.GlobalScope;
+
+  Json::Value& listFiles = entry["listFiles"] = Json::arrayValue;
+  std::set<std::string> directories = r.Directories;
+  for (std::string const& path : r.ListFiles) {
+    FileStat stat;
+    if (!LoadFileStat(path, stat)) {
+      return;
+    }
+    Json::Value f(Json::objectValue);
+    f["path"] = path;
+    f["size"] = static_cast<Json::UInt64>(stat.Size);
+    f["mtime"] = static_cast<Json::UInt64>(stat.MTime);
+    f["hash"] = HashFile(path);
+    listFiles.append(std::move(f));
+    directories.insert(cmSystemTools::GetFilenamePath(path));
+  }
+  Json::Value& dirs = entry["directories"] = Json::arrayValue;
+  for (std::string const& path : directories) {
+    Json::Value d(Json::objectValue);
+    d["path"] = path;
+    d["hash"] = HashDirectory(cm->GetFileSystemCache(), path);
+    dirs.append(std::move(d));
+  }
+
+  // Record the values that the inputs had before the load.
+  Json::Value& variables = entry["variables"] = Json::arrayValue;
+  for (std::string const& name : r.VariableReads) {
+    auto v = r.Variables.find(name);
+    if (v != r.Variables.end()) {
+      variables.append(ValueToJson(name, cmValue(v->second)));
+      continue;
+    }
+    auto c = r.CacheEntries.find(name);
+    variables.append(ValueToJson(
+      name,
+      c != r.CacheEntries.end() && c->second.Initialized
+        ? cmValue(c->second.Value)
+        : cmValue(nullptr)));
+  }
+  Json::Value& cacheReads = entry["cache"] = Json::arrayValue;
+  for (std::string const& name : r.CacheReads) {
+    auto c = r.CacheEntries.find(name);
+    cacheReads.append(ValueToJson(name,
+                                  c != r.CacheEntries.end()
+                                    ? cmValue(c->second.Value)
+                                    : cmValue(nullptr)));
+  }
+  Json::Value& environment = entry["environment"] = Json::arrayValue;
+  for (auto const& e : r.EnvironmentReads) {
+    environment.append(ValueToJson(
+      e.first, e.second ? cmValue(*e.second) : cmValue(nullptr)));
+  }
+  Json::Value& fileTests = entry["fileTests"] = Json::arrayValue;
+  for (auto const& t : r.FileTests) {
+    Json::Value f(Json::objectValue);
+    f["test"] = t.first.first;
+    f["path"] = t.first.second;
+    f["result"] = t.second;
+    fileTests.append(std::move(f));
+  }
+  Json::Value& targets = entry["targets"] = Json::arrayValue;
+  for (std::string const& name : r.TargetQueries) {
+    cmTarget const* target = mf.FindTargetToUse(name);
+    bool const existed = target && !created.count(target) &&
+      (!aliases.count(name) || r.Aliases.count(name));
+    Json::Value t(Json::objectValue);
+    t["name"] = name;
+    t["exists"] = existed;
+    targets.append(std::move(t));
+  }
+  std::map<std::string, std::string> globalProperties;
+  for (auto& p : state->GetGlobalPropertyList()) {
+    globalProperties.emplace(std::move(p));
+  }
+  Json::Value& globalReads = entry["globalProperties"] = Json::arrayValue;
+  for (std::string const& name : r.GlobalPropertyReads) {
+    auto p = r.GlobalProperties.find(name);
+    if (p != r.GlobalProperties.end()) {
+      globalReads.append(ValueToJson(name, cmValue(p->second)));
+    } else if (globalProperties.count(name)) {
+      globalReads.append(ValueToJson(name, nullptr));
+    } else {
+      globalReads.append(ValueToJson(name, cm->GetProperty(name)));
+    }
+  }
+  cmStateDirectory const dir = r.Snapshot.GetDirectory();
+  std::map<std::string, std::string> directoryProperties;
+  for (std::string const& key : dir.GetPropertyKeys()) {
+    if (cmValue value = dir.GetProperty(key)) {
+      directoryProperties.emplace(key, *value);
+    }
+  }
+  Json::Value& directoryReads = entry["directoryProperties"] =
+    Json::arrayValue;
+  for (std::string const& name : r.DirectoryPropertyReads) {
+    auto p = r.DirectoryProperties.find(name);
+    if (p != r.DirectoryProperties.end()) {
+      directoryReads.append(ValueToJson(name, cmValue(p->second)));
+    } else if (directoryProperties.count(name)) {
+      directoryReads.append(ValueToJson(name, nullptr));
+    } else {
+      directoryReads.append(ValueToJson(name, mf.GetProperty(name)));
+    }
+  }
+
+  Json::Value& effects = entry["effects"] = Json::objectValue;
+
+  Json::Value& cacheEffects = effects["cache"] = Json::arrayValue;
+  std::vector<std::string> const cacheKeys = state->GetCacheEntryKeys();
+  std::set<std::string> cacheNames(cacheKeys.begin(), cacheKeys.end());
+  for (auto const& c : r.CacheEntries) {
+    cacheNames.insert(c.first);
+  }
+  for (std::string const& name : cacheNames) {
+    auto before = r.CacheEntries.find(name);
+    cm::optional<CacheEntryState> after;
+    if (state->GetCacheEntryValue(name)) {
+      after = GetCacheEntryState(state, name);
+    }
+    if (before != r.CacheEntries.end() && after && before->second == *after) {
+      continue;
+    }
+    // Searches that failed are repeated by a real load.
+    if (after && cmIsNOTFOUND(after->Value)) {
+      return;
+    }
+    Json::Value c(Json::objectValue);
+    c["name"] = name;
+    if (before != r.CacheEntries.end() && before->second.Initialized) {
+      c["before"] = CacheValueToJson(before->second);
+    }
+    if (after) {
+      c["after"] = CacheValueToJson(*after);
+      Json::Value& properties = c["properties"] = Json::objectValue;
+      for (auto const& p : after->Properties) {
+        properties[p.first] = p.second;
+      }
+    } else {
+      c["after"] = Json::nullValue;
+    }
+    cacheEffects.append(std::move(c));
+  }
+
+  Json::Value& variableEffects = effects["variables"] = Json::arrayValue;
+  std::unordered_set<std::string> remaining;
+  for (auto const& v : r.Variables) {
+    remaining.insert(v.first);
+  }
+  std::vector<std::string> names = r.Snapshot.ClosureKeys();
+  std::sort(names.begin(), names.end());
+  for (std::string const& name : names) {
+    cmValue value = r.Snapshot.GetDefinition(name);
+    if (!value) {
+      continue;
+    }
+    remaining.erase(name);
+    auto v = r.Variables.find(name);
+    if (v == r.Variables.end() || v->second != *value) {
+      variableEffects.append(ValueToJson(name, value));
+    }
+  }
+  std::vector<std::string> removed(remaining.begin(), remaining.end());
+  std::sort(removed.begin(), removed.end());
+  for (std::string const& name : removed) {
+    variableEffects.append(ValueToJson(name, nullptr));
+  }
+
+  effects["commands"] = r.Commands;
+
+  Json::Value& targetEffects = effects["targets"] = Json::arrayValue;
+  std::size_t const backtraceDepth = BacktraceDepth(r.Backtrace);
+  for (std::size_t i = r.ImportedTargets; i < owned.size(); ++i) {
+    cmTarget const* target = owned[i].get();
+    Json::Value t(Json::objectValue);
+    t["name"] = target->GetName();
+    t["type"] = static_cast<int>(target->GetType());
+    t["global"] = target->IsImportedGloballyVisible();
+    t["policies"] = PoliciesToString(target->GetPolicyMap());
+    t["backtrace"] = BacktraceToJson(target->GetBacktrace(), backtraceDepth);
+    Json::Value& properties = t["properties"] = Json::objectValue;
+    for (auto const& p : target->GetProperties().GetList()) {
+      properties[p.first] = p.second;
+    }
+    for (std::string const& name : SpecialTargetProperties()) {
+      if (cmValue value = target->GetProperty(name)) {
+        properties[name] = *value;
+      }
+    }
+    targetEffects.append(std::move(t));
+  }
+  Json::Value& aliasEffects = effects["aliases"] = Json::arrayValue;
+  for (auto const& a : aliases) {
+    if (!r.Aliases.count(a.first)) {
+      Json::Value v(Json::objectValue);
+      v["name"] = a.first;
+      v["target"] = a.second;
+      aliasEffects.append(std::move(v));
+    }
+  }
+
+  Json::Value& globalEffects = effects["globalProperties"] = Json::arrayValue;
+  for (auto const& p : globalProperties) {
+    auto before = r.GlobalProperties.find(p.first);
+    if (before == r.GlobalProperties.end()) {
+      globalEffects.append(PropertyChangeToJson(p.first, nullptr, &p.second));
+    } else if (before->second != p.second) {
+      globalEffects.append(
+        PropertyChangeToJson(p.first, &before->second, &p.second));
+    }
+  }
+  for (auto const& p : r.GlobalProperties) {
+    if (!globalProperties.count(p.first)) {
+      globalEffects.append(PropertyChangeToJson(p.first, &p.second, nullptr));
+    }
+  }
+  Json::Value& directoryEffects = effects["directoryProperties"] =
+    Json::arrayValue;
+  for (auto const& p : directoryProperties) {
+    // Replaying the macro definitions updates this one.
+    if (p.first == "MACROS"_s) {
+      continue;
+    }
+    auto before = r.DirectoryProperties.find(p.first);
+    if (before == r.DirectoryProperties.end()) {
+      directoryEffects.append(
+        PropertyChangeToJson(p.first, nullptr, &p.second));
+    } else if (before->second != p.second) {
+      directoryEffects.append(
+        PropertyChangeToJson(p.first, &before->second, &p.second));
+    }
+  }
+  for (auto const& p : r.DirectoryProperties) {
+    if (!directoryProperties.count(p.first)) {
+      directoryEffects.append(
+        PropertyChangeToJson(p.first, &p.second, nullptr));
+    }
+  }
+
+  std::vector<Json::Value>& entries =
+    this->Entries[MakeKey(r.Package, r.File, r.GlobalScope)];
+  entries.insert(entries.begin(), std::move(entry));
+  if (entries.size() > MaxRecordings) {
+    entries.resize(MaxRecordings);
+  }
+  this->Modified = true;
+}
+
+void cmFindPackageCache::OnVariableRead(std::string const& name)
+{
+  if (IsScopeVariable(name)) {
+    return;
+  }
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    r->VariableReads.insert(name);
+  }
+}
+
+void cmFindPackageCache::OnCacheRead(std::string const& name)
+{
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    r->CacheReads.insert(name);
+  }
+}
+
+void cmFindPackageCache::OnEnvironmentRead(std::string const& name)
+{
+  // Loads that change the environment are not recorded, so the first
+  // value read is the value before the load.
+  cm::optional<std::string> value;
+  std::string v;
+  if (cmSystemTools::GetEnv(name, v)) {
+    value = std::move(v);
+  }
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    r->EnvironmentReads.emplace(name, value);
+  }
+}
+
+void cmFindPackageCache::OnFileTest(cm::string_view test,
+                                    std::string const& path, bool result)
+{
+  // Tests that compare the times of two files are not recorded.
+  bool const recorded = test != "IS_NEWER_THAN"_s;
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    if (recorded) {
+      r->FileTests.emplace(std::make_pair(std::string(test), path), result);
+    } else {
+      r->Replayable = false;
+    }
+  }
+}
+
+void cmFindPackageCache::OnTargetQuery(std::string const& name)
+{
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    r->TargetQueries.insert(name);
+  }
+}
+
+void cmFindPackageCache::OnTargetChange(cmTarget const* target)
+{
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    r->ChangedTargets.insert(target);
+  }
+}
+
+void cmFindPackageCache::OnGlobalPropertyRead(std::string const& name)
+{
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    r->GlobalPropertyReads.insert(name);
+  }
+}
+
+void cmFindPackageCache::OnDirectoryPropertyRead(cmMakefile const* mf,
+                                                 std::string const& name)
+{
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    if (r->Makefile == mf) {
+      r->DirectoryPropertyReads.insert(name);
+    } else {
+      r->Replayable = false;
+    }
+  }
+}
+
+void cmFindPackageCache::RecordCommand(cmMakefile& mf,
+                                       cmListFileFunction const& lff)
+{
+  if (!this->Active) {
+    return;
+  }
+
+  // Commands defined by function() and macro() are recorded through the
+  // commands they run.  A built-in command replaced by one of them remains
+  // available with a leading underscore.
+  std::string const& lowerName = lff.LowerCaseName();
+  std::string const name = lowerName.substr(
+    std::min(lowerName.find_first_not_of('_'), lowerName.size()));
+  if (!mf.GetState()->IsBuiltinCommand(name)) {
+    return;
+  }
+
+  bool supported = true;
+  if (!IsRecordedCommand(name)) {
+    supported = false;
+  } else if (name == "file"_s) {
+    cm::optional<std::string> const mode = LiteralArgument(lff, 0);
+    if (mode == "GLOB"_s) {
+      // A non-recursive glob of an absolute path depends only on the
+      // entries of the directory it names.
+      std::vector<std::string> args;
+      mf.ExpandArguments(lff.Arguments(), args);
+      for (std::size_t i = 2; i < args.size() && supported; ++i) {
+        if (args[i] == "LIST_DIRECTORIES"_s || args[i] == "RELATIVE"_s) {
+          ++i;
+          continue;
+        }
+        if (args[i] == "CONFIGURE_DEPENDS"_s) {
+          continue;
+        }
+        std::string const dir = cmSystemTools::GetFilenamePath(args[i]);
+        if (!cmSystemTools::FileIsFullPath(dir) ||
+            dir.find_first_of("*?[") != std::string::npos) {
+          supported = false;
+          break;
+        }
+        for (cmFindPackageCacheRecorder* r = this->Active; r;
+             r = r->Parent) {
+          r->Directories.insert(dir);
+        }
+      }
+    } else {
+      supported = mode == "TO_CMAKE_PATH"_s || mode == "TO_NATIVE_PATH"_s ||
+        mode == "RELATIVE_PATH"_s;
+    }
+  } else if (name == "get_filename_component"_s) {
+    // Resolving symbolic links and searching for programs query the file
+    // system.
+    cm::optional<std::string> const mode = LiteralArgument(lff, 2);
+    supported = mode && *mode != "REALPATH"_s && *mode != "PROGRAM"_s;
+  } else if (name == "string"_s) {
+    cm::optional<std::string> const mode = LiteralArgument(lff, 0);
+    supported = mode && *mode != "TIMESTAMP"_s && *mode != "RANDOM"_s;
+  } else if (name == "set"_s || name == "unset"_s) {
+    // Changes of the environment are not recorded.
+    if (!lff.Arguments().empty()) {
+      std::string var = lff.Arguments()[0].Value;
+      if (var.find('$') != std::string::npos) {
+        mf.ExpandVariablesInString(var);
+      }
+      supported = !cmHasLiteralPrefix(var, "ENV{");
+    }
+  } else if (name == "message"_s) {
+    // Messages shown by default would be lost in a replay.
+    cm::optional<std::string> const mode = LiteralArgument(lff, 0);
+    supported = mode == "VERBOSE"_s || mode == "DEBUG"_s ||
+      mode == "TRACE"_s || mode == "CONFIGURE_LOG"_s;
+  } else if (name == "cmake_language"_s) {
+    cm::optional<std::string> const mode = LiteralArgument(lff, 0);
+    supported = mode && *mode != "DEFER"_s &&
+      *mode != "SET_DEPENDENCY_PROVIDER"_s;
+  } else if (cmHasLiteralPrefix(name, "target_")) {
+    // The target commands change targets through more than their
+    // properties.  Check the target they name instead.
+    cm::optional<std::string> const target = LiteralArgument(lff, 0);
+    if (target) {
+      for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+        r->ChangedTargetNames.insert(*target);
+      }
+    } else {
+      supported = false;
+    }
+  } else if (name == "get_cmake_property"_s) {
+    // Listings of variables and commands are not recorded as inputs.
+    cm::optional<std::string> const prop = LiteralArgument(lff, 1);
+    supported = prop && *prop != "VARIABLES"_s &&
+      *prop != "CACHE_VARIABLES"_s && *prop != "COMMANDS"_s &&
+      *prop != "MACROS"_s && *prop != "COMPONENTS"_s;
+  } else if (name == "set_property"_s) {
+    cm::optional<std::string> const scope = LiteralArgument(lff, 0);
+    supported =
+      scope == "GLOBAL"_s || scope == "TARGET"_s || scope == "CACHE"_s;
+  } else if (name == "get_property"_s) {
+    // Properties of cache entries, sources, tests and installed files are
+    // not recorded as inputs.
+    cm::optional<std::string> const scope = LiteralArgument(lff, 1);
+    supported = scope == "GLOBAL"_s || scope == "DIRECTORY"_s ||
+      scope == "TARGET"_s || scope == "VARIABLE"_s;
+  }
+
+  if (!supported) {
+    for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+      r->Replayable = false;
+    }
+  }
+}
+
+void cmFindPackageCache::RecordListFile(std::string const& file)
+{
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    r->ListFiles.insert(file);
+  }
+}
+
+void cmFindPackageCache::RecordRaiseScope(cmStateSnapshot const& snapshot)
+{
+  // Setting a variable in the scope that calls find_package cannot be
+  // replayed.
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    if (snapshot.HasSameVariableScope(r->Snapshot)) {
+      r->Replayable = false;
+    }
+  }
+}
+
+void cmFindPackageCache::RecordCommandDefinition(
+  cm::string_view kind, std::vector<std::string> const& args,
+  std::vector<cmListFileFunction> const& body,
+  cmListFileContext const& context, cmPolicies::PolicyMap const& policies)
+{
+  if (!this->Active) {
+    return;
+  }
+
+  Json::Value c(Json::objectValue);
+  c["kind"] = std::string(kind);
+  Json::Value& a = c["args"] = Json::arrayValue;
+  for (std::string const& arg : args) {
+    a.append(arg);
+  }
+  Json::Value& b = c["body"] = Json::arrayValue;
+  for (cmListFileFunction const& function : body) {
+    b.append(FunctionToJson(function));
+  }
+  c["file"] = context.FilePath;
+  c["line"] = static_cast<Json::Int64>(context.Line);
+  c["policies"] = PoliciesToString(policies);
+
+  for (cmFindPackageCacheRecorder* r = this->Active; r; r = r->Parent) {
+    r->Commands.append(c);
+  }
+}
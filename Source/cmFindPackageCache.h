@@ -0,0 +1,164 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cm/string_view>
+
+#include <cm3p/json/value.h>
+
+#include "cmPolicies.h"
+
+class cmListFileContext;
+class cmListFileFunction;
+class cmMakefile;
+class cmStateSnapshot;
+class cmTarget;
+struct cmFindPackageCacheRecorder;
+
+/** \class cmFindPackageCache
+ * \brief Persistent cache of package configuration files loaded by
+ *        find_package.
+ *
+ * Loading a package configuration file is recorded: the listfiles it
+ * reads, the variables, cache entries, environment variables, files and
+ * targets it queries, and its effects on
+ * variables, cache entries, properties, commands and imported targets.
+ * When a later configure run loads the same file while all recorded
+ * inputs are unchanged, the recorded effects are applied instead.
+ * Imported targets are created again with the policies and the backtrace
+ * that they were first created with.
+ *
+ * A load is recorded only if it runs nothing but commands whose effects
+ * and inputs are known, and does nothing that cannot be replayed, such as
+ * creating targets that are not imported, searching for files, or
+ * changing targets that it did not create.
+ */
+class cmFindPackageCache
+{
+public:
+  cmFindPackageCache(std::string cacheFile);
+  ~cmFindPackageCache();
+
+  cmFindPackageCache(cmFindPackageCache const&) = delete;
+  cmFindPackageCache& operator=(cmFindPackageCache const&) = delete;
+
+  /** Load entries stored by a previous run.  Returns false if the cache
+      file does not exist or is not in the expected format.  */
+  bool Load();
+
+  /** Save all entries if any changed.  */
+  bool Save() const;
+
+  /** Apply the effects recorded for loading the given configuration file
+      of a package if its inputs are unchanged.  Returns false if the file
+      must be loaded instead.  */
+  bool Replay(cmMakefile& mf, std::string const& package,
+              std::string const& file, bool globalScope);
+
+  /** Records a load of a package configuration file while it exists.  */
+  class Recording
+  {
+  public:
+    Recording(cmFindPackageCache& cache, cmMakefile& mf,
+              std::string const& package, std::string const& file,
+              bool globalScope);
+    ~Recording();
+
+    Recording(Recording const&) = delete;
+    Recording& operator=(Recording const&) = delete;
+
+    /** Stop recording.  The recording is stored if the load succeeded
+        and can be replayed.  */
+    void Finish(bool success);
+
+  private:
+    cmFindPackageCache& Cache;
+    std::unique_ptr<cmFindPackageCacheRecorder> Recorder;
+  };
+
+  // Notifications about the inputs and effects of a load being recorded.
+  void RecordVariableRead(std::string const& name)
+  {
+    if (this->Active) {
+      this->OnVariableRead(name);
+    }
+  }
+  void RecordTargetQuery(std::string const& name)
+  {
+    if (this->Active) {
+      this->OnTargetQuery(name);
+    }
+  }
+  void RecordTargetChange(cmTarget const* target)
+  {
+    if (this->Active) {
+      this->OnTargetChange(target);
+    }
+  }
+  void RecordCacheRead(std::string const& name)
+  {
+    if (this->Active) {
+      this->OnCacheRead(name);
+    }
+  }
+  void RecordEnvironmentRead(std::string const& name)
+  {
+    if (this->Active) {
+      this->OnEnvironmentRead(name);
+    }
+  }
+  void RecordFileTest(cm::string_view test, std::string const& path,
+                      bool result)
+  {
+    if (this->Active) {
+      this->OnFileTest(test, path, result);
+    }
+  }
+  void RecordGlobalPropertyRead(std::string const& name)
+  {
+    if (this->Active) {
+      this->OnGlobalPropertyRead(name);
+    }
+  }
+  void RecordDirectoryPropertyRead(cmMakefile const* mf,
+                                   std::string const& name)
+  {
+    if (this->Active) {
+      this->OnDirectoryPropertyRead(mf, name);
+    }
+  }
+  void RecordCommand(cmMakefile& mf, cmListFileFunction const& lff);
+  void RecordListFile(std::string const& file);
+  void RecordRaiseScope(cmStateSnapshot const& snapshot);
+  void RecordCommandDefinition(cm::string_view kind,
+                               std::vector<std::string> const& args,
+                               std::vector<cmListFileFunction> const& body,
+                               cmListFileContext const& context,
+                               cmPolicies::PolicyMap const& policies);
+
+private:
+  void OnVariableRead(std::string const& name);
+  void OnCacheRead(std::string const& name);
+  void OnEnvironmentRead(std::string const& name);
+  void OnFileTest(cm::string_view test, std::string const& path, bool result);
+  void OnTargetQuery(std::string const& name);
+  void OnTargetChange(cmTarget const* target);
+  void OnGlobalPropertyRead(std::string const& name);
+  void OnDirectoryPropertyRead(cmMakefile const* mf, std::string const& name);
+  void Store(cmFindPackageCacheRecorder& recorder);
+
+  bool IsValid(cmMakefile& mf, Json::Value& record);
+  void Apply(cmMakefile& mf, Json::Value const& record);
+
+  std::string CacheFile;
+  std::unordered_map<std::string, std::vector<Json::Value>> Entries;
+  cmFindPackageCacheRecorder* Active = nullptr;
+  bool Modified = false;
+};
@@ -27,6 +27,7 @@
 #include "cmDependencyProvider.h"
 #include "cmExecutionStatus.h"
 #include "cmExperimental.h"
+#include "cmFileSystemCache.h"
 #include "cmList.h"
 #include "cmListFileCache.h"
 #include "cmMakefile.h"
@@ -43,6 +44,11 @@
 #include "cmValue.h"
 #include "cmVersion.h"
 #include "cmWindowsRegistry.h"
+#include "cmake.h"
+
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmFindPackageCache.h"
+#endif
 
 #if defined(__HAIKU__)
 #  include <FindDirectory.h>
@@ -114,14 +120,6 @@ public:
 };
 #endif
 
-bool isDirentryToIgnore(char const* const fname)
-{
-  assert(fname);
-  assert(fname[0] != 0);
-  return fname[0] == '.' &&
-    (fname[1] == 0 || (fname[1] == '.' && fname[2] == 0));
-}
-
 class cmAppendPathSegmentGenerator
 {
 public:
@@ -173,8 +171,10 @@ private:
 class cmCaseInsensitiveDirectoryListGenerator
 {
 public:
-  cmCaseInsensitiveDirectoryListGenerator(cm::string_view name)
-    : DirName{ name }
+  cmCaseInsensitiveDirectoryListGenerator(cmFileSystemCache& cache,
+                                          cm::string_view name)
+    : Cache{ cache }
+    , DirName{ name }
   {
   }
 
@@ -183,20 +183,16 @@ public:
     if (!this->Loaded) {
       this->CurrentIdx = 0ul;
       this->Loaded = true;
-      if (!this->DirectoryLister.Load(parent)) {
-        return {};
-      }
+      // Copy the names because the search may run version files, which
+      // may use the cache for other searches.
+      this->Entries = this->Cache.get().GetDirectoryEntries(parent);
     }
 
-    while (this->CurrentIdx < this->DirectoryLister.GetNumberOfFiles()) {
-      char const* const fname =
-        this->DirectoryLister.GetFile(this->CurrentIdx++);
-      if (isDirentryToIgnore(fname)) {
-        continue;
-      }
-      if (cmsysString_strcasecmp(fname, this->DirName.data()) == 0) {
+    while (this->CurrentIdx < this->Entries.size()) {
+      std::string const& fname = this->Entries[this->CurrentIdx++];
+      if (cmsysString_strcasecmp(fname.c_str(), this->DirName.data()) == 0) {
         auto candidate = cmStrCat(parent, fname, '/');
-        if (cmSystemTools::FileIsDirectory(candidate)) {
+        if (this->Cache.get().FileIsDirectory(candidate)) {
           return candidate;
         }
       }
@@ -207,18 +203,21 @@ public:
   void Reset() { this->Loaded = false; }
 
 private:
-  cmsys::Directory DirectoryLister;
+  std::reference_wrapper<cmFileSystemCache> Cache;
+  std::vector<std::string> Entries;
   cm::string_view const DirName;
-  unsigned long CurrentIdx = 0ul;
+  std::size_t CurrentIdx = 0;
   bool Loaded = false;
 };
 
 class cmDirectoryListGenerator
 {
 public:
-  cmDirectoryListGenerator(std::vector<std::string> const* names,
+  cmDirectoryListGenerator(cmFileSystemCache& cache,
+                           std::vector<std::string> const* names,
                            bool exactMatch)
-    : Names{ names }
+    : Cache{ cache }
+    , Names{ names }
     , ExactMatch{ exactMatch }
     , Current{ this->Matches.cbegin() }
   {
@@ -231,27 +230,13 @@ public:
   {
     // Construct a list of matches if not yet
     if (this->Matches.empty()) {
-      cmsys::Directory directoryLister;
-      // ALERT `Directory::Load()` keeps only names
-      // internally and LOST entry type from `dirent`.
-      // So, `Directory::FileIsDirectory` gonna use
-      // `SystemTools::FileIsDirectory()` and waste a syscall.
-      // TODO Need to enhance the `Directory` class.
-      directoryLister.Load(parent);
-
-      // ATTENTION Is it guaranteed that first two entries are
-      // `.` and `..`?
-      // TODO If so, just start with index 2 and drop the
-      // `isDirentryToIgnore(i)` condition to check.
-      for (auto i = 0ul; i < directoryLister.GetNumberOfFiles(); ++i) {
-        char const* const fname = directoryLister.GetFile(i);
-        // Skip entries to ignore or that aren't directories.
-        if (isDirentryToIgnore(fname)) {
-          continue;
-        }
-
+      cmFileSystemCache& cache = this->Cache;
+      // The cache remembers which entries are directories, so searches
+      // of other packages in the same parent do not check them again.
+      for (std::string const& fname : cache.GetDirectoryEntries(parent)) {
+        // Skip entries that aren't directories.
         if (!this->Names) {
-          if (directoryLister.FileIsDirectory(i)) {
+          if (cache.FileIsDirectory(cmStrCat(parent, fname))) {
             this->Matches.emplace_back(fname);
           }
         } else {
@@ -262,11 +247,11 @@ public:
             // Skip entries that don't match.
             auto const equal =
               ((this->ExactMatch
-                  ? cmsysString_strcasecmp(fname, name.c_str())
-                  : cmsysString_strncasecmp(fname, name.c_str(),
+                  ? cmsysString_strcasecmp(fname.c_str(), name.c_str())
+                  : cmsysString_strncasecmp(fname.c_str(), name.c_str(),
                                             name.length())) == 0);
             if (equal) {
-              if (directoryLister.FileIsDirectory(i)) {
+              if (cache.FileIsDirectory(cmStrCat(parent, fname))) {
                 this->Matches.emplace_back(fname);
               }
               break;
@@ -298,6 +283,7 @@ protected:
   virtual void OnMatchesLoaded() {}
   virtual std::string TransformNameBeforeCmp(std::string same) { return same; }
 
+  std::reference_wrapper<cmFileSystemCache> Cache;
   std::vector<std::string> const* Names;
   bool const ExactMatch;
   std::vector<std::string> Matches;
@@ -307,11 +293,12 @@ protected:
 class cmProjectDirectoryListGenerator : public cmDirectoryListGenerator
 {
 public:
-  cmProjectDirectoryListGenerator(std::vector<std::string> const* names,
+  cmProjectDirectoryListGenerator(cmFileSystemCache& cache,
+                                  std::vector<std::string> const* names,
                                   cmFindPackageCommand::SortOrderType so,
                                   cmFindPackageCommand::SortDirectionType sd,
                                   bool exactMatch)
-    : cmDirectoryListGenerator{ names, exactMatch }
+    : cmDirectoryListGenerator{ cache, names, exactMatch }
     , SortOrder{ so }
     , SortDirection{ sd }
   {
@@ -336,9 +323,10 @@ private:
 class cmMacProjectDirectoryListGenerator : public cmDirectoryListGenerator
 {
 public:
-  cmMacProjectDirectoryListGenerator(std::vector<std::string> const* names,
+  cmMacProjectDirectoryListGenerator(cmFileSystemCache& cache,
+                                     std::vector<std::string> const* names,
                                      cm::string_view ext)
-    : cmDirectoryListGenerator{ names, true }
+    : cmDirectoryListGenerator{ cache, names, true }
     , Extension{ ext }
   {
   }
@@ -356,9 +344,10 @@ private:
 class cmAnyDirectoryListGenerator : public cmProjectDirectoryListGenerator
 {
 public:
-  cmAnyDirectoryListGenerator(cmFindPackageCommand::SortOrderType so,
+  cmAnyDirectoryListGenerator(cmFileSystemCache& cache,
+                              cmFindPackageCommand::SortOrderType so,
                               cmFindPackageCommand::SortDirectionType sd)
-    : cmProjectDirectoryListGenerator(nullptr, so, sd, false)
+    : cmProjectDirectoryListGenerator(cache, nullptr, so, sd, false)
   {
   }
 };
@@ -1599,7 +1588,7 @@ bool cmFindPackageCommand::HandlePackageMode(
       // The package has been found.
       found = true;
       result = this->ReadPackage();
-    } else if (this->ReadListFile(this->FileFound, DoPolicyScope)) {
+    } else if (this->ReadConfigFile()) {
       // The package has been found.
       found = true;
 
@@ -1977,6 +1966,39 @@ bool cmFindPackageCommand::ReadListFile(std::string const& f,
   return false;
 }
 
+bool cmFindPackageCommand::ReadConfigFile()
+{
+#ifndef CMAKE_BOOTSTRAP
+  cmake* cm = this->Makefile->GetCMakeInstance();
+  cmFindPackageCache* cache = cm->GetFindPackageCache();
+  // Loads without a policy scope and traced loads are not replayed.
+  if (!cache || !this->PolicyScope || cm->GetTrace()) {
+    return this->ReadListFile(this->FileFound, DoPolicyScope);
+  }
+
+  if (cache->Replay(*this->Makefile, this->Name, this->FileFound,
+                    this->GlobalScope)) {
+    return true;
+  }
+
+  cmFindPackageCache::Recording recording(
+    *cache, *this->Makefile, this->Name, this->FileFound, this->GlobalScope);
+  bool const result = this->ReadListFile(this->FileFound, DoPolicyScope);
+
+  // Do not record a load that reports the package as not found.  Look up
+  // the result directly so it does not count as an input of the load.
+  std::string const foundVar = cmStrCat(this->Name, "_FOUND"_s);
+  cmValue found = this->Makefile->GetStateSnapshot().GetDefinition(foundVar);
+  if (!found) {
+    found = this->Makefile->GetState()->GetInitializedCacheValue(foundVar);
+  }
+  recording.Finish(result && (!found || found.IsOn()));
+  return result;
+#else
+  return this->ReadListFile(this->FileFound, DoPolicyScope);
+#endif
+}
+
 bool cmFindPackageCommand::ReadPackage()
 {
   // Resolve any transitive dependencies for the root file.
@@ -2789,7 +2811,8 @@ bool cmFindPackageCommand::FindConfigFile(std::string const& dir,
     if (this->DebugModeEnabled()) {
       this->DebugBuffer = cmStrCat(this->DebugBuffer, "  ", file, '\n');
     }
-    if (cmSystemTools::FileExists(file, true) && this->CheckVersion(file)) {
+    if (this->FileSystemCache.FileExists(file, true) &&
+        this->CheckVersion(file)) {
       // Allow resolving symlinks when the config file is found through a link
       if (this->UseRealPath) {
         file = cmSystemTools::GetRealPath(file);
@@ -2944,14 +2967,16 @@ bool cmFindPackageCommand::CheckVersion(std::string const& config_file)
 
     // Look for foo-config-version.cmake
     std::string version_file = cmStrCat(version_file_base, "-version.cmake");
-    if (!haveResult && cmSystemTools::FileExists(version_file, true)) {
+    if (!haveResult &&
+        this->FileSystemCache.FileExists(version_file, true)) {
       result = this->CheckVersionFile(version_file, version);
       haveResult = true;
     }
 
     // Look for fooConfigVersion.cmake
     version_file = cmStrCat(version_file_base, "Version.cmake");
-    if (!haveResult && cmSystemTools::FileExists(version_file, true)) {
+    if (!haveResult &&
+        this->FileSystemCache.FileExists(version_file, true)) {
       result = this->CheckVersionFile(version_file, version);
       haveResult = true;
     }
@@ -3096,7 +3121,7 @@ bool cmFindPackageCommand::SearchPrefix(std::string const& prefix)
   assert(!prefix.empty() && prefix.back() == '/');
 
   // Skip this if the prefix does not exist.
-  if (!cmSystemTools::FileIsDirectory(prefix)) {
+  if (!this->FileSystemCache.FileIsDirectory(prefix)) {
     return false;
   }
 
@@ -3115,15 +3140,16 @@ bool cmFindPackageCommand::SearchPrefix(std::string const& prefix)
     return this->SearchDirectory(fullPath, type);
   };
 
-  auto iCpsGen = cmCaseInsensitiveDirectoryListGenerator{ "cps"_s };
-  auto iCMakeGen = cmCaseInsensitiveDirectoryListGenerator{ "cmake"_s };
+  cmFileSystemCache& cache = this->FileSystemCache;
+  auto iCpsGen = cmCaseInsensitiveDirectoryListGenerator{ cache, "cps"_s };
+  auto iCMakeGen = cmCaseInsensitiveDirectoryListGenerator{ cache, "cmake"_s };
   auto anyDirGen =
-    cmAnyDirectoryListGenerator{ this->SortOrder, this->SortDirection };
+    cmAnyDirectoryListGenerator{ cache, this->SortOrder, this->SortDirection };
   auto cpsPkgDirGen =
-    cmProjectDirectoryListGenerator{ &this->Names, this->SortOrder,
+    cmProjectDirectoryListGenerator{ cache, &this->Names, this->SortOrder,
                                      this->SortDirection, true };
   auto cmakePkgDirGen =
-    cmProjectDirectoryListGenerator{ &this->Names, this->SortOrder,
+    cmProjectDirectoryListGenerator{ cache, &this->Names, this->SortOrder,
                                      this->SortDirection, false };
 
   // PREFIX/(Foo|foo|FOO)/(cps|CPS)/
@@ -3175,7 +3201,7 @@ bool cmFindPackageCommand::SearchPrefix(std::string const& prefix)
   }
 
   auto secondPkgDirGen =
-    cmProjectDirectoryListGenerator{ &this->Names, this->SortOrder,
+    cmProjectDirectoryListGenerator{ cache, &this->Names, this->SortOrder,
                                      this->SortDirection, false };
 
   // PREFIX/(Foo|foo|FOO).*/(cmake|CMake)/(Foo|foo|FOO).*/
@@ -3268,14 +3294,15 @@ bool cmFindPackageCommand::SearchFrameworkPrefix(std::string const& prefix)
     return this->SearchDirectory(fullPath, type);
   };
 
-  auto iCMakeGen = cmCaseInsensitiveDirectoryListGenerator{ "cmake"_s };
-  auto iCpsGen = cmCaseInsensitiveDirectoryListGenerator{ "cps"_s };
+  cmFileSystemCache& cache = this->FileSystemCache;
+  auto iCMakeGen = cmCaseInsensitiveDirectoryListGenerator{ cache, "cmake"_s };
+  auto iCpsGen = cmCaseInsensitiveDirectoryListGenerator{ cache, "cps"_s };
   auto fwGen =
-    cmMacProjectDirectoryListGenerator{ &this->Names, ".framework"_s };
+    cmMacProjectDirectoryListGenerator{ cache, &this->Names, ".framework"_s };
   auto rGen = cmAppendPathSegmentGenerator{ "Resources"_s };
   auto vGen = cmAppendPathSegmentGenerator{ "Versions"_s };
   auto anyGen =
-    cmAnyDirectoryListGenerator{ this->SortOrder, this->SortDirection };
+    cmAnyDirectoryListGenerator{ cache, this->SortOrder, this->SortDirection };
 
   // <prefix>/Foo.framework/Versions/*/Resources/CPS/
   if (TryGeneratedPaths(searchFn, pdt::Cps, prefix, fwGen, vGen, anyGen, rGen,
@@ -3319,12 +3346,15 @@ bool cmFindPackageCommand::SearchAppBundlePrefix(std::string const& prefix)
     return this->SearchDirectory(fullPath, type);
   };
 
-  auto appGen = cmMacProjectDirectoryListGenerator{ &this->Names, ".app"_s };
+  cmFileSystemCache& cache = this->FileSystemCache;
+  auto appGen =
+    cmMacProjectDirectoryListGenerator{ cache, &this->Names, ".app"_s };
   auto crGen = cmAppendPathSegmentGenerator{ "Contents/Resources"_s };
 
   // <prefix>/Foo.app/Contents/Resources/CPS/
-  if (TryGeneratedPaths(searchFn, pdt::Cps, prefix, appGen, crGen,
-                        cmCaseInsensitiveDirectoryListGenerator{ "cps"_s })) {
+  if (TryGeneratedPaths(
+        searchFn, pdt::Cps, prefix, appGen, crGen,
+        cmCaseInsensitiveDirectoryListGenerator{ cache, "cps"_s })) {
     return true;
   }
 
@@ -3336,7 +3366,7 @@ bool cmFindPackageCommand::SearchAppBundlePrefix(std::string const& prefix)
   // <prefix>/Foo.app/Contents/Resources/CMake/
   return TryGeneratedPaths(
     searchFn, pdt::CMake, prefix, appGen, crGen,
-    cmCaseInsensitiveDirectoryListGenerator{ "cmake"_s });
+    cmCaseInsensitiveDirectoryListGenerator{ cache, "cmake"_s });
 }
 
 bool cmFindPackageCommand::SearchEnvironmentPrefix(std::string const& prefix)
@@ -3344,7 +3374,7 @@ bool cmFindPackageCommand::SearchEnvironmentPrefix(std::string const& prefix)
   assert(!prefix.empty() && prefix.back() == '/');
 
   // Skip this if the prefix does not exist.
-  if (!cmSystemTools::FileIsDirectory(prefix)) {
+  if (!this->FileSystemCache.FileIsDirectory(prefix)) {
     return false;
   }
 
@@ -3353,8 +3383,9 @@ bool cmFindPackageCommand::SearchEnvironmentPrefix(std::string const& prefix)
     return this->SearchDirectory(fullPath, type);
   };
 
+  cmFileSystemCache& cache = this->FileSystemCache;
   auto pkgDirGen =
-    cmProjectDirectoryListGenerator{ &this->Names, this->SortOrder,
+    cmProjectDirectoryListGenerator{ cache, &this->Names, this->SortOrder,
                                      this->SortDirection, true };
 
   // <environment-path>/(Foo|foo|FOO)/cps/
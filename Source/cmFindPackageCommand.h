@@ -145,6 +145,7 @@ private:
     DoPolicyScope
   };
   bool ReadListFile(std::string const& f, PolicyScopeRule psr);
+  bool ReadConfigFile();
   bool ReadPackage();
 
   struct Appendix
@@ -8,6 +8,7 @@
 
 #include "cmsys/Glob.hxx"
 
+#include "cmFileSystemCache.h"
 #include "cmFindCommon.h"
 #include "cmStateTypes.h"
 #include "cmStringAlgorithms.h"
@@ -91,7 +92,7 @@ std::string cmFindPathCommand::FindHeaderInFramework(
     if (!frameWorkName.empty()) {
       std::string fpath = cmStrCat(dir, frameWorkName, ".framework");
       std::string intPath = cmStrCat(fpath, "/Headers/", fileName);
-      if (cmSystemTools::FileExists(intPath) &&
+      if (this->FileSystemCache.FileExists(intPath) &&
           this->Validate(this->IncludeFileInPath ? intPath : fpath)) {
         if (this->DebugState) {
           this->DebugState->FoundAt(intPath);
@@ -134,7 +135,7 @@ std::string cmFindPathCommand::FindNormalHeader()
   for (std::string const& n : this->Names) {
     for (std::string const& sp : this->SearchPaths) {
       tryPath = cmStrCat(sp, n);
-      if (cmSystemTools::FileExists(tryPath) &&
+      if (this->FileSystemCache.FileExists(tryPath) &&
           this->Validate(this->IncludeFileInPath ? tryPath : sp)) {
         if (this->DebugState) {
           this->DebugState->FoundAt(tryPath);
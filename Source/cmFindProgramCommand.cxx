@@ -7,6 +7,7 @@
 
 #include <cm/memory>
 
+#include "cmFileSystemCache.h"
 #include "cmFindCommon.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
@@ -16,6 +17,7 @@
 #include "cmSystemTools.h"
 #include "cmValue.h"
 #include "cmWindowsRegistry.h"
+#include "cmake.h"
 
 class cmExecutionStatus;
 
@@ -32,6 +34,7 @@ struct cmFindProgramHelper
     : DebugState(debugState)
     , Makefile(makefile)
     , FindBase(base)
+    , FileSystemCache(makefile->GetCMakeInstance()->GetFileSystemCache())
     , PolicyCMP0109(makefile->GetPolicyStatus(cmPolicies::CMP0109))
   {
 #if defined(_WIN32) || defined(__CYGWIN__) || defined(__MINGW32__)
@@ -56,6 +59,7 @@ struct cmFindProgramHelper
   cmFindCommonDebugState* DebugState;
   cmMakefile* Makefile;
   cmFindBase const* FindBase;
+  cmFileSystemCache& FileSystemCache;
 
   cmPolicies::PolicyStatus PolicyCMP0109;
 
@@ -111,6 +115,10 @@ struct cmFindProgramHelper
   }
   bool FileIsExecutable(std::string const& file) const
   {
+    // Most names are not in most directories of the search path.
+    if (!this->FileSystemCache.FileMayExist(file)) {
+      return false;
+    }
     if (!this->FileIsExecutableCMP0109(file)) {
       return false;
     }
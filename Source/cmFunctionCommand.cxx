@@ -20,6 +20,11 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmFindPackageCache.h"
+#  include "cmake.h"
+#endif
+
 namespace {
 std::string const ARGC = "ARGC";
 std::string const ARGN = "ARGN";
@@ -163,18 +168,10 @@ bool cmFunctionFunctionBlocker::Replay(
   std::vector<cmListFileFunction> functions, cmExecutionStatus& status)
 {
   cmMakefile& mf = status.GetMakefile();
-  // create a new command and add it to cmake
-  cmFunctionHelperCommand f;
-  f.Args = this->Args;
-  f.Functions = std::move(functions);
-  f.FilePath = this->GetStartingContext().FilePath;
-  f.Line = this->GetStartingContext().Line;
-  mf.RecordPolicies(f.Policies);
-  return mf.GetState()->AddScriptedCommand(
-    this->Args.front(),
-    BT<cmState::Command>(std::move(f),
-                         mf.GetBacktrace().Push(this->GetStartingContext())),
-    mf);
+  cmPolicies::PolicyMap policies;
+  mf.RecordPolicies(policies);
+  return cmDefineFunction(mf, this->Args, std::move(functions),
+                          this->GetStartingContext(), policies);
 }
 
 } // anonymous namespace
@@ -194,3 +191,28 @@ bool cmFunctionCommand(std::vector<std::string> const& args,
 
   return true;
 }
+
+bool cmDefineFunction(cmMakefile& mf, std::vector<std::string> const& args,
+                      std::vector<cmListFileFunction> functions,
+                      cmListFileContext const& context,
+                      cmPolicies::PolicyMap const& policies)
+{
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        mf.GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordCommandDefinition("function"_s, args, functions, context,
+                                   policies);
+  }
+#endif
+
+  // create a new command and add it to cmake
+  cmFunctionHelperCommand f;
+  f.Args = args;
+  f.Functions = std::move(functions);
+  f.FilePath = context.FilePath;
+  f.Line = context.Line;
+  f.Policies = policies;
+  return mf.GetState()->AddScriptedCommand(
+    args.front(),
+    BT<cmState::Command>(std::move(f), mf.GetBacktrace().Push(context)), mf);
+}
@@ -3,44 +3,318 @@
 #include "cmGccDepfileLexerHelper.h"
 
 #include <algorithm>
-#include <cstdio>
 #include <string>
 #include <vector>
 
 #include "cmGccDepfileReaderTypes.h"
 
-#include "LexerParser/cmGccDepfileLexer.h"
-
 #ifdef _WIN32
 #  include <cctype>
 
-#  include "cmsys/Encoding.h"
+#  include <windows.h>
+
+#  include "cmsys/Encoding.hxx"
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+
+#  include <sys/mman.h>
+#  include <sys/stat.h>
 #endif
 
-bool cmGccDepfileLexerHelper::readFile(char const* filePath)
+namespace {
+
+// A read-only view of a whole file, mapped into memory when possible.
+class DepfileView
 {
+public:
+  DepfileView() = default;
+  DepfileView(DepfileView const&) = delete;
+  DepfileView& operator=(DepfileView const&) = delete;
+  ~DepfileView();
+
+  bool open(char const* filePath);
+  char const* begin() const { return this->Data; }
+  char const* end() const { return this->Data + this->Size; }
+
+private:
+  char const* Data = "";
+  std::size_t Size = 0;
+  bool Mapped = false;
+  std::string Buffer;
+};
+
 #ifdef _WIN32
-  wchar_t* wpath = cmsysEncoding_DupToWide(filePath);
-  FILE* file = _wfopen(wpath, L"rb");
-  free(wpath);
+bool DepfileView::open(char const* filePath)
+{
+  HANDLE file =
+    CreateFileW(cmsys::Encoding::ToWide(filePath).c_str(), GENERIC_READ,
+                FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+  // An empty file cannot be mapped and has nothing to read.
+  if (size.QuadPart > 0) {
+    HANDLE mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) {
+      void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+      if (view) {
+        this->Data = static_cast<char const*>(view);
+        this->Size = static_cast<std::size_t>(size.QuadPart);
+        this->Mapped = true;
+      }
+    }
+  }
+  // Read files that cannot be mapped.
+  if (!this->Mapped) {
+    char buf[16384];
+    DWORD n;
+    do {
+      if (!ReadFile(file, buf, static_cast<DWORD>(sizeof(buf)), &n,
+                    nullptr)) {
+        CloseHandle(file);
+        return false;
+      }
+      this->Buffer.append(buf, static_cast<std::size_t>(n));
+    } while (n > 0);
+    this->Data = this->Buffer.data();
+    this->Size = this->Buffer.size();
+  }
+  CloseHandle(file);
+  return true;
+}
+
+DepfileView::~DepfileView()
+{
+  if (this->Mapped) {
+    UnmapViewOfFile(this->Data);
+  }
+}
 #else
-  FILE* file = fopen(filePath, "r");
+bool DepfileView::open(char const* filePath)
+{
+  int fd = ::open(filePath, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  // An empty file cannot be mapped and has nothing to read.
+  if (st.st_size > 0 && S_ISREG(st.st_mode)) {
+    void* view = mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                      PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view != MAP_FAILED) {
+      this->Data = static_cast<char const*>(view);
+      this->Size = static_cast<std::size_t>(st.st_size);
+      this->Mapped = true;
+    }
+  }
+  // Read files that cannot be mapped, such as pipes.
+  if (!this->Mapped) {
+    char buf[16384];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+      this->Buffer.append(buf, static_cast<std::size_t>(n));
+    }
+    if (n < 0) {
+      close(fd);
+      return false;
+    }
+    this->Data = this->Buffer.data();
+    this->Size = this->Buffer.size();
+  }
+  close(fd);
+  return true;
+}
+
+DepfileView::~DepfileView()
+{
+  if (this->Mapped) {
+    munmap(const_cast<char*>(this->Data), this->Size);
+  }
+}
 #endif
-  if (!file) {
+
+// Characters that end a span of plain text in a file name.
+struct SpecialCharacters
+{
+  bool Table[256] = {};
+  SpecialCharacters()
+  {
+    for (unsigned char c : { '\0', '\t', '\n', '\r', ' ', '$', ':', '\\' }) {
+      this->Table[c] = true;
+    }
+  }
+  bool operator()(char c) const
+  {
+    return this->Table[static_cast<unsigned char>(c)];
+  }
+};
+SpecialCharacters const isSpecial;
+
+bool isSpace(char c)
+{
+  return c == ' ' || c == '\t';
+}
+
+// Length of the newline at the given position, if any.
+std::size_t newlineLength(char const* cur, char const* end)
+{
+  if (cur != end && cur[0] == '\n') {
+    return 1;
+  }
+  if (end - cur >= 2 && cur[0] == '\r' && cur[1] == '\n') {
+    return 2;
+  }
+  return 0;
+}
+
+} // anonymous namespace
+
+bool cmGccDepfileLexerHelper::readFile(char const* filePath)
+{
+  DepfileView view;
+  if (!view.open(filePath)) {
     return false;
   }
   this->newEntry();
-  yyscan_t scanner;
-  cmGccDepfile_yylex_init(&scanner);
-  cmGccDepfile_yyset_extra(this, scanner);
-  cmGccDepfile_yyrestart(file, scanner);
-  cmGccDepfile_yylex(scanner);
-  cmGccDepfile_yylex_destroy(scanner);
+  this->scan(view.begin(), view.end());
   this->sanitizeContent();
-  fclose(file);
   return this->HelperState != State::Failed;
 }
 
+void cmGccDepfileLexerHelper::scan(char const* cur, char const* end)
+{
+  while (cur != end) {
+    if (!isSpecial(*cur)) {
+      // Got a span of plain text.
+      char const* const start = cur;
+      do {
+        ++cur;
+      } while (cur != end && !isSpecial(*cur));
+      this->addToCurrentPath(start, cur - start);
+      continue;
+    }
+
+    std::size_t newline;
+    switch (*cur) {
+      case '$':
+        // Unescape the dollar sign.
+        this->addToCurrentPath("$", 1);
+        cur += (end - cur >= 2 && cur[1] == '$') ? 2 : 1;
+        break;
+      case '\\':
+        cur = this->scanBackslashes(cur, end);
+        break;
+      case ' ':
+      case '\t':
+        // Rules and dependencies are separated by blocks of whitespace,
+        // which may end in a line continuation.
+        do {
+          ++cur;
+        } while (cur != end && isSpace(*cur));
+        if (cur != end && *cur == '\\' &&
+            (newline = newlineLength(cur + 1, end))) {
+          cur += 1 + newline;
+        }
+        this->newRuleOrDependency();
+        break;
+      case ':':
+        ++cur;
+        if ((newline = newlineLength(cur, end))) {
+          // A newline after colon terminates current rule.
+          this->newDependency();
+          this->newEntry();
+          cur += newline;
+        } else if (cur != end && isSpace(*cur)) {
+          // A colon followed by space ends the rules and starts a new
+          // dependency.
+          do {
+            ++cur;
+          } while (cur != end && isSpace(*cur));
+          this->newDependency();
+        } else if (cur != end && *cur == '\\' &&
+                   (newline = newlineLength(cur + 1, end))) {
+          // So does a colon followed by a line continuation.
+          cur += 1 + newline;
+          this->newDependency();
+        } else {
+          this->addToCurrentPath(":", 1);
+        }
+        break;
+      case '\n':
+      case '\r':
+        if ((newline = newlineLength(cur, end))) {
+          // A newline ends the current file name and the current rule.
+          this->newEntry();
+          cur += newline;
+        } else {
+          this->addToCurrentPath(cur, 1);
+          ++cur;
+        }
+        break;
+      default:
+        // A null character adds nothing.
+        ++cur;
+        break;
+    }
+  }
+}
+
+char const* cmGccDepfileLexerHelper::scanBackslashes(char const* cur,
+                                                     char const* end)
+{
+  char const* last = cur;
+  while (last + 1 != end && last[1] == '\\') {
+    ++last;
+  }
+  std::size_t const count = last - cur + 1;
+  char const* const next = last + 1;
+
+  if (next != end && *next == ' ') {
+    if (count % 2 == 1) {
+      // 2N+1 backslashes plus space -> N backslashes plus space.
+      std::string s(count / 2, '\\');
+      s.push_back(' ');
+      this->addToCurrentPath(s.data(), s.size());
+    } else {
+      // 2N backslashes plus space -> 2N backslashes, end of filename.
+      this->addToCurrentPath(cur, count);
+      this->newDependency();
+    }
+    return next + 1;
+  }
+
+  // Other backslashes are taken literally, except that the last one may
+  // escape the following character.
+  this->addToCurrentPath(cur, count - 1);
+  if (next != end) {
+    if (*next == '#' || *next == ':') {
+      // Unescape the hash or the colon.
+      this->addToCurrentPath(next, 1);
+      return next + 1;
+    }
+    if (std::size_t const newline = newlineLength(next, end)) {
+      // A line continuation ends the current file name.
+      this->newRuleOrDependency();
+      return next + newline;
+    }
+  }
+  this->addToCurrentPath(last, 1);
+  return next;
+}
+
 void cmGccDepfileLexerHelper::newEntry()
 {
   if (this->HelperState == State::Rule && !this->Content.empty()) {
@@ -84,7 +358,7 @@ void cmGccDepfileLexerHelper::newRuleOrDependency()
   }
 }
 
-void cmGccDepfileLexerHelper::addToCurrentPath(char const* s)
+void cmGccDepfileLexerHelper::addToCurrentPath(char const* s, std::size_t n)
 {
   if (this->Content.empty()) {
     return;
@@ -107,7 +381,7 @@ void cmGccDepfileLexerHelper::addToCurrentPath(char const* s)
     case State::Failed:
       return;
   }
-  dst->append(s);
+  dst->append(s, n);
 }
 
 void cmGccDepfileLexerHelper::sanitizeContent()
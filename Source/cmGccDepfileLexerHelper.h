@@ -2,6 +2,7 @@
    file LICENSE.rst or https://cmake.org/licensing for details.  */
 #pragma once
 
+#include <cstddef>
 #include <utility>
 
 #include <cmGccDepfileReaderTypes.h>
@@ -14,14 +15,18 @@ public:
   bool readFile(char const* filePath);
   cmGccDepfileContent extractContent() && { return std::move(this->Content); }
 
+private:
+  // The lexer
+  void scan(char const* cur, char const* end);
+  char const* scanBackslashes(char const* cur, char const* end);
+
   // Functions called by the lexer
   void newEntry();
   void newRule();
   void newDependency();
   void newRuleOrDependency();
-  void addToCurrentPath(char const* s);
+  void addToCurrentPath(char const* s, std::size_t n);
 
-private:
   void sanitizeContent();
 
   cmGccDepfileContent Content;
@@ -34,5 +39,3 @@ private:
   };
   State HelperState = State::Rule;
 };
-
-#define YY_EXTRA_TYPE cmGccDepfileLexerHelper*
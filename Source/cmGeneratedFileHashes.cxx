@@ -0,0 +1,124 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmGeneratedFileHashes.h"
+
+#include <utility>
+#include <vector>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmFileTime.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+namespace {
+bool StatFile(std::string const& name, unsigned long long& size,
+              long long& mtime)
+{
+  cmFileTime ft;
+  if (!ft.Load(name)) {
+    return false;
+  }
+  size = cmSystemTools::FileLength(name);
+  mtime = ft.GetTime();
+  return true;
+}
+}
+
+cmGeneratedFileHashes::cmGeneratedFileHashes(std::string manifestFile)
+  : ManifestFile(std::move(manifestFile))
+{
+}
+
+void cmGeneratedFileHashes::Load()
+{
+  cmsys::ifstream fin(this->ManifestFile.c_str());
+  if (!fin) {
+    return;
+  }
+  // Each line holds "<hash> <size> <mtime> <path>".
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::string::size_type const p1 = line.find(' ');
+    std::string::size_type const p2 =
+      p1 == std::string::npos ? p1 : line.find(' ', p1 + 1);
+    std::string::size_type const p3 =
+      p2 == std::string::npos ? p2 : line.find(' ', p2 + 1);
+    if (p3 == std::string::npos) {
+      continue;
+    }
+    // Skip lines that do not parse.  Their files are written as usual.
+    Entry entry;
+    if (!cmStrToULongLong(line.substr(p1 + 1, p2 - p1 - 1), &entry.Size) ||
+        !cmStrToLongLong(line.substr(p2 + 1, p3 - p2 - 1), &entry.MTime)) {
+      continue;
+    }
+    entry.Hash = line.substr(0, p1);
+    this->Entries[line.substr(p3 + 1)] = std::move(entry);
+  }
+}
+
+bool cmGeneratedFileHashes::Save()
+{
+  // Verify files recorded in this run only now that all of them have been
+  // replaced, possibly by deferred commits.  Only the files whose content
+  // changed, or was compared, are read.
+  cmCryptoHash md5(cmCryptoHash::AlgoMD5);
+
+  cmsys::ofstream fout(this->ManifestFile.c_str());
+  if (!fout) {
+    return false;
+  }
+  fout << "# Hashes of files generated by CMake.\n";
+  for (auto& e : this->Entries) {
+    Entry& entry = e.second;
+    if (!entry.Used) {
+      continue;
+    }
+    if (entry.Pending) {
+      if (md5.HashFile(e.first) != entry.Hash ||
+          !StatFile(e.first, entry.Size, entry.MTime)) {
+        continue;
+      }
+    }
+    fout << entry.Hash << ' ' << entry.Size << ' ' << entry.MTime << ' '
+         << e.first << '\n';
+  }
+  return static_cast<bool>(fout);
+}
+
+bool cmGeneratedFileHashes::IsCurrent(std::string const& name,
+                                      cm::string_view content,
+                                      std::string& hash)
+{
+  cmCryptoHash md5(cmCryptoHash::AlgoMD5);
+  hash = md5.HashString(content);
+
+  auto i = this->Entries.find(name);
+  if (i == this->Entries.end() || i->second.Hash != hash) {
+    return false;
+  }
+  Entry& entry = i->second;
+  if (!entry.Pending) {
+    unsigned long long size;
+    long long mtime;
+    if (!StatFile(name, size, mtime) || size != entry.Size ||
+        mtime != entry.MTime) {
+      return false;
+    }
+  }
+  entry.Used = true;
+  return true;
+}
+
+void cmGeneratedFileHashes::Record(std::string const& name, std::string hash)
+{
+  Entry& entry = this->Entries[name];
+  entry.Hash = std::move(hash);
+  entry.Used = true;
+  entry.Pending = true;
+}
@@ -0,0 +1,53 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <unordered_map>
+
+#include <cm/string_view>
+
+/** \class cmGeneratedFileHashes
+ * \brief Manifest of the content of files written by a generate step.
+ *
+ * Records the content hash, size and modification time of each
+ * copy-if-different file generated.  A later generate step that produces
+ * the same content for a file whose size and modification time still
+ * match the record neither writes the file nor reads it back to compare.
+ */
+class cmGeneratedFileHashes
+{
+public:
+  cmGeneratedFileHashes(std::string manifestFile);
+
+  /** Load the records of the previous generate step.  */
+  void Load();
+
+  /** Save the records of all files generated by this generate step.
+      Files not generated by it are forgotten.  */
+  bool Save();
+
+  /** Return whether the file named is known to hold the given content.
+      The hash of the content is returned in the last argument.  */
+  bool IsCurrent(std::string const& name, cm::string_view content,
+                 std::string& hash);
+
+  /** Record that the file named has been replaced by, or compared equal
+      to, content with the given hash.  */
+  void Record(std::string const& name, std::string hash);
+
+private:
+  struct Entry
+  {
+    std::string Hash;
+    unsigned long long Size = 0;
+    long long MTime = 0;
+    bool Used = false;
+    bool Pending = false;
+  };
+
+  std::string ManifestFile;
+  std::unordered_map<std::string, Entry> Entries;
+};
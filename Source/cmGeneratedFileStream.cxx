@@ -4,7 +4,11 @@
 
 #include <cstdio>
 #include <locale>
+#include <utility>
 
+#include <cm/memory>
+
+#include "cmGeneratedFileHashes.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
@@ -14,8 +18,14 @@
 #  include "cm_codecvt.hxx"
 #endif
 
+namespace {
+std::vector<cmGeneratedFileStream::DeferredCommit>* DeferredCommits = nullptr;
+cmGeneratedFileHashes* HashManifest = nullptr;
+}
+
 cmGeneratedFileStream::cmGeneratedFileStream(Encoding encoding)
 {
+  this->MayBuffer = encoding == codecvt_Encoding::None;
 #ifndef CMAKE_BOOTSTRAP
   if (encoding != codecvt_Encoding::None) {
     this->imbue(std::locale(this->getloc(), new codecvt(encoding)));
@@ -28,8 +38,10 @@ cmGeneratedFileStream::cmGeneratedFileStream(Encoding encoding)
 cmGeneratedFileStream::cmGeneratedFileStream(std::string const& name,
                                              bool quiet, Encoding encoding)
   : cmGeneratedFileStreamBase(name)
-  , Stream(this->TempName.c_str()) // NOLINT(cmake-use-cmsys-fstream)
 {
+  this->MayBuffer = encoding == codecvt_Encoding::None;
+  this->OpenTemporary();
+
   // Check if the file opened.
   if (!*this && !quiet) {
     cmSystemTools::Error("Cannot open file for write: " + this->TempName);
@@ -67,13 +79,8 @@ cmGeneratedFileStream& cmGeneratedFileStream::Open(std::string const& name,
   this->cmGeneratedFileStreamBase::Open(name);
 
   // Open the temporary output file.
-  if (binaryFlag) {
-    this->Stream::open( // NOLINT(cmake-use-cmsys-fstream)
-      this->TempName.c_str(), std::ios::out | std::ios::binary);
-  } else {
-    this->Stream::open( // NOLINT(cmake-use-cmsys-fstream)
-      this->TempName.c_str());
-  }
+  this->Binary = binaryFlag;
+  this->OpenTemporary();
 
   // Check if the file opened.
   if (!*this && !quiet) {
@@ -88,13 +95,49 @@ bool cmGeneratedFileStream::Close()
   // Save whether the temporary output file is valid before closing.
   this->Okay = !this->fail();
 
-  // Close the temporary output file.
-  this->Stream::close(); // NOLINT(cmake-use-cmsys-fstream)
+  // Close the temporary output file.  Content held in memory is written
+  // by the base, if needed.
+  if (this->Buffer) {
+    this->std::ostream::rdbuf(this->Stream::rdbuf());
+  } else {
+    this->Stream::close(); // NOLINT(cmake-use-cmsys-fstream)
+  }
 
   // Remove the temporary file (possibly by renaming to the real file).
   return this->cmGeneratedFileStreamBase::Close();
 }
 
+void cmGeneratedFileStream::OpenTemporary()
+{
+  // Hold the content in memory until it is known whether it needs to be
+  // written at all.
+  if (HashManifest && this->MayBuffer) {
+    this->Buffer = cm::make_unique<std::stringbuf>(std::ios::out);
+    this->std::ostream::rdbuf(this->Buffer.get());
+    return;
+  }
+
+  this->PrepareTemporary();
+  std::ios::openmode mode = std::ios::out;
+  if (this->Binary) {
+    mode |= std::ios::binary;
+  }
+  this->Stream::open( // NOLINT(cmake-use-cmsys-fstream)
+    this->TempName.c_str(), mode);
+}
+
+void cmGeneratedFileStream::WriteBufferToTemporary()
+{
+  std::string const content = this->Buffer->str();
+  std::ios::iostate const state = this->rdstate();
+  this->std::ostream::rdbuf(this->Stream::rdbuf());
+  this->Buffer.reset();
+  this->MayBuffer = false;
+  this->OpenTemporary();
+  this->setstate(state);
+  this->write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
 void cmGeneratedFileStream::SetCopyIfDifferent(bool copy_if_different)
 {
   this->CopyIfDifferent = copy_if_different;
@@ -142,7 +185,10 @@ void cmGeneratedFileStreamBase::Open(std::string const& name)
              cmSystemTools::RandomNumber() & 0xFFFFF);
     this->TempName += buf;
   }
+}
 
+void cmGeneratedFileStreamBase::PrepareTemporary()
+{
   // Make sure the temporary file that will be used is not present.
   cmSystemTools::RemoveFile(this->TempName);
 
@@ -159,6 +205,46 @@ bool cmGeneratedFileStreamBase::Close()
     resname += ".gz";
   }
 
+  // Write content held in memory to the temporary file unless the hash
+  // manifest knows that the destination already holds it.
+  if (this->Buffer) {
+    std::string const content = this->Buffer->str();
+    this->Buffer.reset();
+    std::string hash;
+    bool const useManifest = HashManifest && !this->Name.empty() &&
+      this->Okay && this->CopyIfDifferent && !this->Compress;
+    if (useManifest && HashManifest->IsCurrent(resname, content, hash)) {
+      this->Name.clear();
+      this->TempName.clear();
+      return false;
+    }
+    if (!this->Name.empty() && this->Okay) {
+      this->PrepareTemporary();
+      std::ios::openmode mode = std::ios::out;
+      if (this->Binary) {
+        mode |= std::ios::binary;
+      }
+      cmsys::ofstream fout(this->TempName.c_str(), mode);
+      fout.write(content.data(), static_cast<std::streamsize>(content.size()));
+      fout.close();
+      this->Okay = !fout.fail();
+      if (useManifest && this->Okay) {
+        HashManifest->Record(resname, std::move(hash));
+      }
+    }
+  }
+
+  // Leave a copy-if-different replacement to the deferred commit list.
+  // The temporary file is removed when the commit is performed, so
+  // forget about it here.
+  if (DeferredCommits && !this->Name.empty() && this->Okay &&
+      this->CopyIfDifferent && !this->Compress) {
+    DeferredCommits->push_back({ std::move(this->TempName), resname });
+    this->Name.clear();
+    this->TempName.clear();
+    return true;
+  }
+
   // Only consider replacing the destination file if no error
   // occurred.
   if (!this->Name.empty() && this->Okay &&
@@ -230,6 +316,32 @@ int cmGeneratedFileStreamBase::RenameFile(std::string const& oldname,
   return cmSystemTools::RenameFile(oldname, newname);
 }
 
+std::vector<cmGeneratedFileStream::DeferredCommit>*
+cmGeneratedFileStream::SetDeferredCommits(std::vector<DeferredCommit>* commits)
+{
+  std::vector<DeferredCommit>* previous = DeferredCommits;
+  DeferredCommits = commits;
+  return previous;
+}
+
+bool cmGeneratedFileStream::CommitDeferred(DeferredCommit const& commit)
+{
+  bool okay = true;
+  if (cmSystemTools::FilesDiffer(commit.TempName, commit.Name)) {
+    okay = cmSystemTools::RenameFile(commit.TempName, commit.Name);
+  }
+  cmSystemTools::RemoveFile(commit.TempName);
+  return okay;
+}
+
+cmGeneratedFileHashes* cmGeneratedFileStream::SetHashManifest(
+  cmGeneratedFileHashes* manifest)
+{
+  cmGeneratedFileHashes* previous = HashManifest;
+  HashManifest = manifest;
+  return previous;
+}
+
 void cmGeneratedFileStream::SetName(std::string const& fname)
 {
   this->Name = cmSystemTools::CollapseFullPath(fname);
@@ -243,6 +355,10 @@ void cmGeneratedFileStream::SetTempExt(std::string const& ext)
 void cmGeneratedFileStream::WriteAltEncoding(std::string const& data,
                                              Encoding encoding)
 {
+  // Alternate encodings are applied by the file buffer.
+  if (this->Buffer) {
+    this->WriteBufferToTemporary();
+  }
 #ifndef CMAKE_BOOTSTRAP
   std::locale prevLocale =
     this->imbue(std::locale(this->getloc(), new codecvt(encoding)));
@@ -4,12 +4,17 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "cmsys/FStream.hxx"
 
 #include "cm_codecvt_Encoding.hxx"
 
+class cmGeneratedFileHashes;
+
 // This is the first base class of cmGeneratedFileStream.  It will be
 // created before and destroyed after the ofstream portion and can
 // therefore be used to manage the temporary file.
@@ -33,6 +38,9 @@ protected:
   void Open(std::string const& name);
   bool Close();
 
+  // Remove a stale temporary file and create its directory.
+  void PrepareTemporary();
+
   // Internal file replacement implementation.
   int RenameFile(std::string const& oldname, std::string const& newname);
 
@@ -59,6 +67,16 @@ protected:
 
   // Whether the destination file is compressed
   bool CompressExtraExtension = true;
+
+  // The content written so far if it is held in memory instead of the
+  // temporary file.
+  std::unique_ptr<std::stringbuf> Buffer;
+
+  // Whether the content may be held in memory.
+  bool MayBuffer = true;
+
+  // Whether the temporary file is written in binary mode.
+  bool Binary = false;
 };
 
 /** \class cmGeneratedFileStream
@@ -157,4 +175,45 @@ public:
    * Afterward, the original encoding is restored.
    */
   void WriteAltEncoding(std::string const& data, codecvt_Encoding encoding);
+
+  /**
+   * A replacement of a destination file by its temporary file that has
+   * been postponed by a deferred commit list.
+   */
+  struct DeferredCommit
+  {
+    std::string TempName;
+    std::string Name;
+  };
+
+  /**
+   * Install a list to collect copy-if-different replacements instead of
+   * performing them when streams are closed.  The entries must later be
+   * passed to CommitDeferred.  Pass nullptr to restore immediate
+   * replacement.  Returns the previously installed list.
+   */
+  static std::vector<DeferredCommit>* SetDeferredCommits(
+    std::vector<DeferredCommit>* commits);
+
+  /**
+   * Replace the destination of a deferred commit by its temporary file
+   * if their contents differ, and remove the temporary file.  Distinct
+   * destinations may be committed concurrently.  Returns false if the
+   * destination had to be replaced but could not be.
+   */
+  static bool CommitDeferred(DeferredCommit const& commit);
+
+  /**
+   * Install a manifest of generated file hashes.  While installed,
+   * the content of streams is held in memory, and a copy-if-different
+   * destination recorded by the manifest with the same content is
+   * neither written nor compared.  Pass nullptr to uninstall it.
+   * Returns the previously installed manifest.
+   */
+  static cmGeneratedFileHashes* SetHashManifest(
+    cmGeneratedFileHashes* manifest);
+
+private:
+  void OpenTemporary();
+  void WriteBufferToTemporary();
 };
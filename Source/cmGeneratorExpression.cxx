@@ -4,11 +4,13 @@
 
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <memory>
 #include <stack>
 #include <utility>
 
 #include <cm/string_view>
+#include <cmext/string_view>
 
 #include "cmsys/RegularExpression.hxx"
 
@@ -78,6 +80,10 @@ std::string const& cmCompiledGeneratorExpression::Evaluate(
   }
 
   this->Output.clear();
+  this->HadContextSensitiveCondition = false;
+  this->HadHeadSensitiveCondition = false;
+  this->HadLinkLanguageSensitiveCondition = false;
+  this->SourceSensitiveTargets.clear();
 
   for (auto const& it : this->Evaluators) {
     this->Output += it->Evaluate(&context, dagChecker);
@@ -412,6 +418,36 @@ cm::string_view::size_type cmGeneratorExpression::Find(
   return cm::string_view::npos;
 }
 
+bool cmGeneratorExpression::IsConfigIndependent(cm::string_view input)
+{
+  static cm::string_view const wrappers[] = {
+    "$<BUILD_INTERFACE:"_s,
+    "$<BUILD_LOCAL_INTERFACE:"_s,
+    "$<INSTALL_INTERFACE:"_s,
+    "$<LINK_ONLY:"_s,
+  };
+  cm::string_view::size_type pos = 0;
+  while ((pos = input.find("$<", pos)) != cm::string_view::npos) {
+    cm::string_view const rest = input.substr(pos);
+    auto const wrapper =
+      std::find_if(std::begin(wrappers), std::end(wrappers),
+                   [rest](cm::string_view w) { return cmHasPrefix(rest, w); });
+    if (wrapper == std::end(wrappers)) {
+      return false;
+    }
+    // The wrapped value may not contain further generator expressions.
+    cm::string_view::size_type const close =
+      input.find('>', pos + wrapper->size());
+    if (close == cm::string_view::npos ||
+        input.substr(pos + 2, close - pos - 2).find("$<") !=
+          cm::string_view::npos) {
+      return false;
+    }
+    pos = close + 1;
+  }
+  return true;
+}
+
 bool cmGeneratorExpression::IsValidTargetName(std::string const& input)
 {
   // The ':' is supported to allow use with IMPORTED targets. At least
@@ -74,6 +74,13 @@ public:
 
   static bool IsValidTargetName(std::string const& input);
 
+  /** Whether the input evaluates to the same value in every
+      configuration for any head target.  Only plain values and values
+      whose generator expressions are one level of $<BUILD_INTERFACE>,
+      $<BUILD_LOCAL_INTERFACE>, $<INSTALL_INTERFACE> or $<LINK_ONLY>
+      are recognized.  */
+  static bool IsConfigIndependent(cm::string_view input);
+
   static std::string StripEmptyListElements(std::string const& input);
 
   static bool StartsWithGeneratorExpression(std::string const& input)
@@ -128,6 +135,10 @@ public:
   std::string const& GetInput() const { return this->Input; }
 
   cmListFileBacktrace GetBacktrace() const { return this->Backtrace; }
+  void SetBacktrace(cmListFileBacktrace backtrace)
+  {
+    this->Backtrace = std::move(backtrace);
+  }
   bool GetHadContextSensitiveCondition() const
   {
     return this->HadContextSensitiveCondition;
@@ -57,13 +57,40 @@ std::string cmGeneratorExpressionNode::EvaluateDependentExpression(
   cmGeneratorExpressionDAGChecker* dagChecker,
   cmGeneratorTarget const* currentTarget)
 {
-  cmGeneratorExpression ge(*lg->GetCMakeInstance(), context->Backtrace);
-  std::unique_ptr<cmCompiledGeneratorExpression> cge = ge.Parse(prop);
+  // A value without generator expressions evaluates to itself.
+  if (cmGeneratorExpression::Find(prop) == cm::string_view::npos) {
+    return prop;
+  }
+
+  // The same property values are evaluated for many head targets and
+  // configurations, so reuse their compilations.  A value may appear
+  // again while it is being evaluated, e.g. on a dependency that has the
+  // same usage requirements, so nested evaluations compile their own.
+  cmGlobalGenerator::DependentExpression& dependent =
+    lg->GetGlobalGenerator()->GetDependentExpression(prop);
+  std::unique_ptr<cmCompiledGeneratorExpression> nested;
+  cmCompiledGeneratorExpression* cge;
+  if (dependent.InUse) {
+    cmGeneratorExpression ge(*lg->GetCMakeInstance(), context->Backtrace);
+    nested = ge.Parse(prop);
+    cge = nested.get();
+  } else {
+    if (!dependent.Compiled) {
+      cmGeneratorExpression ge(*lg->GetCMakeInstance(), context->Backtrace);
+      dependent.Compiled = ge.Parse(prop);
+    }
+    cge = dependent.Compiled.get();
+    cge->SetBacktrace(context->Backtrace);
+    dependent.InUse = true;
+  }
   cge->SetEvaluateForBuildsystem(context->EvaluateForBuildsystem);
   cge->SetQuiet(context->Quiet);
   std::string result =
     cge->Evaluate(lg, context->Config, headTarget, dagChecker, currentTarget,
                   context->Language);
+  if (!nested) {
+    dependent.InUse = false;
+  }
   if (cge->GetHadContextSensitiveCondition()) {
     context->HadContextSensitiveCondition = true;
   }
@@ -18,6 +18,7 @@
 #include <cm/string_view>
 
 #include "cmAlgorithms.h"
+#include "cmAtom.h"
 #include "cmLinkItem.h"
 #include "cmListFileCache.h"
 #include "cmPolicies.h"
@@ -96,6 +97,11 @@ public:
   cmComputeLinkInformation* GetLinkInformation(
     std::string const& config) const;
 
+  /** Find the link information computed for another configuration whose
+      link entries are the same in every configuration, if any.  */
+  cmComputeLinkInformation const* FindConfigIndependentLinkInformation(
+    std::string const& linkLanguage) const;
+
   // Perform validation checks on memoized link structures.
   // Call this after generation is complete.
   void CheckLinkLibraries() const;
@@ -276,6 +282,10 @@ public:
     std::string const& config, cmGeneratorTarget const* headTarget,
     UseTo usage) const;
 
+  /** Whether the link interface libraries of this target are the same
+      in every configuration.  */
+  bool IsLinkInterfaceConfigIndependent() const;
+
   void ComputeLinkInterfaceLibraries(std::string const& config,
                                      cmOptionalLinkInterface& iface,
                                      cmGeneratorTarget const* head,
@@ -625,9 +635,36 @@ private:
   /** Return the name of the `.swiftmodule` file for this target. */
   std::string GetSwiftModuleFileName() const;
 
-  using ConfigAndLanguage = std::pair<std::string, std::string>;
+  /** Key of the caches below.  Its names are interned, so keys hash and
+      compare without looking at the characters.  */
+  struct ConfigAndLanguage
+  {
+    ConfigAndLanguage(cm::string_view config, cm::string_view language)
+      : Config(cmAtom::Intern(config))
+      , Language(cmAtom::Intern(language))
+    {
+    }
+
+    cmAtom Config;
+    cmAtom Language;
+
+    friend bool operator==(ConfigAndLanguage const& l,
+                           ConfigAndLanguage const& r)
+    {
+      return l.Config == r.Config && l.Language == r.Language;
+    }
+  };
+  struct ConfigAndLanguageHash
+  {
+    std::size_t operator()(ConfigAndLanguage const& key) const noexcept
+    {
+      return std::hash<cmAtom>{}(key.Config) * 31 +
+        std::hash<cmAtom>{}(key.Language);
+    }
+  };
   using ConfigAndLanguageToBTStrings =
-    std::map<ConfigAndLanguage, std::vector<BT<std::string>>>;
+    std::unordered_map<ConfigAndLanguage, std::vector<BT<std::string>>,
+                       ConfigAndLanguageHash>;
   mutable ConfigAndLanguageToBTStrings IncludeDirectoriesCache;
   mutable ConfigAndLanguageToBTStrings CompileOptionsCache;
   mutable ConfigAndLanguageToBTStrings CompileDefinitionsCache;
@@ -1217,6 +1254,7 @@ private:
   struct LinkImplClosure : public std::vector<cmGeneratorTarget const*>
   {
     bool Done = false;
+    bool ConfigIndependent = false;
   };
   mutable std::map<std::string, LinkImplClosure> LinkImplClosureForLinkMap;
   mutable std::map<std::string, LinkImplClosure> LinkImplClosureForUsageMap;
@@ -1310,6 +1348,14 @@ private:
   TargetPropertyEntryVector PrecompileHeadersEntries;
   TargetPropertyEntryVector SourceEntries;
   mutable std::set<std::string> LinkImplicitNullProperties;
+
+  /** Find the value of a usage requirement cached for another
+      configuration if the value is the same in every configuration.  */
+  std::vector<BT<std::string>> const* FindConfigIndependentUsageRequirement(
+    ConfigAndLanguageToBTStrings const& cache, std::string const& config,
+    std::string const& language, std::string const& interfaceProp,
+    TargetPropertyEntryVector const& entries) const;
+
   mutable std::map<std::string, std::string> PchHeaders;
   mutable std::map<std::string, std::string> PchSources;
   mutable std::map<std::string, std::string> PchObjectFiles;
@@ -1403,6 +1449,7 @@ private:
     Indeterminate = 0x2
   };
   mutable Tribool SourcesAreContextDependent = Tribool::Indeterminate;
+  mutable Tribool LinkInterfaceIsConfigIndependent = Tribool::Indeterminate;
 
   bool ComputePDBOutputDir(std::string const& kind, std::string const& config,
                            std::string& out) const;
@@ -229,6 +229,21 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetIncludeDirectories(
       return it->second;
     }
   }
+  // Implicit include directories of Swift and ISPC dependencies and
+  // framework include directories on Apple platforms are not covered.
+  if (lang != "Swift" && !this->IsApple() &&
+      !this->GetGlobalGenerator()->GetLanguageEnabled("ISPC")) {
+    if (auto const* shared = this->FindConfigIndependentUsageRequirement(
+          this->IncludeDirectoriesCache, config, lang,
+          "INTERFACE_INCLUDE_DIRECTORIES", this->IncludeDirectoriesEntries)) {
+      return this->IncludeDirectoriesCache.emplace(cacheKey, *shared)
+        .first->second;
+    }
+  }
+#ifndef CMAKE_BOOTSTRAP
+  auto profilingRAII =
+    ProfileTargetPropertyEvaluation(this, "INCLUDE_DIRECTORIES", config, lang);
+#endif
   std::vector<BT<std::string>> includes;
   std::unordered_set<std::string> uniqueIncludes;
 
@@ -68,6 +68,51 @@ void MaybeEnableCheckLinkLibraries(cmOptionalLinkInterface& iface)
     iface.CheckLinkLibraries = true;
   }
 }
+
+bool LinkEntriesAreConfigIndependent(cmBTStringRange entries)
+{
+  return std::all_of(entries.begin(), entries.end(),
+                     [](BT<std::string> const& entry) {
+                       return cmGeneratorExpression::IsConfigIndependent(
+                         entry.Value);
+                     });
+}
+
+// Copy the libraries of a link implementation computed for another
+// configuration if they are the same in every configuration.
+bool ReuseConfigIndependentLibraries(
+  std::map<std::string, cmOptionalLinkImplementation> const& implMap,
+  cmOptionalLinkImplementation& impl)
+{
+  for (auto const& other : implMap) {
+    if (&other.second != &impl && other.second.LibrariesDone &&
+        other.second.ConfigIndependent) {
+      static_cast<cmLinkImplementationLibraries&>(impl) = other.second;
+      impl.HadHeadSensitiveCondition = other.second.HadHeadSensitiveCondition;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Copy the libraries of a link interface computed for another
+// configuration.  The caller checks that they are the same in every
+// configuration, in which case they do not depend on the head target.
+bool ReuseConfigIndependentLibraries(
+  std::map<std::string, cmHeadToLinkInterfaceMap> const& ifaceMap,
+  cmOptionalLinkInterface& iface)
+{
+  for (auto const& other : ifaceMap) {
+    for (auto const& hmi : other.second) {
+      if (&hmi.second != &iface && hmi.second.LibrariesDone) {
+        static_cast<cmLinkInterfaceLibraries&>(iface) = hmi.second;
+        iface.Exists = hmi.second.Exists;
+        return true;
+      }
+    }
+  }
+  return false;
+}
 }
 
 class cmTargetCollectLinkLanguages
@@ -324,11 +369,23 @@ cmGeneratorTarget::GetLinkImplementationClosure(std::string const& config,
     return empty;
   }
 
-  LinkImplClosure& tgts =
-    (usage == UseTo::Compile ? this->LinkImplClosureForUsageMap[config]
-                             : this->LinkImplClosureForLinkMap[config]);
+  std::map<std::string, LinkImplClosure>& closureMap =
+    (usage == UseTo::Compile ? this->LinkImplClosureForUsageMap
+                             : this->LinkImplClosureForLinkMap);
+  LinkImplClosure& tgts = closureMap[config];
   if (!tgts.Done) {
     tgts.Done = true;
+
+    // Reuse the closure computed for another configuration if it is
+    // the same in every configuration.
+    for (auto const& other : closureMap) {
+      if (&other.second != &tgts && other.second.Done &&
+          other.second.ConfigIndependent) {
+        tgts = other.second;
+        return tgts;
+      }
+    }
+
     std::set<cmGeneratorTarget const*> emitted;
 
     cmLinkImplementationLibraries const* impl =
@@ -340,6 +397,12 @@ cmGeneratorTarget::GetLinkImplementationClosure(std::string const& config,
                    this->LocalGenerator->GetGlobalGenerator(), tgts, emitted,
                    usage);
     }
+
+    tgts.ConfigIndependent = impl->ConfigIndependent &&
+      std::all_of(tgts.begin(), tgts.end(),
+                  [](cmGeneratorTarget const* t) {
+                    return t->IsLinkInterfaceConfigIndependent();
+                  });
   }
   return tgts;
 }
@@ -367,6 +430,19 @@ cmComputeLinkInformation* cmGeneratorTarget::GetLinkInformation(
   return i->second.get();
 }
 
+cmComputeLinkInformation const*
+cmGeneratorTarget::FindConfigIndependentLinkInformation(
+  std::string const& linkLanguage) const
+{
+  for (auto const& info : this->LinkInformation) {
+    if (info.second && info.second->HasConfigIndependentLinkEntries() &&
+        info.second->GetLinkLanguage() == linkLanguage) {
+      return info.second.get();
+    }
+  }
+  return nullptr;
+}
+
 void cmGeneratorTarget::CheckLinkLibraries() const
 {
   bool linkLibrariesOnlyTargets =
@@ -658,7 +734,10 @@ cmLinkInterface const* cmGeneratorTarget::GetLinkInterface(
   MaybeEnableCheckLinkLibraries(iface);
   if (!iface.LibrariesDone) {
     iface.LibrariesDone = true;
-    this->ComputeLinkInterfaceLibraries(config, iface, head, UseTo::Link);
+    if (!this->IsLinkInterfaceConfigIndependent() ||
+        !ReuseConfigIndependentLibraries(this->LinkInterfaceMap, iface)) {
+      this->ComputeLinkInterfaceLibraries(config, iface, head, UseTo::Link);
+    }
   }
   if (!iface.AllDone) {
     iface.AllDone = true;
@@ -765,7 +844,13 @@ cmLinkInterfaceLibraries const* cmGeneratorTarget::GetLinkInterfaceLibraries(
   MaybeEnableCheckLinkLibraries(iface);
   if (!iface.LibrariesDone) {
     iface.LibrariesDone = true;
-    this->ComputeLinkInterfaceLibraries(config, iface, head, usage);
+    if (!this->IsLinkInterfaceConfigIndependent() ||
+        !ReuseConfigIndependentLibraries(
+          usage == UseTo::Compile ? this->LinkInterfaceUsageRequirementsOnlyMap
+                                  : this->LinkInterfaceMap,
+          iface)) {
+      this->ComputeLinkInterfaceLibraries(config, iface, head, usage);
+    }
   }
 
   return iface.Exists ? &iface : nullptr;
@@ -952,6 +1037,58 @@ cmLinkInterface const* cmGeneratorTarget::GetImportLinkInterface(
   return &iface;
 }
 
+bool cmGeneratorTarget::IsLinkInterfaceConfigIndependent() const
+{
+  if (this->LinkInterfaceIsConfigIndependent != Tribool::Indeterminate) {
+    return this->LinkInterfaceIsConfigIndependent == Tribool::True;
+  }
+
+  bool independent = true;
+  if (this->IsImported()) {
+    // The link interface of an imported target is taken from the import
+    // information of each configuration.  Compare it over every
+    // configuration that may be generated.
+    std::vector<std::string> configs =
+      this->Makefile->GetGeneratorConfigs(cmMakefile::IncludeEmptyConfig);
+    configs.emplace_back();
+    ImportInfo const* first = nullptr;
+    for (std::string const& config : configs) {
+      ImportInfo const* info = this->GetImportInfo(config);
+      if (!info) {
+        independent = false;
+      } else if (!first) {
+        first = info;
+        independent =
+          LinkEntriesAreConfigIndependent(cmMakeRange(info->Libraries)) &&
+          LinkEntriesAreConfigIndependent(
+            cmMakeRange(info->LibrariesHeadInclude)) &&
+          LinkEntriesAreConfigIndependent(
+            cmMakeRange(info->LibrariesHeadExclude));
+      } else {
+        independent = info->LibrariesProp == first->LibrariesProp &&
+          info->Libraries == first->Libraries &&
+          info->LibrariesHeadInclude == first->LibrariesHeadInclude &&
+          info->LibrariesHeadExclude == first->LibrariesHeadExclude;
+      }
+      if (!independent) {
+        break;
+      }
+    }
+  } else {
+    independent =
+      LinkEntriesAreConfigIndependent(
+        this->Target->GetLinkInterfaceEntries()) &&
+      LinkEntriesAreConfigIndependent(
+        this->Target->GetLinkInterfaceDirectEntries()) &&
+      LinkEntriesAreConfigIndependent(
+        this->Target->GetLinkInterfaceDirectExcludeEntries());
+  }
+
+  this->LinkInterfaceIsConfigIndependent =
+    independent ? Tribool::True : Tribool::False;
+  return independent;
+}
+
 cmHeadToLinkInterfaceMap& cmGeneratorTarget::GetHeadToLinkInterfaceMap(
   std::string const& config) const
 {
@@ -980,18 +1117,20 @@ cmLinkImplementation const* cmGeneratorTarget::GetLinkImplementation(
     return nullptr;
   }
 
+  LinkImplMapType& implMap =
+    (usage == UseTo::Compile ? this->LinkImplUsageRequirementsOnlyMap
+                             : this->LinkImplMap);
   cmOptionalLinkImplementation& impl =
-    (usage == UseTo::Compile
-       ? this
-           ->LinkImplUsageRequirementsOnlyMap[cmSystemTools::UpperCase(config)]
-       : this->LinkImplMap[cmSystemTools::UpperCase(config)]);
+    implMap[cmSystemTools::UpperCase(config)];
   if (secondPass) {
     impl = cmOptionalLinkImplementation();
   }
   MaybeEnableCheckLinkLibraries(impl);
   if (!impl.LibrariesDone) {
     impl.LibrariesDone = true;
-    this->ComputeLinkImplementationLibraries(config, impl, usage);
+    if (!ReuseConfigIndependentLibraries(implMap, impl)) {
+      this->ComputeLinkImplementationLibraries(config, impl, usage);
+    }
   }
   if (!impl.LanguagesDone) {
     impl.LanguagesDone = true;
@@ -1011,15 +1150,17 @@ cmGeneratorTarget::GetLinkImplementationLibraries(std::string const& config,
   }
 
   // Populate the link implementation libraries for this configuration.
+  LinkImplMapType& implMap =
+    (usage == UseTo::Compile ? this->LinkImplUsageRequirementsOnlyMap
+                             : this->LinkImplMap);
   cmOptionalLinkImplementation& impl =
-    (usage == UseTo::Compile
-       ? this
-           ->LinkImplUsageRequirementsOnlyMap[cmSystemTools::UpperCase(config)]
-       : this->LinkImplMap[cmSystemTools::UpperCase(config)]);
+    implMap[cmSystemTools::UpperCase(config)];
   MaybeEnableCheckLinkLibraries(impl);
   if (!impl.LibrariesDone) {
     impl.LibrariesDone = true;
-    this->ComputeLinkImplementationLibraries(config, impl, usage);
+    if (!ReuseConfigIndependentLibraries(implMap, impl)) {
+      this->ComputeLinkImplementationLibraries(config, impl, usage);
+    }
   }
   return &impl;
 }
@@ -1056,6 +1197,9 @@ void TransitiveLinkImpl::Follow(cmGeneratorTarget const* target)
   if (!target || !this->Followed.insert(target).second) {
     return;
   }
+  if (!target->IsLinkInterfaceConfigIndependent()) {
+    this->Impl.ConfigIndependent = false;
+  }
 
   // Get this target's usage requirements.
   cmLinkInterfaceLibraries const* iface =
@@ -1138,6 +1282,11 @@ void cmGeneratorTarget::ComputeLinkImplementationLibraries(
   cmMakefile const* mf = lg->GetMakefile();
   cmBTStringRange entryRange = this->Target->GetLinkImplementationEntries();
   auto const& synthTargetsForConfig = this->Configs[config].SyntheticDeps;
+  impl.ConfigIndependent = LinkEntriesAreConfigIndependent(entryRange) &&
+    std::all_of(this->Configs.begin(), this->Configs.end(),
+                [](std::pair<std::string const, InfoByConfig> const& c) {
+                  return c.second.SyntheticDeps.empty();
+                });
   // Collect libraries directly linked in this configuration.
   for (auto const& entry : entryRange) {
     // Keep this logic in sync with ExpandLinkItems.
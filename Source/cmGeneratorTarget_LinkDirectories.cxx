@@ -119,6 +119,10 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetLinkDirectories(
       return it->second;
     }
   }
+#ifndef CMAKE_BOOTSTRAP
+  auto profilingRAII = ProfileTargetPropertyEvaluation(
+    this, "LINK_DIRECTORIES", config, language);
+#endif
   std::vector<BT<std::string>> result;
   std::unordered_set<std::string> uniqueDirectories;
 
@@ -227,6 +227,15 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetCompileOptions(
       return it->second;
     }
   }
+  if (auto const* shared = this->FindConfigIndependentUsageRequirement(
+        this->CompileOptionsCache, config, language,
+        "INTERFACE_COMPILE_OPTIONS", this->CompileOptionsEntries)) {
+    return this->CompileOptionsCache.emplace(cacheKey, *shared).first->second;
+  }
+#ifndef CMAKE_BOOTSTRAP
+  auto profilingRAII =
+    ProfileTargetPropertyEvaluation(this, "COMPILE_OPTIONS", config, language);
+#endif
   std::vector<BT<std::string>> result;
   std::unordered_set<std::string> uniqueOptions;
 
@@ -316,6 +325,16 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetCompileDefinitions(
       return it->second;
     }
   }
+  if (auto const* shared = this->FindConfigIndependentUsageRequirement(
+        this->CompileDefinitionsCache, config, language,
+        "INTERFACE_COMPILE_DEFINITIONS", this->CompileDefinitionsEntries)) {
+    return this->CompileDefinitionsCache.emplace(cacheKey, *shared)
+      .first->second;
+  }
+#ifndef CMAKE_BOOTSTRAP
+  auto profilingRAII = ProfileTargetPropertyEvaluation(
+    this, "COMPILE_DEFINITIONS", config, language);
+#endif
   std::vector<BT<std::string>> list;
   std::unordered_set<std::string> uniqueOptions;
 
@@ -354,6 +373,10 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetPrecompileHeaders(
       return it->second;
     }
   }
+#ifndef CMAKE_BOOTSTRAP
+  auto profilingRAII = ProfileTargetPropertyEvaluation(
+    this, "PRECOMPILE_HEADERS", config, language);
+#endif
   std::unordered_set<std::string> uniqueOptions;
 
   cmGeneratorExpressionDAGChecker dagChecker{
@@ -410,6 +433,10 @@ std::vector<BT<std::string>> cmGeneratorTarget::GetLinkOptions(
       return it->second;
     }
   }
+#ifndef CMAKE_BOOTSTRAP
+  auto profilingRAII =
+    ProfileTargetPropertyEvaluation(this, "LINK_OPTIONS", config, language);
+#endif
   std::vector<BT<std::string>> result;
   std::unordered_set<std::string> uniqueOptions;
 
@@ -4,7 +4,9 @@
 #include "cmGeneratorTarget.h"
 /* clang-format on */
 
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -15,6 +17,7 @@
 #include <cm/string_view>
 #include <cmext/string_view>
 
+#include "cmAtom.h"
 #include "cmGeneratorExpression.h"
 #include "cmGeneratorExpressionContext.h"
 #include "cmGeneratorExpressionDAGChecker.h"
@@ -183,6 +186,71 @@ std::string cmGeneratorTarget::EvaluateInterfaceProperty(
   return result;
 }
 
+std::vector<BT<std::string>> const*
+cmGeneratorTarget::FindConfigIndependentUsageRequirement(
+  ConfigAndLanguageToBTStrings const& cache, std::string const& config,
+  std::string const& language, std::string const& interfaceProp,
+  TargetPropertyEntryVector const& entries) const
+{
+  using CacheEntry = ConfigAndLanguageToBTStrings::value_type;
+  cmAtom const languageAtom = cmAtom::Intern(language);
+  auto const other = std::find_if(
+    cache.begin(), cache.end(), [languageAtom](CacheEntry const& v) {
+      return v.first.Language == languageAtom;
+    });
+  if (other == cache.end()) {
+    return nullptr;
+  }
+
+  // The value does not depend on the configuration if neither this
+  // target's entries nor the interface property of any target in its
+  // link implementation closure do.
+  if (!std::all_of(entries.begin(), entries.end(),
+                   [](std::unique_ptr<TargetPropertyEntry> const& entry) {
+                     return cmGeneratorExpression::IsConfigIndependent(
+                       entry->GetInput());
+                   })) {
+    return nullptr;
+  }
+  // The language runtime libraries are selected per configuration, so
+  // they must be the same in the configuration whose result is taken.
+  cmLinkImplementation const* impl =
+    this->GetLinkImplementation(config, UseTo::Compile);
+  cmLinkImplementation const* otherImpl =
+    this->GetLinkImplementation(other->first.Config.str(), UseTo::Compile);
+  if (!impl != !otherImpl) {
+    return nullptr;
+  }
+  if (impl) {
+    if (!impl->ConfigIndependent ||
+        impl->LanguageRuntimeLibraries !=
+          otherImpl->LanguageRuntimeLibraries) {
+      return nullptr;
+    }
+    std::vector<cmGeneratorTarget const*> const& closure =
+      this->GetLinkImplementationClosure(config, UseTo::Compile);
+    if (!this->LinkImplClosureForUsageMap[config].ConfigIndependent) {
+      return nullptr;
+    }
+    auto const isConfigIndependent =
+      [&interfaceProp](cmGeneratorTarget const* target) -> bool {
+      cmValue value = target->GetProperty(interfaceProp);
+      return !value || cmGeneratorExpression::IsConfigIndependent(*value);
+    };
+    if (!std::all_of(closure.begin(), closure.end(), isConfigIndependent)) {
+      return nullptr;
+    }
+    for (auto const& runtime : impl->LanguageRuntimeLibraries) {
+      for (cmLinkImplItem const& lib : runtime.second) {
+        if (lib.Target && !isConfigIndependent(lib.Target)) {
+          return nullptr;
+        }
+      }
+    }
+  }
+  return &other->second;
+}
+
 cm::optional<cmGeneratorTarget::TransitiveProperty>
 cmGeneratorTarget::IsTransitiveProperty(
   cm::string_view prop, cmLocalGenerator const* lg, std::string const& config,
@@ -8,8 +8,8 @@
 #include "cmGlobalGenerator.h"
 #include "cmList.h"
 #include "cmMakefile.h"
-#include "cmState.h"
 #include "cmValue.h"
+#include "cmake.h"
 
 // cmGetCMakePropertyCommand
 bool cmGetCMakePropertyCommand(std::vector<std::string> const& args,
@@ -39,7 +39,7 @@ bool cmGetCMakePropertyCommand(std::vector<std::string> const& args,
   } else {
     cmValue prop = nullptr;
     if (!args[1].empty()) {
-      prop = status.GetMakefile().GetState()->GetGlobalProperty(args[1]);
+      prop = status.GetMakefile().GetCMakeInstance()->GetProperty(args[1]);
     }
     if (prop) {
       output = *prop;
@@ -340,7 +340,7 @@ bool HandleGlobalMode(cmExecutionStatus& status, std::string const& name,
   // Get the property.
   cmake* cm = status.GetMakefile().GetCMakeInstance();
   return StoreResult(infoType, status.GetMakefile(), variable,
-                     cm->GetState()->GetGlobalProperty(propertyName));
+                     cm->GetProperty(propertyName));
 }
 
 bool HandleDirectoryMode(cmExecutionStatus& status, std::string const& name,
@@ -67,7 +67,9 @@
 #  include <cm3p/json/value.h>
 #  include <cm3p/json/writer.h>
 
+#  include "cmCompilerIdCache.h"
 #  include "cmQtAutoGenGlobalInitializer.h"
+#  include "cmWorkerPool.h"
 #endif
 
 class cmListFileBacktrace;
@@ -94,6 +96,93 @@ std::string GeneratedMakeCommand::QuotedPrintable() const
 }
 }
 
+namespace {
+#if !defined(CMAKE_BOOTSTRAP)
+class CommitJob : public cmWorkerPool::JobT
+{
+public:
+  CommitJob(cmGeneratedFileStream::DeferredCommit const& commit, char& okay)
+    : Commit(commit)
+    , Okay(okay)
+  {
+  }
+
+private:
+  void Process() override
+  {
+    this->Okay = cmGeneratedFileStream::CommitDeferred(this->Commit);
+  }
+
+  cmGeneratedFileStream::DeferredCommit const& Commit;
+  char& Okay;
+};
+
+class CommitFinishJob : public cmWorkerPool::JobFenceT
+{
+  void Process() override { this->Pool()->Abort(); }
+};
+#endif
+
+bool CommitDeferredFiles(
+  std::vector<cmGeneratedFileStream::DeferredCommit> const& commits,
+  unsigned int jobs)
+{
+  // A destination written more than once keeps its last content.
+  // Drop the superseded temporary files so that every remaining
+  // commit has a distinct destination and may run concurrently.
+  std::unordered_map<std::string, std::size_t> last;
+  for (std::size_t i = 0; i < commits.size(); ++i) {
+    last[commits[i].Name] = i;
+  }
+  std::vector<cmGeneratedFileStream::DeferredCommit const*> pending;
+  pending.reserve(last.size());
+  for (std::size_t i = 0; i < commits.size(); ++i) {
+    auto const& commit = commits[i];
+    std::size_t const keep = last[commit.Name];
+    if (keep == i) {
+      pending.push_back(&commit);
+    } else if (commit.TempName != commits[keep].TempName) {
+      cmSystemTools::RemoveFile(commit.TempName);
+    }
+  }
+
+  // Each job reports to its own element, so no locking is needed.
+  std::vector<char> okay(pending.size(), 1);
+#if !defined(CMAKE_BOOTSTRAP)
+  bool const parallel = jobs > 1 && pending.size() > 1;
+  if (parallel) {
+    cmWorkerPool pool;
+    pool.SetThreadCount(
+      static_cast<unsigned int>(std::min<std::size_t>(jobs, pending.size())));
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+      pool.EmplaceJob<CommitJob>(*pending[i], okay[i]);
+    }
+    pool.EmplaceJob<CommitFinishJob>();
+    pool.Process();
+  }
+#else
+  bool const parallel = false;
+  static_cast<void>(jobs);
+#endif
+  if (!parallel) {
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+      okay[i] = cmGeneratedFileStream::CommitDeferred(*pending[i]);
+    }
+  }
+
+  bool result = true;
+  for (std::size_t i = 0; i < pending.size(); ++i) {
+    if (!okay[i]) {
+      cmSystemTools::Error(cmStrCat("Cannot replace generated file\n  ",
+                                    pending[i]->Name,
+                                    "\nwith its new content."));
+      result = false;
+    }
+  }
+  return result;
+}
+}
+
 bool cmTarget::StrictTargetComparison::operator()(cmTarget const* t1,
                                                   cmTarget const* t2) const
 {
@@ -746,6 +835,16 @@ void cmGlobalGenerator::EnableLanguage(
 
   std::map<std::string, bool> needTestLanguage;
   std::map<std::string, bool> needSetLanguageEnabledMaps;
+#ifndef CMAKE_BOOTSTRAP
+  // Keys under which to store the compilers determined below, and the
+  // cache entries created while determining them.
+  std::unique_ptr<cmCompilerIdCache> compilerIdCache;
+  std::map<std::string, std::string> compilerIdKeys;
+  std::map<std::string, std::vector<std::string>> compilerIdCacheEntries;
+  if (!this->CMakeInstance->GetIsInTryCompile()) {
+    compilerIdCache = cmCompilerIdCache::Create(*mf);
+  }
+#endif
   // foreach language
   // load the CMakeDetermine(LANG)Compiler.cmake file to find
   // the compiler
@@ -760,6 +859,25 @@ void cmGlobalGenerator::EnableLanguage(
     if (!mf->GetDefinition(loadedLang)) {
       fpath = cmStrCat(rootBin, "/CMake", lang, "Compiler.cmake");
 
+#ifndef CMAKE_BOOTSTRAP
+      // A fresh build tree may take the configured file of the same
+      // toolchain from another one.
+      if (compilerIdCache && !cmSystemTools::FileExists(fpath)) {
+        std::string key = compilerIdCache->ComputeKey(*mf, lang);
+        if (!key.empty()) {
+          if (compilerIdCache->Load(key, *mf, fpath)) {
+            mf->DisplayStatus(
+              cmStrCat("Using the ", lang,
+                       " compiler information from the compiler "
+                       "identification cache"),
+              -1);
+          } else {
+            compilerIdKeys[lang] = std::move(key);
+          }
+        }
+      }
+#endif
+
       // If the existing build tree was already configured with this
       // version of CMake then try to load the configured file first
       // to avoid duplicate compiler tests.
@@ -789,6 +907,14 @@ void cmGlobalGenerator::EnableLanguage(
       std::string determineCompiler =
         cmStrCat("CMakeDetermine", lang, "Compiler.cmake");
       std::string determineFile = mf->GetModulesFile(determineCompiler);
+#ifndef CMAKE_BOOTSTRAP
+      std::vector<std::string> cacheEntriesBefore;
+      if (compilerIdKeys.count(lang)) {
+        cacheEntriesBefore =
+          this->CMakeInstance->GetState()->GetCacheEntryKeys();
+        std::sort(cacheEntriesBefore.begin(), cacheEntriesBefore.end());
+      }
+#endif
       if (!mf->ReadListFile(determineFile)) {
         cmSystemTools::Error(
           cmStrCat("Could not find cmake module file: ", determineCompiler));
@@ -822,6 +948,17 @@ void cmGlobalGenerator::EnableLanguage(
         cmSystemTools::Error(
           cmStrCat("Could not find cmake module file: ", fpath));
       }
+#ifndef CMAKE_BOOTSTRAP
+      if (compilerIdKeys.count(lang)) {
+        std::vector<std::string> cacheEntries =
+          this->CMakeInstance->GetState()->GetCacheEntryKeys();
+        std::sort(cacheEntries.begin(), cacheEntries.end());
+        std::set_difference(
+          cacheEntries.begin(), cacheEntries.end(), cacheEntriesBefore.begin(),
+          cacheEntriesBefore.end(),
+          std::back_inserter(compilerIdCacheEntries[lang]));
+      }
+#endif
       this->SetLanguageEnabledFlag(lang, mf);
       needSetLanguageEnabledMaps[lang] = true;
       // this can only be called after loading CMake(LANG)Compiler.cmake
@@ -974,6 +1111,20 @@ void cmGlobalGenerator::EnableLanguage(
       }
     }
 
+#ifndef CMAKE_BOOTSTRAP
+    // Share the configured file of a working compiler with other build
+    // trees once it holds everything inspected above.
+    auto const key = compilerIdKeys.find(lang);
+    if (key != compilerIdKeys.end() && needTestLanguage[lang] &&
+        mf->IsOn(cmStrCat("CMAKE_", lang, "_COMPILER_WORKS")) &&
+        !cmSystemTools::GetFatalErrorOccurred()) {
+      compilerIdCache->Store(
+        key->second, *mf, lang,
+        cmStrCat(rootBin, "/CMake", lang, "Compiler.cmake"),
+        compilerIdCacheEntries[lang]);
+    }
+#endif
+
     // Translate compiler ids for compatibility.
     this->CheckCompilerIdCompatibility(mf, lang);
   } // end for each language
@@ -1588,8 +1739,14 @@ bool cmGlobalGenerator::Compute()
   }
 
   // Compute the inter-target dependencies.
-  if (!this->ComputeTargetDepends()) {
-    return false;
+  {
+#ifndef CMAKE_BOOTSTRAP
+    auto profilingRAII = this->CMakeInstance->CreateProfilingEntry(
+      "generate", "compute_target_depends");
+#endif
+    if (!this->ComputeTargetDepends()) {
+      return false;
+    }
   }
   this->ComputeTargetOrder();
 
@@ -1605,6 +1762,10 @@ bool cmGlobalGenerator::Compute()
     localGen->ComputeHomeRelativeOutputPath();
   }
 
+#ifndef CMAKE_BOOTSTRAP
+  this->CMakeInstance->RecordProfilingMemoryUsage();
+#endif
+
   return true;
 }
 
@@ -1629,15 +1790,35 @@ void cmGlobalGenerator::Generate()
   }
 #endif
 
+  // With multiple generate jobs, files written by the local generators
+  // are compared to and moved over their previous content concurrently
+  // once all of them have been produced.  The local generators themselves
+  // run serially: they share the global generator, the targets, and the
+  // caches of evaluated usage requirements, none of which are thread-safe.
+  unsigned int const generateJobs = this->CMakeInstance->GetGenerateJobs();
+  std::vector<cmGeneratedFileStream::DeferredCommit> deferredCommits;
+  if (generateJobs > 1 && this->SupportsDeferredFileCommits()) {
+    cmGeneratedFileStream::SetDeferredCommits(&deferredCommits);
+  }
+
   // Generate project files
   for (unsigned int i = 0; i < this->LocalGenerators.size(); ++i) {
     this->SetCurrentMakefile(this->LocalGenerators[i]->GetMakefile());
+#ifndef CMAKE_BOOTSTRAP
+    cm::optional<cmMakefileProfilingData::RAII> profilingRAII =
+      this->CMakeInstance->CreateProfilingEntry(
+        "generate", this->LocalGenerators[i]->GetCurrentBinaryDirectory());
+#endif
     this->LocalGenerators[i]->Generate();
     if (!this->LocalGenerators[i]->GetMakefile()->IsOn(
           "CMAKE_SKIP_INSTALL_RULES")) {
       this->LocalGenerators[i]->GenerateInstallRules();
     }
     this->LocalGenerators[i]->GenerateTestFiles();
+#ifndef CMAKE_BOOTSTRAP
+    profilingRAII.reset();
+    this->CMakeInstance->RecordProfilingMemoryUsage();
+#endif
     this->CMakeInstance->UpdateProgress(
       "Generating",
       0.1f +
@@ -1646,6 +1827,11 @@ void cmGlobalGenerator::Generate()
   }
   this->SetCurrentMakefile(nullptr);
 
+  cmGeneratedFileStream::SetDeferredCommits(nullptr);
+  if (!CommitDeferredFiles(deferredCommits, generateJobs)) {
+    return;
+  }
+
   if (!this->GenerateCPackPropertiesFile()) {
     this->GetCMakeInstance()->IssueMessage(
       MessageType::FATAL_ERROR, "Could not write CPack properties file.");
@@ -2003,6 +2189,7 @@ void cmGlobalGenerator::ClearGeneratorMembers()
   this->GeneratedFiles.clear();
   this->RuntimeDependencySets.clear();
   this->RuntimeDependencySetsByName.clear();
+  this->DependentExpressions.clear();
 }
 
 void cmGlobalGenerator::ComputeTargetObjectDirectory(
@@ -2077,11 +2264,11 @@ void cmGlobalGenerator::CheckTargetProperties()
   }
 }
 
-int cmGlobalGenerator::TryCompile(int jobs, std::string const& srcdir,
-                                  std::string const& bindir,
-                                  std::string const& projectName,
-                                  std::string const& target, bool fast,
-                                  std::string& output, cmMakefile* mf)
+int cmGlobalGenerator::TryCompile(
+  int jobs, std::string const& srcdir, std::string const& bindir,
+  std::string const& projectName, std::string const& target, bool fast,
+  std::string& output, cmMakefile* mf,
+  std::vector<std::string> const& nativeOptions)
 {
   // if this is not set, then this is a first time configure
   // and there is a good chance that the try compile stuff will
@@ -2112,7 +2299,8 @@ int cmGlobalGenerator::TryCompile(int jobs, std::string const& srcdir,
   std::stringstream ostr;
   auto ret = this->Build(jobs, srcdir, bindir, projectName, newTarget, ostr,
                          "", config, defaultBuildOptions, true,
-                         this->TryCompileTimeout, cmSystemTools::OUTPUT_NONE);
+                         this->TryCompileTimeout, cmSystemTools::OUTPUT_NONE,
+                         nativeOptions);
   output = ostr.str();
   return ret;
 }
@@ -3622,6 +3810,36 @@ void cmGlobalGenerator::WriteRuleHashes(std::string const& pfile)
   }
 }
 
+void cmGlobalGenerator::WriteRegenerateInputHashes(
+  std::vector<std::string> const& inputs,
+  std::vector<std::string> const& outputs) const
+{
+  cmake* cm = this->GetCMakeInstance();
+  std::string const pfile = cm->GetRegenerateInputHashesFile();
+  if (!this->GlobalSettingIsOn("CMAKE_REGENERATE_ON_CONTENT_CHANGE")) {
+    cmSystemTools::RemoveFile(pfile);
+    return;
+  }
+
+  std::string const& home = cm->GetHomeOutputDirectory();
+  cmCryptoHash md5(cmCryptoHash::AlgoMD5);
+  cmGeneratedFileStream fout(pfile);
+  fout << "# Hashes of build system regeneration inputs.\n";
+  for (std::string const& out : outputs) {
+    fout << "output " << cmSystemTools::CollapseFullPath(out, home) << '\n';
+  }
+  for (std::string const& in : inputs) {
+    std::string const path = cmSystemTools::CollapseFullPath(in, home);
+    // The glob verification stamp is touched, not modified, when the
+    // result of a glob changes.
+    std::string hash;
+    if (path != cm->GetGlobVerifyStamp()) {
+      hash = md5.HashFile(path);
+    }
+    fout << "input " << (hash.empty() ? "-" : hash) << ' ' << path << '\n';
+  }
+}
+
 void cmGlobalGenerator::WriteSummary()
 {
   // Record all target directories in a central location.
@@ -3776,6 +3994,12 @@ cmGlobalGenerator::GetFilenameTargetDepends(cmSourceFile* sf) const
   return this->FilenameTargetDepends[sf];
 }
 
+cmGlobalGenerator::DependentExpression&
+cmGlobalGenerator::GetDependentExpression(std::string const& input) const
+{
+  return this->DependentExpressions[input];
+}
+
 std::string const& cmGlobalGenerator::GetRealPath(std::string const& dir)
 {
   auto i = this->RealPaths.lower_bound(dir);
@@ -43,6 +43,7 @@
 enum class cmDepfileFormat;
 enum class codecvt_Encoding;
 
+class cmCompiledGeneratorExpression;
 class cmDirectoryId;
 class cmExportBuildFileGenerator;
 class cmExternalMakefileProjectGenerator;
@@ -241,7 +242,9 @@ public:
   int TryCompile(int jobs, std::string const& srcdir,
                  std::string const& bindir, std::string const& projectName,
                  std::string const& targetName, bool fast, std::string& output,
-                 cmMakefile* mf);
+                 cmMakefile* mf,
+                 std::vector<std::string> const& nativeOptions =
+                   std::vector<std::string>());
 
   /**
    * Build a file given the following information. This is a more direct call
@@ -277,6 +280,13 @@ public:
 
   virtual void PrintBuildCommandAdvice(std::ostream& os, int jobs) const;
 
+  /** Native build tool options to go on building the remaining targets
+      after one of them fails.  Empty if the build tool has none.  */
+  virtual std::vector<std::string> GetKeepGoingBuildOptions() const
+  {
+    return std::vector<std::string>();
+  }
+
   /**
    * Generate a "cmake --build" call for a given target, config and parallel
    * level.
@@ -594,6 +604,13 @@ public:
 
   virtual bool SupportsLinkerDependencyFile() const { return false; }
 
+  /** Return whether copy-if-different files written by the local
+      generators may be committed after all of them have been generated,
+      concurrently with --generate-jobs.  Generators must not read back
+      or depend on the replacement status of such files while
+      generating.  */
+  virtual bool SupportsDeferredFileCommits() const { return false; }
+
   /** Generate an <output>.rule file path for a given command output.  */
   virtual std::string GenerateRuleFile(std::string const& output) const;
 
@@ -637,6 +654,16 @@ public:
   std::set<cmGeneratorTarget const*> const& GetFilenameTargetDepends(
     cmSourceFile* sf) const;
 
+  /** Compiled generator expression of a property value that is evaluated
+      on behalf of another expression.  The compilation is shared by all
+      evaluations of the same value that are not nested in each other.  */
+  struct DependentExpression
+  {
+    std::unique_ptr<cmCompiledGeneratorExpression> Compiled;
+    bool InUse = false;
+  };
+  DependentExpression& GetDependentExpression(std::string const& input) const;
+
 #if !defined(CMAKE_BOOTSTRAP)
   cmFileLockPool& GetFileLockPool() { return this->FileLockPool; }
 #endif
@@ -682,6 +709,13 @@ public:
   }
 
 protected:
+  /** Record the content of the inputs of the build system regeneration
+      step so that it may be skipped when only their timestamps change.
+      Does nothing unless CMAKE_REGENERATE_ON_CONTENT_CHANGE is set.  */
+  void WriteRegenerateInputHashes(
+    std::vector<std::string> const& inputs,
+    std::vector<std::string> const& outputs) const;
+
   // for a project collect all its targets by following depend
   // information, and also collect all the targets
   void GetTargetSets(TargetDependSet& projectTargets,
@@ -911,6 +945,9 @@ private:
   mutable std::map<cmSourceFile*, std::set<cmGeneratorTarget const*>>
     FilenameTargetDepends;
 
+  mutable std::unordered_map<std::string, DependentExpression>
+    DependentExpressions;
+
   std::map<std::string, std::string> RealPaths;
 
   std::unordered_set<std::string> GeneratedFiles;
@@ -622,6 +622,7 @@ void cmGlobalNinjaGenerator::Generate()
 
   for (auto& it : this->Configs) {
     it.second.TargetDependsClosures.clear();
+    it.second.DyndepCollations.clear();
   }
 
   this->TargetAll = this->NinjaOutputPath("all");
@@ -629,10 +630,13 @@ void cmGlobalNinjaGenerator::Generate()
   this->DiagnosedCxxModuleNinjaSupport = false;
   this->ClangTidyExportFixesDirs.clear();
   this->ClangTidyExportFixesFiles.clear();
+  this->BatchDyndepCollation =
+    this->LocalGenerators[0]->GetMakefile()->IsOn("CMAKE_NINJA_BATCH_DYNDEP");
 
   this->cmGlobalGenerator::Generate();
 
   this->WriteAssumedSourceDependencies();
+  this->WriteBatchedDyndepCollations();
   this->WriteTargetAliases(*this->GetCommonFileStream());
   this->WriteFolderTargets(*this->GetCommonFileStream());
   this->WriteBuiltinTargets(*this->GetCommonFileStream());
@@ -1279,6 +1283,96 @@ void cmGlobalNinjaGenerator::WriteAssumedSourceDependencies()
   }
 }
 
+void cmGlobalNinjaGenerator::AddBatchedDyndepCollation(
+  std::string const& config, std::string const& lang, std::string const& tdi,
+  std::string const& modmapFormat, cmNinjaBuild build)
+{
+  this->Configs[config].DyndepCollations.push_back(
+    { lang, tdi, modmapFormat, std::move(build) });
+}
+
+void cmGlobalNinjaGenerator::WriteBatchedDyndepCollations()
+{
+  std::map<std::string, cmNinjaBuild> batchBuilds;
+  for (std::string const& config : this->GetConfigNames()) {
+    auto const& collations = this->Configs[config].DyndepCollations;
+    if (collations.empty()) {
+      continue;
+    }
+
+    // List the collations in a file read by `cmake -E cmake_ninja_dyndep`.
+    std::string const batchFile =
+      cmStrCat(this->GetCMakeInstance()->GetHomeOutputDirectory(),
+               "/CMakeFiles", this->ConfigDirectory(config),
+               "/DyndepBatch.json");
+    Json::Value batch = Json::objectValue;
+    Json::Value& batchCollations = batch["collations"] = Json::arrayValue;
+
+    cmNinjaBuild build("CMAKE_DYNDEP_BATCH");
+    build.Comment = "Collate the dyndep files of all targets.";
+    build.ExplicitDeps.push_back(this->ConvertToNinjaPath(batchFile));
+    std::set<std::string> outputs;
+    std::set<std::string> deps;
+    for (auto const& collation : collations) {
+      Json::Value& batchCollation = batchCollations.append(Json::objectValue);
+      batchCollation["tdi"] = collation.TargetDependInfo;
+      batchCollation["lang"] = collation.Language;
+      batchCollation["dd"] = collation.Build.Outputs.front();
+      batchCollation["modmapfmt"] = collation.ModmapFormat;
+      Json::Value& ddis = batchCollation["ddis"] = Json::arrayValue;
+      for (std::string const& ddi : collation.Build.ExplicitDeps) {
+        ddis.append(ddi);
+      }
+
+      cm::append(build.Outputs, collation.Build.Outputs);
+      cm::append(build.ImplicitOuts, collation.Build.ImplicitOuts);
+      outputs.insert(collation.Build.Outputs.begin(),
+                     collation.Build.Outputs.end());
+      outputs.insert(collation.Build.ImplicitOuts.begin(),
+                     collation.Build.ImplicitOuts.end());
+      deps.insert(collation.Build.ExplicitDeps.begin(),
+                  collation.Build.ExplicitDeps.end());
+      deps.insert(collation.Build.ImplicitDeps.begin(),
+                  collation.Build.ImplicitDeps.end());
+    }
+    // Module information of linked targets is produced by this statement.
+    for (std::string const& dep : deps) {
+      if (!outputs.count(dep)) {
+        build.ImplicitDeps.push_back(dep);
+      }
+    }
+
+    cmGeneratedFileStream batchf(batchFile);
+    batchf.SetCopyIfDifferent(true);
+    batchf << batch;
+
+    batchBuilds.emplace(config, std::move(build));
+  }
+  if (batchBuilds.empty()) {
+    return;
+  }
+
+  {
+    cmNinjaRule rule("CMAKE_DYNDEP_BATCH");
+    rule.Command =
+      cmStrCat(this->CMakeCmd(), " -E cmake_ninja_dyndep --batch=$in");
+    // The collator only updates outputs whose contents change.
+    rule.Restat = "1";
+    rule.Description = "Generating dyndep files";
+    rule.Comment = "Rule for collating the dyndep files of all targets.";
+    this->AddRule(rule);
+  }
+
+  for (std::string const& fileConfig : this->GetConfigNames()) {
+    for (std::string const& config : this->GetCrossConfigs(fileConfig)) {
+      auto const it = batchBuilds.find(config);
+      if (it != batchBuilds.end()) {
+        this->WriteBuild(*this->GetImplFileStream(fileConfig), it->second);
+      }
+    }
+  }
+}
+
 std::string cmGlobalNinjaGenerator::OrderDependsTargetForTarget(
   cmGeneratorTarget const* target, std::string const& /*config*/) const
 {
@@ -1829,6 +1923,9 @@ void cmGlobalNinjaGenerator::WriteTargetRebuildManifest(std::ostream& os)
     cmNinjaRule rule("RERUN_CMAKE");
     rule.Command = cmStrCat(
       this->CMakeCmd(), " --regenerate-during-build",
+      this->GlobalSettingIsOn("CMAKE_REGENERATE_ON_CONTENT_CHANGE")
+        ? " --check-regenerate-inputs"
+        : "",
       cm->GetIgnoreCompileWarningAsError() ? " --compile-no-warning-as-error"
                                            : "",
       cm->GetIgnoreLinkWarningAsError() ? " --link-no-warning-as-error" : "",
@@ -1930,6 +2027,12 @@ void cmGlobalNinjaGenerator::WriteTargetRebuildManifest(std::ostream& os)
 
   this->WriteBuild(os, reBuild);
 
+  {
+    cmNinjaDeps inputs = reBuild.ImplicitDeps;
+    cm::append(inputs, reBuild.ExplicitDeps);
+    this->WriteRegenerateInputHashes(inputs, reBuild.Outputs);
+  }
+
   {
     cmNinjaBuild build("phony");
     build.Comment = "A missing CMake input file is not an error.";
@@ -2573,6 +2676,38 @@ cm::optional<cmSourceInfo> cmcmd_cmake_ninja_depends_fortran(
 }
 }
 
+namespace {
+// Load the module information of another target, preferring the copy kept
+// in memory when that target was collated earlier in the same process.
+Json::Value const* LoadTargetModuleInfo(
+  std::string const& path, std::string const& target_dir,
+  cmGlobalNinjaGenerator::CollatedModuleInfo const* collated_modules,
+  Json::Value& storage)
+{
+  if (collated_modules) {
+    auto const it =
+      collated_modules->find(cmSystemTools::CollapseFullPath(path));
+    if (it != collated_modules->end()) {
+      return &it->second;
+    }
+  }
+  cmsys::ifstream f(path.c_str(), std::ios::in | std::ios::binary);
+  if (!f) {
+    cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to open ",
+                                  path, " for module information"));
+    return nullptr;
+  }
+  Json::Reader reader;
+  if (!reader.parse(f, storage, false)) {
+    cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
+                                  target_dir,
+                                  reader.getFormattedErrorMessages()));
+    return nullptr;
+  }
+  return &storage;
+}
+}
+
 bool cmGlobalNinjaGenerator::WriteDyndepFile(
   std::string const& dir_top_src, std::string const& dir_top_bld,
   std::string const& dir_cur_src, std::string const& dir_cur_bld,
@@ -2581,7 +2716,8 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
   std::vector<std::string> const& linked_target_dirs,
   std::vector<std::string> const& forward_modules_from_target_dirs,
   std::string const& arg_lang, std::string const& arg_modmapfmt,
-  cmCxxModuleExportInfo const& export_info)
+  cmCxxModuleExportInfo const& export_info,
+  CollatedModuleInfo* collated_modules)
 {
   // Setup path conversions.
   {
@@ -2620,20 +2756,13 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
   for (std::string const& linked_target_dir : linked_target_dirs) {
     std::string const ltmn =
       cmStrCat(linked_target_dir, '/', arg_lang, "Modules.json");
-    Json::Value ltm;
-    cmsys::ifstream ltmf(ltmn.c_str(), std::ios::in | std::ios::binary);
-    if (!ltmf) {
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to open ",
-                                    ltmn, " for module information"));
-      return false;
-    }
-    Json::Reader reader;
-    if (!reader.parse(ltmf, ltm, false)) {
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                    linked_target_dir,
-                                    reader.getFormattedErrorMessages()));
+    Json::Value ltms;
+    Json::Value const* ltmp =
+      LoadTargetModuleInfo(ltmn, linked_target_dir, collated_modules, ltms);
+    if (!ltmp) {
       return false;
     }
+    Json::Value const& ltm = *ltmp;
     if (ltm.isObject()) {
       Json::Value const& target_modules = ltm["modules"];
       if (target_modules.isObject()) {
@@ -2873,20 +3002,13 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
        forward_modules_from_target_dirs) {
     std::string const fmftn =
       cmStrCat(forward_modules_from_target_dir, '/', arg_lang, "Modules.json");
-    Json::Value fmft;
-    cmsys::ifstream fmftf(fmftn.c_str(), std::ios::in | std::ios::binary);
-    if (!fmftf) {
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to open ",
-                                    fmftn, " for module information"));
-      return false;
-    }
-    Json::Reader reader;
-    if (!reader.parse(fmftf, fmft, false)) {
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                    forward_modules_from_target_dir,
-                                    reader.getFormattedErrorMessages()));
+    Json::Value fmfts;
+    Json::Value const* fmftp = LoadTargetModuleInfo(
+      fmftn, forward_modules_from_target_dir, collated_modules, fmfts);
+    if (!fmftp) {
       return false;
     }
+    Json::Value const& fmft = *fmftp;
     if (!fmft.isObject()) {
       continue;
     }
@@ -2912,9 +3034,15 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
     forward_info(target_usages, fmft["usages"]);
   }
 
-  cmGeneratedFileStream tmf(target_mods_file);
-  tmf.SetCopyIfDifferent(true);
-  tmf << target_module_info;
+  {
+    cmGeneratedFileStream tmf(target_mods_file);
+    tmf.SetCopyIfDifferent(true);
+    tmf << target_module_info;
+  }
+  if (collated_modules) {
+    (*collated_modules)[cmSystemTools::CollapseFullPath(target_mods_file)] =
+      std::move(target_module_info);
+  }
 
   cmDyndepMetadataCallbacks cb;
   cb.ModuleFile =
@@ -2930,61 +3058,49 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
                                                 cb);
 }
 
-int cmcmd_cmake_ninja_dyndep(std::vector<std::string>::const_iterator argBeg,
-                             std::vector<std::string>::const_iterator argEnd)
-{
-  std::vector<std::string> arg_full =
-    cmSystemTools::HandleResponseFile(argBeg, argEnd);
+namespace {
+struct DyndepCollation
+{
+  std::string TargetDependInfoFile;
+  std::string Language;
+  std::string DyndepFile;
+  std::string ModmapFormat;
+  std::vector<std::string> ScanDepFiles;
+  Json::Value TargetDependInfo;
+};
 
-  std::string arg_dd;
-  std::string arg_lang;
-  std::string arg_tdi;
-  std::string arg_modmapfmt;
-  std::vector<std::string> arg_ddis;
-  for (std::string const& arg : arg_full) {
-    if (cmHasLiteralPrefix(arg, "--tdi=")) {
-      arg_tdi = arg.substr(6);
-    } else if (cmHasLiteralPrefix(arg, "--lang=")) {
-      arg_lang = arg.substr(7);
-    } else if (cmHasLiteralPrefix(arg, "--dd=")) {
-      arg_dd = arg.substr(5);
-    } else if (cmHasLiteralPrefix(arg, "--modmapfmt=")) {
-      arg_modmapfmt = arg.substr(12);
-    } else if (!cmHasLiteralPrefix(arg, "--") &&
-               cmHasLiteralSuffix(arg, ".ddi")) {
-      arg_ddis.push_back(arg);
-    } else {
-      cmSystemTools::Error(
-        cmStrCat("-E cmake_ninja_dyndep unknown argument: ", arg));
-      return 1;
-    }
-  }
-  if (arg_tdi.empty()) {
-    cmSystemTools::Error("-E cmake_ninja_dyndep requires value for --tdi=");
-    return 1;
-  }
-  if (arg_lang.empty()) {
-    cmSystemTools::Error("-E cmake_ninja_dyndep requires value for --lang=");
-    return 1;
-  }
-  if (arg_dd.empty()) {
-    cmSystemTools::Error("-E cmake_ninja_dyndep requires value for --dd=");
-    return 1;
+bool LoadTargetDependInfo(DyndepCollation& collation)
+{
+  cmsys::ifstream tdif(collation.TargetDependInfoFile.c_str(),
+                       std::ios::in | std::ios::binary);
+  Json::Reader reader;
+  if (!reader.parse(tdif, collation.TargetDependInfo, false)) {
+    cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
+                                  collation.TargetDependInfoFile,
+                                  reader.getFormattedErrorMessages()));
+    return false;
   }
+  return true;
+}
 
-  Json::Value tdio;
-  Json::Value const& tdi = tdio;
-  {
-    cmsys::ifstream tdif(arg_tdi.c_str(), std::ios::in | std::ios::binary);
-    Json::Reader reader;
-    if (!reader.parse(tdif, tdio, false)) {
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                    arg_tdi,
-                                    reader.getFormattedErrorMessages()));
-      return 1;
+std::vector<std::string> ReadTargetDirs(Json::Value const& tdi,
+                                        char const* key)
+{
+  std::vector<std::string> dirs;
+  Json::Value const& tdi_dirs = tdi[key];
+  if (tdi_dirs.isArray()) {
+    for (auto const& tdi_dir : tdi_dirs) {
+      dirs.push_back(tdi_dir.asString());
     }
   }
+  return dirs;
+}
 
+bool CollateDyndep(
+  DyndepCollation const& collation,
+  cmGlobalNinjaGenerator::CollatedModuleInfo* collated_modules)
+{
+  Json::Value const& tdi = collation.TargetDependInfo;
   std::string const dir_cur_bld = tdi["dir-cur-bld"].asString();
   std::string const dir_cur_src = tdi["dir-cur-src"].asString();
   std::string const dir_top_bld = tdi["dir-top-bld"].asString();
@@ -2993,23 +3109,10 @@ int cmcmd_cmake_ninja_dyndep(std::vector<std::string>::const_iterator argBeg,
   if (!module_dir.empty() && !cmHasLiteralSuffix(module_dir, "/")) {
     module_dir += '/';
   }
-  std::vector<std::string> linked_target_dirs;
-  Json::Value const& tdi_linked_target_dirs = tdi["linked-target-dirs"];
-  if (tdi_linked_target_dirs.isArray()) {
-    for (auto const& tdi_linked_target_dir : tdi_linked_target_dirs) {
-      linked_target_dirs.push_back(tdi_linked_target_dir.asString());
-    }
-  }
-  std::vector<std::string> forward_modules_from_target_dirs;
-  Json::Value const& tdi_forward_modules_from_target_dirs =
-    tdi["forward-modules-from-target-dirs"];
-  if (tdi_forward_modules_from_target_dirs.isArray()) {
-    for (auto const& tdi_forward_modules_from_target_dir :
-         tdi_forward_modules_from_target_dirs) {
-      forward_modules_from_target_dirs.push_back(
-        tdi_forward_modules_from_target_dir.asString());
-    }
-  }
+  std::vector<std::string> const linked_target_dirs =
+    ReadTargetDirs(tdi, "linked-target-dirs");
+  std::vector<std::string> const forward_modules_from_target_dirs =
+    ReadTargetDirs(tdi, "forward-modules-from-target-dirs");
   std::string const compilerId = tdi["compiler-id"].asString();
   std::string const simulateId = tdi["compiler-simulate-id"].asString();
   std::string const compilerFrontendVariant =
@@ -3022,7 +3125,7 @@ int cmcmd_cmake_ninja_dyndep(std::vector<std::string>::const_iterator argBeg,
   cm.SetHomeOutputDirectory(dir_top_bld);
   auto ggd = cm.CreateGlobalGenerator("Ninja");
   if (!ggd) {
-    return 1;
+    return false;
   }
   cmGlobalNinjaGenerator& gg =
     cm::static_reference_cast<cmGlobalNinjaGenerator>(ggd);
@@ -3031,12 +3134,145 @@ int cmcmd_cmake_ninja_dyndep(std::vector<std::string>::const_iterator argBeg,
     gg.MarkAsGCCOnWindows();
   }
 #  endif
-  return gg.WriteDyndepFile(dir_top_src, dir_top_bld, dir_cur_src, dir_cur_bld,
-                            arg_dd, arg_ddis, module_dir, linked_target_dirs,
-                            forward_modules_from_target_dirs, arg_lang,
-                            arg_modmapfmt, *export_info)
-    ? 0
-    : 1;
+  return gg.WriteDyndepFile(
+    dir_top_src, dir_top_bld, dir_cur_src, dir_cur_bld, collation.DyndepFile,
+    collation.ScanDepFiles, module_dir, linked_target_dirs,
+    forward_modules_from_target_dirs, collation.Language,
+    collation.ModmapFormat, *export_info, collated_modules);
+}
+
+// Collate all targets listed in a batch file in one process.  Targets are
+// visited after the targets whose modules they consume so that the module
+// information of the latter is taken from memory instead of being re-read.
+int CollateDyndepBatch(std::string const& arg_batch)
+{
+  Json::Value batch;
+  {
+    cmsys::ifstream batchf(arg_batch.c_str(), std::ios::in | std::ios::binary);
+    Json::Reader reader;
+    if (!reader.parse(batchf, batch, false)) {
+      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
+                                    arg_batch,
+                                    reader.getFormattedErrorMessages()));
+      return 1;
+    }
+  }
+
+  std::vector<DyndepCollation> collations;
+  std::map<std::string, std::size_t> collation_for_modules;
+  Json::Value const& batch_collations = batch["collations"];
+  if (batch_collations.isArray()) {
+    for (Json::Value const& batch_collation : batch_collations) {
+      DyndepCollation collation;
+      collation.TargetDependInfoFile = batch_collation["tdi"].asString();
+      collation.Language = batch_collation["lang"].asString();
+      collation.DyndepFile = batch_collation["dd"].asString();
+      collation.ModmapFormat = batch_collation["modmapfmt"].asString();
+      for (Json::Value const& ddi : batch_collation["ddis"]) {
+        collation.ScanDepFiles.push_back(ddi.asString());
+      }
+      if (!LoadTargetDependInfo(collation)) {
+        return 1;
+      }
+      collation_for_modules[cmSystemTools::CollapseFullPath(
+        cmStrCat(cmSystemTools::GetFilenamePath(collation.DyndepFile), '/',
+                 collation.Language, "Modules.json"))] = collations.size();
+      collations.push_back(std::move(collation));
+    }
+  }
+
+  enum class VisitState
+  {
+    NotVisited,
+    Visiting,
+    Done,
+  };
+  std::vector<VisitState> states(collations.size(), VisitState::NotVisited);
+  std::vector<std::size_t> order;
+  order.reserve(collations.size());
+  std::function<void(std::size_t)> visit = [&](std::size_t i) {
+    if (states[i] != VisitState::NotVisited) {
+      return;
+    }
+    states[i] = VisitState::Visiting;
+    DyndepCollation const& collation = collations[i];
+    for (char const* key :
+         { "linked-target-dirs", "forward-modules-from-target-dirs" }) {
+      for (std::string const& dir :
+           ReadTargetDirs(collation.TargetDependInfo, key)) {
+        auto const it =
+          collation_for_modules.find(cmSystemTools::CollapseFullPath(
+            cmStrCat(dir, '/', collation.Language, "Modules.json")));
+        if (it != collation_for_modules.end()) {
+          visit(it->second);
+        }
+      }
+    }
+    states[i] = VisitState::Done;
+    order.push_back(i);
+  };
+  for (std::size_t i = 0; i < collations.size(); ++i) {
+    visit(i);
+  }
+
+  cmGlobalNinjaGenerator::CollatedModuleInfo collated_modules;
+  for (std::size_t i : order) {
+    if (!CollateDyndep(collations[i], &collated_modules)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+}
+
+int cmcmd_cmake_ninja_dyndep(std::vector<std::string>::const_iterator argBeg,
+                             std::vector<std::string>::const_iterator argEnd)
+{
+  std::vector<std::string> arg_full =
+    cmSystemTools::HandleResponseFile(argBeg, argEnd);
+
+  DyndepCollation collation;
+  std::string arg_batch;
+  for (std::string const& arg : arg_full) {
+    if (cmHasLiteralPrefix(arg, "--tdi=")) {
+      collation.TargetDependInfoFile = arg.substr(6);
+    } else if (cmHasLiteralPrefix(arg, "--lang=")) {
+      collation.Language = arg.substr(7);
+    } else if (cmHasLiteralPrefix(arg, "--dd=")) {
+      collation.DyndepFile = arg.substr(5);
+    } else if (cmHasLiteralPrefix(arg, "--modmapfmt=")) {
+      collation.ModmapFormat = arg.substr(12);
+    } else if (cmHasLiteralPrefix(arg, "--batch=")) {
+      arg_batch = arg.substr(8);
+    } else if (!cmHasLiteralPrefix(arg, "--") &&
+               cmHasLiteralSuffix(arg, ".ddi")) {
+      collation.ScanDepFiles.push_back(arg);
+    } else {
+      cmSystemTools::Error(
+        cmStrCat("-E cmake_ninja_dyndep unknown argument: ", arg));
+      return 1;
+    }
+  }
+  if (!arg_batch.empty()) {
+    return CollateDyndepBatch(arg_batch);
+  }
+  if (collation.TargetDependInfoFile.empty()) {
+    cmSystemTools::Error("-E cmake_ninja_dyndep requires value for --tdi=");
+    return 1;
+  }
+  if (collation.Language.empty()) {
+    cmSystemTools::Error("-E cmake_ninja_dyndep requires value for --lang=");
+    return 1;
+  }
+  if (collation.DyndepFile.empty()) {
+    cmSystemTools::Error("-E cmake_ninja_dyndep requires value for --dd=");
+    return 1;
+  }
+
+  if (!LoadTargetDependInfo(collation)) {
+    return 1;
+  }
+  return CollateDyndep(collation, nullptr) ? 0 : 1;
 }
 
 #endif
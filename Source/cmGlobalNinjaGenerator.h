@@ -36,6 +36,10 @@ class cmStateDirectory;
 class cmake;
 struct cmCxxModuleExportInfo;
 
+namespace Json {
+class Value;
+}
+
 /**
  * \class cmGlobalNinjaGenerator
  * \brief Write a build.ninja file.
@@ -205,6 +209,11 @@ public:
     std::vector<std::string> const& makeOptions =
       std::vector<std::string>()) override;
 
+  std::vector<std::string> GetKeepGoingBuildOptions() const override
+  {
+    return { "-k", "0" };
+  }
+
   // Setup target names
   char const* GetAllTargetName() const override { return "all"; }
   char const* GetInstallTargetName() const override { return "install"; }
@@ -240,6 +249,8 @@ public:
 
   bool SupportsLinkerDependencyFile() const override { return true; }
 
+  bool SupportsDeferredFileCommits() const override { return true; }
+
   virtual cmGeneratedFileStream* GetImplFileStream(
     std::string const& /*config*/) const
   {
@@ -429,6 +440,10 @@ public:
   bool HasOutputPathPrefix() const { return !this->OutputPathPrefix.empty(); }
   void StripNinjaOutputPathPrefixAsSuffix(std::string& path);
 
+  /// Module information written by targets collated earlier in the same
+  /// process, keyed by the full path of their `<LANG>Modules.json` file.
+  using CollatedModuleInfo = std::map<std::string, Json::Value>;
+
   bool WriteDyndepFile(
     std::string const& dir_top_src, std::string const& dir_top_bld,
     std::string const& dir_cur_src, std::string const& dir_cur_bld,
@@ -437,7 +452,17 @@ public:
     std::vector<std::string> const& linked_target_dirs,
     std::vector<std::string> const& forward_modules_from_target_dirs,
     std::string const& arg_lang, std::string const& arg_modmapfmt,
-    cmCxxModuleExportInfo const& export_info);
+    cmCxxModuleExportInfo const& export_info,
+    CollatedModuleInfo* collated_modules = nullptr);
+
+  /// Whether the dyndep files of all targets in a configuration are
+  /// collated by a single build statement.
+  bool IsDyndepCollationBatched() const { return this->BatchDyndepCollation; }
+  void AddBatchedDyndepCollation(std::string const& config,
+                                 std::string const& lang,
+                                 std::string const& tdi,
+                                 std::string const& modmapFormat,
+                                 cmNinjaBuild build);
 
   virtual std::string BuildAlias(std::string const& alias,
                                  std::string const& /*config*/) const
@@ -526,6 +551,7 @@ private:
   void WriteDisclaimer(std::ostream& os) const;
 
   void WriteAssumedSourceDependencies();
+  void WriteBatchedDyndepCollations();
 
   void WriteTargetAliases(std::ostream& os);
   void WriteFolderTargets(std::ostream& os);
@@ -563,6 +589,7 @@ private:
   std::unordered_map<std::string, int> RuleCmdLength;
 
   bool UsingGCCOnWindows = false;
+  bool BatchDyndepCollation = false;
 
   /// The set of custom command outputs we have seen.
   std::set<std::string> CustomCommandOutputs;
@@ -635,6 +662,17 @@ private:
     TargetAliasMap TargetAliases;
 
     cmNinjaDeps ByproductsForCleanTarget;
+
+    struct DyndepCollation
+    {
+      std::string Language;
+      std::string TargetDependInfo;
+      std::string ModmapFormat;
+      cmNinjaBuild Build;
+    };
+
+    /// The collations written by `WriteBatchedDyndepCollations`.
+    std::vector<DyndepCollation> DyndepCollations;
   };
   std::map<std::string, ByConfig> Configs;
 
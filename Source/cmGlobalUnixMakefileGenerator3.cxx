@@ -3,23 +3,36 @@
 #include "cmGlobalUnixMakefileGenerator3.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <functional>
 #include <sstream>
 #include <utility>
 
 #include <cm/memory>
+#include <cm/string_view>
 #include <cmext/algorithm>
 #include <cmext/memory>
+#include <cmext/string_view>
 
+#include "cmsys/FStream.hxx"
+
+#include "cmComputeComponentGraph.h"
+#include "cmDepends.h"
+#include "cmDependsCompiler.h"
+#include "cmFileTime.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGeneratorTarget.h"
 #include "cmGlobalGenerator.h"
+#include "cmGraphAdjacencyList.h"
+#include "cmList.h"
+#include "cmListFileCache.h"
 #include "cmLocalGenerator.h"
 #include "cmLocalUnixMakefileGenerator3.h"
 #include "cmMakefile.h"
 #include "cmMakefileTargetGenerator.h"
 #include "cmOutputConverter.h"
 #include "cmState.h"
+#include "cmStateDirectory.h"
 #include "cmStateTypes.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
@@ -106,6 +119,14 @@ void cmGlobalUnixMakefileGenerator3::Generate()
   this->ClangTidyExportFixesDirs.clear();
   this->ClangTidyExportFixesFiles.clear();
 
+#ifndef CMAKE_BOOTSTRAP
+  // Only the plain "make" tool is known to honor the stamp check.
+  this->BuildStampTargets.clear();
+  this->BuildStamp = this->GetName() == "Unix Makefiles" &&
+    this->LocalGenerators[0]->GetMakefile()->IsOn(
+      "CMAKE_MAKEFILE_BUILD_STAMP");
+#endif
+
   // first do superclass method
   this->cmGlobalGenerator::Generate();
 
@@ -126,6 +147,10 @@ void cmGlobalUnixMakefileGenerator3::Generate()
   for (auto& pmi : this->ProgressMap) {
     pmi.second.WriteProgressVariables(total, current);
   }
+
+  // Compute the targets whose progress marks count toward each target.
+  this->ComputeProgressReach();
+
   for (auto const& lg : this->LocalGenerators) {
     std::string markFileName =
       cmStrCat(lg->GetCurrentBinaryDirectory(), "/CMakeFiles/progress.marks");
@@ -133,6 +158,10 @@ void cmGlobalUnixMakefileGenerator3::Generate()
     markFile << this->CountProgressMarksInAll(*lg) << "\n";
   }
 
+  if (this->BuildStamp) {
+    this->WriteBuildStampManifest();
+  }
+
   // write the main makefile
   this->WriteMainMakefile2();
   this->WriteMainCMakefile();
@@ -316,6 +345,10 @@ void cmGlobalUnixMakefileGenerator3::WriteMainCMakefile()
                     << "  \"" << lg.MaybeRelativeToCurBinDir(check) << "\"\n";
     cmakefileStream << "  )\n\n";
 
+    lfiles.push_back(cmStrCat(
+      this->GetCMakeInstance()->GetHomeOutputDirectory(), "/CMakeCache.txt"));
+    this->WriteRegenerateInputHashes(lfiles, { makefileName, check });
+
     // CMake must rerun if a byproduct is missing.
     cmakefileStream << "# Byproducts of CMake generate step:\n"
                     << "set(CMAKE_MAKEFILE_PRODUCTS\n";
@@ -437,7 +470,23 @@ void cmGlobalUnixMakefileGenerator3::WriteDirectoryRules2(
   }
 
   // Write directory-level rules for "all".
-  this->WriteDirectoryRule2(ruleFileStream, rootLG, dt, "all", true, false);
+  {
+    std::vector<std::string> cmds;
+    if (this->BuildStamp && lg->IsRootMakefile()) {
+      // Record the state of the build after everything is up to date.
+      std::string const dir =
+        cmStrCat(rootLG.GetBinaryDirectory(), "/CMakeFiles/");
+      cmds.push_back(cmStrCat(
+        "$(CMAKE_COMMAND) -E cmake_build_stamp update ",
+        rootLG.ConvertToOutputFormat(cmStrCat(dir, "BuildStampManifest.txt"),
+                                     cmOutputConverter::SHELL),
+        ' ',
+        rootLG.ConvertToOutputFormat(cmStrCat(dir, "BuildStamp.txt"),
+                                     cmOutputConverter::SHELL)));
+    }
+    this->WriteDirectoryRule2(ruleFileStream, rootLG, dt, "all", true, false,
+                              cmds);
+  }
 
   // Write directory-level rules for "codegen".
   this->WriteDirectoryRule2(ruleFileStream, rootLG, dt, "codegen", true,
@@ -720,9 +769,7 @@ void cmGlobalUnixMakefileGenerator3::WriteConvenienceRules2(
         progCmd << lg.ConvertToOutputFormat(progress.Dir,
                                             cmOutputConverter::SHELL);
         //
-        std::set<cmGeneratorTarget const*> emitted;
-        progCmd << " "
-                << this->CountProgressMarksInTarget(gtarget.get(), emitted);
+        progCmd << " " << this->CountProgressMarksInTarget(gtarget.get());
         commands.push_back(progCmd.str());
       }
       std::string tmp = "CMakeFiles/Makefile2";
@@ -827,34 +874,113 @@ void cmGlobalUnixMakefileGenerator3::InitializeProgressMarks()
   }
 }
 
-size_t cmGlobalUnixMakefileGenerator3::CountProgressMarksInTarget(
-  cmGeneratorTarget const* target, std::set<cmGeneratorTarget const*>& emitted)
+void cmGlobalUnixMakefileGenerator3::ComputeProgressReach()
 {
-  size_t count = 0;
-  if (emitted.insert(target).second) {
-    count = this->ProgressMap[target].Marks.size();
-    for (cmTargetDepend const& depend : this->GetTargetDirectDepends(target)) {
+  // Number the targets and build their dependency graph.  Dependencies
+  // not in the build system do not contribute progress marks.
+  this->ProgressTargetIndex.clear();
+  this->ProgressTargets.clear();
+  for (auto const& lg : this->LocalGenerators) {
+    for (auto const& gt : lg->GetGeneratorTargets()) {
+      this->ProgressTargetIndex.emplace(gt.get(),
+                                        this->ProgressTargets.size());
+      this->ProgressTargets.push_back(gt.get());
+    }
+  }
+  cmGraphAdjacencyList graph;
+  for (size_t i = 0; i < this->ProgressTargets.size(); ++i) {
+    graph.emplace_back();
+    for (cmTargetDepend const& depend :
+         this->GetTargetDirectDepends(this->ProgressTargets[i])) {
       if (!depend->IsInBuildSystem()) {
         continue;
       }
-      count += this->CountProgressMarksInTarget(depend, emitted);
+      auto entry = this->ProgressTargetIndex.emplace(
+        depend, this->ProgressTargets.size());
+      if (entry.second) {
+        this->ProgressTargets.push_back(depend);
+      }
+      graph[i].emplace_back(entry.first->second, true, false,
+                            cmListFileBacktrace());
+    }
+  }
+
+  this->ProgressTargetMarks.clear();
+  for (cmGeneratorTarget const* target : this->ProgressTargets) {
+    auto const i = this->ProgressMap.find(target);
+    this->ProgressTargetMarks.push_back(
+      i != this->ProgressMap.end() ? i->second.Marks.size() : 0);
+  }
+
+  cmComputeComponentGraph ccg(graph);
+  ccg.Compute();
+  this->ProgressTargetComponent = ccg.GetComponentMap();
+
+  // Components are identified in topological order, so the components a
+  // component depends on have already been computed.
+  size_t const words = (this->ProgressTargets.size() + 63) / 64;
+  std::vector<cmGraphNodeList> const& components = ccg.GetComponents();
+  this->ProgressComponentReach.assign(components.size(),
+                                      TargetBitSet(words, 0));
+  for (size_t c = 0; c < components.size(); ++c) {
+    TargetBitSet& reach = this->ProgressComponentReach[c];
+    for (size_t i : components[c]) {
+      reach[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+    for (cmGraphEdge const& edge : ccg.GetComponentGraphEdges(c)) {
+      TargetBitSet const& dependReach = this->ProgressComponentReach[edge];
+      for (size_t w = 0; w < words; ++w) {
+        reach[w] |= dependReach[w];
+      }
+    }
+  }
+}
+
+size_t cmGlobalUnixMakefileGenerator3::CountProgressMarks(
+  TargetBitSet const& reach) const
+{
+  size_t count = 0;
+  for (size_t i = 0; i < this->ProgressTargetMarks.size(); ++i) {
+    if ((reach[i / 64] >> (i % 64)) & 1) {
+      count += this->ProgressTargetMarks[i];
     }
   }
   return count;
 }
 
+size_t cmGlobalUnixMakefileGenerator3::CountProgressMarksInTarget(
+  cmGeneratorTarget const* target)
+{
+  auto i = this->ProgressTargetIndex.find(target);
+  if (i == this->ProgressTargetIndex.end()) {
+    return this->ProgressMap[target].Marks.size();
+  }
+  return this->CountProgressMarks(
+    this->ProgressComponentReach[this->ProgressTargetComponent[i->second]]);
+}
+
 size_t cmGlobalUnixMakefileGenerator3::CountProgressMarksInAll(
   cmLocalGenerator const& lg)
 {
+  TargetBitSet reach((this->ProgressTargets.size() + 63) / 64, 0);
   size_t count = 0;
-  std::set<cmGeneratorTarget const*> emitted;
   for (cmGeneratorTarget const* target :
        this->DirectoryTargetsMap[lg.GetStateSnapshot()]) {
-    if (!this->IsExcluded(&lg, target)) {
-      count += this->CountProgressMarksInTarget(target, emitted);
+    if (this->IsExcluded(&lg, target)) {
+      continue;
+    }
+    auto i = this->ProgressTargetIndex.find(target);
+    if (i == this->ProgressTargetIndex.end()) {
+      count += this->ProgressMap[target].Marks.size();
+      continue;
+    }
+    TargetBitSet const& targetReach =
+      this->ProgressComponentReach[this->ProgressTargetComponent[i->second]];
+    for (size_t w = 0; w < reach.size(); ++w) {
+      reach[w] |= targetReach[w];
     }
   }
-  return count;
+  return count + this->CountProgressMarks(reach);
 }
 
 void cmGlobalUnixMakefileGenerator3::RecordTargetProgress(
@@ -865,6 +991,123 @@ void cmGlobalUnixMakefileGenerator3::RecordTargetProgress(
   tp.VariableFile = tg->GetProgressFileNameFull();
 }
 
+void cmGlobalUnixMakefileGenerator3::RecordTargetBuildStamp(
+  cmMakefileTargetGenerator* tg)
+{
+  if (!this->BuildStamp) {
+    return;
+  }
+  cmGeneratorTarget* gt = tg->GetGeneratorTarget();
+  auto* lg =
+    static_cast<cmLocalUnixMakefileGenerator3*>(gt->GetLocalGenerator());
+  std::string const& topBinDir = lg->GetBinaryDirectory();
+  auto fullPath = [&topBinDir](std::string const& path) -> std::string {
+    return cmSystemTools::CollapseFullPath(path, topBinDir);
+  };
+
+  auto const& rules = tg->GetRecordedRules();
+  std::unordered_map<std::string, std::vector<size_t>> rulesByTarget;
+  for (size_t i = 0; i < rules.size(); ++i) {
+    rulesByTarget[rules[i].Target].push_back(i);
+  }
+
+  BuildStampTarget& bst = this->BuildStampTargets[gt];
+  bst.SourceDirectory = lg->GetCurrentSourceDirectory();
+  bst.BinaryDirectory = lg->GetCurrentBinaryDirectory();
+  bst.TargetDirectory = cmStrCat(lg->GetCurrentBinaryDirectory(), '/',
+                                 lg->GetTargetDirectory(gt));
+
+  // Collect the rules reachable from the build rule of the target.  The
+  // others, such as those preprocessing single sources, are not run by
+  // the "all" target.
+  std::string const buildRule = lg->MaybeRelativeToTopBinDir(
+    cmStrCat(lg->GetRelativeTargetDirectory(gt), "/build"));
+  std::set<std::string> visited{ buildRule };
+  std::vector<std::string> queue{ buildRule };
+  while (!queue.empty()) {
+    std::string const name = std::move(queue.back());
+    queue.pop_back();
+    auto const i = rulesByTarget.find(name);
+    if (i == rulesByTarget.end()) {
+      continue;
+    }
+    for (size_t r : i->second) {
+      auto const& rule = rules[r];
+      if (rule.Symbolic) {
+        // Symbolic rules with commands run on every build.
+        bst.AlwaysOutOfDate = bst.AlwaysOutOfDate || rule.HasCommands;
+      } else if (rule.HasCommands) {
+        std::set<std::string>& depends = bst.Rules[fullPath(rule.Target)];
+        for (std::string const& depend : rule.Depends) {
+          depends.insert(fullPath(depend));
+        }
+      }
+      for (std::string const& depend : rule.Depends) {
+        if (visited.insert(depend).second) {
+          queue.push_back(depend);
+        }
+      }
+    }
+  }
+}
+
+void cmGlobalUnixMakefileGenerator3::WriteBuildStampManifest()
+{
+  auto& rootLG = cm::static_reference_cast<cmLocalUnixMakefileGenerator3>(
+    this->LocalGenerators[0]);
+
+  // Open the manifest.  This should not be copy-if-different because
+  // the stamp records its time to notice that the build system changed.
+  std::string const manifestName = cmStrCat(
+    rootLG.GetBinaryDirectory(), "/CMakeFiles/BuildStampManifest.txt");
+  cmGeneratedFileStream fout(manifestName);
+  rootLG.WriteDisclaimer(fout);
+  fout << "home-source " << rootLG.GetSourceDirectory() << "\n"
+       << "home-binary " << rootLG.GetBinaryDirectory() << "\n";
+
+  // Describe the targets built by the top-level "all" target.
+  TargetBitSet reach((this->ProgressTargets.size() + 63) / 64, 0);
+  for (cmGeneratorTarget const* target :
+       this->DirectoryTargetsMap[rootLG.GetStateSnapshot()]) {
+    if (this->IsExcluded(&rootLG, target)) {
+      continue;
+    }
+    auto i = this->ProgressTargetIndex.find(target);
+    if (i == this->ProgressTargetIndex.end()) {
+      continue;
+    }
+    TargetBitSet const& targetReach =
+      this->ProgressComponentReach[this->ProgressTargetComponent[i->second]];
+    for (size_t w = 0; w < reach.size(); ++w) {
+      reach[w] |= targetReach[w];
+    }
+  }
+  for (size_t i = 0; i < this->ProgressTargets.size(); ++i) {
+    cmGeneratorTarget const* target = this->ProgressTargets[i];
+    if (!((reach[i / 64] >> (i % 64)) & 1) || !target->IsInBuildSystem()) {
+      continue;
+    }
+    auto const bst = this->BuildStampTargets.find(target);
+    if (bst == this->BuildStampTargets.end()) {
+      // We do not know what building this target does.
+      fout << "always\n";
+      continue;
+    }
+    fout << "target " << bst->second.TargetDirectory << "\n"
+         << "source " << bst->second.SourceDirectory << "\n"
+         << "binary " << bst->second.BinaryDirectory << "\n";
+    if (bst->second.AlwaysOutOfDate) {
+      fout << "always\n";
+    }
+    for (auto const& rule : bst->second.Rules) {
+      fout << "rule " << rule.first << "\n";
+      for (std::string const& depend : rule.second) {
+        fout << "depend " << depend << "\n";
+      }
+    }
+  }
+}
+
 void cmGlobalUnixMakefileGenerator3::TargetProgress::WriteProgressVariables(
   unsigned long total, unsigned long& current)
 {
@@ -1001,3 +1244,289 @@ void cmGlobalUnixMakefileGenerator3::WriteHelpRule(
                     commands, true);
   ruleFileStream << "\n\n";
 }
+
+#ifndef CMAKE_BOOTSTRAP
+namespace {
+// The targets described by the build stamp manifest.
+struct BuildStampManifest
+{
+  struct Target
+  {
+    std::string TargetDirectory;
+    std::string SourceDirectory;
+    std::string BinaryDirectory;
+    std::vector<std::pair<std::string, std::vector<std::string>>> Rules;
+  };
+  std::string HomeSourceDirectory;
+  std::string HomeBinaryDirectory;
+  std::vector<Target> Targets;
+  bool AlwaysOutOfDate = false;
+};
+
+bool ReadBuildStampManifest(std::string const& manifestFile,
+                            BuildStampManifest& manifest)
+{
+  cmsys::ifstream fin(manifestFile.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::string::size_type const space = line.find(' ');
+    cm::string_view const key = cm::string_view(line).substr(0, space);
+    std::string value =
+      space == std::string::npos ? std::string() : line.substr(space + 1);
+    if (key == "always"_s) {
+      manifest.AlwaysOutOfDate = true;
+    } else if (key == "home-source"_s) {
+      manifest.HomeSourceDirectory = std::move(value);
+    } else if (key == "home-binary"_s) {
+      manifest.HomeBinaryDirectory = std::move(value);
+    } else if (key == "target"_s) {
+      manifest.Targets.emplace_back();
+      manifest.Targets.back().TargetDirectory = std::move(value);
+    } else if (manifest.Targets.empty()) {
+      return false;
+    } else if (key == "source"_s) {
+      manifest.Targets.back().SourceDirectory = std::move(value);
+    } else if (key == "binary"_s) {
+      manifest.Targets.back().BinaryDirectory = std::move(value);
+    } else if (key == "rule"_s) {
+      manifest.Targets.back().Rules.emplace_back(std::move(value),
+                                                 std::vector<std::string>());
+    } else if (key == "depend"_s && !manifest.Targets.back().Rules.empty()) {
+      manifest.Targets.back().Rules.back().second.push_back(std::move(value));
+    } else {
+      return false;
+    }
+  }
+  return !manifest.HomeSourceDirectory.empty() &&
+    !manifest.HomeBinaryDirectory.empty();
+}
+
+// Read the dependencies scanned by CMake itself for a target.
+bool ReadScannedDependencies(std::string const& internalDependFile,
+                             cmDepends::DependencyMap& dependencies)
+{
+  cmsys::ifstream fin(internalDependFile.c_str());
+  if (!fin) {
+    return false;
+  }
+  std::string line;
+  std::vector<std::string>* current = nullptr;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    if (line[0] != ' ') {
+      current = &dependencies[line];
+    } else if (current) {
+      current->push_back(line.substr(1));
+    }
+  }
+  return true;
+}
+
+// Whether MAKEFLAGS asks to consider every target out of date.
+bool MakeAlwaysMakes()
+{
+  std::string makeflags;
+  if (!cmSystemTools::GetEnv("MAKEFLAGS", makeflags)) {
+    return false;
+  }
+  std::vector<std::string> const words = cmTokenize(makeflags, " ");
+  for (size_t i = 0; i < words.size(); ++i) {
+    std::string const& word = words[i];
+    if (word == "--") {
+      // Variable assignments follow.
+      break;
+    }
+    if (word == "--always-make") {
+      return true;
+    }
+    // GNU make lists single letter flags without a dash in the first word.
+    if (i == 0 && !cmHasLiteralPrefix(word, "--") &&
+        word.find('=') == std::string::npos &&
+        word.find('B') != std::string::npos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The build stamp lists the time of every file the last complete build
+// depended on.  The build is up to date while none of them changed.
+bool CheckBuildStamp(std::string const& stampFile)
+{
+  if (MakeAlwaysMakes()) {
+    return false;
+  }
+  cmsys::ifstream fin(stampFile.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  bool haveFiles = false;
+  std::string line;
+  cmFileTime fileTime;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    char* end = nullptr;
+    long long const time = std::strtoll(line.c_str(), &end, 10);
+    if (*end != ' ' || !fileTime.Load(end + 1) ||
+        fileTime.GetTime() != time) {
+      return false;
+    }
+    haveFiles = true;
+  }
+  return haveFiles;
+}
+
+void UpdateBuildStamp(std::string const& manifestFile,
+                      std::string const& stampFile)
+{
+  // A stale stamp must not survive if the build turns out not to be
+  // up to date.
+  cmSystemTools::RemoveFile(stampFile);
+
+  BuildStampManifest manifest;
+  if (!ReadBuildStampManifest(manifestFile, manifest) ||
+      manifest.AlwaysOutOfDate) {
+    return;
+  }
+  std::string const& homeBinDir = manifest.HomeBinaryDirectory;
+
+  // Load the time of each file once.  Missing files have no entry.
+  std::map<std::string, cmFileTime> fileTimes;
+  std::set<std::string> missingFiles;
+  auto getFileTime = [&](std::string const& path) -> cmFileTime const* {
+    std::string const fullPath =
+      cmSystemTools::CollapseFullPath(path, homeBinDir);
+    auto const i = fileTimes.find(fullPath);
+    if (i != fileTimes.end()) {
+      return &i->second;
+    }
+    if (missingFiles.count(fullPath)) {
+      return nullptr;
+    }
+    cmFileTime fileTime;
+    if (!fileTime.Load(fullPath)) {
+      missingFiles.insert(fullPath);
+      return nullptr;
+    }
+    return &fileTimes.emplace(fullPath, fileTime).first->second;
+  };
+  auto upToDate = [&](std::string const& output,
+                      std::vector<std::string> const& inputs) -> bool {
+    cmFileTime const* outputTime = getFileTime(output);
+    if (!outputTime) {
+      return false;
+    }
+    for (std::string const& input : inputs) {
+      cmFileTime const* inputTime = getFileTime(input);
+      if (!inputTime || outputTime->Older(*inputTime)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // Make would run no rule of the build system.
+  for (BuildStampManifest::Target const& target : manifest.Targets) {
+    for (auto const& rule : target.Rules) {
+      if (!upToDate(rule.first, rule.second)) {
+        return;
+      }
+    }
+  }
+
+  // Nor a rule for the dependencies found while building.
+  cmake cm(cmake::RoleScript, cmState::Unknown);
+  cm.SetHomeDirectory(manifest.HomeSourceDirectory);
+  cm.SetHomeOutputDirectory(homeBinDir);
+  cm.GetCurrentSnapshot().SetDefaultDefinitions();
+  auto gg = cm.CreateGlobalGenerator("Unix Makefiles");
+  if (!gg) {
+    return;
+  }
+  cm.SetGlobalGenerator(std::move(gg));
+  for (BuildStampManifest::Target const& target : manifest.Targets) {
+    std::string const dependInfo =
+      cmStrCat(target.TargetDirectory, "/DependInfo.cmake");
+    if (!cmSystemTools::FileExists(dependInfo)) {
+      continue;
+    }
+    cmStateSnapshot snapshot = cm.GetCurrentSnapshot();
+    snapshot.GetDirectory().SetCurrentBinary(target.BinaryDirectory);
+    snapshot.GetDirectory().SetCurrentSource(target.SourceDirectory);
+    cmMakefile mf(cm.GetGlobalGenerator(), snapshot);
+    auto lg = cm.GetGlobalGenerator()->CreateLocalGenerator(&mf);
+    lg->SetRelativePathTop(manifest.HomeSourceDirectory, homeBinDir);
+    if (!mf.ReadListFile(dependInfo)) {
+      return;
+    }
+
+    cmDepends::DependencyMap dependencies;
+    cmList const languages{ mf.GetSafeDefinition("CMAKE_DEPENDS_LANGUAGES") };
+    if (!languages.empty()) {
+      // Fortran module dependencies are not described by the scanned
+      // dependencies alone.
+      if (cm::contains(languages, "Fortran") ||
+          !ReadScannedDependencies(
+            cmStrCat(target.TargetDirectory, "/depend.internal"),
+            dependencies)) {
+        return;
+      }
+    }
+    cmList const depFiles{ mf.GetSafeDefinition(
+                             "CMAKE_DEPENDS_DEPENDENCY_FILES"),
+                           cmList::EmptyElements::Yes };
+    if (!depFiles.empty()) {
+      cmDependsCompiler depsManager;
+      depsManager.SetLocalGenerator(
+        static_cast<cmLocalUnixMakefileGenerator3*>(lg.get()));
+      depsManager.ReadDependencies(
+        cmStrCat(target.TargetDirectory, "/compiler_depend.internal"),
+        depFiles, dependencies);
+    }
+
+    for (auto const& node : dependencies) {
+      // Dependencies of files no longer built do not matter.
+      if (getFileTime(node.first) && !upToDate(node.first, node.second)) {
+        return;
+      }
+    }
+  }
+
+  // Record the time of every file consulted, including the manifest
+  // which changes whenever the build system is generated.
+  getFileTime(manifestFile);
+  cmGeneratedFileStream fout(stampFile);
+  fout << "# CMAKE generated file: DO NOT EDIT!\n";
+  for (auto const& fileTime : fileTimes) {
+    fout << fileTime.second.GetTime() << ' ' << fileTime.first << '\n';
+  }
+}
+}
+
+int cmcmd_cmake_build_stamp(std::vector<std::string>::const_iterator argBeg,
+                            std::vector<std::string>::const_iterator argEnd)
+{
+  std::vector<std::string> const args(argBeg, argEnd);
+  if (args.size() == 2 && args[0] == "check") {
+    return CheckBuildStamp(args[1]) ? 0 : 1;
+  }
+  if (args.size() == 3 && args[0] == "update") {
+    // Failing to record the stamp only loses the fast path.
+    UpdateBuildStamp(args[1], args[2]);
+    return 0;
+  }
+  cmSystemTools::Error("-E cmake_build_stamp requires check <stamp> or "
+                       "update <manifest> <stamp>");
+  return 1;
+}
+#endif
@@ -5,11 +5,13 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <cstddef>
+#include <cstdint>
 #include <iosfwd>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "cmBuildOptions.h"
@@ -105,6 +107,8 @@ public:
    */
   bool SupportsLinkerDependencyFile() const override { return true; }
 
+  bool SupportsDeferredFileCommits() const override { return true; }
+
   /** Get the documentation entry for this generator.  */
   static cmDocumentationEntry GetDocumentation();
 
@@ -176,9 +180,22 @@ public:
     std::vector<std::string> const& makeOptions =
       std::vector<std::string>()) override;
 
+  std::vector<std::string> GetKeepGoingBuildOptions() const override
+  {
+    return { "-k" };
+  }
+
   /** Record per-target progress information.  */
   void RecordTargetProgress(cmMakefileTargetGenerator* tg);
 
+  /** Whether the top-level "all" target skips builds that have nothing
+      to do using the CMAKE_MAKEFILE_BUILD_STAMP stamp file.  */
+  bool IsBuildStampEnabled() const { return this->BuildStamp; }
+
+  /** Record the rules the build of the target runs for the build
+      stamp manifest.  */
+  void RecordTargetBuildStamp(cmMakefileTargetGenerator* tg);
+
   void AddCXXCompileCommand(std::string const& sourceFile,
                             std::string const& workingDirectory,
                             std::string const& compileCommand,
@@ -284,9 +301,7 @@ protected:
                                    cmGeneratorTarget::StrictTargetComparison>;
   ProgressMapType ProgressMap;
 
-  size_t CountProgressMarksInTarget(
-    cmGeneratorTarget const* target,
-    std::set<cmGeneratorTarget const*>& emitted);
+  size_t CountProgressMarksInTarget(cmGeneratorTarget const* target);
   size_t CountProgressMarksInAll(cmLocalGenerator const& lg);
 
   std::unique_ptr<cmGeneratedFileStream> CommandDatabase;
@@ -298,4 +313,34 @@ private:
            cmStateSnapshot::StrictWeakOrder>
     DirectoryTargetsMap;
   void InitializeProgressMarks() override;
+
+  // The set of targets reachable from each target through target-level
+  // dependencies, as bits indexed by ProgressTargetIndex.  The sets are
+  // computed bottom-up once per strongly connected component of the
+  // dependency graph so that each target reuses the sets of its
+  // dependencies.
+  using TargetBitSet = std::vector<std::uint64_t>;
+  std::unordered_map<cmGeneratorTarget const*, size_t> ProgressTargetIndex;
+  std::vector<cmGeneratorTarget const*> ProgressTargets;
+  std::vector<size_t> ProgressTargetMarks;
+  std::vector<size_t> ProgressTargetComponent;
+  std::vector<TargetBitSet> ProgressComponentReach;
+  void ComputeProgressReach();
+  size_t CountProgressMarks(TargetBitSet const& reach) const;
+
+  // The rules that building each target with a build stamp runs, by
+  // full path of the file they update, with their full dependencies.
+  struct BuildStampTarget
+  {
+    std::string SourceDirectory;
+    std::string BinaryDirectory;
+    std::string TargetDirectory;
+    std::map<std::string, std::set<std::string>> Rules;
+    bool AlwaysOutOfDate = false;
+  };
+  std::map<cmGeneratorTarget const*, BuildStampTarget,
+           cmGeneratorTarget::StrictTargetComparison>
+    BuildStampTargets;
+  bool BuildStamp = false;
+  void WriteBuildStampManifest();
 };
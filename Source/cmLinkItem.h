@@ -66,6 +66,9 @@ struct cmLinkImplementationLibraries
 
   // Whether the list depends on a genex referencing the configuration.
   bool HadContextSensitiveCondition = false;
+
+  // Whether the list is known to be the same in every configuration.
+  bool ConfigIndependent = false;
 };
 
 struct cmLinkInterfaceLibraries
@@ -326,6 +326,7 @@ bool cmListFileParser::AddArgument(cmListFileLexer_Token* token,
     return false;
   }
   this->Messenger->IssueMessage(MessageType::AUTHOR_WARNING, msg, lfbt);
+  this->ListFile->HasWarnings = true;
   return true;
 }
 
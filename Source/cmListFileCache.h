@@ -244,4 +244,7 @@ struct cmListFile
                    cmMessenger* messenger, cmListFileBacktrace const& lfbt);
 
   std::vector<cmListFileFunction> Functions;
+
+  // Whether parsing issued warnings.
+  bool HasWarnings = false;
 };
@@ -0,0 +1,346 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmListFileParseCache.h"
+
+#include <cstdint>
+#include <ctime>
+#include <utility>
+
+#include <cm/string_view>
+
+#include "cmsys/FStream.hxx"
+#include "cmsys/SystemTools.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmGeneratedFileStream.h"
+#include "cmSystemTools.h"
+
+namespace {
+
+// Bump the version whenever the layout below changes.
+//
+//   file     := magic version:u32 count:u32 entry*
+//   entry    := path:str hash:str size:u64 mtime:u64 body:str
+//   body     := count:u32 function*
+//   function := name:str line:u32 lineEnd:u32 count:u32 argument*
+//   argument := value:str delim:u8 line:u32
+//   str      := size:u32 byte*
+//
+// The body of an entry is decoded only when the entry is used.
+cm::string_view const Magic = "CMLFPC";
+std::uint32_t const Version = 1;
+
+class Writer
+{
+public:
+  void U8(unsigned char v) { this->Data.push_back(static_cast<char>(v)); }
+
+  void U32(std::uint32_t v)
+  {
+    for (int i = 0; i < 4; ++i) {
+      this->U8(static_cast<unsigned char>((v >> (8 * i)) & 0xFF));
+    }
+  }
+
+  void U64(std::uint64_t v)
+  {
+    this->U32(static_cast<std::uint32_t>(v & 0xFFFFFFFF));
+    this->U32(static_cast<std::uint32_t>(v >> 32));
+  }
+
+  void Str(cm::string_view s)
+  {
+    this->U32(static_cast<std::uint32_t>(s.size()));
+    this->Data.append(s.data(), s.size());
+  }
+
+  std::string Data;
+};
+
+class Reader
+{
+public:
+  Reader(cm::string_view data)
+    : Cur(data.data())
+    , End(data.data() + data.size())
+  {
+  }
+
+  bool AtEnd() const { return this->Cur == this->End; }
+
+  bool Raw(cm::string_view expect)
+  {
+    if (static_cast<std::size_t>(this->End - this->Cur) < expect.size() ||
+        cm::string_view(this->Cur, expect.size()) != expect) {
+      return false;
+    }
+    this->Cur += expect.size();
+    return true;
+  }
+
+  bool U8(unsigned char& v)
+  {
+    if (this->Cur == this->End) {
+      return false;
+    }
+    v = static_cast<unsigned char>(*this->Cur++);
+    return true;
+  }
+
+  bool U32(std::uint32_t& v)
+  {
+    v = 0;
+    for (int i = 0; i < 4; ++i) {
+      unsigned char b;
+      if (!this->U8(b)) {
+        return false;
+      }
+      v |= static_cast<std::uint32_t>(b) << (8 * i);
+    }
+    return true;
+  }
+
+  bool U64(std::uint64_t& v)
+  {
+    std::uint32_t lo;
+    std::uint32_t hi;
+    if (!this->U32(lo) || !this->U32(hi)) {
+      return false;
+    }
+    v = (static_cast<std::uint64_t>(hi) << 32) | lo;
+    return true;
+  }
+
+  bool Str(cm::string_view& s)
+  {
+    std::uint32_t size;
+    if (!this->U32(size) ||
+        static_cast<std::size_t>(this->End - this->Cur) < size) {
+      return false;
+    }
+    s = cm::string_view(this->Cur, size);
+    this->Cur += size;
+    return true;
+  }
+
+  bool Str(std::string& s)
+  {
+    cm::string_view v;
+    if (!this->Str(v)) {
+      return false;
+    }
+    s.assign(v.data(), v.size());
+    return true;
+  }
+
+private:
+  char const* Cur;
+  char const* End;
+};
+
+bool DecodeFunctions(cm::string_view body,
+                     std::vector<cmListFileFunction>& functions)
+{
+  Reader r(body);
+  std::uint32_t count;
+  if (!r.U32(count)) {
+    return false;
+  }
+  functions.reserve(count);
+  for (std::uint32_t i = 0; i < count; ++i) {
+    std::string name;
+    std::uint32_t line;
+    std::uint32_t lineEnd;
+    std::uint32_t argCount;
+    if (!r.Str(name) || !r.U32(line) || !r.U32(lineEnd) ||
+        !r.U32(argCount)) {
+      return false;
+    }
+    std::vector<cmListFileArgument> args;
+    args.reserve(argCount);
+    for (std::uint32_t j = 0; j < argCount; ++j) {
+      std::string value;
+      unsigned char delim;
+      std::uint32_t argLine;
+      if (!r.Str(value) || !r.U8(delim) || !r.U32(argLine) ||
+          delim > cmListFileArgument::Bracket) {
+        return false;
+      }
+      args.emplace_back(std::move(value),
+                        static_cast<cmListFileArgument::Delimiter>(delim),
+                        static_cast<long>(argLine));
+    }
+    functions.emplace_back(std::move(name), static_cast<long>(line),
+                           static_cast<long>(lineEnd), std::move(args));
+  }
+  return r.AtEnd();
+}
+
+std::string EncodeFunctions(std::vector<cmListFileFunction> const& functions)
+{
+  Writer w;
+  w.U32(static_cast<std::uint32_t>(functions.size()));
+  for (cmListFileFunction const& function : functions) {
+    w.Str(function.OriginalName());
+    w.U32(static_cast<std::uint32_t>(function.Line()));
+    w.U32(static_cast<std::uint32_t>(function.LineEnd()));
+    w.U32(static_cast<std::uint32_t>(function.Arguments().size()));
+    for (cmListFileArgument const& arg : function.Arguments()) {
+      w.Str(arg.Value);
+      w.U8(static_cast<unsigned char>(arg.Delim));
+      w.U32(static_cast<std::uint32_t>(arg.Line));
+    }
+  }
+  return std::move(w.Data);
+}
+}
+
+cmListFileParseCache::cmListFileParseCache(std::string cacheFile)
+  : CacheFile(std::move(cacheFile))
+{
+}
+
+bool cmListFileParseCache::Load()
+{
+  cmsys::ifstream fin(this->CacheFile.c_str(),
+                      std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  fin.seekg(0, std::ios::end);
+  std::streamoff const length = fin.tellg();
+  fin.seekg(0, std::ios::beg);
+  if (length <= 0) {
+    return false;
+  }
+  std::string data(static_cast<std::size_t>(length), '\0');
+  if (!fin.read(&data[0], length)) {
+    return false;
+  }
+
+  Reader r(data);
+  std::uint32_t version;
+  std::uint32_t count;
+  if (!r.Raw(Magic) || !r.U32(version) || version != Version ||
+      !r.U32(count)) {
+    return false;
+  }
+  std::unordered_map<std::string, Entry> entries;
+  for (std::uint32_t i = 0; i < count; ++i) {
+    std::string path;
+    Entry entry;
+    if (!r.Str(path) || !r.Str(entry.Hash) || !r.U64(entry.Size) ||
+        !r.U64(entry.MTime) || !r.Str(entry.Body)) {
+      return false;
+    }
+    entries.emplace(std::move(path), std::move(entry));
+  }
+  this->Entries = std::move(entries);
+  return true;
+}
+
+bool cmListFileParseCache::Save() const
+{
+  if (!this->Modified) {
+    return true;
+  }
+
+  // Drop entries of listfiles that no longer exist.
+  std::vector<std::pair<std::string const, Entry> const*> entries;
+  entries.reserve(this->Entries.size());
+  for (auto const& e : this->Entries) {
+    if (cmSystemTools::FileExists(e.first, true)) {
+      entries.push_back(&e);
+    }
+  }
+
+  Writer w;
+  w.Data.append(Magic.data(), Magic.size());
+  w.U32(Version);
+  w.U32(static_cast<std::uint32_t>(entries.size()));
+  for (auto const* e : entries) {
+    w.Str(e->first);
+    w.Str(e->second.Hash);
+    w.U64(e->second.Size);
+    w.U64(e->second.MTime);
+    w.Str(e->second.Body);
+  }
+
+  cmGeneratedFileStream fout;
+  fout.Open(this->CacheFile, true, true);
+  fout.write(w.Data.data(), static_cast<std::streamsize>(w.Data.size()));
+  return fout.Close();
+}
+
+bool cmListFileParseCache::ParseFile(cmListFile& listFile,
+                                     std::string const& path,
+                                     cmMessenger* messenger,
+                                     cmListFileBacktrace const& lfbt)
+{
+  cmsys::SystemTools::Stat_t st;
+  bool const haveStat = cmsys::SystemTools::Stat(path, &st) == 0;
+  std::uint64_t const size =
+    haveStat ? static_cast<std::uint64_t>(st.st_size) : 0;
+  std::uint64_t const mtime =
+    haveStat ? static_cast<std::uint64_t>(st.st_mtime) : 0;
+
+  auto i = this->Entries.find(path);
+  std::string hash;
+  if (haveStat) {
+    // The size and modification time identify the content recorded in
+    // an entry only if the file was not modified within the timestamp
+    // resolution of its recording.  Otherwise compare the content hash.
+    bool const sameStat = i != this->Entries.end() && i->second.MTime != 0 &&
+      i->second.Size == size && i->second.MTime == mtime;
+    if (!sameStat) {
+      cmCryptoHash md5(cmCryptoHash::AlgoMD5);
+      hash = md5.HashFile(path);
+    }
+    if (i != this->Entries.end() &&
+        (sameStat || (!hash.empty() && i->second.Hash == hash))) {
+      Entry& entry = i->second;
+      if (entry.Functions.empty() &&
+          !DecodeFunctions(entry.Body, entry.Functions)) {
+        entry.Functions.clear();
+      } else {
+        if (!sameStat) {
+          this->UpdateStat(entry, size, mtime);
+        }
+        listFile.Functions = entry.Functions;
+        return true;
+      }
+    }
+  }
+
+  if (!listFile.ParseFile(path.c_str(), messenger, lfbt)) {
+    return false;
+  }
+
+  // Results that produced diagnostics are not stored so that the
+  // diagnostics are issued again on the next parse.
+  if (!hash.empty() && !listFile.HasWarnings) {
+    Entry& entry = this->Entries[path];
+    entry.Hash = std::move(hash);
+    entry.Body = EncodeFunctions(listFile.Functions);
+    entry.Functions = listFile.Functions;
+    this->UpdateStat(entry, size, mtime);
+    this->Modified = true;
+  }
+  return true;
+}
+
+void cmListFileParseCache::UpdateStat(Entry& entry, std::uint64_t size,
+                                      std::uint64_t mtime)
+{
+  // A file modified within the last seconds may be modified again
+  // without a change of its modification time.
+  std::uint64_t const now = static_cast<std::uint64_t>(std::time(nullptr));
+  if (mtime + 2 >= now) {
+    mtime = 0;
+  }
+  if (entry.Size != size || entry.MTime != mtime) {
+    entry.Size = size;
+    entry.MTime = mtime;
+    this->Modified = true;
+  }
+}
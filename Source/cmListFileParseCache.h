@@ -0,0 +1,57 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cmListFileCache.h"
+
+class cmMessenger;
+
+/** \class cmListFileParseCache
+ * \brief Persistent cache of parsed listfiles.
+ *
+ * Maps listfile paths to the functions parsed from them, keyed by the
+ * size, modification time and content hash of the file.  A listfile
+ * whose content is unchanged since it was stored is not lexed again.
+ * The cache may be loaded from and saved to a file so that later
+ * configure runs, possibly of other build trees of the same source tree,
+ * can reuse it.
+ */
+class cmListFileParseCache
+{
+public:
+  cmListFileParseCache(std::string cacheFile);
+
+  /** Load entries stored by a previous run.  Returns false if the cache
+      file does not exist or is not in the expected format.  */
+  bool Load();
+
+  /** Save all entries used or loaded in this run if any changed.  */
+  bool Save() const;
+
+  /** Parse a listfile, reusing the functions stored for its content.  */
+  bool ParseFile(cmListFile& listFile, std::string const& path,
+                 cmMessenger* messenger, cmListFileBacktrace const& lfbt);
+
+private:
+  struct Entry
+  {
+    std::string Hash;
+    std::uint64_t Size = 0;
+    std::uint64_t MTime = 0;
+    std::string Body;
+    std::vector<cmListFileFunction> Functions;
+  };
+
+  void UpdateStat(Entry& entry, std::uint64_t size, std::uint64_t mtime);
+
+  std::string CacheFile;
+  std::unordered_map<std::string, Entry> Entries;
+  bool Modified = false;
+};
@@ -188,6 +188,7 @@ void cmLocalUnixMakefileGenerator3::Generate()
     if (tg) {
       tg->WriteRuleFiles();
       gg->RecordTargetProgress(tg.get());
+      gg->RecordTargetBuildStamp(tg.get());
     }
   }
 
@@ -583,6 +584,17 @@ void cmLocalUnixMakefileGenerator3::WriteMakeRule(
     os << "# " << replace.substr(lpos) << "\n";
   }
 
+  if (this->RecordedRules) {
+    RecordedRule rule;
+    rule.Target = this->MaybeRelativeToTopBinDir(target);
+    for (std::string const& depend : depends) {
+      rule.Depends.push_back(this->MaybeRelativeToTopBinDir(depend));
+    }
+    rule.Symbolic = symbolic;
+    rule.HasCommands = !commands.empty();
+    this->RecordedRules->push_back(std::move(rule));
+  }
+
   // Construct the left hand side of the rule.
   std::string tgt =
     this->ConvertToMakefilePath(this->MaybeRelativeToTopBinDir(target));
@@ -1508,20 +1520,12 @@ bool cmLocalUnixMakefileGenerator3::UpdateDependencies(
         return false;
       }
 
-      // Open the cmake dependency tracking file.  This should not be
-      // copy-if-different because dependencies are re-scanned when it is
-      // older than the DependInfo.cmake.
-      cmGeneratedFileStream internalRuleFileStream(
-        internalDepFile, false, this->GlobalGenerator->GetMakefileEncoding());
-      if (!internalRuleFileStream) {
-        return false;
-      }
-
       this->WriteDisclaimer(ruleFileStream);
-      this->WriteDisclaimer(internalRuleFileStream);
 
-      depsManager.WriteDependencies(dependencies, ruleFileStream,
-                                    internalRuleFileStream);
+      if (!depsManager.WriteDependencies(dependencies, ruleFileStream,
+                                         internalDepFile)) {
+        return false;
+      }
     }
   }
 
@@ -1769,6 +1773,19 @@ void cmLocalUnixMakefileGenerator3::WriteLocalAllRules(
   this->CreateCDCommand(commands, this->GetBinaryDirectory(),
                         this->GetCurrentBinaryDirectory());
   commands.emplace_back(progressFinishCommand);
+  if (this->IsRootMakefile() &&
+      static_cast<cmGlobalUnixMakefileGenerator3*>(this->GlobalGenerator)
+        ->IsBuildStampEnabled()) {
+    // Skip the recursive make entirely while the build stamp shows that
+    // nothing changed since the last complete build.
+    std::string const stampFile = this->ConvertToOutputFormat(
+      cmStrCat(this->GetBinaryDirectory(), "/CMakeFiles/BuildStamp.txt"),
+      cmOutputConverter::SHELL);
+    std::string const command =
+      cmStrCat("$(CMAKE_COMMAND) -E cmake_build_stamp check ", stampFile,
+               " || ( ", cmJoin(commands, " && "), " )");
+    commands.assign(1, command);
+  }
   this->WriteMakeRule(ruleFileStream, "The main all target", "all", depends,
                       commands, true);
 
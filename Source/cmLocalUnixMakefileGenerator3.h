@@ -60,6 +60,24 @@ public:
                      std::vector<std::string> const& commands, bool symbolic,
                      bool in_help = false);
 
+  /** A rule written by WriteMakeRule while rules are recorded.  The
+      target and dependencies are relative to the top build directory
+      when they are inside it.  */
+  struct RecordedRule
+  {
+    std::string Target;
+    std::vector<std::string> Depends;
+    bool Symbolic = false;
+    bool HasCommands = false;
+  };
+
+  /** Record the rules written by WriteMakeRule in the given list.
+      Recording stops when the list is null.  */
+  void SetRecordedRules(std::vector<RecordedRule>* rules)
+  {
+    this->RecordedRules = rules;
+  }
+
   // write the main variables used by the makefiles
   void WriteMakeVariables(std::ostream& makefileStream);
 
@@ -298,6 +316,8 @@ private:
   bool SkipPreprocessedSourceRules;
   bool SkipAssemblySourceRules;
 
+  std::vector<RecordedRule>* RecordedRules = nullptr;
+
   std::set<cmSourceFile const*>& GetCommandsVisited(
     cmGeneratorTarget const* target)
   {
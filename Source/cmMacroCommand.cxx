@@ -20,6 +20,11 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmFindPackageCache.h"
+#  include "cmake.h"
+#endif
+
 namespace {
 
 // define the class for macro commands
@@ -167,18 +172,10 @@ bool cmMacroFunctionBlocker::Replay(std::vector<cmListFileFunction> functions,
                                     cmExecutionStatus& status)
 {
   cmMakefile& mf = status.GetMakefile();
-  mf.AppendProperty("MACROS", this->Args[0]);
-  // create a new command and add it to cmake
-  cmMacroHelperCommand f;
-  f.Args = this->Args;
-  f.Functions = std::move(functions);
-  f.FilePath = this->GetStartingContext().FilePath;
-  mf.RecordPolicies(f.Policies);
-  return mf.GetState()->AddScriptedCommand(
-    this->Args[0],
-    BT<cmState::Command>(std::move(f),
-                         mf.GetBacktrace().Push(this->GetStartingContext())),
-    mf);
+  cmPolicies::PolicyMap policies;
+  mf.RecordPolicies(policies);
+  return cmDefineMacro(mf, this->Args, std::move(functions),
+                       this->GetStartingContext(), policies);
 }
 }
 
@@ -198,3 +195,28 @@ bool cmMacroCommand(std::vector<std::string> const& args,
   }
   return true;
 }
+
+bool cmDefineMacro(cmMakefile& mf, std::vector<std::string> const& args,
+                   std::vector<cmListFileFunction> functions,
+                   cmListFileContext const& context,
+                   cmPolicies::PolicyMap const& policies)
+{
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        mf.GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordCommandDefinition("macro"_s, args, functions, context,
+                                   policies);
+  }
+#endif
+
+  mf.AppendProperty("MACROS", args[0]);
+  // create a new command and add it to cmake
+  cmMacroHelperCommand f;
+  f.Args = args;
+  f.Functions = std::move(functions);
+  f.FilePath = context.FilePath;
+  f.Policies = policies;
+  return mf.GetState()->AddScriptedCommand(
+    args[0],
+    BT<cmState::Command>(std::move(f), mf.GetBacktrace().Push(context)), mf);
+}
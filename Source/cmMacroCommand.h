@@ -7,8 +7,20 @@
 #include <string>
 #include <vector>
 
+#include "cmPolicies.h"
+
 class cmExecutionStatus;
+class cmListFileContext;
+class cmListFileFunction;
+class cmMakefile;
 
 /// Starts macro() ... endmacro() block
 bool cmMacroCommand(std::vector<std::string> const& args,
                     cmExecutionStatus& status);
+
+/// Defines a macro like a macro() ... endmacro() block with the given
+/// arguments and body at the given context under the given policies
+bool cmDefineMacro(cmMakefile& mf, std::vector<std::string> const& args,
+                   std::vector<cmListFileFunction> functions,
+                   cmListFileContext const& context,
+                   cmPolicies::PolicyMap const& policies);
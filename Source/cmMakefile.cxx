@@ -29,6 +29,7 @@
 #include "cmsys/FStream.hxx"
 #include "cmsys/RegularExpression.hxx"
 
+#include "cmCoreTryCompile.h"
 #include "cmCustomCommand.h"
 #include "cmCustomCommandLines.h"
 #include "cmCustomCommandTypes.h"
@@ -64,6 +65,8 @@
 #include "cmake.h"
 
 #ifndef CMAKE_BOOTSTRAP
+#  include "cmFindPackageCache.h"
+#  include "cmListFileParseCache.h"
 #  include "cmMakefileProfilingData.h"
 #  include "cmVariableWatch.h"
 #endif
@@ -95,6 +98,24 @@ std::string const kCMAKE_CURRENT_LIST_DIR = "CMAKE_CURRENT_LIST_DIR";
 std::string const kCMAKE_CURRENT_LIST_FILE = "CMAKE_CURRENT_LIST_FILE";
 std::string const kCMAKE_PARENT_LIST_FILE = "CMAKE_PARENT_LIST_FILE";
 
+bool ParseListFile(cmListFile& listFile, std::string const& path,
+                   cmMakefile* mf)
+{
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        mf->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordListFile(path);
+  }
+  if (cmListFileParseCache* cache =
+        mf->GetCMakeInstance()->GetListFileParseCache()) {
+    return cache->ParseFile(listFile, path, mf->GetMessenger(),
+                            mf->GetBacktrace());
+  }
+#endif
+  return listFile.ParseFile(path.c_str(), mf->GetMessenger(),
+                            mf->GetBacktrace());
+}
+
 class FileScopeBase
 {
 protected:
@@ -548,6 +569,13 @@ bool cmMakefile::ExecuteCommand(cmListFileFunction const& lff,
   CallScope stack_manager(this, lff, std::move(deferId), status);
   static_cast<void>(stack_manager);
 
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        this->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordCommand(*this, lff);
+  }
+#endif
+
   // Check for maximum recursion depth.
   size_t depthLimit = this->GetRecursionDepthLimit();
   if (this->RecursionDepth > depthLimit) {
@@ -678,8 +706,7 @@ bool cmMakefile::ReadDependentFile(std::string const& filename,
 #endif
 
   cmListFile listFile;
-  if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+  if (!ParseListFile(listFile, filenametoread, this)) {
 #ifdef CMake_ENABLE_DEBUGGER
     if (this->GetCMakeInstance()->GetDebugAdapter()) {
       this->GetCMakeInstance()->GetDebugAdapter()->OnEndFileParse();
@@ -801,8 +828,7 @@ bool cmMakefile::ReadListFile(std::string const& filename)
 #endif
 
   cmListFile listFile;
-  if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+  if (!ParseListFile(listFile, filenametoread, this)) {
 #ifdef CMake_ENABLE_DEBUGGER
     if (this->GetCMakeInstance()->GetDebugAdapter()) {
       this->GetCMakeInstance()->GetDebugAdapter()->OnEndFileParse();
@@ -1563,8 +1589,7 @@ void cmMakefile::Configure()
 #endif
 
   cmListFile listFile;
-  if (!listFile.ParseFile(currentStart.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+  if (!ParseListFile(listFile, currentStart, this)) {
 #ifdef CMake_ENABLE_DEBUGGER
     if (this->GetCMakeInstance()->GetDebugAdapter()) {
       this->GetCMakeInstance()->GetDebugAdapter()->OnEndFileParse();
@@ -2348,6 +2373,12 @@ std::string const& cmMakefile::GetRequiredDefinition(
 
 bool cmMakefile::IsDefinitionSet(std::string const& name) const
 {
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        this->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordVariableRead(name);
+  }
+#endif
   cmValue def = this->StateSnapshot.GetDefinition(name);
   if (!def) {
     def = this->GetState()->GetInitializedCacheValue(name);
@@ -2365,6 +2396,12 @@ bool cmMakefile::IsDefinitionSet(std::string const& name) const
 
 bool cmMakefile::IsNormalDefinitionSet(std::string const& name) const
 {
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        this->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordVariableRead(name);
+  }
+#endif
   cmValue def = this->StateSnapshot.GetDefinition(name);
 #ifndef CMAKE_BOOTSTRAP
   if (cmVariableWatch* vv = this->GetVariableWatch()) {
@@ -2379,6 +2416,12 @@ bool cmMakefile::IsNormalDefinitionSet(std::string const& name) const
 
 cmValue cmMakefile::GetDefinition(std::string const& name) const
 {
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        this->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordVariableRead(name);
+  }
+#endif
   cmValue def = this->StateSnapshot.GetDefinition(name);
   if (!def) {
     def = this->GetState()->GetInitializedCacheValue(name);
@@ -2611,11 +2654,23 @@ MessageType cmMakefile::ExpandVariablesInStringImpl(
               }
               break;
             case ENVIRONMENT:
+#ifndef CMAKE_BOOTSTRAP
+              if (cmFindPackageCache* cache =
+                    this->GetCMakeInstance()->GetFindPackageCache()) {
+                cache->RecordEnvironmentRead(lookup);
+              }
+#endif
               if (cmSystemTools::GetEnv(lookup, svalue)) {
                 value = cmValue(svalue);
               }
               break;
             case CACHE:
+#ifndef CMAKE_BOOTSTRAP
+              if (cmFindPackageCache* cache =
+                    this->GetCMakeInstance()->GetFindPackageCache()) {
+                cache->RecordCacheRead(lookup);
+              }
+#endif
               value = state->GetCacheEntryValue(lookup);
               break;
           }
@@ -3203,7 +3258,8 @@ int cmMakefile::TryCompile(std::string const& srcdir,
                            std::string const& projectName,
                            std::string const& targetName, bool fast, int jobs,
                            std::vector<std::string> const* cmakeArgs,
-                           std::string& output)
+                           std::string& output,
+                           std::vector<std::string> const& nativeOptions)
 {
   this->IsSourceFileTryCompile = fast;
   // does the binary directory exist ? If not create it...
@@ -3322,7 +3378,8 @@ int cmMakefile::TryCompile(std::string const& srcdir,
 
   // finally call the generator to actually build the resulting project
   int ret = this->GetGlobalGenerator()->TryCompile(
-    jobs, srcdir, bindir, projectName, targetName, fast, output, this);
+    jobs, srcdir, bindir, projectName, targetName, fast, output, this,
+    nativeOptions);
 
   this->IsSourceFileTryCompile = false;
   return ret;
@@ -3333,6 +3390,27 @@ bool cmMakefile::GetIsSourceFileTryCompile() const
   return this->IsSourceFileTryCompile;
 }
 
+cmTryCompileBatch& cmMakefile::GetTryCompileBatch(std::string const& name)
+{
+  std::unique_ptr<cmTryCompileBatch>& batch = this->TryCompileBatches[name];
+  if (!batch) {
+    batch = cm::make_unique<cmTryCompileBatch>();
+  }
+  return *batch;
+}
+
+std::unique_ptr<cmTryCompileBatch> cmMakefile::TakeTryCompileBatch(
+  std::string const& name)
+{
+  std::unique_ptr<cmTryCompileBatch> batch;
+  auto i = this->TryCompileBatches.find(name);
+  if (i != this->TryCompileBatches.end()) {
+    batch = std::move(i->second);
+    this->TryCompileBatches.erase(i);
+  }
+  return batch;
+}
+
 cmake* cmMakefile::GetCMakeInstance() const
 {
   return this->GlobalGenerator->GetCMakeInstance();
@@ -3649,6 +3727,12 @@ void cmMakefile::AppendProperty(std::string const& prop,
 
 cmValue cmMakefile::GetProperty(std::string const& prop) const
 {
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        this->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordDirectoryPropertyRead(this, prop);
+  }
+#endif
   // Check for computed properties.
   static std::string output;
   if (prop == "TESTS"_s) {
@@ -3667,6 +3751,12 @@ cmValue cmMakefile::GetProperty(std::string const& prop) const
 
 cmValue cmMakefile::GetProperty(std::string const& prop, bool chain) const
 {
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        this->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordDirectoryPropertyRead(this, prop);
+  }
+#endif
   return this->StateSnapshot.GetDirectory().GetProperty(prop, chain);
 }
 
@@ -3794,6 +3884,13 @@ void cmMakefile::RaiseScope(std::string const& var, char const* varDef)
     return;
   }
 
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        this->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordRaiseScope(this->StateSnapshot);
+  }
+#endif
+
 #ifndef CMAKE_BOOTSTRAP
   cmVariableWatch* vv = this->GetVariableWatch();
   if (vv) {
@@ -3855,6 +3952,12 @@ cmTarget* cmMakefile::AddForeignTarget(std::string const& origin,
 cmTarget* cmMakefile::FindTargetToUse(
   std::string const& name, cmStateEnums::TargetDomainSet domains) const
 {
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        this->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordTargetQuery(name);
+  }
+#endif
   // Look for an imported target.  These take priority because they
   // are more local in scope and do not have to be globally unique.
   auto targetName = name;
@@ -4101,11 +4204,31 @@ cmMakefile::PolicyPushPop::PolicyPushPop(cmMakefile* m)
   this->Makefile->PushPolicy();
 }
 
+cmMakefile::PolicyPushPop::PolicyPushPop(cmMakefile* m,
+                                         cmPolicies::PolicyMap const& pm)
+  : Makefile(m)
+{
+  this->Makefile->PushPolicy(false, pm);
+}
+
 cmMakefile::PolicyPushPop::~PolicyPushPop()
 {
   this->Makefile->PopPolicy();
 }
 
+cmMakefile::BacktracePushPop::BacktracePushPop(cmMakefile* m,
+                                               cmListFileBacktrace bt)
+  : Makefile(m)
+  , Previous(m->Backtrace)
+{
+  this->Makefile->Backtrace = std::move(bt);
+}
+
+cmMakefile::BacktracePushPop::~BacktracePushPop()
+{
+  this->Makefile->Backtrace = std::move(this->Previous);
+}
+
 void cmMakefile::PushPolicy(bool weak, cmPolicies::PolicyMap const& pm)
 {
   this->StateSnapshot.PushPolicy(pm, weak);
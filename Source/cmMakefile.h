@@ -62,6 +62,7 @@ class cmState;
 class cmTest;
 class cmTestGenerator;
 class cmVariableWatch;
+struct cmTryCompileBatch;
 class cmake;
 
 /** A type-safe wrapper for a string representing a directory id.  */
@@ -133,10 +134,21 @@ public:
                  std::string const& projectName, std::string const& targetName,
                  bool fast, int jobs,
                  std::vector<std::string> const* cmakeArgs,
-                 std::string& output);
+                 std::string& output,
+                 std::vector<std::string> const& nativeOptions =
+                   std::vector<std::string>());
 
   bool GetIsSourceFileTryCompile() const;
 
+  /**
+   * Get the batch of try_compile projects with the given name, which
+   * collects the projects generated by try_compile calls with BATCH until
+   * they are built together.
+   */
+  cmTryCompileBatch& GetTryCompileBatch(std::string const& name);
+  std::unique_ptr<cmTryCompileBatch> TakeTryCompileBatch(
+    std::string const& name);
+
   /**
    * Help enforce global target name uniqueness.
    */
@@ -396,6 +408,7 @@ public:
   {
   public:
     PolicyPushPop(cmMakefile* m);
+    PolicyPushPop(cmMakefile* m, cmPolicies::PolicyMap const& pm);
     ~PolicyPushPop();
 
     PolicyPushPop(PolicyPushPop const&) = delete;
@@ -406,6 +419,22 @@ public:
   };
   friend class PolicyPushPop;
 
+  /** Helper class to replace the current backtrace temporarily.  */
+  class BacktracePushPop
+  {
+  public:
+    BacktracePushPop(cmMakefile* m, cmListFileBacktrace bt);
+    ~BacktracePushPop();
+
+    BacktracePushPop(BacktracePushPop const&) = delete;
+    BacktracePushPop& operator=(BacktracePushPop const&) = delete;
+
+  private:
+    cmMakefile* Makefile;
+    cmListFileBacktrace Previous;
+  };
+  friend class BacktracePushPop;
+
   /** Helper class to push and pop variables scopes automatically. */
   class VariablePushPop
   {
@@ -1253,5 +1282,6 @@ private:
   std::set<std::string> WarnedCMP0074;
   std::set<std::string> WarnedCMP0144;
   bool IsSourceFileTryCompile;
+  std::map<std::string, std::unique_ptr<cmTryCompileBatch>> TryCompileBatches;
   ImportedTargetScope CurrentImportedTargetScope = ImportedTargetScope::Local;
 };
@@ -23,6 +23,12 @@ public:
                   cm::optional<Json::Value> args = cm::nullopt);
   void StopEntry();
 
+  /** Record the resident memory of the process as a counter event.  */
+  void RecordMemoryUsage();
+
+  /** Record the values of a counter as a counter event.  */
+  void RecordCounter(std::string const& name, Json::Value const& values);
+
   class RAII
   {
   public:
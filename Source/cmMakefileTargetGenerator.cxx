@@ -201,6 +201,11 @@ void cmMakefileTargetGenerator::CreateRuleFile()
       ".DELETE_ON_ERROR", no_depends, no_commands, false);
   }
   this->LocalGenerator->WriteSpecialTargetsTop(*this->BuildFileStream);
+
+  // Record the rules of the target for the build stamp.
+  if (this->GlobalGenerator->IsBuildStampEnabled()) {
+    this->LocalGenerator->SetRecordedRules(&this->RecordedRules);
+  }
 }
 
 void cmMakefileTargetGenerator::WriteTargetBuildRules()
@@ -2071,6 +2076,7 @@ std::string cmMakefileTargetGenerator::GetLinkRule(
 
 void cmMakefileTargetGenerator::CloseFileStreams()
 {
+  this->LocalGenerator->SetRecordedRules(nullptr);
   this->BuildFileStream.reset();
   this->InfoFileStream.reset();
   this->FlagFileStream.reset();
@@ -54,6 +54,13 @@ public:
   }
   std::string GetProgressFileNameFull() { return this->ProgressFileNameFull; }
 
+  /* return the rules written to the build file, if they were recorded */
+  std::vector<cmLocalUnixMakefileGenerator3::RecordedRule> const&
+  GetRecordedRules() const
+  {
+    return this->RecordedRules;
+  }
+
   cmGeneratorTarget* GetGeneratorTarget() { return this->GeneratorTarget; }
 
   std::string const& GetConfigName() const;
@@ -231,6 +238,9 @@ protected:
   // the stream for the build file
   std::unique_ptr<cmGeneratedFileStream> BuildFileStream;
 
+  // the rules written to the build file
+  std::vector<cmLocalUnixMakefileGenerator3::RecordedRule> RecordedRules;
+
   // the stream for the flag file
   std::string FlagFileNameFull;
   std::unique_ptr<cmGeneratedFileStream> FlagFileStream;
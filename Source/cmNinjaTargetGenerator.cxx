@@ -1274,6 +1274,19 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatements(
         cmStrCat(l, '/', language, "Modules.json"));
     }
 
+    if (this->GetGlobalGenerator()->IsDyndepCollationBatched()) {
+      if (firstForConfig) {
+        this->GetGlobalGenerator()->AddBatchedDyndepCollation(
+          config, language,
+          this->ConvertToNinjaPath(
+            this->GetTargetDependInfoPath(language, config)),
+          this->Makefile->GetSafeDefinition(
+            cmStrCat("CMAKE_", language, "_MODULE_MAP_FORMAT")),
+          std::move(build));
+      }
+      continue;
+    }
+
     this->GetGlobalGenerator()->WriteBuild(this->GetImplFileStream(fileConfig),
                                            build);
   }
@@ -13,11 +13,11 @@ void cmPropertyMap::Clear()
 void cmPropertyMap::SetProperty(std::string const& name, cmValue value)
 {
   if (!value) {
-    this->Map_.erase(name);
+    this->RemoveProperty(name);
     return;
   }
 
-  this->Map_[name] = *value;
+  this->Map_[cmAtom::Intern(name)] = *value;
 }
 
 void cmPropertyMap::AppendProperty(std::string const& name,
@@ -29,7 +29,7 @@ void cmPropertyMap::AppendProperty(std::string const& name,
   }
 
   {
-    std::string& pVal = this->Map_[name];
+    std::string& pVal = this->Map_[cmAtom::Intern(name)];
     if (!pVal.empty() && !asString) {
       pVal += ';';
     }
@@ -39,11 +39,24 @@ void cmPropertyMap::AppendProperty(std::string const& name,
 
 void cmPropertyMap::RemoveProperty(std::string const& name)
 {
-  this->Map_.erase(name);
+  if (cmAtom const atom = cmAtom::Lookup(name)) {
+    this->Map_.erase(atom);
+  }
 }
 
 cmValue cmPropertyMap::GetPropertyValue(std::string const& name) const
 {
+  if (this->Map_.empty()) {
+    return nullptr;
+  }
+  return this->GetPropertyValue(cmAtom::Lookup(name));
+}
+
+cmValue cmPropertyMap::GetPropertyValue(cmAtom name) const
+{
+  if (!name) {
+    return nullptr;
+  }
   auto it = this->Map_.find(name);
   if (it != this->Map_.end()) {
     return cmValue(it->second);
@@ -56,7 +69,7 @@ std::vector<std::string> cmPropertyMap::GetKeys() const
   std::vector<std::string> keyList;
   keyList.reserve(this->Map_.size());
   for (auto const& item : this->Map_) {
-    keyList.push_back(item.first);
+    keyList.push_back(item.first.str());
   }
   std::sort(keyList.begin(), keyList.end());
   return keyList;
@@ -68,7 +81,7 @@ std::vector<std::pair<std::string, std::string>> cmPropertyMap::GetList() const
   std::vector<StringPair> kvList;
   kvList.reserve(this->Map_.size());
   for (auto const& item : this->Map_) {
-    kvList.emplace_back(item.first, item.second);
+    kvList.emplace_back(item.first.str(), item.second);
   }
   std::sort(kvList.begin(), kvList.end(),
             [](StringPair const& a, StringPair const& b) {
@@ -9,10 +9,15 @@
 #include <utility>
 #include <vector>
 
+#include "cmAtom.h"
 #include "cmValue.h"
 
 /** \class cmPropertyMap
  * \brief String property map.
+ *
+ * Property names are stored as atoms so that lookups by atom do not
+ * hash the name, and lookups of names never set on any object return
+ * without a map lookup.
  */
 class cmPropertyMap
 {
@@ -37,6 +42,7 @@ public:
 
   //! Get the property value
   cmValue GetPropertyValue(std::string const& name) const;
+  cmValue GetPropertyValue(cmAtom name) const;
 
   //! Remove the property @a name from the map
   void RemoveProperty(std::string const& name);
@@ -50,5 +56,5 @@ public:
   std::vector<std::pair<std::string, std::string>> GetList() const;
 
 private:
-  std::unordered_map<std::string, std::string> Map_;
+  std::unordered_map<cmAtom, std::string> Map_;
 };
@@ -4,10 +4,11 @@
 #include "cmScanDepFormat.h"
 
 #include <cctype>
+#include <cstddef>
 #include <cstdio>
-#include <utility>
+#include <cstdlib>
+#include <ios>
 
-#include <cm/optional>
 #include <cm/string_view>
 #include <cmext/string_view>
 
@@ -21,17 +22,6 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
-static bool ParseFilename(Json::Value const& val, std::string& result)
-{
-  if (val.isString()) {
-    result = val.asString();
-  } else {
-    return false;
-  }
-
-  return true;
-}
-
 static Json::Value EncodeFilename(std::string const& path)
 {
   std::string data;
@@ -57,233 +47,694 @@ static Json::Value EncodeFilename(std::string const& path)
   return data;
 }
 
-#define PARSE_BLOB(val, res)                                                  \
-  do {                                                                        \
-    if (!ParseFilename(val, res)) {                                           \
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ", \
-                                    arg_pp, ": invalid blob"));               \
-      return false;                                                           \
-    }                                                                         \
-  } while (0)
-
-#define PARSE_FILENAME(val, res)                                              \
-  do {                                                                        \
-    if (!ParseFilename(val, res)) {                                           \
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ", \
-                                    arg_pp, ": invalid filename"));           \
-      return false;                                                           \
-    }                                                                         \
-                                                                              \
-    if (work_directory && !work_directory->empty() &&                         \
-        !cmSystemTools::FileIsFullPath(res)) {                                \
-      res = cmStrCat(*work_directory, '/', res);                              \
-    }                                                                         \
-  } while (0)
-
-bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
-                                 cmScanDepInfo* info)
+namespace {
+// Read a JSON document in place, decoding only the values asked for.  This
+// avoids building a DOM for scanner output which is read exactly once.
+class JsonCursor
 {
-  Json::Value ppio;
-  Json::Value const& ppi = ppio;
-  cmsys::ifstream ppf(arg_pp.c_str(), std::ios::in | std::ios::binary);
-  {
-    Json::Reader reader;
-    if (!reader.parse(ppf, ppio, false)) {
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                    arg_pp,
-                                    reader.getFormattedErrorMessages()));
-      return false;
+public:
+  enum class Type
+  {
+    Object,
+    Array,
+    String,
+    Number,
+    Boolean,
+    Null,
+    Invalid,
+  };
+
+  JsonCursor(char const* begin, char const* end)
+    : Begin(begin)
+    , Cur(begin)
+    , End(end)
+  {
+  }
+
+  std::string const& GetError() const { return this->Error; }
+  bool TooDeep() const { return this->Depth > MaxDepth; }
+
+  Type Peek()
+  {
+    this->SkipSpace();
+    if (this->Cur == this->End) {
+      return Type::Invalid;
+    }
+    switch (*this->Cur) {
+      case '{':
+        return Type::Object;
+      case '[':
+        return Type::Array;
+      case '"':
+        return Type::String;
+      case 't':
+      case 'f':
+        return Type::Boolean;
+      case 'n':
+        return Type::Null;
+      case '-':
+        return Type::Number;
+      default:
+        break;
     }
+    return std::isdigit(static_cast<unsigned char>(*this->Cur))
+      ? Type::Number
+      : Type::Invalid;
   }
 
-  Json::Value const& version = ppi["version"];
-  if (version.asUInt() > 1) {
-    cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                  arg_pp, ": version ", version.asString()));
-    return false;
+  // Read an object, calling `onMember(key)` to read the value of each member.
+  template <typename F>
+  bool ReadObject(F&& onMember)
+  {
+    if (!this->Enter('{')) {
+      return false;
+    }
+    if (!this->Consume('}')) {
+      std::string key;
+      do {
+        if (this->Peek() != Type::String) {
+          return this->SetError("expected member name");
+        }
+        if (!this->ReadString(key) || !this->Expect(':') || !onMember(key)) {
+          return false;
+        }
+      } while (this->Consume(','));
+      if (!this->Expect('}')) {
+        return false;
+      }
+    }
+    --this->Depth;
+    return true;
   }
 
-  Json::Value const& rules = ppi["rules"];
-  if (rules.isArray()) {
-    if (rules.size() != 1) {
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                    arg_pp, ": expected 1 source entry"));
+  // Read an array, calling `onElement()` to read each element.
+  template <typename F>
+  bool ReadArray(F&& onElement)
+  {
+    if (!this->Enter('[')) {
       return false;
     }
+    if (!this->Consume(']')) {
+      do {
+        if (!onElement()) {
+          return false;
+        }
+      } while (this->Consume(','));
+      if (!this->Expect(']')) {
+        return false;
+      }
+    }
+    --this->Depth;
+    return true;
+  }
 
-    for (auto const& rule : rules) {
-      cm::optional<std::string> work_directory;
-      Json::Value const& workdir = rule["work-directory"];
-      if (workdir.isString()) {
-        std::string wd;
-        PARSE_BLOB(workdir, wd);
-        work_directory = std::move(wd);
-      } else if (!workdir.isNull()) {
-        cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                      arg_pp,
-                                      ": work-directory is not a string"));
+  bool ReadString(std::string& out)
+  {
+    if (!this->Expect('"')) {
+      return false;
+    }
+    out.clear();
+    for (;;) {
+      char const* run = this->Cur;
+      while (this->Cur != this->End && *this->Cur != '"' &&
+             *this->Cur != '\\') {
+        ++this->Cur;
+      }
+      out.append(run, this->Cur);
+      if (this->Cur == this->End) {
+        return this->SetError("missing '\"' to end string");
+      }
+      if (*this->Cur++ == '"') {
+        return true;
+      }
+      if (!this->ReadEscape(out)) {
         return false;
       }
+    }
+  }
 
-      if (rule.isMember("primary-output")) {
-        Json::Value const& primary_output = rule["primary-output"];
-        PARSE_FILENAME(primary_output, info->PrimaryOutput);
+  bool ReadNumber(cm::string_view& text)
+  {
+    this->SkipSpace();
+    char const* start = this->Cur;
+    this->Accept('-');
+    if (!this->SkipDigits()) {
+      return this->SetError("invalid number");
+    }
+    if (this->Accept('.') && !this->SkipDigits()) {
+      return this->SetError("invalid number");
+    }
+    if (this->Accept('e') || this->Accept('E')) {
+      if (!this->Accept('+')) {
+        this->Accept('-');
       }
+      if (!this->SkipDigits()) {
+        return this->SetError("invalid number");
+      }
+    }
+    text = cm::string_view(start, this->Cur - start);
+    return true;
+  }
+
+  bool ReadBool(bool& out)
+  {
+    if (this->Match("true"_s)) {
+      out = true;
+      return true;
+    }
+    if (this->Match("false"_s)) {
+      out = false;
+      return true;
+    }
+    return this->SetError("invalid value");
+  }
 
-      if (rule.isMember("outputs")) {
-        Json::Value const& outputs = rule["outputs"];
-        if (outputs.isArray()) {
-          for (auto const& output : outputs) {
-            std::string extra_output;
-            PARSE_FILENAME(output, extra_output);
+  bool Skip()
+  {
+    switch (this->Peek()) {
+      case Type::Object:
+        return this->ReadObject(
+          [this](std::string const&) -> bool { return this->Skip(); });
+      case Type::Array:
+        return this->ReadArray([this]() -> bool { return this->Skip(); });
+      case Type::String:
+        return this->SkipString();
+      case Type::Number: {
+        cm::string_view text;
+        return this->ReadNumber(text);
+      }
+      case Type::Boolean: {
+        bool b = false;
+        return this->ReadBool(b);
+      }
+      case Type::Null:
+        return this->Match("null"_s) || this->SetError("invalid value");
+      case Type::Invalid:
+        break;
+    }
+    return this->SetError("expected a value");
+  }
 
-            info->ExtraOutputs.emplace_back(extra_output);
-          }
+private:
+  bool SetError(cm::string_view what)
+  {
+    if (this->Error.empty()) {
+      std::size_t line = 1;
+      char const* lineStart = this->Begin;
+      for (char const* c = this->Begin; c != this->Cur; ++c) {
+        if (*c == '\n') {
+          ++line;
+          lineStart = c + 1;
         }
       }
+      this->Error = cmStrCat("line ", line, ", column ",
+                             this->Cur - lineStart + 1, ": ", what);
+    }
+    return false;
+  }
 
-      if (rule.isMember("provides")) {
-        Json::Value const& provides = rule["provides"];
-        if (!provides.isArray()) {
-          cmSystemTools::Error(
-            cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                     ": provides is not an array"));
-          return false;
+  void SkipSpace()
+  {
+    while (this->Cur != this->End) {
+      char const c = *this->Cur;
+      if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+        ++this->Cur;
+      } else if (c == '/' && this->End - this->Cur > 1 &&
+                 this->Cur[1] == '/') {
+        while (this->Cur != this->End && *this->Cur != '\n') {
+          ++this->Cur;
+        }
+      } else if (c == '/' && this->End - this->Cur > 1 &&
+                 this->Cur[1] == '*') {
+        this->Cur += 2;
+        while (this->Cur != this->End && !this->Match("*/"_s)) {
+          ++this->Cur;
         }
+      } else {
+        break;
+      }
+    }
+  }
 
-        for (auto const& provide : provides) {
-          cmSourceReqInfo provide_info;
+  bool Accept(char c)
+  {
+    if (this->Cur != this->End && *this->Cur == c) {
+      ++this->Cur;
+      return true;
+    }
+    return false;
+  }
 
-          Json::Value const& logical_name = provide["logical-name"];
-          PARSE_BLOB(logical_name, provide_info.LogicalName);
+  bool Consume(char c)
+  {
+    this->SkipSpace();
+    return this->Accept(c);
+  }
 
-          if (provide.isMember("compiled-module-path")) {
-            Json::Value const& compiled_module_path =
-              provide["compiled-module-path"];
-            PARSE_FILENAME(compiled_module_path,
-                           provide_info.CompiledModulePath);
-          }
+  bool Expect(char c)
+  {
+    if (!this->Consume(c)) {
+      return this->SetError(cmStrCat("expected '", c, '\''));
+    }
+    return true;
+  }
 
-          if (provide.isMember("unique-on-source-path")) {
-            Json::Value const& unique_on_source_path =
-              provide["unique-on-source-path"];
-            if (!unique_on_source_path.isBool()) {
-              cmSystemTools::Error(
-                cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                         ": unique-on-source-path is not a boolean"));
-              return false;
-            }
-            provide_info.UseSourcePath = unique_on_source_path.asBool();
-          } else {
-            provide_info.UseSourcePath = false;
-          }
+  bool Enter(char c)
+  {
+    if (++this->Depth > MaxDepth) {
+      return this->SetError("too deeply nested");
+    }
+    return this->Expect(c);
+  }
 
-          if (provide.isMember("source-path")) {
-            Json::Value const& source_path = provide["source-path"];
-            PARSE_FILENAME(source_path, provide_info.SourcePath);
-          } else if (provide_info.UseSourcePath) {
-            cmSystemTools::Error(
-              cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                       ": source-path is missing"));
-            return false;
-          }
+  bool Match(cm::string_view word)
+  {
+    if (static_cast<std::size_t>(this->End - this->Cur) >= word.size() &&
+        cm::string_view(this->Cur, word.size()) == word) {
+      this->Cur += word.size();
+      return true;
+    }
+    return false;
+  }
 
-          if (provide.isMember("is-interface")) {
-            Json::Value const& is_interface = provide["is-interface"];
-            if (!is_interface.isBool()) {
-              cmSystemTools::Error(
-                cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                         ": is-interface is not a boolean"));
-              return false;
-            }
-            provide_info.IsInterface = is_interface.asBool();
-          } else {
-            provide_info.IsInterface = true;
-          }
+  bool SkipDigits()
+  {
+    char const* start = this->Cur;
+    while (this->Cur != this->End &&
+           std::isdigit(static_cast<unsigned char>(*this->Cur))) {
+      ++this->Cur;
+    }
+    return this->Cur != start;
+  }
 
-          info->Provides.push_back(provide_info);
-        }
+  bool SkipString()
+  {
+    if (!this->Expect('"')) {
+      return false;
+    }
+    while (this->Cur != this->End) {
+      char const c = *this->Cur++;
+      if (c == '"') {
+        return true;
+      }
+      if (c == '\\' && this->Cur != this->End) {
+        ++this->Cur;
       }
+    }
+    return this->SetError("missing '\"' to end string");
+  }
 
-      if (rule.isMember("requires")) {
-        Json::Value const& reqs = rule["requires"];
-        if (!reqs.isArray()) {
-          cmSystemTools::Error(
-            cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                     ": requires is not an array"));
-          return false;
+  bool ReadHex4(unsigned int& value)
+  {
+    if (this->End - this->Cur < 4) {
+      return this->SetError("bad unicode escape sequence");
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+      char const c = *this->Cur++;
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value += static_cast<unsigned int>(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        value += static_cast<unsigned int>(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        value += static_cast<unsigned int>(c - 'A' + 10);
+      } else {
+        return this->SetError("bad unicode escape sequence");
+      }
+    }
+    return true;
+  }
+
+  bool ReadEscape(std::string& out)
+  {
+    if (this->Cur == this->End) {
+      return this->SetError("missing '\"' to end string");
+    }
+    switch (*this->Cur++) {
+      case '"':
+        out += '"';
+        return true;
+      case '\\':
+        out += '\\';
+        return true;
+      case '/':
+        out += '/';
+        return true;
+      case 'b':
+        out += '\b';
+        return true;
+      case 'f':
+        out += '\f';
+        return true;
+      case 'n':
+        out += '\n';
+        return true;
+      case 'r':
+        out += '\r';
+        return true;
+      case 't':
+        out += '\t';
+        return true;
+      case 'u':
+        break;
+      default:
+        return this->SetError("bad escape sequence in string");
+    }
+
+    unsigned int cp;
+    if (!this->ReadHex4(cp)) {
+      return false;
+    }
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+      unsigned int low;
+      if (!this->Match("\\u"_s) || !this->ReadHex4(low) || low < 0xDC00 ||
+          low > 0xDFFF) {
+        return this->SetError("bad surrogate pair in string");
+      }
+      cp = 0x10000 + ((cp & 0x3FF) << 10) + (low & 0x3FF);
+    }
+    if (cp <= 0x7F) {
+      out += static_cast<char>(cp);
+    } else if (cp <= 0x7FF) {
+      out += static_cast<char>(0xC0 | (cp >> 6));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp <= 0xFFFF) {
+      out += static_cast<char>(0xE0 | (cp >> 12));
+      out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (cp >> 18));
+      out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return true;
+  }
+
+  static constexpr int MaxDepth = 1000;
+
+  char const* Begin;
+  char const* Cur;
+  char const* End;
+  int Depth = 0;
+  std::string Error;
+};
+
+// Decode P1689 scanner output directly into a `cmScanDepInfo`.
+class P1689Parser
+{
+public:
+  P1689Parser(std::string const& path, std::string const& content,
+              cmScanDepInfo* info)
+    : Path(path)
+    , Content(content)
+    , Json(content.data(), content.data() + content.size())
+    , Info(info)
+  {
+  }
+
+  bool Parse()
+  {
+    if (this->Json.Peek() != JsonCursor::Type::Object) {
+      return this->Json.Skip() ? this->Fail("expected an object")
+                               : this->FailSyntax();
+    }
+    bool const ok = this->Json.ReadObject(
+      [this](std::string const& key) -> bool {
+        if (key == "version"_s) {
+          return this->ParseVersion();
         }
+        if (key == "rules"_s) {
+          return this->ParseRules();
+        }
+        return this->Json.Skip();
+      });
+    return ok || this->FailSyntax();
+  }
 
-        for (auto const& require : reqs) {
-          cmSourceReqInfo require_info;
+private:
+  bool Fail(cm::string_view message) const
+  {
+    cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
+                                  this->Path, ": ", message));
+    return false;
+  }
 
-          Json::Value const& logical_name = require["logical-name"];
-          PARSE_BLOB(logical_name, require_info.LogicalName);
+  bool FailSyntax() const
+  {
+    // Errors in the values themselves have already been reported.
+    if (this->Json.GetError().empty()) {
+      return false;
+    }
+    // Malformed scanner output is rare.  Parse it again with jsoncpp to
+    // report it with the same diagnostics as other JSON files.  Its reader
+    // throws on documents nested too deeply, so report those directly.
+    if (!this->Json.TooDeep()) {
+      Json::Reader reader;
+      Json::Value value;
+      if (!reader.parse(this->Content, value, false)) {
+        cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
+                                      this->Path,
+                                      reader.getFormattedErrorMessages()));
+        return false;
+      }
+    }
+    return this->Fail(this->Json.GetError());
+  }
 
-          if (require.isMember("compiled-module-path")) {
-            Json::Value const& compiled_module_path =
-              require["compiled-module-path"];
-            PARSE_FILENAME(compiled_module_path,
-                           require_info.CompiledModulePath);
-          }
+  bool ParseVersion()
+  {
+    switch (this->Json.Peek()) {
+      case JsonCursor::Type::Null:
+        return this->Json.Skip();
+      case JsonCursor::Type::Number: {
+        cm::string_view version;
+        if (!this->Json.ReadNumber(version)) {
+          return false;
+        }
+        double const value =
+          std::strtod(std::string(version).c_str(), nullptr);
+        if (value < 0 || value >= 2) {
+          return this->Fail(cmStrCat("version ", version));
+        }
+        return true;
+      }
+      default:
+        break;
+    }
+    return this->Fail("version is not a number");
+  }
 
-          if (require.isMember("unique-on-source-path")) {
-            Json::Value const& unique_on_source_path =
-              require["unique-on-source-path"];
-            if (!unique_on_source_path.isBool()) {
-              cmSystemTools::Error(
-                cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                         ": unique-on-source-path is not a boolean"));
-              return false;
-            }
-            require_info.UseSourcePath = unique_on_source_path.asBool();
-          } else {
-            require_info.UseSourcePath = false;
+  bool ParseRules()
+  {
+    if (this->Json.Peek() != JsonCursor::Type::Array) {
+      return this->Json.Skip();
+    }
+    std::size_t rules = 0;
+    if (!this->Json.ReadArray([this, &rules]() -> bool {
+          if (++rules > 1) {
+            return this->Fail("expected 1 source entry");
           }
+          return this->ParseRule();
+        })) {
+      return false;
+    }
+    if (rules != 1) {
+      return this->Fail("expected 1 source entry");
+    }
+    return true;
+  }
 
-          if (require.isMember("source-path")) {
-            Json::Value const& source_path = require["source-path"];
-            PARSE_FILENAME(source_path, require_info.SourcePath);
-          } else if (require_info.UseSourcePath) {
-            cmSystemTools::Error(
-              cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                       ": source-path is missing"));
-            return false;
-          }
+  bool ParseFilename(std::string& result)
+  {
+    if (this->Json.Peek() != JsonCursor::Type::String) {
+      return this->Fail("invalid filename");
+    }
+    return this->Json.ReadString(result);
+  }
 
-          if (require.isMember("lookup-method")) {
-            Json::Value const& lookup_method = require["lookup-method"];
-            if (!lookup_method.isString()) {
-              cmSystemTools::Error(
-                cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                         ": lookup-method is not a string"));
-              return false;
-            }
-
-            std::string lookup_method_str = lookup_method.asString();
-            if (lookup_method_str == "by-name"_s) {
-              require_info.Method = LookupMethod::ByName;
-            } else if (lookup_method_str == "include-angle"_s) {
-              require_info.Method = LookupMethod::IncludeAngle;
-            } else if (lookup_method_str == "include-quote"_s) {
-              require_info.Method = LookupMethod::IncludeQuote;
-            } else {
-              cmSystemTools::Error(cmStrCat(
-                "-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                ": lookup-method is not a valid: ", lookup_method_str));
-              return false;
-            }
-          } else if (require_info.UseSourcePath) {
-            require_info.Method = LookupMethod::ByName;
+  bool ParseRule()
+  {
+    if (this->Json.Peek() != JsonCursor::Type::Object) {
+      return this->Fail("source entry is not an object");
+    }
+
+    cmScanDepInfo& info = *this->Info;
+    std::string work_directory;
+    bool const ok = this->Json.ReadObject(
+      [this, &info, &work_directory](std::string const& key) -> bool {
+        if (key == "work-directory"_s) {
+          switch (this->Json.Peek()) {
+            case JsonCursor::Type::String:
+              return this->Json.ReadString(work_directory);
+            case JsonCursor::Type::Null:
+              return this->Json.Skip();
+            default:
+              break;
+          }
+          return this->Fail("work-directory is not a string");
+        }
+        if (key == "primary-output"_s) {
+          return this->ParseFilename(info.PrimaryOutput);
+        }
+        if (key == "outputs"_s) {
+          if (this->Json.Peek() != JsonCursor::Type::Array) {
+            return this->Json.Skip();
           }
+          info.ExtraOutputs.clear();
+          return this->Json.ReadArray([this, &info]() -> bool {
+            info.ExtraOutputs.emplace_back();
+            return this->ParseFilename(info.ExtraOutputs.back());
+          });
+        }
+        if (key == "provides"_s) {
+          return this->ParseSourceReqInfos("provides", info.Provides, false);
+        }
+        if (key == "requires"_s) {
+          return this->ParseSourceReqInfos("requires", info.Requires, true);
+        }
+        return this->Json.Skip();
+      });
+    if (!ok) {
+      return false;
+    }
 
-          info->Requires.push_back(require_info);
+    // Members may appear in any order, so resolve relative paths last.
+    if (!work_directory.empty()) {
+      auto resolve = [&work_directory](std::string& path) {
+        if (!path.empty() && !cmSystemTools::FileIsFullPath(path)) {
+          path = cmStrCat(work_directory, '/', path);
         }
+      };
+      resolve(info.PrimaryOutput);
+      for (std::string& output : info.ExtraOutputs) {
+        resolve(output);
       }
+      for (auto* reqs : { &info.Provides, &info.Requires }) {
+        for (cmSourceReqInfo& req : *reqs) {
+          resolve(req.CompiledModulePath);
+          resolve(req.SourcePath);
+        }
+      }
+    }
+    return true;
+  }
+
+  bool ParseSourceReqInfos(cm::string_view name,
+                           std::vector<cmSourceReqInfo>& reqs, bool require)
+  {
+    if (this->Json.Peek() != JsonCursor::Type::Array) {
+      return this->Fail(cmStrCat(name, " is not an array"));
+    }
+    reqs.clear();
+    return this->Json.ReadArray([this, &reqs, require]() -> bool {
+      reqs.emplace_back();
+      return this->ParseSourceReqInfo(reqs.back(), require);
+    });
+  }
+
+  bool ParseSourceReqInfo(cmSourceReqInfo& req, bool require)
+  {
+    if (this->Json.Peek() != JsonCursor::Type::Object) {
+      return this->Fail("invalid blob");
+    }
+    bool have_logical_name = false;
+    bool have_source_path = false;
+    bool const ok = this->Json.ReadObject(
+      [this, &req, require, &have_logical_name,
+       &have_source_path](std::string const& key) -> bool {
+        if (key == "logical-name"_s) {
+          if (this->Json.Peek() != JsonCursor::Type::String) {
+            return this->Fail("invalid blob");
+          }
+          have_logical_name = true;
+          return this->Json.ReadString(req.LogicalName);
+        }
+        if (key == "compiled-module-path"_s) {
+          return this->ParseFilename(req.CompiledModulePath);
+        }
+        if (key == "unique-on-source-path"_s) {
+          if (this->Json.Peek() != JsonCursor::Type::Boolean) {
+            return this->Fail("unique-on-source-path is not a boolean");
+          }
+          return this->Json.ReadBool(req.UseSourcePath);
+        }
+        if (key == "source-path"_s) {
+          have_source_path = true;
+          return this->ParseFilename(req.SourcePath);
+        }
+        if (!require && key == "is-interface"_s) {
+          if (this->Json.Peek() != JsonCursor::Type::Boolean) {
+            return this->Fail("is-interface is not a boolean");
+          }
+          return this->Json.ReadBool(req.IsInterface);
+        }
+        if (require && key == "lookup-method"_s) {
+          return this->ParseLookupMethod(req.Method);
+        }
+        return this->Json.Skip();
+      });
+    if (!ok) {
+      return false;
+    }
+    if (!have_logical_name) {
+      return this->Fail("invalid blob");
+    }
+    if (req.UseSourcePath && !have_source_path) {
+      return this->Fail("source-path is missing");
+    }
+    return true;
+  }
+
+  bool ParseLookupMethod(LookupMethod& method)
+  {
+    if (this->Json.Peek() != JsonCursor::Type::String) {
+      return this->Fail("lookup-method is not a string");
+    }
+    std::string lookup_method;
+    if (!this->Json.ReadString(lookup_method)) {
+      return false;
+    }
+    if (lookup_method == "by-name"_s) {
+      method = LookupMethod::ByName;
+    } else if (lookup_method == "include-angle"_s) {
+      method = LookupMethod::IncludeAngle;
+    } else if (lookup_method == "include-quote"_s) {
+      method = LookupMethod::IncludeQuote;
+    } else {
+      return this->Fail(
+        cmStrCat("lookup-method is not a valid: ", lookup_method));
+    }
+    return true;
+  }
+
+  std::string const& Path;
+  std::string const& Content;
+  JsonCursor Json;
+  cmScanDepInfo* Info;
+};
+}
+
+bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
+                                 cmScanDepInfo* info)
+{
+  std::string content;
+  {
+    // A file that cannot be read is reported as a syntax error below.
+    cmsys::ifstream ppf(arg_pp.c_str(), std::ios::in | std::ios::binary);
+    ppf.seekg(0, std::ios::end);
+    std::streamoff const size = ppf.tellg();
+    ppf.seekg(0, std::ios::beg);
+    if (size > 0) {
+      content.resize(static_cast<std::size_t>(size));
+      ppf.read(&content[0], size);
+      content.resize(static_cast<std::size_t>(ppf.gcount()));
     }
   }
 
-  return true;
+  P1689Parser parser(arg_pp, content, info);
+  return parser.Parse();
 }
 
 bool cmScanDepFormat_P1689_Write(std::string const& path,
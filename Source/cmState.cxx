@@ -546,6 +546,11 @@ cmState::Command cmState::GetCommandByExactName(std::string const& name) const
   return nullptr;
 }
 
+bool cmState::IsBuiltinCommand(std::string const& name) const
+{
+  return this->BuiltinCommands.count(name) != 0;
+}
+
 std::vector<std::string> cmState::GetCommandNames() const
 {
   std::vector<std::string> commandNames;
@@ -175,6 +175,8 @@ public:
   Command GetCommand(std::string const& name) const;
   // Returns a command from its name, or nullptr
   Command GetCommandByExactName(std::string const& name) const;
+  // Returns whether a command of the given name is built into CMake
+  bool IsBuiltinCommand(std::string const& name) const;
 
   void AddBuiltinCommand(std::string const& name, Command command);
   void AddBuiltinCommand(std::string const& name, BuiltinCommand command);
@@ -199,6 +201,11 @@ public:
                             bool asString = false);
   cmValue GetGlobalProperty(std::string const& prop);
   bool GetGlobalPropertyAsBool(std::string const& prop);
+  std::vector<std::pair<std::string, std::string>> GetGlobalPropertyList()
+    const
+  {
+    return this->GlobalProperties.GetList();
+  }
 
   std::string const& GetSourceDirectory() const;
   void SetSourceDirectory(std::string const& sourceDirectory);
@@ -231,6 +231,11 @@ std::vector<std::string> cmStateSnapshot::ClosureKeys() const
                                     this->Position->Root);
 }
 
+bool cmStateSnapshot::HasSameVariableScope(cmStateSnapshot const& other) const
+{
+  return this->Position->Vars == other.Position->Vars;
+}
+
 bool cmStateSnapshot::RaiseScope(std::string const& var, char const* varDef)
 {
   if (this->Position->ScopeParent == this->Position->DirectoryParent) {
@@ -30,6 +30,7 @@ public:
   void RemoveDefinition(std::string const& name);
   std::vector<std::string> ClosureKeys() const;
   bool RaiseScope(std::string const& var, char const* varDef);
+  bool HasSameVariableScope(cmStateSnapshot const& other) const;
 
   void SetListFile(std::string const& listfile);
 
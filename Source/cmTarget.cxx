@@ -19,6 +19,7 @@
 #include "cmsys/RegularExpression.hxx"
 
 #include "cmAlgorithms.h"
+#include "cmAtom.h"
 #include "cmCustomCommand.h"
 #include "cmFileSet.h"
 #include "cmFindPackageStack.h"
@@ -44,6 +45,10 @@
 #include "cmXcFramework.h"
 #include "cmake.h"
 
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmFindPackageCache.h"
+#endif
+
 template <>
 std::string const& cmTargetPropertyComputer::ImportedLocation<cmTarget>(
   cmTarget const* tgt, std::string const& config)
@@ -2053,6 +2058,12 @@ void cmTarget::SetProperty(std::string const& prop, cmValue value)
   if (!IsSettableProperty(this->impl->Makefile, this, prop)) {
     return;
   }
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        this->impl->Makefile->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordTargetChange(this);
+  }
+#endif
 
   UsageRequirementProperty* usageRequirements[] = {
     &this->impl->IncludeDirectories,
@@ -2198,6 +2209,12 @@ void cmTarget::AppendProperty(std::string const& prop,
   if (!IsSettableProperty(this->impl->Makefile, this, prop)) {
     return;
   }
+#ifndef CMAKE_BOOTSTRAP
+  if (cmFindPackageCache* cache =
+        this->impl->Makefile->GetCMakeInstance()->GetFindPackageCache()) {
+    cache->RecordTargetChange(this);
+  }
+#endif
   if (prop == "IMPORTED_GLOBAL") {
     this->impl->Makefile->IssueMessage(
       MessageType::FATAL_ERROR,
@@ -2606,39 +2623,46 @@ cmValue cmTarget::GetComputedProperty(std::string const& prop,
 
 cmValue cmTarget::GetProperty(std::string const& prop) const
 {
-  static std::unordered_set<std::string> const specialProps{
-    propC_STANDARD,
-    propCXX_STANDARD,
-    propCUDA_STANDARD,
-    propHIP_STANDARD,
-    propOBJC_STANDARD,
-    propOBJCXX_STANDARD,
-    propLINK_LIBRARIES,
-    propTYPE,
-    propINCLUDE_DIRECTORIES,
-    propCOMPILE_FEATURES,
-    propCOMPILE_OPTIONS,
-    propCOMPILE_DEFINITIONS,
-    propPRECOMPILE_HEADERS,
-    propLINK_OPTIONS,
-    propLINK_DIRECTORIES,
-    propIMPORTED,
-    propIMPORTED_GLOBAL,
-    propMANUALLY_ADDED_DEPENDENCIES,
-    propNAME,
-    propBINARY_DIR,
-    propSOURCE_DIR,
-    propSOURCES,
-    propINTERFACE_LINK_LIBRARIES,
-    propINTERFACE_LINK_LIBRARIES_DIRECT,
-    propINTERFACE_LINK_LIBRARIES_DIRECT_EXCLUDE,
-    propIMPORTED_CXX_MODULES_INCLUDE_DIRECTORIES,
-    propIMPORTED_CXX_MODULES_COMPILE_DEFINITIONS,
-    propIMPORTED_CXX_MODULES_COMPILE_FEATURES,
-    propIMPORTED_CXX_MODULES_COMPILE_OPTIONS,
-    propIMPORTED_CXX_MODULES_LINK_LIBRARIES,
-  };
-  if (specialProps.count(prop)) {
+  static std::unordered_set<cmAtom> const specialProps = []() {
+    std::unordered_set<cmAtom> props;
+    for (std::string const& name : {
+           propC_STANDARD,
+           propCXX_STANDARD,
+           propCUDA_STANDARD,
+           propHIP_STANDARD,
+           propOBJC_STANDARD,
+           propOBJCXX_STANDARD,
+           propLINK_LIBRARIES,
+           propTYPE,
+           propINCLUDE_DIRECTORIES,
+           propCOMPILE_FEATURES,
+           propCOMPILE_OPTIONS,
+           propCOMPILE_DEFINITIONS,
+           propPRECOMPILE_HEADERS,
+           propLINK_OPTIONS,
+           propLINK_DIRECTORIES,
+           propIMPORTED,
+           propIMPORTED_GLOBAL,
+           propMANUALLY_ADDED_DEPENDENCIES,
+           propNAME,
+           propBINARY_DIR,
+           propSOURCE_DIR,
+           propSOURCES,
+           propINTERFACE_LINK_LIBRARIES,
+           propINTERFACE_LINK_LIBRARIES_DIRECT,
+           propINTERFACE_LINK_LIBRARIES_DIRECT_EXCLUDE,
+           propIMPORTED_CXX_MODULES_INCLUDE_DIRECTORIES,
+           propIMPORTED_CXX_MODULES_COMPILE_DEFINITIONS,
+           propIMPORTED_CXX_MODULES_COMPILE_FEATURES,
+           propIMPORTED_CXX_MODULES_COMPILE_OPTIONS,
+           propIMPORTED_CXX_MODULES_LINK_LIBRARIES,
+         }) {
+      props.insert(cmAtom::Intern(name));
+    }
+    return props;
+  }();
+  cmAtom const propAtom = cmAtom::Lookup(prop);
+  if (specialProps.count(propAtom)) {
     if (prop == propC_STANDARD || prop == propCXX_STANDARD ||
         prop == propCUDA_STANDARD || prop == propHIP_STANDARD ||
         prop == propOBJC_STANDARD || prop == propOBJCXX_STANDARD) {
@@ -2734,7 +2758,7 @@ cmValue cmTarget::GetProperty(std::string const& prop) const
     }
   }
 
-  cmValue retVal = this->impl->Properties.GetPropertyValue(prop);
+  cmValue retVal = this->impl->Properties.GetPropertyValue(propAtom);
   if (!retVal) {
     bool const chain = this->impl->Makefile->GetState()->IsPropertyChained(
       prop, cmProperty::TARGET);
@@ -0,0 +1,434 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmTryCompileCache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <cm/memory>
+#include <cm/string_view>
+
+#include <cm3p/json/reader.h>
+#include <cm3p/json/value.h>
+#include <cm3p/json/writer.h>
+
+#include "cmsys/Directory.hxx"
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmFileLock.h"
+#include "cmFileLockResult.h"
+#include "cmFileTime.h"
+#include "cmGeneratedFileStream.h"
+#include "cmGlobalGenerator.h"
+#include "cmMakefile.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+#include "cmValue.h"
+#include "cmVersion.h"
+#include "cmake.h"
+
+namespace {
+
+int const Version = 1;
+
+// Waiting longer than this for another process to finish with an entry
+// costs more than building the project.
+unsigned long const LockTimeout = 10;
+
+std::uint64_t const DefaultMaxSize = 256;
+
+char const BinaryDirectoryPlaceholder[] = "@TRY_COMPILE_BINARY_DIR@";
+char const TargetNamePlaceholder[] = "@TRY_COMPILE_TARGET_NAME@";
+
+std::string Normalize(std::string text, std::string const& binaryDirectory,
+                      std::string const& targetName)
+{
+  cmSystemTools::ReplaceString(text, binaryDirectory,
+                               BinaryDirectoryPlaceholder);
+  cmSystemTools::ReplaceString(text, targetName, TargetNamePlaceholder);
+  return text;
+}
+
+std::string Restore(std::string text, std::string const& binaryDirectory,
+                    std::string const& targetName)
+{
+  cmSystemTools::ReplaceString(text, BinaryDirectoryPlaceholder,
+                               binaryDirectory);
+  cmSystemTools::ReplaceString(text, TargetNamePlaceholder, targetName);
+  return text;
+}
+
+bool ReadFile(std::string const& file, std::string& content)
+{
+  cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  content.assign(std::istreambuf_iterator<char>(fin),
+                 std::istreambuf_iterator<char>());
+  return !fin.bad();
+}
+
+// Identify a file that is too large to hash each time by its size and
+// modification time.
+std::string FileStamp(std::string const& file)
+{
+  cmFileTime time;
+  if (!time.Load(file)) {
+    return std::string();
+  }
+  return cmStrCat(cmSystemTools::FileLength(file), ' ', time.GetTime());
+}
+
+bool LockEntry(std::string const& entry, cmFileLock& lock,
+               unsigned long timeout)
+{
+  std::string const lockName = cmStrCat(entry, "/lock");
+  return cmSystemTools::Touch(lockName, true) &&
+    lock.Lock(lockName, timeout).IsOk();
+}
+}
+
+std::unique_ptr<cmTryCompileCache> cmTryCompileCache::Create(
+  cmMakefile const& mf)
+{
+  std::string directory = mf.GetSafeDefinition("CMAKE_TRY_COMPILE_CACHE");
+  if (directory.empty()) {
+    if (cm::optional<std::string> env =
+          cmSystemTools::GetEnvVar("CMAKE_TRY_COMPILE_CACHE")) {
+      directory = std::move(*env);
+    }
+  }
+  if (directory.empty() || !cmSystemTools::FileIsFullPath(directory)) {
+    return nullptr;
+  }
+
+  std::uint64_t maxSize = DefaultMaxSize;
+  cmValue const maxSizeValue =
+    mf.GetDefinition("CMAKE_TRY_COMPILE_CACHE_MAX_SIZE");
+  unsigned long value;
+  if (cmNonempty(maxSizeValue) && cmStrToULong(*maxSizeValue, &value)) {
+    maxSize = value;
+  }
+  return cm::make_unique<cmTryCompileCache>(
+    cmSystemTools::CollapseFullPath(directory), maxSize * 1024 * 1024,
+    mf.GetCMakeInstance());
+}
+
+cmTryCompileCache::cmTryCompileCache(std::string directory,
+                                     std::uint64_t maxSize, cmake* cm)
+  : Directory(std::move(directory))
+  , MaxSize(maxSize)
+  , CMakeInstance(cm)
+{
+}
+
+std::string cmTryCompileCache::ComputeKey(
+  cmMakefile const& mf, std::string const& binaryDirectory,
+  std::string const& targetName, std::vector<std::string> const& cmakeFlags,
+  std::vector<std::string> const& sources,
+  std::vector<std::string> const& linkLibraries) const
+{
+  cmCryptoHash contentHash(cmCryptoHash::AlgoSHA256);
+  cmCryptoHash hash(cmCryptoHash::AlgoSHA256);
+  hash.Initialize();
+  auto append = [&hash](cm::string_view name, cm::string_view value) {
+    hash.Append(name);
+    hash.Append(cm::string_view("=", 1));
+    hash.Append(value);
+    hash.Append(cm::string_view("\n", 1));
+  };
+
+  append("version", std::to_string(Version));
+  append("cmake", cmVersion::GetCMakeVersion());
+  cmGlobalGenerator const* gg = mf.GetGlobalGenerator();
+  append("generator", gg->GetName());
+  for (char const* var :
+       { "CMAKE_GENERATOR_PLATFORM", "CMAKE_GENERATOR_TOOLSET",
+         "CMAKE_TRY_COMPILE_CONFIGURATION" }) {
+    append(var, mf.GetSafeDefinition(var));
+  }
+  for (std::string const& flag : cmakeFlags) {
+    append("flag", Normalize(flag, binaryDirectory, targetName));
+  }
+
+  // The generated project and the sources written for it.
+  cmsys::Directory dir;
+  if (!dir.Load(binaryDirectory)) {
+    return std::string();
+  }
+  std::vector<std::string> names;
+  for (unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i) {
+    std::string const& name = dir.GetFileName(i);
+    if (!dir.FileIsDirectory(i)) {
+      names.push_back(name);
+    }
+  }
+  std::sort(names.begin(), names.end());
+  for (std::string const& name : names) {
+    std::string content;
+    if (!ReadFile(cmStrCat(binaryDirectory, '/', name), content)) {
+      return std::string();
+    }
+    append("file", Normalize(name, binaryDirectory, targetName));
+    append("content",
+           contentHash.HashString(
+             Normalize(content, binaryDirectory, targetName)));
+  }
+
+  for (std::string const& source : sources) {
+    if (cmSystemTools::IsSubDirectory(source, binaryDirectory)) {
+      continue;
+    }
+    std::string const sourceHash = contentHash.HashFile(source);
+    if (sourceHash.empty()) {
+      return std::string();
+    }
+    append("source", source);
+    append("content", sourceHash);
+  }
+  for (std::string const& library : linkLibraries) {
+    if (cmSystemTools::FileIsFullPath(library)) {
+      append("library", library);
+      append("stamp", FileStamp(library));
+    }
+  }
+
+  // The toolchain of the calling project.  The files in the platform
+  // information directory do not name the build tree.
+  std::string const platformDir =
+    mf.GetSafeDefinition("CMAKE_PLATFORM_INFO_DIR");
+  std::string content;
+  if (ReadFile(cmStrCat(platformDir, "/CMakeSystem.cmake"), content)) {
+    append("system", contentHash.HashString(content));
+  }
+  if (cmValue toolchain = mf.GetDefinition("CMAKE_TOOLCHAIN_FILE")) {
+    if (ReadFile(*toolchain, content)) {
+      append("toolchain", contentHash.HashString(content));
+    }
+  }
+  std::vector<std::string> languages;
+  gg->GetEnabledLanguages(languages);
+  for (std::string const& lang : languages) {
+    append("language", lang);
+    if (ReadFile(cmStrCat(platformDir, "/CMake", lang, "Compiler.cmake"),
+                 content)) {
+      append("compiler", contentHash.HashString(content));
+    }
+    if (cmValue compiler =
+          mf.GetDefinition(cmStrCat("CMAKE_", lang, "_COMPILER"))) {
+      append("stamp", FileStamp(*compiler));
+    }
+  }
+
+  return hash.FinalizeHex();
+}
+
+cm::optional<cmTryCompileCache::Result> cmTryCompileCache::Load(
+  std::string const& key, std::string const& binaryDirectory,
+  std::string const& targetName) const
+{
+  std::string const entry = this->GetEntryDirectory(key);
+  std::string const resultFile = cmStrCat(entry, "/result.json");
+  if (!cmSystemTools::FileExists(resultFile, true)) {
+    return cm::nullopt;
+  }
+
+  // Keep the entry from being evicted while it is read.
+  cmFileLock lock;
+  if (!LockEntry(entry, lock, LockTimeout)) {
+    return cm::nullopt;
+  }
+
+  cmsys::ifstream fin(resultFile.c_str(), std::ios::in | std::ios::binary);
+  Json::CharReaderBuilder builder;
+  Json::Value root;
+  std::string errors;
+  if (!fin || !Json::parseFromStream(builder, fin, &root, &errors) ||
+      !root.isObject() || root["version"] != Version ||
+      !root["exitCode"].isInt() || !root["output"].isString() ||
+      !root["outputFile"].isString()) {
+    return cm::nullopt;
+  }
+
+  Result result;
+  result.ExitCode = root["exitCode"].asInt();
+  result.Output =
+    Restore(root["output"].asString(), binaryDirectory, targetName);
+  std::string const outputFile = root["outputFile"].asString();
+  if (!outputFile.empty()) {
+    result.OutputFile = Restore(outputFile, binaryDirectory, targetName);
+    cmSystemTools::MakeDirectory(
+      cmSystemTools::GetFilenamePath(result.OutputFile));
+    if (!cmSystemTools::CopyFileAlways(cmStrCat(entry, "/output"),
+                                       result.OutputFile)) {
+      return cm::nullopt;
+    }
+  }
+
+  // Mark the entry as recently used.
+  cmSystemTools::Touch(resultFile, false);
+  return result;
+}
+
+void cmTryCompileCache::Store(std::string const& key,
+                              std::string const& binaryDirectory,
+                              std::string const& targetName,
+                              Result const& result)
+{
+  if (result.ExitCode == 0 &&
+      !cmSystemTools::IsSubDirectory(result.OutputFile, binaryDirectory)) {
+    return;
+  }
+
+  std::string const entry = this->GetEntryDirectory(key);
+  if (!cmSystemTools::MakeDirectory(entry)) {
+    return;
+  }
+  {
+    cmFileLock lock;
+    if (!LockEntry(entry, lock, LockTimeout)) {
+      return;
+    }
+    std::string const resultFile = cmStrCat(entry, "/result.json");
+    if (cmSystemTools::FileExists(resultFile, true)) {
+      // Another process stored the entry first.
+      return;
+    }
+
+    // Readers look for the result, so write it last.
+    Json::Value root(Json::objectValue);
+    root["version"] = Version;
+    root["exitCode"] = result.ExitCode;
+    root["output"] = Normalize(result.Output, binaryDirectory, targetName);
+    root["outputFile"] = std::string();
+    if (result.ExitCode == 0) {
+      std::string const tmp = cmStrCat(entry, "/output.tmp");
+      if (!cmSystemTools::CopyFileAlways(result.OutputFile, tmp) ||
+          !cmSystemTools::RenameFile(tmp, cmStrCat(entry, "/output"))) {
+        cmSystemTools::RemoveFile(tmp);
+        return;
+      }
+      root["outputFile"] =
+        Normalize(result.OutputFile, binaryDirectory, targetName);
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    std::unique_ptr<Json::StreamWriter> const writer(
+      builder.newStreamWriter());
+    cmGeneratedFileStream fout;
+    fout.Open(resultFile, true, true);
+    writer->write(root, &fout);
+    fout.Close();
+  }
+
+  this->Evict();
+}
+
+std::string cmTryCompileCache::GetEntryDirectory(std::string const& key) const
+{
+  return cmStrCat(this->Directory, '/', cm::string_view(key).substr(0, 2), '/',
+                  key);
+}
+
+void cmTryCompileCache::Evict() const
+{
+  // Check the size once per configure step.  Scanning the cache costs much
+  // more than storing an entry.
+  if (this->MaxSize == 0 || this->CMakeInstance->GetTryCompileCacheChecked()) {
+    return;
+  }
+  this->CMakeInstance->TryCompileCacheCheckedOn();
+
+  // Let one process evict at a time.  Others skip the check.
+  cmFileLock lock;
+  if (!LockEntry(this->Directory, lock, 0)) {
+    return;
+  }
+
+  struct Entry
+  {
+    std::string Path;
+    cmFileTime::TimeType Time;
+    std::uint64_t Size;
+  };
+  std::vector<Entry> entries;
+  std::uint64_t total = 0;
+  cmsys::Directory root;
+  root.Load(this->Directory);
+  for (unsigned long i = 0; i < root.GetNumberOfFiles(); ++i) {
+    std::string const& prefix = root.GetFileName(i);
+    if (cmHasLiteralSuffix(prefix, ".evicted")) {
+      // Left behind by an interrupted eviction.
+      cmSystemTools::RemoveADirectory(
+        cmStrCat(this->Directory, '/', prefix));
+      continue;
+    }
+    if (prefix.size() != 2 || !root.FileIsDirectory(i)) {
+      continue;
+    }
+    cmsys::Directory group;
+    group.Load(cmStrCat(this->Directory, '/', prefix));
+    for (unsigned long j = 0; j < group.GetNumberOfFiles(); ++j) {
+      std::string const& key = group.GetFileName(j);
+      if (key == "." || key == ".." || !group.FileIsDirectory(j)) {
+        continue;
+      }
+      Entry e;
+      e.Path = cmStrCat(group.GetPath(), '/', key);
+      e.Size = 0;
+      cmsys::Directory files;
+      files.Load(e.Path);
+      for (unsigned long k = 0; k < files.GetNumberOfFiles(); ++k) {
+        if (!files.FileIsDirectory(k)) {
+          e.Size += cmSystemTools::FileLength(
+            cmStrCat(e.Path, '/', files.GetFileName(k)));
+        }
+      }
+      // Entries being written have no result yet.  Use the time of the
+      // directory so that abandoned ones are removed eventually.
+      cmFileTime time;
+      if (!time.Load(cmStrCat(e.Path, "/result.json"))) {
+        time.Load(e.Path);
+      }
+      e.Time = time.GetTime();
+      total += e.Size;
+      entries.emplace_back(std::move(e));
+    }
+  }
+  if (total <= this->MaxSize) {
+    return;
+  }
+
+  // Remove the least recently used entries.  Leave some room so that the
+  // next runs do not have to evict again right away.
+  std::sort(entries.begin(), entries.end(),
+            [](Entry const& l, Entry const& r) { return l.Time < r.Time; });
+  std::uint64_t const target = this->MaxSize / 4 * 3;
+  for (Entry const& e : entries) {
+    if (total <= target) {
+      break;
+    }
+    // Move the entry out of the way while holding its lock, so that no
+    // reader or writer can use it while it is removed.  Skip entries that
+    // are being read or written.
+    std::string const tombstone = cmStrCat(
+      this->Directory, '/', cmSystemTools::GetFilenameName(e.Path),
+      ".evicted");
+    {
+      cmFileLock entryLock;
+      if (!LockEntry(e.Path, entryLock, 0)) {
+        continue;
+      }
+      cmSystemTools::RemoveADirectory(tombstone);
+      if (!cmSystemTools::RenameFile(e.Path, tombstone)) {
+        continue;
+      }
+    }
+    cmSystemTools::RemoveADirectory(tombstone);
+    total -= e.Size;
+  }
+}
@@ -0,0 +1,81 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cm/optional>
+
+class cmMakefile;
+class cmake;
+
+/** \class cmTryCompileCache
+ * \brief Results of try_compile shared by build trees on a machine.
+ *
+ * The result of building a try_compile project from sources is stored
+ * under a key that hashes everything the build depends on: the generated
+ * project, the sources, the flags passed to the project, the toolchain
+ * information of the calling project and the generator.  A later
+ * try_compile with the same key, possibly in another build tree, takes
+ * the stored exit code, output and built file instead of building the
+ * project again.
+ *
+ * Each entry is written under a file lock and replaced atomically.  When
+ * the cache grows beyond its size limit, the least recently used entries
+ * are removed.
+ */
+class cmTryCompileCache
+{
+public:
+  /** Returns the cache selected by the CMAKE_TRY_COMPILE_CACHE variable
+      or environment variable, if any.  */
+  static std::unique_ptr<cmTryCompileCache> Create(cmMakefile const& mf);
+
+  cmTryCompileCache(std::string directory, std::uint64_t maxSize,
+                    cmake* cm);
+
+  /**
+   * @brief Computes the key of a try_compile project generated in
+   *        the given directory.
+   *
+   * Occurrences of the binary directory and the random target name in the
+   * inputs are replaced so that identical checks have the same key.
+   */
+  std::string ComputeKey(cmMakefile const& mf,
+                         std::string const& binaryDirectory,
+                         std::string const& targetName,
+                         std::vector<std::string> const& cmakeFlags,
+                         std::vector<std::string> const& sources,
+                         std::vector<std::string> const& linkLibraries) const;
+
+  struct Result
+  {
+    int ExitCode = 1;
+    std::string Output;
+    // The built file, which must be in the binary directory.
+    std::string OutputFile;
+  };
+
+  /** Loads the result stored for a key.  The built file is restored at
+      the same place in the given binary directory.  */
+  cm::optional<Result> Load(std::string const& key,
+                            std::string const& binaryDirectory,
+                            std::string const& targetName) const;
+
+  /** Stores the result for a key, including the built file if any.  */
+  void Store(std::string const& key, std::string const& binaryDirectory,
+             std::string const& targetName, Result const& result);
+
+private:
+  std::string GetEntryDirectory(std::string const& key) const;
+  void Evict() const;
+
+  std::string Directory;
+  std::uint64_t MaxSize;
+  cmake* CMakeInstance;
+};
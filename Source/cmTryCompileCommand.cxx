@@ -38,7 +38,8 @@ bool cmTryCompileCommand(std::vector<std::string> const& args,
 {
   cmMakefile& mf = status.GetMakefile();
 
-  if (args.size() < 3) {
+  bool const buildBatch = args.size() == 2 && args[0] == "BUILD_BATCH";
+  if (args.size() < 3 && !buildBatch) {
     mf.IssueMessage(
       MessageType::FATAL_ERROR,
       "The try_compile() command requires at least 3 arguments.");
@@ -52,6 +53,21 @@ bool cmTryCompileCommand(std::vector<std::string> const& args,
     return false;
   }
 
+  if (buildBatch) {
+    cmCoreTryCompile tc(&mf);
+    std::vector<cmTryCompileResult> compileResults = tc.BuildBatch(args[1]);
+#ifndef CMAKE_BOOTSTRAP
+    if (cmConfigureLog* log = mf.GetCMakeInstance()->GetConfigureLog()) {
+      for (cmTryCompileResult const& compileResult : compileResults) {
+        WriteTryCompileEvent(*log, mf, compileResult);
+      }
+    }
+#else
+    static_cast<void>(compileResults);
+#endif
+    return true;
+  }
+
   cmStateEnums::TargetType targetType = cmStateEnums::EXECUTABLE;
   cmValue tt = mf.GetDefinition("CMAKE_TRY_COMPILE_TARGET_TYPE");
   if (cmNonempty(tt)) {
@@ -91,7 +107,8 @@ bool cmTryCompileCommand(std::vector<std::string> const& args,
 #endif
 
   // if They specified clean then we clean up what we can
-  if (tc.SrcFileSignature) {
+  // unless the project is queued to build with a batch
+  if (tc.SrcFileSignature && !tc.Queued) {
     if (!mf.GetCMakeInstance()->GetDebugTryCompile()) {
       tc.CleanupFiles(tc.BinaryDirectory);
     }
@@ -36,6 +36,7 @@
 #include "cmCMakePresetsGraph.h"
 #include "cmCommandLineArgument.h"
 #include "cmCommands.h"
+#include "cmCryptoHash.h"
 #ifdef CMake_ENABLE_DEBUGGER
 #  include "cmDebuggerAdapter.h"
 #  ifdef _WIN32
@@ -48,7 +49,10 @@
 #include "cmDocumentationEntry.h"
 #include "cmDuration.h"
 #include "cmExternalMakefileProjectGenerator.h"
+#include "cmFileSystemCache.h"
 #include "cmFileTimeCache.h"
+#include "cmGeneratedFileHashes.h"
+#include "cmGeneratedFileStream.h"
 #include "cmGeneratorTarget.h"
 #include "cmGlobCacheEntry.h"
 #include "cmGlobalGenerator.h"
@@ -84,9 +88,11 @@
 
 #  include "cmConfigureLog.h"
 #  include "cmFileAPI.h"
+#  include "cmFindPackageCache.h"
 #  include "cmGraphVizWriter.h"
 #  include "cmInstrumentation.h"
 #  include "cmInstrumentationQuery.h"
+#  include "cmListFileParseCache.h"
 #  include "cmVariableWatch.h"
 #endif
 
@@ -296,6 +302,7 @@ cmDocumentationEntry cmake::CMAKE_STANDARD_OPTIONS_TABLE[19] = {
 cmake::cmake(Role role, cmState::Mode mode, cmState::ProjectKind projectKind)
   : CMakeWorkingDirectory(cmSystemTools::GetLogicalWorkingDirectory())
   , FileTimeCache(cm::make_unique<cmFileTimeCache>())
+  , FileSystemCache(cm::make_unique<cmFileSystemCache>())
 #ifndef CMAKE_BOOTSTRAP
   , VariableWatch(cm::make_unique<cmVariableWatch>())
 #endif
@@ -1097,6 +1104,12 @@ void cmake::SetArgs(std::vector<std::string> const& args)
                        state->RegenerateDuringBuild = true;
                        return true;
                      } },
+    CommandArgument{ "--check-regenerate-inputs",
+                     CommandArgument::Values::Zero,
+                     [](std::string const&, cmake* state) -> bool {
+                       state->CheckRegenerateInputs = true;
+                       return true;
+                     } },
 
     CommandArgument{ "--find-package", CommandArgument::Values::Zero,
                      IgnoreAndTrueLambda },
@@ -1292,6 +1305,18 @@ void cmake::SetArgs(std::vector<std::string> const& args)
         state->SetIgnoreLinkWarningAsError(true);
         return true;
       } },
+    CommandArgument{
+      "--generate-jobs", "No jobs specified for --generate-jobs",
+      CommandArgument::Values::One,
+      [](std::string const& value, cmake* state) -> bool {
+        unsigned long jobs = 0;
+        if (!cmStrToULong(value, &jobs) || jobs == 0) {
+          cmSystemTools::Error("Invalid value specified for --generate-jobs");
+          return false;
+        }
+        state->SetGenerateJobs(static_cast<unsigned int>(jobs));
+        return true;
+      } },
 #ifndef CMAKE_BOOTSTRAP
     CommandArgument{ "--sarif-output", "No file specified for --sarif-output",
                      CommandArgument::Values::One,
@@ -2417,6 +2442,8 @@ int cmake::ActualConfigure()
 {
   // Construct right now our path conversion table before it's too late:
   this->CleanupCommandsAndMacros();
+  this->FileSystemCache->Clear();
+  this->TryCompileCacheChecked = false;
 
   cmSystemTools::RemoveADirectory(this->GetHomeOutputDirectory() +
                                   "/CMakeFiles/CMakeScratch");
@@ -2626,6 +2653,38 @@ int cmake::ActualConfigure()
     this->ConfigureLog = cm::make_unique<cmConfigureLog>(
       cmStrCat(this->GetHomeOutputDirectory(), "/CMakeFiles"_s),
       this->FileAPI->GetConfigureLogVersions());
+
+    this->ListFileParseCache.reset();
+    this->MarkCliAsUsed("CMAKE_LISTFILE_CACHE");
+    if (cmValue listFileCache =
+          this->State->GetInitializedCacheValue("CMAKE_LISTFILE_CACHE")) {
+      if (cmIsOn(*listFileCache) ||
+          cmSystemTools::FileIsFullPath(*listFileCache)) {
+        std::string cacheFile = cmIsOn(*listFileCache)
+          ? cmStrCat(this->GetHomeOutputDirectory(),
+                     "/CMakeFiles/ListFileCache.bin"_s)
+          : *listFileCache;
+        this->ListFileParseCache =
+          cm::make_unique<cmListFileParseCache>(std::move(cacheFile));
+        this->ListFileParseCache->Load();
+      }
+    }
+
+    this->FindPackageCache.reset();
+    this->MarkCliAsUsed("CMAKE_FIND_PACKAGE_CACHE");
+    if (cmValue findPackageCache =
+          this->State->GetInitializedCacheValue("CMAKE_FIND_PACKAGE_CACHE")) {
+      if (cmIsOn(*findPackageCache) ||
+          cmSystemTools::FileIsFullPath(*findPackageCache)) {
+        std::string cacheFile = cmIsOn(*findPackageCache)
+          ? cmStrCat(this->GetHomeOutputDirectory(),
+                     "/CMakeFiles/FindPackageCache.json"_s)
+          : *findPackageCache;
+        this->FindPackageCache =
+          cm::make_unique<cmFindPackageCache>(std::move(cacheFile));
+        this->FindPackageCache->Load();
+      }
+    }
   }
 
   this->Instrumentation =
@@ -2641,6 +2700,7 @@ int cmake::ActualConfigure()
   }
   auto doConfigure = [this]() -> int {
     this->GlobalGenerator->Configure();
+    this->RecordProfilingFileSystemCacheUsage();
     return 0;
   };
   int ret = this->Instrumentation->InstrumentCommand(
@@ -2670,6 +2730,14 @@ int cmake::ActualConfigure()
 
 #if !defined(CMAKE_BOOTSTRAP)
   this->ConfigureLog.reset();
+  if (this->ListFileParseCache) {
+    this->ListFileParseCache->Save();
+    this->ListFileParseCache.reset();
+  }
+  if (this->FindPackageCache) {
+    this->FindPackageCache->Save();
+    this->FindPackageCache.reset();
+  }
 #endif
 
   // Before saving the cache
@@ -3042,11 +3110,37 @@ int cmake::Generate()
 #if !defined(CMAKE_BOOTSTRAP)
   auto profilingRAII = this->CreateProfilingEntry("project", "generate");
   auto doGenerate = [this]() -> int {
-    if (!this->GlobalGenerator->Compute()) {
-      this->FileAPI->WriteReplies(cmFileAPI::IndexFor::FailedCompute);
-      return -1;
+    this->RecordProfilingMemoryUsage();
+    {
+      auto computeRAII = this->CreateProfilingEntry("generate", "compute");
+      if (!this->GlobalGenerator->Compute()) {
+        this->FileAPI->WriteReplies(cmFileAPI::IndexFor::FailedCompute);
+        return -1;
+      }
+    }
+    // Skip writing generated files whose content is known to be current.
+    std::string const hashesFile = cmStrCat(
+      this->GetHomeOutputDirectory(), "/CMakeFiles/cmake.generated_hashes");
+    std::unique_ptr<cmGeneratedFileHashes> hashes;
+    if (this->GlobalGenerator->GlobalSettingIsOn(
+          "CMAKE_GENERATE_HASH_MANIFEST")) {
+      hashes = cm::make_unique<cmGeneratedFileHashes>(hashesFile);
+      hashes->Load();
+      cmGeneratedFileStream::SetHashManifest(hashes.get());
+    } else {
+      cmSystemTools::RemoveFile(hashesFile);
     }
     this->GlobalGenerator->Generate();
+    if (hashes) {
+      cmGeneratedFileStream::SetHashManifest(nullptr);
+      // Files that failed to be written may not match their hashes.
+      if (cmSystemTools::GetErrorOccurredFlag()) {
+        cmSystemTools::RemoveFile(hashesFile);
+      } else {
+        hashes->Save();
+      }
+    }
+    this->RecordProfilingMemoryUsage();
     return 0;
   };
 
@@ -3147,6 +3241,12 @@ std::vector<cmGlobCacheEntry> cmake::GetGlobCacheEntries() const
   return this->State->GetGlobCacheEntries();
 }
 
+std::string cmake::GetRegenerateInputHashesFile() const
+{
+  return cmStrCat(this->GetHomeOutputDirectory(),
+                  "/CMakeFiles/cmake.input_hashes");
+}
+
 std::vector<std::string> cmake::GetAllExtensions() const
 {
   std::vector<std::string> allExt = this->CLikeSourceFileExtensions.ordered;
@@ -3382,6 +3482,13 @@ int cmake::CheckBuildSystem()
 
   // If no file is provided for the check, we have to rerun.
   if (this->CheckBuildSystemArgument.empty()) {
+    // The build tool decided to regenerate based on timestamps.  Other
+    // requests to regenerate, such as the rebuild_cache target, always
+    // re-run.
+    if (this->CheckRegenerateInputs &&
+        this->CheckRegenerateInputHashes(verbose)) {
+      return 0;
+    }
     if (verbose) {
       cmSystemTools::Stdout("Re-run cmake no build system arguments\n");
     }
@@ -3506,6 +3613,9 @@ int cmake::CheckBuildSystem()
     int result = 0;
     if (!this->FileTimeCache->Compare(out_oldest, dep_newest, &result) ||
         result < 0) {
+      if (this->CheckRegenerateInputHashes(verbose)) {
+        return 0;
+      }
       if (verbose) {
         std::ostringstream msg;
         msg << "Re-run cmake file: " << out_oldest
@@ -3520,6 +3630,78 @@ int cmake::CheckBuildSystem()
   return 0;
 }
 
+bool cmake::CheckRegenerateInputHashes(bool verbose)
+{
+  // This only gates the re-run on the content of the inputs.  If any of
+  // them changed, the whole project is configured again: directory scopes
+  // share the cache, global properties, and targets, so the state of a
+  // directory cannot be reused when another one is configured again.
+
+  // Read the inputs and outputs recorded by the last generate step.
+  cmsys::ifstream fin(this->GetRegenerateInputHashesFile().c_str());
+  if (!fin) {
+    return false;
+  }
+  std::vector<std::string> outputs;
+  std::vector<std::pair<std::string, std::string>> inputs;
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (cmHasLiteralPrefix(line, "output ")) {
+      outputs.emplace_back(line.substr(7));
+    } else if (cmHasLiteralPrefix(line, "input ")) {
+      std::string::size_type const pos = line.find(' ', 6);
+      if (pos == std::string::npos) {
+        return false;
+      }
+      inputs.emplace_back(line.substr(6, pos - 6), line.substr(pos + 1));
+    }
+  }
+  if (outputs.empty() || inputs.empty()) {
+    return false;
+  }
+
+  // Find the oldest output.
+  cmFileTime outOldest;
+  for (std::string const& out : outputs) {
+    cmFileTime outTime;
+    if (!this->FileTimeCache->Load(out, outTime)) {
+      return false;
+    }
+    if (&out == &outputs.front() || outTime.Older(outOldest)) {
+      outOldest = outTime;
+    }
+  }
+
+  // Compare the content of every input newer than the oldest output.
+  // Inputs recorded without a hash must be regenerated from whenever
+  // they are newer.
+  cmCryptoHash md5(cmCryptoHash::AlgoMD5);
+  for (auto const& in : inputs) {
+    cmFileTime inTime;
+    if (!this->FileTimeCache->Load(in.second, inTime)) {
+      return false;
+    }
+    if (inTime.Newer(outOldest) &&
+        (in.first == "-" || md5.HashFile(in.second) != in.first)) {
+      if (verbose) {
+        cmSystemTools::Stdout(
+          cmStrCat("Re-run cmake file content changed: ", in.second, '\n'));
+      }
+      return false;
+    }
+  }
+
+  // Bring the outputs up to date so the next check succeeds quickly.
+  for (std::string const& out : outputs) {
+    cmSystemTools::Touch(out, false);
+  }
+  if (verbose) {
+    cmSystemTools::Stdout(
+      "Skip re-run of cmake, content of build system inputs unchanged\n");
+  }
+  return true;
+}
+
 void cmake::TruncateOutputLog(char const* fname)
 {
   std::string fullPath = cmStrCat(this->GetHomeOutputDirectory(), '/', fname);
@@ -3574,12 +3756,17 @@ void cmake::AppendProperty(std::string const& prop, std::string const& value,
 
 cmValue cmake::GetProperty(std::string const& prop)
 {
+#if !defined(CMAKE_BOOTSTRAP)
+  if (this->FindPackageCache) {
+    this->FindPackageCache->RecordGlobalPropertyRead(prop);
+  }
+#endif
   return this->State->GetGlobalProperty(prop);
 }
 
 bool cmake::GetPropertyAsBool(std::string const& prop)
 {
-  return this->State->GetGlobalPropertyAsBool(prop);
+  return this->GetProperty(prop).IsOn();
 }
 
 cmInstalledFile* cmake::GetOrCreateInstalledFile(cmMakefile* mf,
@@ -4422,6 +4609,20 @@ void cmake::SetCMakeListName(std::string const& name)
   this->CMakeListName = name;
 }
 
+unsigned int cmake::GetGenerateJobs() const
+{
+  if (this->GenerateJobs > 0) {
+    return this->GenerateJobs;
+  }
+  unsigned long jobs = 0;
+  cm::optional<std::string> envJobs =
+    cmSystemTools::GetEnvVar("CMAKE_GENERATE_JOBS");
+  if (envJobs && cmStrToULong(*envJobs, &jobs) && jobs > 0) {
+    return static_cast<unsigned int>(jobs);
+  }
+  return 1;
+}
+
 std::string cmake::GetCMakeListFile(std::string const& dir) const
 {
   std::string listFile = cmStrCat(dir, '/', this->CMakeListName);
@@ -4442,4 +4643,18 @@ bool cmake::IsProfilingEnabled() const
 {
   return static_cast<bool>(this->ProfilingOutput);
 }
+
+void cmake::RecordProfilingFileSystemCacheUsage()
+{
+  if (this->IsProfilingEnabled()) {
+    cmFileSystemCache::Statistics const& stats =
+      this->FileSystemCache->GetStatistics();
+    Json::Value values;
+    values["system_calls"] =
+      static_cast<Json::Value::UInt64>(stats.SystemCalls);
+    values["saved_system_calls"] =
+      static_cast<Json::Value::UInt64>(stats.SavedSystemCalls);
+    this->GetProfilingOutput().RecordCounter("find_file_system_cache", values);
+  }
+}
 #endif
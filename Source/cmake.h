@@ -40,6 +40,8 @@
 #endif
 
 class cmConfigureLog;
+class cmFindPackageCache;
+class cmListFileParseCache;
 
 #ifdef CMake_ENABLE_DEBUGGER
 namespace cmDebugger {
@@ -50,6 +52,7 @@ class cmDebuggerAdapter;
 class cmExternalMakefileProjectGeneratorFactory;
 class cmFileAPI;
 class cmInstrumentation;
+class cmFileSystemCache;
 class cmFileTimeCache;
 class cmGlobalGenerator;
 class cmMakefile;
@@ -372,6 +375,10 @@ public:
                          cmListFileBacktrace const& bt);
   std::vector<cmGlobCacheEntry> GetGlobCacheEntries() const;
 
+  /** Get the file in which the generator records the content of the
+      inputs of the build system regeneration step.  */
+  std::string GetRegenerateInputHashesFile() const;
+
   /**
    * Get the system information and write it to the file specified
    */
@@ -468,6 +475,14 @@ public:
   bool GetDebugTryCompile() const { return this->DebugTryCompile; }
   void DebugTryCompileOn() { this->DebugTryCompile = true; }
 
+  //! Whether the size of the try_compile cache was checked in this
+  //! configure step
+  bool GetTryCompileCacheChecked() const
+  {
+    return this->TryCompileCacheChecked;
+  }
+  void TryCompileCacheCheckedOn() { this->TryCompileCacheChecked = true; }
+
   /**
    * Generate CMAKE_ROOT and CMAKE_COMMAND cache entries
    */
@@ -478,6 +493,11 @@ public:
    */
   cmFileTimeCache* GetFileTimeCache() { return this->FileTimeCache.get(); }
 
+  /**
+   * Get the cache of file system queries made by the find commands
+   */
+  cmFileSystemCache& GetFileSystemCache() { return *this->FileSystemCache; }
+
   bool WasLogLevelSetViaCLI() const { return this->LogLevelWasSetViaCLI; }
 
   //! Get the selected log level for `message()` commands during the cmake run.
@@ -553,6 +573,14 @@ public:
 
 #ifndef CMAKE_BOOTSTRAP
   cmConfigureLog* GetConfigureLog() const { return this->ConfigureLog.get(); }
+  cmListFileParseCache* GetListFileParseCache() const
+  {
+    return this->ListFileParseCache.get();
+  }
+  cmFindPackageCache* GetFindPackageCache() const
+  {
+    return this->FindPackageCache.get();
+  }
 #endif
 
   //! Use trace from another ::cmake instance.
@@ -581,6 +609,10 @@ public:
     this->IgnoreLinkWarningAsError = b;
   }
 
+  //! Number of concurrent jobs used to write files in the generate step.
+  unsigned int GetGenerateJobs() const;
+  void SetGenerateJobs(unsigned int jobs) { this->GenerateJobs = jobs; }
+
   void MarkCliAsUsed(std::string const& variable);
 
   /** Get the list of configurations (in upper case) considered to be
@@ -730,6 +762,15 @@ public:
     }
     return cm::nullopt;
   }
+
+  void RecordProfilingMemoryUsage()
+  {
+    if (this->IsProfilingEnabled()) {
+      this->GetProfilingOutput().RecordMemoryUsage();
+    }
+  }
+
+  void RecordProfilingFileSystemCacheUsage();
 #endif
 
 #ifdef CMake_ENABLE_DEBUGGER
@@ -787,6 +828,13 @@ protected:
    */
   int CheckBuildSystem();
 
+  /**
+   * Check whether the inputs of the build system that are newer than its
+   * outputs have the content recorded by the last generate step.  If so,
+   * touch the outputs and return true.
+   */
+  bool CheckRegenerateInputHashes(bool verbose);
+
   bool SetDirectoriesFromFile(std::string const& arg);
 
   //! Make sure all commands are what they say they are and there is no
@@ -811,12 +859,15 @@ private:
   cmake* TraceRedirect = nullptr;
 #ifndef CMAKE_BOOTSTRAP
   std::unique_ptr<cmConfigureLog> ConfigureLog;
+  std::unique_ptr<cmListFileParseCache> ListFileParseCache;
+  std::unique_ptr<cmFindPackageCache> FindPackageCache;
 #endif
   bool WarnUninitialized = false;
   bool WarnUnusedCli = true;
   bool CheckSystemVars = false;
   bool IgnoreCompileWarningAsError = false;
   bool IgnoreLinkWarningAsError = false;
+  unsigned int GenerateJobs = 0;
   std::map<std::string, bool> UsedCliVariables;
   std::string CMakeEditCommand;
   std::string CXXEnvironment;
@@ -834,10 +885,13 @@ private:
   FileExtensions HipFileExtensions;
   bool ClearBuildSystem = false;
   bool DebugTryCompile = false;
+  bool TryCompileCacheChecked = false;
   bool FreshCache = false;
   bool RegenerateDuringBuild = false;
+  bool CheckRegenerateInputs = false;
   std::string CMakeListName;
   std::unique_ptr<cmFileTimeCache> FileTimeCache;
+  std::unique_ptr<cmFileSystemCache> FileSystemCache;
   std::string GraphVizFile;
   InstalledFilesMap InstalledFiles;
 #ifndef CMAKE_BOOTSTRAP
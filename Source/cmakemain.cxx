@@ -72,7 +72,7 @@ cmDocumentationEntry const cmDocumentationUsageNote = {
   "Run 'cmake --help' for more information."
 };
 
-cmDocumentationEntry const cmDocumentationOptions[35] = {
+cmDocumentationEntry const cmDocumentationOptions[36] = {
   { "--preset <preset>,--preset=<preset>", "Specify a configure preset." },
   { "--list-presets[=<type>]", "List available presets." },
   { "--workflow [<options>]", "Run a workflow preset." },
@@ -127,6 +127,8 @@ cmDocumentationEntry const cmDocumentationOptions[35] = {
   { "--link-no-warning-as-error",
     "Ignore LINK_WARNING_AS_ERROR property and "
     "CMAKE_LINK_WARNING_AS_ERROR variable." },
+  { "--generate-jobs=<jobs>",
+    "Number of concurrent jobs used to write files in the generate step." },
   { "--profiling-format=<fmt>",
     "Output data for profiling CMake scripts. Supported formats: "
     "google-trace" },
@@ -82,6 +82,8 @@ int cmcmd_cmake_ninja_dyndep(std::vector<std::string>::const_iterator argBeg,
 int cmcmd_cmake_module_compile_db(
   std::vector<std::string>::const_iterator argBeg,
   std::vector<std::string>::const_iterator argEnd);
+int cmcmd_cmake_build_stamp(std::vector<std::string>::const_iterator argBeg,
+                            std::vector<std::string>::const_iterator argEnd);
 
 namespace {
 // ATTENTION If you add new commands, change here,
@@ -1431,6 +1433,13 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string> const& args,
     }
 #endif
 
+#if !defined(CMAKE_BOOTSTRAP)
+    // Internal CMake Makefile build stamp support.
+    if (args[1] == "cmake_build_stamp") {
+      return cmcmd_cmake_build_stamp(args.begin() + 2, args.end());
+    }
+#endif
+
     // Internal CMake link script support.
     if (args[1] == "cmake_link_script" && args.size() >= 3) {
       return cmcmd::ExecuteLinkScript(args);
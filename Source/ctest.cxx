@@ -150,6 +150,12 @@ cmDocumentationEntry const cmDocumentationOptions[] = {
   { "--http-header <header>", "Append HTTP header when submitting" },
   { "--schedule-random", "Use a random order for scheduling tests" },
   { "--schedule-random-seed", "Override seed for random order of tests" },
+  { "--schedule-critical-path",
+    "Start tests on the longest chains of test costs first" },
+  { "--shard <i>/<n>",
+    "Run the i-th of n parts of the tests, balanced by test costs" },
+  { "--merge-shards <n>",
+    "Combine the results of n shards run with --shard" },
   { "--submit-index",
     "Submit individual dashboard tests with specific index" },
   { "--timeout <seconds>", "Set the default test timeout." },
@@ -0,0 +1,120 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "cmAtom.h"
+#include "cmPropertyMap.h"
+#include "cmValue.h"
+
+#include "testCommon.h"
+
+namespace {
+
+bool testIntern()
+{
+  std::cout << "testIntern()\n";
+
+  cmAtom const a = cmAtom::Intern("testAtom_A");
+  ASSERT_TRUE(a);
+  ASSERT_EQUAL(a.str(), "testAtom_A");
+
+  // Equal names give the same atom, whatever string holds them.
+  std::string const name = "testAtom_A";
+  ASSERT_TRUE(cmAtom::Intern(name) == a);
+  ASSERT_TRUE(&cmAtom::Intern(name).str() == &a.str());
+
+  cmAtom const b = cmAtom::Intern("testAtom_B");
+  ASSERT_TRUE(b != a);
+  ASSERT_TRUE(std::hash<cmAtom>{}(cmAtom::Intern("testAtom_B")) ==
+              std::hash<cmAtom>{}(b));
+
+  ASSERT_TRUE(!cmAtom());
+  ASSERT_TRUE(cmAtom() == cmAtom());
+  ASSERT_TRUE(cmAtom::Intern("") != cmAtom());
+  return true;
+}
+
+bool testLookup()
+{
+  std::cout << "testLookup()\n";
+
+  // Looking up a name does not intern it.
+  ASSERT_TRUE(!cmAtom::Lookup("testAtom_NotInterned"));
+  ASSERT_TRUE(!cmAtom::Lookup("testAtom_NotInterned"));
+
+  cmAtom const c = cmAtom::Intern("testAtom_C");
+  ASSERT_TRUE(cmAtom::Lookup("testAtom_C") == c);
+  ASSERT_TRUE(!cmAtom::Lookup("testAtom_c"));
+  ASSERT_TRUE(!cmAtom::Lookup("testAtom_C_"));
+  return true;
+}
+
+bool testPropertyMap()
+{
+  std::cout << "testPropertyMap()\n";
+
+  cmPropertyMap map;
+  map.SetProperty("testAtom_Property", "value");
+  ASSERT_EQUAL(*map.GetPropertyValue("testAtom_Property"), "value");
+  ASSERT_EQUAL(
+    *map.GetPropertyValue(cmAtom::Lookup("testAtom_Property")), "value");
+  ASSERT_TRUE(!map.GetPropertyValue("testAtom_OtherProperty"));
+  ASSERT_TRUE(!map.GetPropertyValue(cmAtom::Intern("testAtom_Other")));
+
+  map.AppendProperty("testAtom_Property", "more");
+  ASSERT_EQUAL(*map.GetPropertyValue("testAtom_Property"), "value;more");
+  map.RemoveProperty("testAtom_Property");
+  ASSERT_TRUE(!map.GetPropertyValue("testAtom_Property"));
+  return true;
+}
+
+bool testThreads()
+{
+  std::cout << "testThreads()\n";
+
+  // Threads interning the same names concurrently get the same atoms.
+  int const count = 2000;
+  std::vector<std::string> names;
+  for (int i = 0; i < count; ++i) {
+    names.push_back("testAtom_Thread_" + std::to_string(i));
+  }
+  std::vector<std::vector<cmAtom>> results(8);
+  std::vector<std::thread> threads;
+  for (std::vector<cmAtom>& result : results) {
+    threads.emplace_back([&names, &result]() {
+      for (std::string const& name : names) {
+        result.push_back(cmAtom::Intern(name));
+        cmAtom::Lookup(name);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::unordered_set<cmAtom> distinct;
+  for (int i = 0; i < count; ++i) {
+    cmAtom const atom = cmAtom::Lookup(names[i]);
+    ASSERT_TRUE(atom);
+    ASSERT_EQUAL(atom.str(), names[i]);
+    for (std::vector<cmAtom> const& result : results) {
+      ASSERT_TRUE(result[i] == atom);
+    }
+    distinct.insert(atom);
+  }
+  ASSERT_EQUAL(distinct.size(), static_cast<std::size_t>(count));
+  return true;
+}
+
+} // anonymous namespace
+
+int testAtom(int /*unused*/, char* /*unused*/[])
+{
+  return runTests({ testIntern, testLookup, testPropertyMap, testThreads });
+}
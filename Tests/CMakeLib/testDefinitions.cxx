@@ -0,0 +1,174 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmDefinitions.h"
+#include "cmLinkedTree.h"
+#include "cmValue.h"
+
+#include "testCommon.h"
+
+namespace {
+
+using Tree = cmLinkedTree<cmDefinitions>;
+
+std::string Key(int i)
+{
+  return "VAR_" + std::to_string(i);
+}
+
+// Push a scope like that of a function() call with its ARG* variables.
+Tree::iterator PushScope(Tree& tree, Tree::iterator parent)
+{
+  Tree::iterator scope = tree.Push(parent);
+  scope->Set("ARGC", "1");
+  scope->Set("ARGV", "arg");
+  scope->Set("ARGV0", "arg");
+  scope->Set("ARGN", "");
+  return scope;
+}
+
+bool testGet()
+{
+  std::cout << "testGet()\n";
+
+  Tree tree;
+  Tree::iterator root = tree.Push(tree.Root());
+  root->Set("A", "root");
+  root->Set("B", "root");
+  Tree::iterator scope = PushScope(tree, root);
+  scope->Set("B", "scope");
+  scope->Unset("ARGN");
+  Tree::iterator end = tree.Root();
+
+  ASSERT_EQUAL(*cmDefinitions::Get("A", scope, end), "root");
+  ASSERT_EQUAL(*cmDefinitions::Get("B", scope, end), "scope");
+  ASSERT_EQUAL(*cmDefinitions::Get("B", root, end), "root");
+  ASSERT_TRUE(!cmDefinitions::Get("C", scope, end));
+  ASSERT_TRUE(!cmDefinitions::Get("ARGN", scope, end));
+  ASSERT_TRUE(cmDefinitions::HasKey("ARGN", scope, end));
+  ASSERT_TRUE(!cmDefinitions::HasKey("ARGN", root, end));
+  ASSERT_TRUE(!cmDefinitions::HasKey("C", scope, end));
+  return true;
+}
+
+bool testManyKeys()
+{
+  std::cout << "testManyKeys()\n";
+
+  // Scopes larger than one filter word must still find all their keys.
+  Tree tree;
+  Tree::iterator root = tree.Push(tree.Root());
+  for (int i = 0; i < 2000; i += 2) {
+    root->Set(Key(i), Key(i));
+  }
+  Tree::iterator scope = PushScope(tree, root);
+  for (int i = 1; i < 2000; i += 2) {
+    scope->Set(Key(i), Key(i));
+  }
+  Tree::iterator end = tree.Root();
+
+  for (int i = 0; i < 2000; ++i) {
+    cmValue value = cmDefinitions::Get(Key(i), scope, end);
+    ASSERT_TRUE(value);
+    ASSERT_EQUAL(*value, Key(i));
+    ASSERT_EQUAL(cmDefinitions::HasKey(Key(i), root, end), i % 2 == 0);
+  }
+  for (int i = 2000; i < 4000; ++i) {
+    ASSERT_TRUE(!cmDefinitions::Get(Key(i), scope, end));
+  }
+  return true;
+}
+
+bool testRaiseAndClosure()
+{
+  std::cout << "testRaiseAndClosure()\n";
+
+  Tree tree;
+  Tree::iterator root = tree.Push(tree.Root());
+  for (int i = 0; i < 100; ++i) {
+    root->Set(Key(i), "root");
+  }
+  Tree::iterator scope = PushScope(tree, root);
+  scope->Set(Key(0), "scope");
+  scope->Unset(Key(1));
+  Tree::iterator end = tree.Root();
+
+  cmDefinitions::Raise(Key(2), scope, end);
+  ASSERT_EQUAL(*cmDefinitions::Get(Key(2), scope, end), "root");
+
+  Tree closureTree;
+  Tree::iterator closure = closureTree.Push(
+    closureTree.Root(), cmDefinitions::MakeClosure(scope, end));
+  Tree::iterator closureEnd = closureTree.Root();
+  ASSERT_EQUAL(*cmDefinitions::Get(Key(0), closure, closureEnd), "scope");
+  ASSERT_TRUE(!cmDefinitions::HasKey(Key(1), closure, closureEnd));
+  for (int i = 2; i < 100; ++i) {
+    ASSERT_EQUAL(*cmDefinitions::Get(Key(i), closure, closureEnd), "root");
+  }
+
+  std::vector<std::string> keys = cmDefinitions::ClosureKeys(scope, end);
+  ASSERT_EQUAL(keys.size(), 103u);
+  ASSERT_TRUE(std::find(keys.begin(), keys.end(), Key(1)) == keys.end());
+  return true;
+}
+
+// Measure variable lookups from scopes nested like function() calls in a
+// directory that defines as many variables as a typical project.
+void benchmark(int iterations)
+{
+  int const rootKeys = 1000;
+  for (int depth : { 1, 8, 32, 128 }) {
+    Tree tree;
+    Tree::iterator scope = tree.Push(tree.Root());
+    for (int i = 0; i < rootKeys; ++i) {
+      scope->Set(Key(i), Key(i));
+    }
+    for (int d = 0; d < depth; ++d) {
+      scope = PushScope(tree, scope);
+    }
+    Tree::iterator end = tree.Root();
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < rootKeys; i += rootKeys / 10) {
+      keys.push_back(Key(i));
+    }
+    keys.emplace_back("ARGC");
+    keys.emplace_back("UNDEFINED");
+
+    using clock = std::chrono::steady_clock;
+    std::size_t found = 0;
+    auto const start = clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      for (std::string const& key : keys) {
+        found += cmDefinitions::Get(key, scope, end) ? 1 : 0;
+      }
+    }
+    auto const stop = clock::now();
+
+    double const lookups = static_cast<double>(iterations) * keys.size();
+    double const nanoseconds =
+      std::chrono::duration<double, std::nano>(stop - start).count();
+    std::cout << "Depth " << depth << ": " << nanoseconds / lookups
+              << " ns per lookup (" << found << " found)\n";
+  }
+}
+
+} // anonymous namespace
+
+int testDefinitions(int argc, char* argv[])
+{
+  if (argc > 1) {
+    benchmark(std::atoi(argv[1]));
+    return 0;
+  }
+
+  return runTests({ testGet, testManyKeys, testRaiseAndClosure });
+}
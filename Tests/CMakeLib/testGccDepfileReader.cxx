@@ -1,4 +1,6 @@
+#include <chrono>
 #include <cstddef> // IWYU pragma: keep
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -8,8 +10,10 @@
 
 #include "cmsys/FStream.hxx"
 
+#include "cmGccDepfileLexerHelper.h"
 #include "cmGccDepfileReader.h"
 #include "cmGccDepfileReaderTypes.h" // for cmGccDepfileContent, cmGccStyle...
+#include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
 namespace {
@@ -102,6 +106,50 @@ void dump(char const* label, cmGccDepfileContent const& dfc)
   }
 }
 
+// Measure the throughput of reading a depfile as large as those of
+// heavily templated translation units.
+void benchmark(int iterations)
+{
+  std::string const depfile = "testGccDepfileReader-large.d";
+  {
+    cmsys::ofstream os(depfile.c_str());
+    os << "CMakeFiles/large.dir/large.cxx.o: /src/large.cxx \\\n";
+    for (int i = 0; i < 40000; ++i) {
+      os << " /usr/include/project/component" << i % 100
+         << "/detail/templates_" << i << ".hpp";
+      if (i % 1000 == 0) {
+        os << " /src/with\\ space/$$dollar" << i << ".h";
+      }
+      os << " \\\n";
+    }
+    os << " /src/last.h\n";
+  }
+  double const megabytes =
+    static_cast<double>(cmSystemTools::FileLength(depfile)) / (1 << 20);
+
+  using clock = std::chrono::steady_clock;
+  auto const lexStart = clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    cmGccDepfileLexerHelper helper;
+    helper.readFile(depfile.c_str());
+  }
+  auto const readStart = clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    cmReadGccDepfile(depfile.c_str());
+  }
+  auto const end = clock::now();
+
+  auto throughput = [megabytes, iterations](clock::duration d) {
+    double const seconds = std::chrono::duration<double>(d).count();
+    return megabytes * iterations / seconds;
+  };
+  std::cout << "Depfile of " << megabytes << " MB\n"
+            << "cmGccDepfileLexerHelper::readFile: "
+            << throughput(readStart - lexStart) << " MB/s\n"
+            << "cmReadGccDepfile: " << throughput(end - readStart)
+            << " MB/s\n";
+}
+
 } // anonymous namespace
 
 int testGccDepfileReader(int argc, char* argv[])
@@ -111,9 +159,14 @@ int testGccDepfileReader(int argc, char* argv[])
     return -1;
   }
 
+  if (argc > 2) {
+    benchmark(std::atoi(argv[2]));
+    return 0;
+  }
+
   std::string dataDirPath = argv[1];
   dataDirPath += "/testGccDepfileReader_data";
-  int const numberOfTestFiles = 7; // 6th file doesn't exist
+  int const numberOfTestFiles = 8; // 6th file doesn't exist
   for (int i = 1; i <= numberOfTestFiles; ++i) {
     std::string const base = dataDirPath + "/deps" + std::to_string(i);
     std::string const depfile = base + ".d";
@@ -0,0 +1,198 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cm3p/json/reader.h>
+#include <cm3p/json/value.h>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmScanDepFormat.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+namespace {
+
+char const* const testCases[] = {
+  "gcc",
+  "clang",
+  "msvc",
+  "bad-version",
+  "two-rules",
+  "no-rules",
+  "bad-lookup-method",
+  "missing-source-path",
+  "provides-not-array",
+  "bad-filename",
+  "truncated",
+  "does-not-exist",
+};
+
+char const* lookupMethodName(LookupMethod method)
+{
+  switch (method) {
+    case LookupMethod::ByName:
+      return "by-name";
+    case LookupMethod::IncludeAngle:
+      return "include-angle";
+    case LookupMethod::IncludeQuote:
+      return "include-quote";
+  }
+  return "";
+}
+
+std::string dump(cmScanDepInfo const& info)
+{
+  std::string out = cmStrCat("primary-output: ", info.PrimaryOutput, '\n');
+  for (std::string const& output : info.ExtraOutputs) {
+    out += cmStrCat("output: ", output, '\n');
+  }
+  for (cmSourceReqInfo const& provide : info.Provides) {
+    out += cmStrCat("provide: logical-name=", provide.LogicalName,
+                    " compiled-module-path=", provide.CompiledModulePath,
+                    " source-path=", provide.SourcePath,
+                    " unique-on-source-path=", provide.UseSourcePath ? 1 : 0,
+                    " is-interface=", provide.IsInterface ? 1 : 0, '\n');
+  }
+  for (cmSourceReqInfo const& require : info.Requires) {
+    out += cmStrCat("require: logical-name=", require.LogicalName,
+                    " compiled-module-path=", require.CompiledModulePath,
+                    " source-path=", require.SourcePath,
+                    " unique-on-source-path=", require.UseSourcePath ? 1 : 0,
+                    " lookup-method=", lookupMethodName(require.Method),
+                    '\n');
+  }
+  return out;
+}
+
+std::string readExpected(std::string const& path)
+{
+  std::string out;
+  cmsys::ifstream is(path.c_str());
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(is, line)) {
+    out += cmStrCat(line, '\n');
+  }
+  return out;
+}
+
+bool testRoundTrip(std::string const& ddi)
+{
+  cmScanDepInfo info;
+  if (!cmScanDepFormat_P1689_Parse(ddi, &info)) {
+    std::cerr << "Reading " << ddi << " should have succeeded\n";
+    return false;
+  }
+  std::string const copy = "testScanDepFormat-roundtrip.ddi";
+  cmScanDepInfo copyInfo;
+  if (!cmScanDepFormat_P1689_Write(copy, info) ||
+      !cmScanDepFormat_P1689_Parse(copy, &copyInfo)) {
+    std::cerr << "Round trip of " << ddi << " failed\n";
+    return false;
+  }
+  if (dump(copyInfo) != dump(info)) {
+    std::cerr << "Round trip of " << ddi << " differs:\n"
+              << dump(copyInfo) << "expected:\n"
+              << dump(info);
+    return false;
+  }
+  return true;
+}
+
+// Compare the time taken to decode the test data with the time jsoncpp
+// takes to only build a document for it.
+void benchmark(std::string const& dataDirPath, int iterations)
+{
+  std::vector<std::string> files;
+  for (char const* name : { "gcc", "clang", "msvc" }) {
+    files.push_back(cmStrCat(dataDirPath, '/', name, ".ddi"));
+  }
+
+  // A scan result of a source file using many modules.
+  cmScanDepInfo large;
+  large.PrimaryOutput = "CMakeFiles/large.dir/large.cxx.o";
+  for (int i = 0; i < 500; ++i) {
+    cmSourceReqInfo require;
+    require.LogicalName = cmStrCat("project.component", i, ":partition");
+    require.SourcePath = cmStrCat("/src/component", i, "/partition.cppm");
+    large.Requires.push_back(require);
+  }
+  files.emplace_back("testScanDepFormat-large.ddi");
+  cmScanDepFormat_P1689_Write(files.back(), large);
+
+  using clock = std::chrono::steady_clock;
+  auto const parseStart = clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (std::string const& file : files) {
+      cmScanDepInfo info;
+      cmScanDepFormat_P1689_Parse(file, &info);
+    }
+  }
+  auto const jsonStart = clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (std::string const& file : files) {
+      cmsys::ifstream is(file.c_str(), std::ios::in | std::ios::binary);
+      Json::Value value;
+      Json::Reader reader;
+      reader.parse(is, value, false);
+    }
+  }
+  auto const end = clock::now();
+
+  auto ms = [](clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+  };
+  std::cout << "cmScanDepFormat_P1689_Parse: " << ms(jsonStart - parseStart)
+            << " ms\n"
+            << "Json::Reader::parse: " << ms(end - jsonStart) << " ms\n";
+}
+
+} // anonymous namespace
+
+int testScanDepFormat(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::cout << "Invalid arguments.\n";
+    return -1;
+  }
+
+  std::string const dataDirPath =
+    cmStrCat(argv[1], "/testScanDepFormat_data");
+  if (argc > 2) {
+    benchmark(dataDirPath, std::atoi(argv[2]));
+    return 0;
+  }
+
+  for (char const* testCase : testCases) {
+    std::string const base = cmStrCat(dataDirPath, '/', testCase);
+    std::string const ddi = cmStrCat(base, ".ddi");
+    std::string const expectedFile = cmStrCat(base, ".txt");
+    std::cout << "Parsing " << ddi << std::endl;
+    cmScanDepInfo info;
+    bool const parsed = cmScanDepFormat_P1689_Parse(ddi, &info);
+    if (cmSystemTools::FileExists(expectedFile)) {
+      if (!parsed) {
+        std::cerr << "Reading " << ddi << " should have succeeded\n";
+        return 1;
+      }
+      std::string const actual = dump(info);
+      std::string const expected = readExpected(expectedFile);
+      if (actual != expected) {
+        std::cerr << "actual:\n" << actual << "expected:\n" << expected;
+        return 1;
+      }
+    } else if (parsed) {
+      std::cerr << "Reading " << ddi << " should have failed\n";
+      return 1;
+    }
+  }
+
+  if (!testRoundTrip(cmStrCat(dataDirPath, "/gcc.ddi")) ||
+      !testRoundTrip(cmStrCat(dataDirPath, "/clang.ddi"))) {
+    return 1;
+  }
+
+  return 0;
+}
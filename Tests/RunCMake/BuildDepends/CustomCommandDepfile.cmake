@@ -79,7 +79,7 @@ if(check_step EQUAL 3)
     )
 
   if (RunCMake_GENERATOR MATCHES \"Make\")
-    file(STRINGS \"${CMAKE_BINARY_DIR}/CMakeFiles/topcc.dir/compiler_depend.internal\" deps REGEX \"^.*topccdep\\\\.txt$\")
+    file(STRINGS \"${CMAKE_BINARY_DIR}/CMakeFiles/topcc.dir/compiler_depend.make\" deps REGEX \"topccdep\\\\.txt( \\\\\\\\)?$\")
     list(LENGTH deps count)
     if (NOT count EQUAL 1)
        string(APPEND RunCMake_TEST_FAILED \"dependencies are duplicated\\n\")
@@ -0,0 +1,6 @@
+if(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/BuildStamp.txt")
+  set(RunCMake_TEST_FAILED "The build did not record a build stamp.")
+elseif(actual_stdout MATCHES "Built target")
+  set(RunCMake_TEST_FAILED
+    "The build did not skip the up-to-date targets:\n${actual_stdout}")
+endif()
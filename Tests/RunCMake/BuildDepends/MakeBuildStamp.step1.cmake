@@ -0,0 +1,7 @@
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/main.c"
+  "#include \"main.h\"\n"
+  "int main(void) { return COUNT; }\n"
+  )
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/main.h"
+  "#define COUNT 1\n"
+  )
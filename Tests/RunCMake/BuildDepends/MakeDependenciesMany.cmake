@@ -0,0 +1,18 @@
+enable_language(C)
+
+set(sources ${CMAKE_CURRENT_BINARY_DIR}/main.c)
+foreach(i RANGE 1 32)
+  list(APPEND sources ${CMAKE_CURRENT_BINARY_DIR}/obj_${i}.c)
+endforeach()
+add_executable(main ${sources})
+
+file(GENERATE OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/check-$<LOWER_CASE:$<CONFIG>>.cmake CONTENT "
+set(check_pairs
+  \"$<TARGET_FILE:main>|${CMAKE_CURRENT_BINARY_DIR}/obj_1.h\"
+  \"$<TARGET_FILE:main>|${CMAKE_CURRENT_BINARY_DIR}/obj_17.h\"
+  \"$<TARGET_FILE:main>|${CMAKE_CURRENT_BINARY_DIR}/obj_32.h\"
+  )
+set(check_exes
+  \"$<TARGET_FILE:main>\"
+  )
+")
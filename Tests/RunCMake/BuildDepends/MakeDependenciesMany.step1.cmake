@@ -0,0 +1,19 @@
+# Enough objects for the compiler generated dependencies of the target to
+# be consolidated by several threads.
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/main.c" "")
+foreach(i RANGE 1 32)
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/obj_${i}.h"
+    "#define VALUE_${i} 0\n"
+    )
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/obj_${i}.c"
+    "#include \"obj_${i}.h\"\n"
+    "int obj_${i}(void) { return VALUE_${i}; }\n"
+    )
+  file(APPEND "${RunCMake_TEST_BINARY_DIR}/main.c"
+    "extern int obj_${i}(void);\n"
+    )
+  string(APPEND sum " + obj_${i}()")
+endforeach()
+file(APPEND "${RunCMake_TEST_BINARY_DIR}/main.c"
+  "int main(void) { return 1${sum}; }\n"
+  )
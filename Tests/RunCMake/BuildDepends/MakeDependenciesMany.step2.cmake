@@ -0,0 +1,3 @@
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/obj_17.h"
+  "#define VALUE_17 1\n"
+  )
@@ -0,0 +1,30 @@
+enable_language(C)
+
+# Both targets scan the same headers with the same rules.
+add_executable(main1 ${CMAKE_CURRENT_BINARY_DIR}/main1.c)
+add_executable(main2 ${CMAKE_CURRENT_BINARY_DIR}/main2.c)
+
+# After step 2 both targets depend on the sentinel seeded in the cache.
+set(check_sentinel [[
+if(check_step EQUAL 2)
+  foreach(main IN ITEMS main1 main2)
+    file(READ "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/${main}.dir/depend.internal" deps)
+    if(NOT deps MATCHES "/sentinel[.]h")
+      string(APPEND RunCMake_TEST_FAILED "
+ ${main} did not take the include lines of shared.h from the cache
+")
+    endif()
+  endforeach()
+endif()
+]])
+
+file(GENERATE OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/check-$<LOWER_CASE:$<CONFIG>>.cmake CONTENT "
+set(check_pairs
+  \"$<TARGET_FILE:main1>|${CMAKE_CURRENT_BINARY_DIR}/shared.h\"
+  \"$<TARGET_FILE:main2>|${CMAKE_CURRENT_BINARY_DIR}/shared.h\"
+  )
+set(check_exes
+  \"$<TARGET_FILE:main1>\"
+  \"$<TARGET_FILE:main2>\"
+  )
+${check_sentinel}")
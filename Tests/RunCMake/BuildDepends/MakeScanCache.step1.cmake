@@ -0,0 +1,9 @@
+foreach(main IN ITEMS main1 main2)
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/${main}.c"
+    "#include \"shared.h\"\n"
+    "int main(void) { return COUNT; }\n"
+    )
+endforeach()
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/shared.h"
+  "#define COUNT 1\n"
+  )
@@ -0,0 +1,22 @@
+# Scanning the changed header finds a new dependency for both targets.
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/shared.h"
+  "#include \"count.h\"\n"
+  )
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/count.h"
+  "#define COUNT 2\n"
+  )
+
+# Seed the shared cache with include lines for the new content of the
+# header that also name a sentinel.  Both targets must take them from
+# the cache instead of scanning the header.
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/sentinel.h" "")
+file(SHA256 "${RunCMake_TEST_BINARY_DIR}/shared.h" shared_hash)
+file(GLOB scan_caches
+  "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/CMakeScanCache/*.includecache")
+if(NOT scan_caches)
+  message(FATAL_ERROR "No shared include scan cache written by step 1.")
+endif()
+foreach(scan_cache IN LISTS scan_caches)
+  file(APPEND "${scan_cache}"
+    "${shared_hash}\ncount.h\n\"\nsentinel.h\n\"\n\n")
+endforeach()
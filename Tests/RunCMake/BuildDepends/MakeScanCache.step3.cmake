@@ -0,0 +1,3 @@
+file(WRITE "${RunCMake_TEST_BINARY_DIR}/count.h"
+  "#define COUNT 3\n"
+  )
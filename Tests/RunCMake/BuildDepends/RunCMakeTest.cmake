@@ -194,6 +194,19 @@ endif()
 
 if(RunCMake_GENERATOR MATCHES "Make")
   run_BuildDepends(MakeDependencies)
+  run_BuildDepends(MakeDependenciesMany)
+  unset(run_BuildDepends_skip_step_3)
+  run_BuildDepends(MakeScanCache -DCMAKE_DEPENDS_USE_COMPILER=OFF)
+  set(run_BuildDepends_skip_step_3 1)
+endif()
+
+if(RunCMake_GENERATOR STREQUAL "Unix Makefiles")
+  run_BuildDepends(MakeBuildStamp)
+  block()
+    set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/MakeBuildStamp-build)
+    set(RunCMake_TEST_NO_CLEAN 1)
+    run_cmake_command(MakeBuildStamp-noop ${CMAKE_COMMAND} --build . --config Debug)
+  endblock()
 endif()
 
 if(RunCMake_GENERATOR MATCHES "Ninja" AND ninja_version VERSION_LESS 1.7)
@@ -396,6 +396,33 @@ run_TestOutputTruncation("middle" "12\\.\\.\\..*\\.\\.\\.89")
 run_TestOutputTruncation("tail" "12345\\.\\.\\.")
 run_TestOutputTruncation("bad" "")
 
+# Test output that is too large to be kept in memory in full.
+function(run_TestOutputBounded)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestOutputBounded)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/DartConfiguration.tcl" "
+BuildDirectory: ${RunCMake_TEST_BINARY_DIR}
+")
+  set(script "${RunCMake_SOURCE_DIR}/TestOutputBounded.cmake")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(BoundedPass \"${CMAKE_COMMAND}\" -DMARK=middle -P \"${script}\")
+  set_tests_properties(BoundedPass PROPERTIES
+    PASS_REGULAR_EXPRESSION \"bounded-end\")
+  add_test(BoundedFail \"${CMAKE_COMMAND}\" -DMARK=bounded-error -P \"${script}\")
+  set_tests_properties(BoundedFail PROPERTIES
+    FAIL_REGULAR_EXPRESSION \"bounded-error\")
+")
+  run_cmake_command(TestOutputBounded
+    ${CMAKE_CTEST_COMMAND} -M Experimental -T Test
+                           --no-compress-output
+                           --test-output-size-passed 100
+                           --test-output-size-failed 200
+    )
+endfunction()
+run_TestOutputBounded()
+
 # Test --stop-on-failure
 function(run_stop_on_failure)
   set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/stop-on-failure)
@@ -672,3 +699,102 @@ endforeach()
   run_cmake_command(ScheduleRandomSeed1 ${CMAKE_CTEST_COMMAND} --schedule-random --schedule-random-seed 42)
   run_cmake_command(ScheduleRandomSeed2 ${CMAKE_CTEST_COMMAND} --schedule-random --schedule-random-seed 42)
 endblock()
+
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ScheduleCriticalPath)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+foreach(t IN ITEMS first second third fourth)
+  add_test(\${t} \"${CMAKE_COMMAND}\" -E true)
+endforeach()
+set_tests_properties(second PROPERTIES DEPENDS first)
+")
+  # The chain 'first' then 'second' is shorter than 'third' or 'fourth'.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt" "first 1 1
+second 1 1
+third 1 100
+fourth 1 90
+---
+")
+  run_cmake_command(ScheduleCriticalPath ${CMAKE_CTEST_COMMAND} -j2 --schedule-critical-path)
+endblock()
+
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestManifest)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(one \"${CMAKE_COMMAND}\" -E true)
+set_tests_properties(one PROPERTIES LABELS label)
+subdirs(sub)
+")
+  # The manifest is kept only for test files older than it.
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 2.1)
+  run_cmake_command(TestManifest-evaluate ${CMAKE_CTEST_COMMAND} -N -V)
+  run_cmake_command(TestManifest-replay ${CMAKE_CTEST_COMMAND} -N -V -L label)
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/sub/CTestTestfile.cmake" "
+include(\"\${CMAKE_CURRENT_LIST_DIR}/two.cmake\")
+")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/sub/two.cmake" "
+add_test(two \"${CMAKE_COMMAND}\" -E true)
+")
+  run_cmake_command(TestManifest-subdir ${CMAKE_CTEST_COMMAND} -N -V)
+  # A test file that calls include() is evaluated even once it is old.
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 2.1)
+  run_cmake_command(TestManifest-include ${CMAKE_CTEST_COMMAND} -N -V)
+endblock()
+
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Shard)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(first \"${CMAKE_COMMAND}\" -E true)
+add_test(second \"${CMAKE_COMMAND}\" -E true)
+add_test(third \"${CMAKE_COMMAND}\" -E true)
+add_test(fourth \"${CMAKE_COMMAND}\" -E false)
+")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt" "\
+first 1 100
+second 1 60
+third 1 50
+fourth 1 20
+")
+  run_cmake_command(Shard-1 ${CMAKE_CTEST_COMMAND} --shard 1/2
+    --output-junit "${RunCMake_TEST_BINARY_DIR}/junit.xml")
+  run_cmake_command(Shard-2 ${CMAKE_CTEST_COMMAND} --shard 2/2
+    --output-junit "${RunCMake_TEST_BINARY_DIR}/junit.xml")
+  run_cmake_command(Shard-merge ${CMAKE_CTEST_COMMAND} --merge-shards 2
+    --output-junit "${RunCMake_TEST_BINARY_DIR}/junit.xml")
+  run_cmake_command(Shard-bad ${CMAKE_CTEST_COMMAND} --shard 3/2)
+endblock()
+
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ShardFixture)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  # The setup test runs in both shards and fails only in the second.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(setup \"${CMAKE_COMMAND}\" -E cat setup-ok.txt)
+add_test(a \"${CMAKE_COMMAND}\" -E true)
+add_test(b \"${CMAKE_COMMAND}\" -E true)
+set_tests_properties(setup PROPERTIES FIXTURES_SETUP fx)
+set_tests_properties(a b PROPERTIES FIXTURES_REQUIRED fx)
+")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt" "\
+setup 1 1
+a 1 100
+b 1 90
+")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/setup-ok.txt" "")
+  run_cmake_command(ShardFixture-1 ${CMAKE_CTEST_COMMAND} --shard 1/2)
+  file(REMOVE "${RunCMake_TEST_BINARY_DIR}/setup-ok.txt")
+  run_cmake_command(ShardFixture-2 ${CMAKE_CTEST_COMMAND} --shard 2/2)
+  run_cmake_command(ShardFixture-merge ${CMAKE_CTEST_COMMAND} --merge-shards 2
+    --output-junit "${RunCMake_TEST_BINARY_DIR}/junit.xml")
+endblock()
@@ -0,0 +1,9 @@
+string(REGEX MATCHALL "Start [1-4]: [a-z]+" order "${actual_stdout}")
+list(SUBLIST order 0 2 started)
+list(SORT started)
+if(NOT started STREQUAL "Start 3: third;Start 4: fourth")
+  string(CONCAT RunCMake_TEST_FAILED
+    "Expected 'third' and 'fourth' to start first, but the order was:\n"
+    " ${order}\n"
+    )
+endif()
@@ -0,0 +1,8 @@
+if(actual_stdout MATCHES "first|fourth")
+  set(RunCMake_TEST_FAILED "Shard 2 ran tests of shard 1.")
+  return()
+endif()
+
+if(EXISTS "${RunCMake_TEST_BINARY_DIR}/junit.xml")
+  set(RunCMake_TEST_FAILED "Shard wrote the JUnit file.")
+endif()
@@ -0,0 +1,18 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/junit.xml" junit_xml)
+string(REGEX MATCHALL "<testcase name=\"[a-z]+\"" testcases "${junit_xml}")
+if(NOT testcases STREQUAL [[<testcase name="first";<testcase name="second";<testcase name="third";<testcase name="fourth"]])
+  set(RunCMake_TEST_FAILED "JUnit file does not have the results of all shards:\n ${testcases}")
+  return()
+endif()
+
+file(READ "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt" cost_data)
+if(NOT cost_data MATCHES "^first 2 [0-9.e-]+\nsecond 2 [0-9.e-]+\nthird 2 [0-9.e-]+\nfourth 1 [0-9.e-]+\n---\nfourth\n$")
+  set(RunCMake_TEST_FAILED "Cost data of the shards not merged:\n${cost_data}")
+  return()
+endif()
+
+file(GLOB shard_files "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/*-shard-*")
+list(FILTER shard_files EXCLUDE REGEX "/LastTest")
+if(shard_files)
+  set(RunCMake_TEST_FAILED "Shard files not removed:\n ${shard_files}")
+endif()
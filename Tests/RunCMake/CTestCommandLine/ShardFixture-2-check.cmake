@@ -0,0 +1,6 @@
+set(temp "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary")
+if(NOT EXISTS "${temp}/LastTestsFailed-shard-2-of-2.log")
+  set(RunCMake_TEST_FAILED "Shard did not write its own failed tests log.")
+elseif(EXISTS "${temp}/LastTestsFailed.log")
+  set(RunCMake_TEST_FAILED "Shard wrote the failed tests log of all shards.")
+endif()
@@ -0,0 +1,17 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/junit.xml" junit_xml)
+if(NOT junit_xml MATCHES "<testcase name=\"setup\"[^>]*status=\"fail\"")
+  set(RunCMake_TEST_FAILED "Failed fixture setup reported as passed:\n${junit_xml}")
+  return()
+endif()
+
+set(temp "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary")
+file(STRINGS "${temp}/LastTestsFailed.log" failed_log)
+if(NOT failed_log STREQUAL "1:setup;3:b")
+  set(RunCMake_TEST_FAILED "Failed tests log of the shards not combined:\n ${failed_log}")
+  return()
+endif()
+
+file(GLOB shard_logs "${temp}/LastTestsFailed-shard-*")
+if(shard_logs)
+  set(RunCMake_TEST_FAILED "Shard logs not removed:\n ${shard_logs}")
+endif()
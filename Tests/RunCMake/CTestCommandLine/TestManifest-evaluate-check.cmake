@@ -0,0 +1,3 @@
+if(actual_stdout MATCHES "Reading test manifest")
+  set(RunCMake_TEST_FAILED "Test manifest read before it was written.")
+endif()
@@ -0,0 +1,5 @@
+if(NOT actual_stdout MATCHES "Replaying test file [^\n]*/TestManifest/CTestTestfile\\.cmake")
+  set(RunCMake_TEST_FAILED "Unchanged test file not replayed.")
+elseif(actual_stdout MATCHES "Replaying test file [^\n]*/sub/")
+  set(RunCMake_TEST_FAILED "New test file replayed.")
+endif()
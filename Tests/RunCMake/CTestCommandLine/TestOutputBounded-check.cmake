@@ -0,0 +1,31 @@
+file(GLOB test_xml_file "${RunCMake_TEST_BINARY_DIR}/Testing/*/Test.xml")
+if(test_xml_file)
+  file(READ "${test_xml_file}" test_xml)
+  if("${test_xml}" MATCHES [[(<Test Status="passed">.*</Test>).*(<Test Status="failed">.*</Test>)]])
+    set(test_passed "${CMAKE_MATCH_1}")
+    set(test_failed "${CMAKE_MATCH_2}")
+  else()
+    set(RunCMake_TEST_FAILED "Test.xml does not contain a passed then failed test:\n ${test_xml}")
+  endif()
+  if(NOT "${test_passed}" MATCHES [=[<Value>bounded-head.*100 bytes\.\]]=])
+    set(RunCMake_TEST_FAILED "Test.xml passed test output not truncated at 100 bytes:\n ${test_passed}")
+  elseif(NOT "${test_failed}" MATCHES [=[<Value>bounded-head.*200 bytes\.\]]=])
+    set(RunCMake_TEST_FAILED "Test.xml failed test output not truncated at 200 bytes:\n ${test_failed}")
+  endif()
+else()
+  set(RunCMake_TEST_FAILED "Test.xml not found")
+endif()
+
+file(GLOB test_log_file "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/LastTest_*.log")
+file(STRINGS "${test_log_file}" test_log REGEX "^(bounded-|filler)")
+list(LENGTH test_log test_log_length)
+list(FILTER test_log INCLUDE REGEX "^bounded-")
+if(NOT test_log_length EQUAL 100005 OR
+   NOT test_log STREQUAL "bounded-head;bounded-end;bounded-head;bounded-error;bounded-end")
+  set(RunCMake_TEST_FAILED "LastTest.log does not have the full test output:\n ${test_log_length} lines\n ${test_log}")
+endif()
+
+file(GLOB spill_files "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestOutput-*")
+if(spill_files)
+  set(RunCMake_TEST_FAILED "Temporary test output files not removed:\n ${spill_files}")
+endif()
@@ -0,0 +1,6 @@
+message("bounded-head")
+string(REPEAT "filler line of test output\n" 25000 filler)
+message("${filler}")
+message("${MARK}")
+message("${filler}")
+message("bounded-end")
@@ -0,0 +1,46 @@
+if (RunCMake_GENERATOR_IS_MULTI_CONFIG)
+  set(path "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/impl-Debug.ninja")
+  set(batch "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/Debug/DyndepBatch.json")
+else ()
+  set(path "${RunCMake_TEST_BINARY_DIR}/build.ninja")
+  set(batch "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/DyndepBatch.json")
+endif ()
+
+if (NOT EXISTS "${path}")
+  list(APPEND RunCMake_TEST_FAILED
+    "Failed to find `ninja` build file: '${path}'")
+endif ()
+if (NOT EXISTS "${batch}")
+  list(APPEND RunCMake_TEST_FAILED
+    "Failed to find dyndep batch file: '${batch}'")
+endif ()
+
+if (NOT RunCMake_TEST_FAILED)
+  file(STRINGS "${path}" collations
+    REGEX "^build .*CXX\\.dd.*:")
+  list(LENGTH collations num_collations)
+  if (NOT num_collations EQUAL 1)
+    list(APPEND RunCMake_TEST_FAILED
+      "Expected one build statement collating all dyndep files, found:\n  ${collations}")
+  elseif (NOT collations MATCHES "ninja-batch-dyndep-provider.dir/(Debug/)?CXX\\.dd.*ninja-batch-dyndep-consumer.dir/(Debug/)?CXX\\.dd.*: CMAKE_DYNDEP_BATCH ")
+    list(APPEND RunCMake_TEST_FAILED
+      "The dyndep files are not collated by one batch:\n  ${collations}")
+  else ()
+    string(REGEX MATCHALL "ninja-batch-dyndep-provider\\.dir/(Debug/)?CXXModules\\.json"
+      provider_modules "${collations}")
+    list(LENGTH provider_modules num_provider_modules)
+    if (NOT num_provider_modules EQUAL 1)
+      list(APPEND RunCMake_TEST_FAILED
+        "The batch must not depend on module information it produces:\n  ${collations}")
+    endif ()
+  endif ()
+
+  file(READ "${batch}" batch_content)
+  string(JSON num_batch_collations LENGTH "${batch_content}" collations)
+  if (NOT num_batch_collations EQUAL 2)
+    list(APPEND RunCMake_TEST_FAILED
+      "Expected 2 collations in '${batch}', found ${num_batch_collations}")
+  endif ()
+endif ()
+
+string(REPLACE ";" "\n  " RunCMake_TEST_FAILED "${RunCMake_TEST_FAILED}")
@@ -0,0 +1,41 @@
+# Fake out that we have dyndep; we only need to generate, not actually build
+# here.
+set(CMAKE_CXX_SCANDEP_SOURCE "")
+
+enable_language(CXX)
+
+if (NOT CMAKE_GENERATOR MATCHES "Ninja")
+  message(FATAL_ERROR
+    "This test requires a 'Ninja' generator to be used.")
+endif ()
+
+set(CMAKE_NINJA_BATCH_DYNDEP 1)
+
+add_library(ninja-batch-dyndep-provider)
+target_sources(ninja-batch-dyndep-provider
+  PUBLIC
+    FILE_SET modules TYPE CXX_MODULES
+    BASE_DIRS
+      "${CMAKE_CURRENT_SOURCE_DIR}/sources"
+    FILES
+      sources/module.cxx
+      sources/module-part.cxx
+    FILE_SET internal_partitions TYPE CXX_MODULES FILES
+      sources/module-internal-part.cxx)
+target_compile_features(ninja-batch-dyndep-provider
+  PRIVATE
+    cxx_std_20)
+
+add_library(ninja-batch-dyndep-consumer)
+target_sources(ninja-batch-dyndep-consumer
+  PRIVATE
+    sources/module-use.cxx)
+target_link_libraries(ninja-batch-dyndep-consumer
+  PRIVATE
+    ninja-batch-dyndep-provider)
+target_compile_features(ninja-batch-dyndep-consumer
+  PRIVATE
+    cxx_std_20)
+set_property(TARGET ninja-batch-dyndep-consumer
+  PROPERTY
+    CXX_SCAN_FOR_MODULES 1)
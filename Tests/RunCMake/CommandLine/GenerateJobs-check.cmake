@@ -0,0 +1,12 @@
+file(GLOB_RECURSE leftovers "${RunCMake_TEST_BINARY_DIR}/*.tmp*")
+if(leftovers)
+  list(JOIN leftovers "\n  " leftovers)
+  set(RunCMake_TEST_FAILED "Temporary files left in build tree:\n  ${leftovers}")
+  return()
+endif()
+foreach(i RANGE 1 8)
+  if(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/GenerateJobs${i}/cmake_install.cmake")
+    set(RunCMake_TEST_FAILED "GenerateJobs${i}/cmake_install.cmake not generated")
+    return()
+  endif()
+endforeach()
@@ -0,0 +1,5 @@
+enable_language(C)
+enable_testing()
+foreach(i RANGE 1 8)
+  add_subdirectory(GenerateJobs GenerateJobs${i})
+endforeach()
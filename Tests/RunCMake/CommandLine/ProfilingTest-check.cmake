@@ -29,3 +29,19 @@ if (NOT numInvocations EQUAL 1)
   set(RunCMake_TEST_FAILED
       "Unexpected number of lowercase command names: ${numInvocations}")
 endif()
+
+file(STRINGS ${ProfilingTestOutput} generateEntries
+  REGEX [["cat"[ ]*:[ ]*"generate"]])
+if (generateEntries STREQUAL "")
+  set(RunCMake_TEST_FAILED "Expected generate step entries")
+endif()
+file(STRINGS ${ProfilingTestOutput} memoryCounters
+  REGEX [["ph"[ ]*:[ ]*"C"]])
+if (memoryCounters STREQUAL "")
+  set(RunCMake_TEST_FAILED "Expected memory counter entries")
+endif()
+file(STRINGS ${ProfilingTestOutput} findCacheCounters
+  REGEX [=["saved_system_calls"[ ]*:[ ]*[1-9]]=])
+if (findCacheCounters STREQUAL "")
+  set(RunCMake_TEST_FAILED "Expected find file system cache counter entries")
+endif()
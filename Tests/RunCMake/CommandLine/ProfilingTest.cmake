@@ -3,3 +3,7 @@ endfunction()
 
 # This must not appear in the profiling output as uppercase
 __TESTING_COMMAND_CASE()
+
+# The searches for these names share one listing of this directory.
+find_file(PROFILING_TEST_FILE NAMES no_such_file_1 no_such_file_2
+  PATHS "${CMAKE_CURRENT_SOURCE_DIR}" NO_DEFAULT_PATH)
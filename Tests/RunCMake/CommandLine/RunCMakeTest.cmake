@@ -44,6 +44,11 @@ run_cmake_command(E_touch-nonexistent-dir ${CMAKE_COMMAND} -E touch "${RunCMake_
 run_cmake_command(E_time ${CMAKE_COMMAND} -E time ${CMAKE_COMMAND} -E echo "hello  world")
 run_cmake_command(E_time-no-arg ${CMAKE_COMMAND} -E time)
 
+run_cmake_command(E_cmake_ninja_dyndep-bad-syntax ${CMAKE_COMMAND} -E cmake_ninja_dyndep
+  --tdi=${RunCMake_SOURCE_DIR}/cmake_ninja_dyndep/tdi.json --lang=CXX
+  --dd=${RunCMake_BINARY_DIR}/E_cmake_ninja_dyndep-bad-syntax.dd
+  ${RunCMake_SOURCE_DIR}/cmake_ninja_dyndep/bad-syntax.ddi)
+
 run_cmake_command(E___run_co_compile-no-iwyu ${CMAKE_COMMAND} -E __run_co_compile -- command-does-not-exist)
 run_cmake_command(E___run_co_compile-bad-iwyu ${CMAKE_COMMAND} -E __run_co_compile --iwyu=iwyu-does-not-exist -- command-does-not-exist)
 run_cmake_command(E___run_co_compile-no--- ${CMAKE_COMMAND} -E __run_co_compile --iwyu=iwyu-does-not-exist command-does-not-exist)
@@ -1149,6 +1154,11 @@ set(RunCMake_TEST_OPTIONS --profiling-format=google-trace --profiling-output=${P
 run_cmake(ProfilingTest)
 unset(RunCMake_TEST_OPTIONS)
 
+run_cmake_with_options(generate-jobs-invalid --generate-jobs=0)
+set(RunCMake_TEST_OPTIONS --generate-jobs=4)
+run_cmake(GenerateJobs)
+unset(RunCMake_TEST_OPTIONS)
+
 run_cmake_with_options(help-arbitrary "--help" "CMAKE_CXX_IGNORE_EXTENSIONS")
 
 if (WIN32 OR DEFINED ENV{HOME})
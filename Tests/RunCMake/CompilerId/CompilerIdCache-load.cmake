@@ -0,0 +1,13 @@
+enable_language(C)
+foreach(var IN ITEMS
+    CMAKE_C_COMPILER_ID
+    CMAKE_C_COMPILER_WORKS
+    CMAKE_C_ABI_COMPILED
+    )
+  if(NOT ${var})
+    message(FATAL_ERROR "${var} is not set from the cache")
+  endif()
+endforeach()
+if(NOT DEFINED CACHE{CMAKE_C_COMPILER})
+  message(FATAL_ERROR "CMAKE_C_COMPILER cache entry is not restored")
+endif()
@@ -0,0 +1,6 @@
+enable_language(C)
+file(GLOB_RECURSE entries "${CMAKE_COMPILER_ID_CACHE}/*/entry.json")
+list(LENGTH entries n)
+if(NOT n EQUAL 1)
+  message(FATAL_ERROR "expected 1 cache entry, found ${n}:\n ${entries}")
+endif()
@@ -3,6 +3,13 @@ include(RunCMake)
 run_cmake(C)
 run_cmake(CXX)
 
+set(RunCMake_TEST_OPTIONS
+  -DCMAKE_COMPILER_ID_CACHE=${RunCMake_BINARY_DIR}/CompilerIdCache)
+file(REMOVE_RECURSE "${RunCMake_BINARY_DIR}/CompilerIdCache")
+run_cmake(CompilerIdCache-store)
+run_cmake(CompilerIdCache-load)
+unset(RunCMake_TEST_OPTIONS)
+
 if(CMake_TEST_CUDA)
   run_cmake(CUDA)
 endif()
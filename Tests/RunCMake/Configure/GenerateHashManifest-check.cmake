@@ -0,0 +1,10 @@
+set(manifest "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/cmake.generated_hashes")
+if(NOT EXISTS "${manifest}")
+  set(RunCMake_TEST_FAILED "Expected manifest:\n  ${manifest}")
+  return()
+endif()
+file(STRINGS "${manifest}" entries
+  REGEX "^[0-9a-f]+ [0-9]+ -?[0-9]+ .*/CMakeFiles/CMakeDirectoryInformation\\.cmake$")
+if(NOT entries)
+  set(RunCMake_TEST_FAILED "Expected manifest entry for CMakeDirectoryInformation.cmake")
+endif()
@@ -0,0 +1,3 @@
+if(EXISTS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/cmake.generated_hashes")
+  set(RunCMake_TEST_FAILED "Expected manifest to be removed")
+endif()
@@ -0,0 +1,5 @@
+include(${CMAKE_CURRENT_LIST_DIR}/GenerateHashManifest-check.cmake)
+file(READ "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/CMakeDirectoryInformation.cmake" content)
+if(content MATCHES "# modified")
+  string(APPEND RunCMake_TEST_FAILED "\nModified generated file was not restored")
+endif()
@@ -0,0 +1 @@
+add_custom_target(hashed ALL COMMAND ${CMAKE_COMMAND} -E echo hashed)
@@ -0,0 +1,4 @@
+file(READ ${RunCMake_TEST_BINARY_DIR}/RegenerateLog.txt content)
+if(NOT content STREQUAL "1\n2\n2\n")
+  set(RunCMake_TEST_FAILED "Expected log '1;2;2' but got: '${content}'")
+endif()
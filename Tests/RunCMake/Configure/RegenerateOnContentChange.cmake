@@ -0,0 +1,5 @@
+set(CMAKE_REGENERATE_ON_CONTENT_CHANGE ON)
+set(depend ${CMAKE_CURRENT_BINARY_DIR}/RegenerateDepend.txt)
+set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${depend})
+file(READ ${depend} content)
+file(APPEND ${CMAKE_CURRENT_BINARY_DIR}/RegenerateLog.txt "${content}\n")
@@ -57,6 +57,49 @@ if(RunCMake_GENERATOR MATCHES "^Ninja")
   endblock()
 endif()
 
+if(RunCMake_GENERATOR MATCHES "Makefiles|^Ninja")
+  block()
+    set(RunCMake_TEST_BINARY_DIR
+      ${RunCMake_BINARY_DIR}/RegenerateOnContentChange-build)
+    set(RunCMake_TEST_NO_CLEAN 1)
+    file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+    file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+    set(depend "${RunCMake_TEST_BINARY_DIR}/RegenerateDepend.txt")
+    file(WRITE "${depend}" "1")
+    run_cmake(RegenerateOnContentChange)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1) # handle 1s resolution
+    file(TOUCH "${depend}")
+    run_cmake_command(RegenerateOnContentChange-build1 ${CMAKE_COMMAND} --build .)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1) # handle 1s resolution
+    file(WRITE "${depend}" "2")
+    run_cmake_command(RegenerateOnContentChange-build2 ${CMAKE_COMMAND} --build .)
+    run_cmake_command(RegenerateOnContentChange-rebuild_cache
+      ${CMAKE_COMMAND} --build . --target rebuild_cache)
+  endblock()
+endif()
+
+if(RunCMake_GENERATOR MATCHES "Makefiles")
+  block()
+    set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/GenerateHashManifest-build)
+    set(RunCMake_TEST_NO_CLEAN 1)
+    file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+    file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+    set(RunCMake_TEST_OPTIONS -DCMAKE_GENERATE_HASH_MANIFEST=ON)
+    run_cmake(GenerateHashManifest)
+    unset(RunCMake_TEST_OPTIONS)
+    file(APPEND "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/CMakeDirectoryInformation.cmake" "# modified\n")
+    run_cmake_command(GenerateHashManifest-rerun ${CMAKE_COMMAND} .)
+    file(WRITE "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/cmake.generated_hashes"
+      "# corrupt\n"
+      "0123 x 1 ${RunCMake_TEST_BINARY_DIR}/CMakeFiles/CMakeDirectoryInformation.cmake\n"
+      "0123 1 99999999999999999999999 ${RunCMake_TEST_BINARY_DIR}/Makefile\n"
+      "0123 -\n"
+      )
+    run_cmake_command(GenerateHashManifest-corrupt ${CMAKE_COMMAND} .)
+    run_cmake_command(GenerateHashManifest-off ${CMAKE_COMMAND} -DCMAKE_GENERATE_HASH_MANIFEST=OFF .)
+  endblock()
+endif()
+
 block()
   set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/RemoveCache-build)
   set(RunCMake_TEST_VARIANT_DESCRIPTION "-step1")
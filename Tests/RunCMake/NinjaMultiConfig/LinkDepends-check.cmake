@@ -0,0 +1,35 @@
+set(actual)
+foreach(config IN ITEMS Debug Release MinSizeRel)
+  file(STRINGS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/impl-${config}.ninja" lines)
+  set(target)
+  foreach(line IN LISTS lines)
+    if(line MATCHES "^build [^:]*: C_EXECUTABLE_LINKER__([a-z_]+)_${config} ")
+      set(target "${CMAKE_MATCH_1}")
+    elseif(target AND line MATCHES "^  LINK_LIBRARIES = (.*)$")
+      string(REGEX MATCHALL "ld_[a-z]+" libs "${CMAKE_MATCH_1}")
+      list(JOIN libs " " libs)
+      list(APPEND actual "${target} ${config}:${libs}")
+      set(target)
+    elseif(line STREQUAL "")
+      set(target)
+    endif()
+  endforeach()
+endforeach()
+list(SORT actual)
+
+set(expected
+  "iface_exe Debug:ld_c"
+  "iface_exe MinSizeRel:ld_c"
+  "iface_exe Release:ld_d ld_c"
+  "impl_exe Debug:ld_a ld_d ld_b ld_c"
+  "impl_exe MinSizeRel:ld_a ld_b ld_c"
+  "impl_exe Release:ld_a ld_b ld_c"
+  "shared_exe Debug:ld_a ld_b ld_c"
+  "shared_exe MinSizeRel:ld_a ld_b ld_c"
+  "shared_exe Release:ld_a ld_b ld_c"
+  )
+if(NOT actual STREQUAL expected)
+  string(REPLACE ";" "\n  " expected "${expected}")
+  string(REPLACE ";" "\n  " actual "${actual}")
+  set(RunCMake_TEST_FAILED "Expected link libraries:\n  ${expected}\nActual link libraries:\n  ${actual}\n")
+endif()
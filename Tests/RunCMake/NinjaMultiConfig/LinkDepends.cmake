@@ -0,0 +1,21 @@
+enable_language(C)
+
+add_library(ld_a STATIC empty.c)
+add_library(ld_b STATIC empty.c)
+add_library(ld_c STATIC empty.c)
+add_library(ld_d STATIC empty.c)
+target_link_libraries(ld_a PUBLIC ld_b)
+target_link_libraries(ld_b PUBLIC ld_c)
+
+# Link dependencies that are the same in every configuration.
+add_executable(shared_exe main.c)
+target_link_libraries(shared_exe PRIVATE ld_a)
+
+# Link dependencies that differ between configurations, through the
+# link implementation or the link interface of a dependency.
+add_executable(impl_exe main.c)
+target_link_libraries(impl_exe PRIVATE ld_a $<$<CONFIG:Debug>:ld_d>)
+add_library(ld_iface INTERFACE)
+target_link_libraries(ld_iface INTERFACE $<$<CONFIG:Release>:ld_d> ld_c)
+add_executable(iface_exe main.c)
+target_link_libraries(iface_exe PRIVATE ld_iface)
@@ -0,0 +1,30 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/compile_commands.json" compile_commands)
+string(JSON count LENGTH "${compile_commands}")
+math(EXPR last "${count} - 1")
+set(actual)
+foreach(i RANGE ${last})
+  string(JSON command GET "${compile_commands}" ${i} command)
+  string(JSON output GET "${compile_commands}" ${i} output)
+  if(NOT output MATCHES "/CMakeFiles/([a-z_]+)\\.dir/([A-Za-z]+)/")
+    continue()
+  endif()
+  set(object "${CMAKE_MATCH_1} ${CMAKE_MATCH_2}")
+  string(REGEX MATCHALL "-D[A-Z]+_DEP[A-Za-z_]*" defines "${command}")
+  list(JOIN defines " " defines)
+  list(APPEND actual "${object}:${defines}")
+endforeach()
+list(SORT actual)
+
+set(expected
+  "config_exe Debug:-DCONFIG_DEP_Debug"
+  "config_exe Release:-DCONFIG_DEP_Release"
+  "debug_exe Debug:-DSHARED_DEP"
+  "debug_exe Release:"
+  "shared_exe Debug:-DSHARED_DEP"
+  "shared_exe Release:-DSHARED_DEP"
+  )
+if(NOT actual STREQUAL expected)
+  string(REPLACE ";" "\n  " expected "${expected}")
+  string(REPLACE ";" "\n  " actual "${actual}")
+  set(RunCMake_TEST_FAILED "Expected compile definitions:\n  ${expected}\nActual compile definitions:\n  ${actual}\n")
+endif()
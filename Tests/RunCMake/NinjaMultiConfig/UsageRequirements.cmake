@@ -0,0 +1,17 @@
+enable_language(C)
+
+add_library(shared_dep INTERFACE)
+target_compile_definitions(shared_dep INTERFACE SHARED_DEP)
+add_library(config_dep INTERFACE)
+target_compile_definitions(config_dep INTERFACE CONFIG_DEP_$<CONFIG>)
+
+# Usage requirements that are the same in every configuration.
+add_executable(shared_exe main.c)
+target_link_libraries(shared_exe PRIVATE shared_dep)
+
+# Usage requirements that differ between configurations, through the
+# properties of a dependency or the link implementation.
+add_executable(config_exe main.c)
+target_link_libraries(config_exe PRIVATE config_dep)
+add_executable(debug_exe main.c)
+target_link_libraries(debug_exe PRIVATE $<$<CONFIG:Debug>:shared_dep>)
@@ -0,0 +1,18 @@
+set(prefix "${CMAKE_CURRENT_BINARY_DIR}/prefix")
+file(REMOVE_RECURSE "${prefix}")
+file(MAKE_DIRECTORY "${prefix}/lib/cmake")
+
+find_package(Changed CONFIG QUIET PATHS "${prefix}" NO_DEFAULT_PATH)
+message(STATUS "Changed_FOUND='${Changed_FOUND}'")
+
+# A package written during the configure step is found by later searches.
+file(WRITE "${prefix}/lib/cmake/Changed/ChangedConfig.cmake" "")
+unset(Changed_DIR CACHE)
+find_package(Changed CONFIG QUIET PATHS "${prefix}" NO_DEFAULT_PATH)
+message(STATUS "Changed_FOUND='${Changed_FOUND}'")
+
+# A package removed during the configure step is not found any more.
+file(REMOVE_RECURSE "${prefix}/lib/cmake/Changed")
+unset(Changed_DIR CACHE)
+find_package(Changed CONFIG QUIET PATHS "${prefix}" NO_DEFAULT_PATH)
+message(STATUS "Changed_FOUND='${Changed_FOUND}'")
@@ -0,0 +1,3 @@
+if(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/FindPackageCache.json")
+  set(RunCMake_TEST_FAILED "CMakeFiles/FindPackageCache.json not created")
+endif()
@@ -0,0 +1,3 @@
+if(actual_stdout MATCHES "Loading FpcConfig")
+  set(RunCMake_TEST_FAILED "FpcConfig.cmake loaded instead of replayed")
+endif()
@@ -0,0 +1,15 @@
+set(extra "${CMAKE_CURRENT_BINARY_DIR}/pkg/FpcExtra.cmake")
+if(FPC_CHANGE)
+  file(WRITE "${extra}" "set(Fpc_EXTRA changed)\n")
+elseif(NOT EXISTS "${extra}")
+  file(WRITE "${extra}" "set(Fpc_EXTRA original)\n")
+endif()
+
+find_package(Fpc REQUIRED CONFIG COMPONENTS comp
+  PATHS "${CMAKE_CURRENT_SOURCE_DIR}/FindPackageCache" NO_DEFAULT_PATH)
+
+get_property(defs TARGET Fpc::fpc PROPERTY INTERFACE_COMPILE_DEFINITIONS)
+get_property(loads GLOBAL PROPERTY FPC_LOADS)
+fpc_function(f a)
+fpc_macro(m b)
+message(STATUS "Fpc: ${Fpc_FOUND} ${defs} ${Fpc_VALUE} ${loads} ${f} ${m}")
@@ -0,0 +1,13 @@
+message(DEBUG "Loading FpcConfig.cmake")
+include("${CMAKE_CURRENT_BINARY_DIR}/pkg/FpcExtra.cmake")
+add_library(Fpc::fpc INTERFACE IMPORTED)
+set_property(TARGET Fpc::fpc PROPERTY
+  INTERFACE_COMPILE_DEFINITIONS "FPC_${Fpc_EXTRA}")
+set(Fpc_VALUE "${Fpc_FIND_COMPONENTS}")
+set_property(GLOBAL APPEND PROPERTY FPC_LOADS "${Fpc_EXTRA}")
+function(fpc_function out)
+  set(${out} "function ${ARGN}" PARENT_SCOPE)
+endfunction()
+macro(fpc_macro out)
+  set(${out} "macro ${ARGN}")
+endmacro()
@@ -0,0 +1,7 @@
+message(DEBUG "Loading FpiConfig.cmake")
+set(Fpi_ENV "$ENV{FPI_ENV}")
+if(EXISTS "${CMAKE_BINARY_DIR}/fpi-marker")
+  set(Fpi_MARKER "marker")
+else()
+  set(Fpi_MARKER "no-marker")
+endif()
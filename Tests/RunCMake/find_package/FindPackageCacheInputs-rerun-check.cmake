@@ -0,0 +1,3 @@
+if(actual_stdout MATCHES "Loading FpiConfig")
+  set(RunCMake_TEST_FAILED "FpiConfig.cmake loaded instead of replayed")
+endif()
@@ -0,0 +1,3 @@
+find_package(Fpi REQUIRED CONFIG
+  PATHS "${CMAKE_CURRENT_SOURCE_DIR}/FindPackageCache" NO_DEFAULT_PATH)
+message(STATUS "Fpi: ${Fpi_ENV} ${Fpi_MARKER}")
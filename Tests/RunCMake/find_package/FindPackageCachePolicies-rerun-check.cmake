@@ -0,0 +1,3 @@
+if(actual_stdout MATCHES "Loading FppConfig")
+  set(RunCMake_TEST_FAILED "FppConfig.cmake loaded instead of replayed")
+endif()
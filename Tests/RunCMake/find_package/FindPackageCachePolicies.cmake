@@ -0,0 +1,8 @@
+cmake_policy(SET CMP0111 NEW)
+find_package(Fpp REQUIRED CONFIG
+  PATHS "${CMAKE_CURRENT_SOURCE_DIR}/FindPackageCachePolicies" NO_DEFAULT_PATH)
+
+# Fpp::fpp has no location.  It was created with CMP0111 unset, so this
+# warns instead of failing.
+file(GENERATE OUTPUT "${CMAKE_CURRENT_BINARY_DIR}/fpp.txt"
+  CONTENT "$<TARGET_FILE:Fpp::fpp>\n")
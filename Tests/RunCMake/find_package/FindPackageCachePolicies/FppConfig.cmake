@@ -0,0 +1,9 @@
+message(DEBUG "Loading FppConfig.cmake")
+cmake_policy(PUSH)
+cmake_policy(VERSION 3.10)
+add_library(Fpp::fpp UNKNOWN IMPORTED)
+add_library(Fpp::check INTERFACE IMPORTED)
+set_target_properties(Fpp::check PROPERTIES
+  INTERFACE_LINK_LIBRARIES missing
+  LINK_LIBRARIES_ONLY_TARGETS ON)
+cmake_policy(POP)
@@ -5,6 +5,7 @@ run_cmake(CMP0074-OLD)
 run_cmake(ComponentRecursion)
 run_cmake(ComponentRequiredAndOptional)
 run_cmake(EmptyRoots)
+run_cmake(FileSystemChanges)
 run_cmake(FromPATHEnv)
 run_cmake_with_options(FromPATHEnvDebugPkg --debug-find-pkg=Resolved)
 run_cmake(FromPrefixPath)
@@ -126,6 +127,43 @@ if(UNIX
   run_cmake(SetFoundResolved)
 endif()
 
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/FindPackageCache-build)
+  set(RunCMake_TEST_OPTIONS -DCMAKE_FIND_PACKAGE_CACHE=ON --log-level=DEBUG)
+  run_cmake(FindPackageCache)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  run_cmake_command(FindPackageCache-rerun
+    ${CMAKE_COMMAND} --log-level=DEBUG .)
+  run_cmake_command(FindPackageCache-changed
+    ${CMAKE_COMMAND} --log-level=DEBUG -DFPC_CHANGE=1 .)
+endblock()
+
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/FindPackageCachePolicies-build)
+  set(RunCMake_TEST_OPTIONS -DCMAKE_FIND_PACKAGE_CACHE=ON --log-level=DEBUG)
+  run_cmake(FindPackageCachePolicies)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  run_cmake_command(FindPackageCachePolicies-rerun
+    ${CMAKE_COMMAND} --log-level=DEBUG .)
+endblock()
+
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/FindPackageCacheInputs-build)
+  set(RunCMake_TEST_OPTIONS -DCMAKE_FIND_PACKAGE_CACHE=ON --log-level=DEBUG)
+  set(ENV{FPI_ENV} a)
+  run_cmake(FindPackageCacheInputs)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  run_cmake_command(FindPackageCacheInputs-rerun
+    ${CMAKE_COMMAND} --log-level=DEBUG .)
+  set(ENV{FPI_ENV} b)
+  run_cmake_command(FindPackageCacheInputs-env
+    ${CMAKE_COMMAND} --log-level=DEBUG .)
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/fpi-marker" "")
+  run_cmake_command(FindPackageCacheInputs-exists
+    ${CMAKE_COMMAND} --log-level=DEBUG .)
+  unset(ENV{FPI_ENV})
+endblock()
+
 if(CMAKE_HOST_SYSTEM_NAME STREQUAL "Windows")
   # Tests using the Windows registry
   find_program(REG NAMES "reg.exe" NO_CACHE)
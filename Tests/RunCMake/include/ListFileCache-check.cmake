@@ -0,0 +1,3 @@
+if(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/ListFileCache.bin")
+  set(RunCMake_TEST_FAILED "CMakeFiles/ListFileCache.bin not created")
+endif()
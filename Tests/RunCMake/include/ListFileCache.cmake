@@ -0,0 +1,6 @@
+set(inc "${CMAKE_CURRENT_BINARY_DIR}/ListFileCacheInc.cmake")
+file(WRITE "${inc}" "message(STATUS \"ListFileCacheInc: first\")\n")
+include("${inc}")
+file(WRITE "${inc}" "message(STATUS \"ListFileCacheInc: second\")\n")
+include("${inc}")
+include(ListFileCacheWarn.cmake)
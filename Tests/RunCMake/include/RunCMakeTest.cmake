@@ -38,3 +38,11 @@ run_cmake(CMP0191-OLD)
 run_cmake(CMP0191-WARN)
 run_cmake(CMP0191-NEW-name)
 run_cmake(CMP0191-NEW-path)
+
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ListFileCache-build)
+  set(RunCMake_TEST_OPTIONS -DCMAKE_LISTFILE_CACHE=ON)
+  run_cmake(ListFileCache)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  run_cmake_command(ListFileCache-rerun ${CMAKE_COMMAND} .)
+endblock()
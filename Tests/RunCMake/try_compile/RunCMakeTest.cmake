@@ -50,6 +50,9 @@ run_cmake(Verbose)
 
 run_cmake(ProjectVars)
 
+run_cmake(TryCompileCache)
+run_cmake(TryCompileBatch)
+
 set(RunCMake_TEST_OPTIONS --debug-trycompile)
 run_cmake(PlatformVariables)
 run_cmake(WarnDeprecated)
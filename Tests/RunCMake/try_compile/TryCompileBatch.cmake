@@ -0,0 +1,49 @@
+enable_language(C)
+
+try_compile(good SOURCE_FROM_CONTENT good.c "int main(void) { return 0; }\n"
+  NO_CACHE BATCH checks
+  COPY_FILE "${CMAKE_CURRENT_BINARY_DIR}/copy")
+try_compile(bad SOURCE_FROM_CONTENT bad.c "#error bad\nint main(void) { return 0; }\n"
+  NO_CACHE BATCH checks
+  OUTPUT_VARIABLE bad_output)
+try_compile(defined SOURCE_FROM_CONTENT defined.c "
+#ifndef DEFINED
+#error DEFINED is not defined
+#endif
+int main(void) { return 0; }
+"
+  NO_CACHE BATCH checks
+  CMAKE_FLAGS -DCOMPILE_DEFINITIONS:STRING=-DDEFINED)
+try_compile(undefined SOURCE_FROM_CONTENT undefined.c "
+#ifdef DEFINED
+#error DEFINED is defined
+#endif
+int main(void) { return 0; }
+"
+  NO_CACHE BATCH checks)
+
+foreach(var IN ITEMS good bad defined undefined)
+  if(DEFINED ${var})
+    message(FATAL_ERROR "${var} is set before the batch is built")
+  endif()
+endforeach()
+
+try_compile(BUILD_BATCH checks)
+
+foreach(var IN ITEMS good defined undefined)
+  if(NOT ${var})
+    message(FATAL_ERROR "try_compile of ${var} failed in the batch")
+  endif()
+endforeach()
+if(bad)
+  message(FATAL_ERROR "try_compile of bad succeeded in the batch")
+endif()
+if(NOT bad_output MATCHES "bad")
+  message(FATAL_ERROR "try_compile of bad has no output:\n${bad_output}")
+endif()
+if(NOT EXISTS "${CMAKE_CURRENT_BINARY_DIR}/copy")
+  message(FATAL_ERROR "try_compile in the batch did not copy the built file")
+endif()
+
+# The batch is empty once built.
+try_compile(BUILD_BATCH checks)
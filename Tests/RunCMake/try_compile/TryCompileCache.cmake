@@ -0,0 +1,57 @@
+enable_language(C)
+
+set(CMAKE_TRY_COMPILE_CACHE "${CMAKE_CURRENT_BINARY_DIR}/cache")
+
+function(count_results expect)
+  file(GLOB_RECURSE results "${CMAKE_TRY_COMPILE_CACHE}/*/result.json")
+  list(LENGTH results n)
+  if(NOT n EQUAL expect)
+    message(FATAL_ERROR "expected ${expect} cache entries, found ${n}:\n ${results}")
+  endif()
+  set(results "${results}" PARENT_SCOPE)
+endfunction()
+
+try_compile(first SOURCE_FROM_CONTENT cache.c "int main(void) { return 0; }\n"
+  NO_CACHE)
+if(NOT first)
+  message(FATAL_ERROR "first try_compile failed")
+endif()
+count_results(1)
+
+# Mark the stored output to tell a cached result from a build.
+file(READ "${results}" json)
+string(JSON json SET "${json}" output "\"cached output\"")
+file(WRITE "${results}" "${json}")
+
+try_compile(second SOURCE_FROM_CONTENT cache.c "int main(void) { return 0; }\n"
+  NO_CACHE
+  OUTPUT_VARIABLE output
+  COPY_FILE "${CMAKE_CURRENT_BINARY_DIR}/copy")
+if(NOT second)
+  message(FATAL_ERROR "second try_compile failed")
+endif()
+if(NOT output STREQUAL "cached output")
+  message(FATAL_ERROR "second try_compile did not use the cache:\n${output}")
+endif()
+if(NOT EXISTS "${CMAKE_CURRENT_BINARY_DIR}/copy")
+  message(FATAL_ERROR "cached try_compile did not restore the built file")
+endif()
+count_results(1)
+
+try_compile(third SOURCE_FROM_CONTENT cache.c "int main(void) { return 1; }\n"
+  NO_CACHE
+  OUTPUT_VARIABLE output)
+if(output STREQUAL "cached output")
+  message(FATAL_ERROR "try_compile of different source used the cache")
+endif()
+count_results(2)
+
+foreach(i 1 2)
+  try_run(run_result compile_result
+    SOURCE_FROM_CONTENT run.c "int main(void) { return 42; }\n"
+    NO_CACHE)
+  if(NOT compile_result OR NOT run_result EQUAL 42)
+    message(FATAL_ERROR "try_run ${i} failed: ${compile_result} ${run_result}")
+  endif()
+endforeach()
+count_results(3)